@@ -1,9 +1,11 @@
 {
-    'targets': [{
-        'target_name': 'couchbase_impl',
-        'variables': {
-            'couchbase_root%': ''
-        },
+    'variables': {
+        'couchbase_root%': '',
+        # Also build couchbase_bench, the binding instrumented for
+        # test/kvbench.js (node-gyp rebuild --couchbase_bench=1)
+        'couchbase_bench%': 0
+    },
+    'target_defaults': {
         'defines': [
             'LCBUV_EMBEDDED_SOURCE',
             'LCB_TRACING'
@@ -71,6 +73,7 @@
         ],
         'sources': [
             'src/addondata.cpp',
+            'src/benchstats.cpp',
             'src/binding.cpp',
             'src/cas.cpp',
             'src/connection_ops.cpp',
@@ -79,17 +82,46 @@
             'src/error.cpp',
             'src/instance.cpp',
             'src/instance_callbacks.cpp',
+            'src/ioshards.cpp',
+            'src/iothread.cpp',
             'src/lcbx.cpp',
             'src/logger.cpp',
             'src/metrics.cpp',
             'src/mutationtoken.cpp',
             'src/opbuilder.cpp',
             'src/respreader.cpp',
+            'src/sdresult.cpp',
+            'src/sdtemplate.cpp',
             'src/tracing.cpp',
             'src/uv-plugin-all.cpp'
         ],
         'include_dirs': [
             '<!(node -e "require(\'nan\')")'
         ]
-    }]
+    },
+    'targets': [{
+        'target_name': 'couchbase_impl'
+    }],
+    'conditions': [
+        ['couchbase_bench==1', {
+            'targets': [{
+                'target_name': 'couchbase_bench',
+                'defines': [
+                    'LCBX_BENCH'
+                ],
+                'conditions': [
+                    ['OS=="linux"', {
+                        # The allocation counters replace operator new, which
+                        # must only apply to the code inside of the addon
+                        'defines': [
+                            'LCBX_BENCH_ALLOCS'
+                        ],
+                        'ldflags': [
+                            '-Wl,-Bsymbolic-functions'
+                        ]
+                    }]
+                ]
+            }]
+        }]
+    ]
 }
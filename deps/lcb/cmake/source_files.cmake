@@ -26,6 +26,9 @@ FILE(GLOB LCB_RDB_SRC src/rdb/*.c)
 # send buffer management
 FILE(GLOB LCB_NETBUF_SRC src/netbuf/*.c)
 
+# shared buffer pool
+FILE(GLOB LCB_SLAB_SRC src/slab/*.cc)
+
 # HTTP protocol management
 LIST(APPEND LCB_HT_SRC "contrib/http_parser/http_parser.c")
 
@@ -77,6 +80,7 @@ SET(LCB_CORE_CXXSRC
     src/n1ql/ixmgmt.cc
     src/n1ql/n1ql-internal.cc
     src/n1ql/n1ql.cc
+    src/n1ql/query_body.cc
     src/n1ql/query_handle.cc
     src/n1ql/query_utils.cc
     src/newconfig.cc
@@ -1326,11 +1326,199 @@ typedef enum {
  */
 #define LCB_CNTL_ENABLE_OP_METRICS 0x67
 
+/**
+ * @brief Revalidate configurations loaded from the config cache.
+ *
+ * When the client bootstraps from a cached configuration (see
+ * @ref LCB_CNTL_CONFIGCACHE), operations are dispatched using the cached
+ * cluster map straight away, and a fresh configuration is requested from the
+ * cluster in the background.  Operations which hit a stale mapping are
+ * retried according to the NOT_MY_VBUCKET response.  Disabling this leaves
+ * the cached configuration in place until an error triggers a refresh.
+ *
+ * This is enabled by default.
+ *
+ * Use `config_cache_revalidate` in the connection string.
+ *
+ * @cntl_arg_both{int* (as boolean)}
+ * @uncommitted
+ */
+#define LCB_CNTL_CONFIGCACHE_REVALIDATE 0x68
+
+/**
+ * @brief Maximum number of TLS sessions kept for resumption.
+ *
+ * Each TLS connection stores the session it negotiated under the remote
+ * `host:port`, and new connections to the same endpoint offer it to the
+ * server, which allows them to skip the full key exchange.  The oldest
+ * session is evicted once the cache is full.  Setting this to 0 disables
+ * session resumption.
+ *
+ * The number of resumed and full handshakes is reported in @ref lcb_METRICS
+ * when metrics are enabled.
+ *
+ * Use `ssl_session_cache_size` in the connection string.
+ *
+ * @cntl_arg_both{lcb_U32*}
+ * @uncommitted
+ */
+#define LCB_CNTL_SSL_SESSION_CACHE_SIZE 0x69
+
+/**
+ * @brief Time for which a cached TLS session is offered for resumption.
+ *
+ * Sessions older than this are discarded rather than offered to the server.
+ * The default is 300 seconds.
+ *
+ * Use `ssl_session_lifetime` in the connection string.
+ *
+ * @cntl_arg_both{lcb_U32*}
+ * @uncommitted
+ */
+#define LCB_CNTL_SSL_SESSION_LIFETIME 0x6A
+
+/**
+ * @brief Time for which resolved host addresses are reused.
+ *
+ * Connections to a host whose addresses were looked up less than this long
+ * ago reuse the earlier result instead of querying the resolver again. An
+ * entry is dropped early if none of its addresses accept a connection.
+ * The default is 10 seconds. Setting this to 0 disables the cache.
+ *
+ * Use `dns_cache_ttl` in the connection string.
+ *
+ * @cntl_arg_both{lcb_U32*}
+ * @uncommitted
+ */
+#define LCB_CNTL_DNS_CACHE_TTL 0x6B
+
+/**
+ * @brief Maximum number of bytes kept in the process-wide buffer pool.
+ *
+ * Network read and write buffers for every instance in the process are drawn
+ * from a single pool. Buffers released beyond this limit are given back to
+ * the system. The default is 16 MB.
+ *
+ * This modifies a static, global setting.
+ *
+ * @cntl_arg_both{lcb_SIZE*}
+ * @note Pass NULL to lcb_cntl for the 'instance' parameter.
+ * @uncommitted
+ */
+#define LCB_CNTL_BUFFER_POOL_LIMIT 0x6C
+
+/**
+ * @brief Maximum number of bytes each thread keeps in its private cache of
+ * the buffer pool.
+ *
+ * Buffers in a thread's cache are reused without taking the pool's lock. The
+ * default is 1 MB.
+ *
+ * This modifies a static, global setting.
+ *
+ * @cntl_arg_both{lcb_SIZE*}
+ * @note Pass NULL to lcb_cntl for the 'instance' parameter.
+ * @uncommitted
+ */
+#define LCB_CNTL_BUFFER_POOL_THREAD_LIMIT 0x6D
+
+/**
+ * @brief Usage counters of the process-wide buffer pool.
+ * @uncommitted
+ */
+typedef struct {
+    lcb_U64 bytes_pooled;   /**< Bytes currently held for reuse, including thread caches */
+    lcb_U64 allocations;    /**< Buffers handed out */
+    lcb_U64 hits;           /**< Buffers handed out from the pool rather than allocated */
+    lcb_U64 bytes_released; /**< Bytes given back to the system */
+} lcb_BUFFER_POOL_STATS;
+
+/**
+ * @brief Retrieve the usage counters of the process-wide buffer pool.
+ *
+ * The hit rate is `hits / allocations`.
+ *
+ * @cntl_arg_getonly{lcb_BUFFER_POOL_STATS*}
+ * @note Pass NULL to lcb_cntl for the 'instance' parameter.
+ * @uncommitted
+ */
+#define LCB_CNTL_BUFFER_POOL_STATS 0x6E
+
+/**
+ * @brief Number of idle connections to keep open to each query node.
+ *
+ * Connections are opened as soon as the cluster map is known, and replaced
+ * as they are used or closed, so that requests do not have to wait for a new
+ * connection. The default is 0, which opens connections only on demand.
+ *
+ * Use `query_min_idle_connections` in the connection string
+ *
+ * @cntl_arg_both{lcb_U32*}
+ * @uncommitted
+ */
+#define LCB_CNTL_QUERY_MIN_IDLE_CONNECTIONS 0x6F
+
+/**
+ * @brief Number of idle connections to keep open to each search node.
+ *
+ * Use `search_min_idle_connections` in the connection string
+ *
+ * @cntl_arg_both{lcb_U32*}
+ * @see LCB_CNTL_QUERY_MIN_IDLE_CONNECTIONS
+ * @uncommitted
+ */
+#define LCB_CNTL_SEARCH_MIN_IDLE_CONNECTIONS 0x70
+
+/**
+ * @brief Number of idle connections to keep open to each analytics node.
+ *
+ * Use `analytics_min_idle_connections` in the connection string
+ *
+ * @cntl_arg_both{lcb_U32*}
+ * @see LCB_CNTL_QUERY_MIN_IDLE_CONNECTIONS
+ * @uncommitted
+ */
+#define LCB_CNTL_ANALYTICS_MIN_IDLE_CONNECTIONS 0x71
+
+/**
+ * @brief Maximum number of HTTP connections open to a single node.
+ *
+ * Requests which find no idle connection once the limit is reached wait for
+ * one to be released. The default is 0, which means no limit.
+ *
+ * Use `http_max_connections_per_host` in the connection string
+ *
+ * @cntl_arg_both{lcb_SIZE*}
+ * @uncommitted
+ */
+#define LCB_CNTL_HTTP_MAX_CONNECTIONS_PER_HOST 0x72
+
+/**
+ * @brief Record where the time of each KV operation is spent.
+ *
+ * When enabled, the response context of each KV operation carries the time
+ * the request waited in the library before it was written to the network,
+ * the time the server reports it spent processing the request, and the
+ * remainder of the round trip, which is attributed to the network (see
+ * lcb_errctx_kv_op_timings()). The same values are recorded in per-server
+ * histograms, available through @ref LCB_CNTL_METRICS, which this setting
+ * enables as well.
+ *
+ * Unlike tracing, this does not allocate anything per operation. It must be
+ * set before connecting, so that the server durations can be negotiated.
+ *
+ * Use `kv_op_timings` in the connection string
+ *
+ * @cntl_arg_both{int* (as boolean)}
+ * @uncommitted
+ */
+#define LCB_CNTL_KV_OP_TIMINGS 0x73
+
 /**
  * This is not a command, but rather an indicator of the last item.
  * @internal
  */
-#define LCB_CNTL__MAX 0x68
+#define LCB_CNTL__MAX 0x74
 /**@}*/
 
 #ifdef __cplusplus
@@ -2001,6 +2001,32 @@ void lcb_sched_fail(lcb_INSTANCE *instance);
 LIBCOUCHBASE_API
 void lcb_sched_flush(lcb_INSTANCE *instance);
 
+/**
+ * @uncommitted
+ * @brief Callback invoked when commands were queued without being flushed
+ *
+ * With @ref LCB_CNTL_SCHED_IMPLICIT_FLUSH disabled, the library still queues
+ * commands of its own, for example once the ID of a collection is resolved or
+ * while polling for durability. This callback is invoked from lcb_sched_leave()
+ * whenever it leaves commands unflushed, so that the application can call
+ * lcb_sched_flush() on its next loop iteration.
+ *
+ * @param instance the instance with unflushed commands
+ */
+typedef void (*lcb_sched_flush_callback)(lcb_INSTANCE *instance);
+
+/**
+ * @uncommitted
+ * @brief Set the callback invoked when commands are left unflushed
+ *
+ * @param instance the instance
+ * @param callback the callback to set. If `NULL`, return the existing callback
+ * @return The existing (and previous) callback.
+ * @see lcb_sched_flush_callback
+ */
+LIBCOUCHBASE_API
+lcb_sched_flush_callback lcb_set_sched_flush_callback(lcb_INSTANCE *instance, lcb_sched_flush_callback callback);
+
 /**@} (Group: Adanced Scheduling) */
 
 /* @ingroup lcb-public-api
@@ -2843,6 +2869,87 @@ LIBCOUCHBASE_API lcb_STATUS lcb_respquery_http_response(const lcb_RESPQUERY *res
 LIBCOUCHBASE_API lcb_STATUS lcb_respquery_handle(const lcb_RESPQUERY *resp, lcb_QUERY_HANDLE **handle);
 LIBCOUCHBASE_API lcb_STATUS lcb_respquery_error_context(const lcb_RESPQUERY *resp, const lcb_QUERY_ERROR_CONTEXT **ctx);
 LIBCOUCHBASE_API int lcb_respquery_is_final(const lcb_RESPQUERY *resp);
+
+/**
+ * @uncommitted
+ *
+ * Opaque structure holding the metadata of a query response: the members
+ * which surround the "results" array, decoded by the library.
+ */
+typedef struct lcb_QUERY_META_ lcb_QUERY_META;
+
+/** Metrics reported in the "metrics" member of a query response */
+typedef enum {
+    /** Total time taken by the request, in microseconds */
+    LCB_QUERY_METRIC_ELAPSED_TIME_US = 0,
+    /** Time taken to execute the query, in microseconds */
+    LCB_QUERY_METRIC_EXECUTION_TIME_US,
+    LCB_QUERY_METRIC_SORT_COUNT,
+    LCB_QUERY_METRIC_RESULT_COUNT,
+    LCB_QUERY_METRIC_RESULT_SIZE,
+    LCB_QUERY_METRIC_MUTATION_COUNT,
+    LCB_QUERY_METRIC_ERROR_COUNT,
+    LCB_QUERY_METRIC_WARNING_COUNT,
+    LCB_QUERY_METRIC__MAX
+} lcb_QUERY_METRIC;
+
+/**
+ * @uncommitted
+ *
+ * Get the decoded metadata of the final response.
+ *
+ * The metadata is parsed once, when the final response is delivered, and
+ * remains valid until the callback returns. Reading it through these
+ * functions avoids parsing the raw metadata returned by lcb_respquery_row()
+ * again.
+ *
+ * @param resp the response
+ * @param[out] meta the metadata
+ * @return LCB_ERR_INVALID_ARGUMENT if this is not the final response, or the
+ *  metadata could not be parsed
+ */
+LIBCOUCHBASE_API lcb_STATUS lcb_respquery_meta(const lcb_RESPQUERY *resp, const lcb_QUERY_META **meta);
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_request_id(const lcb_QUERY_META *meta, const char **value, size_t *value_len);
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_client_context_id(const lcb_QUERY_META *meta, const char **value,
+                                                            size_t *value_len);
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_status(const lcb_QUERY_META *meta, const char **value, size_t *value_len);
+/**
+ * @uncommitted
+ *
+ * Get the "signature" member, still encoded as JSON.
+ * @return LCB_ERR_INVALID_ARGUMENT if the response has no signature
+ */
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_signature(const lcb_QUERY_META *meta, const char **value, size_t *value_len);
+/**
+ * @uncommitted
+ *
+ * Get the "profile" member, still encoded as JSON.
+ * @return LCB_ERR_INVALID_ARGUMENT if the response has no profile
+ */
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_profile(const lcb_QUERY_META *meta, const char **value, size_t *value_len);
+/** @uncommitted @return non-zero if the response includes metrics */
+LIBCOUCHBASE_API int lcb_querymeta_has_metrics(const lcb_QUERY_META *meta);
+/**
+ * @uncommitted
+ *
+ * Get one of the metrics of the response. Metrics the server did not report
+ * are zero.
+ */
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_metric(const lcb_QUERY_META *meta, lcb_QUERY_METRIC metric,
+                                                 uint64_t *value);
+LIBCOUCHBASE_API size_t lcb_querymeta_warning_count(const lcb_QUERY_META *meta);
+/**
+ * @uncommitted
+ *
+ * Get a warning reported by the server.
+ * @param meta the metadata
+ * @param index index of the warning, less than lcb_querymeta_warning_count()
+ * @param[out] code the warning code
+ * @param[out] message the warning message
+ * @param[out] message_len length of the message
+ */
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_warning(const lcb_QUERY_META *meta, size_t index, uint32_t *code,
+                                                  const char **message, size_t *message_len);
 /**
  * Create a new lcb_CMDQUERY object. The returned object is an opaque
  * pointer which may be used to set various properties on a N1QL query.
@@ -242,6 +242,21 @@ LIBCOUCHBASE_API lcb_STATUS lcb_errctx_kv_ref(const lcb_KEY_VALUE_ERROR_CONTEXT
                                               size_t *ref_len);
 LIBCOUCHBASE_API lcb_STATUS lcb_errctx_kv_endpoint(const lcb_KEY_VALUE_ERROR_CONTEXT *ctx, const char **endpoint,
                                                    size_t *endpoint_len);
+/**
+ * Where the time of the operation was spent, in microseconds. Only available
+ * when @ref LCB_CNTL_KV_OP_TIMINGS is enabled, and the server answered the
+ * request.
+ *
+ * @param queue_us time between scheduling the request and writing it out
+ * @param network_us the rest of the round trip, after the server time
+ * @param server_us time the server reported spending on the request, zero
+ *  if it did not report it (and then it is included in network_us)
+ * @return LCB_ERR_INVALID_ARGUMENT if the timings were not recorded
+ *
+ * @uncommitted
+ */
+LIBCOUCHBASE_API lcb_STATUS lcb_errctx_kv_op_timings(const lcb_KEY_VALUE_ERROR_CONTEXT *ctx, uint64_t *queue_us,
+                                                     uint64_t *network_us, uint64_t *server_us);
 
 typedef struct lcb_QUERY_ERROR_CONTEXT_ lcb_QUERY_ERROR_CONTEXT;
 LIBCOUCHBASE_API lcb_STATUS lcb_errctx_query_rc(const lcb_QUERY_ERROR_CONTEXT *ctx);
@@ -23,6 +23,7 @@ extern "C" {
 #endif
 
 struct lcb_METRICS_st;
+struct lcb_histogram_st;
 
 typedef struct lcb_IOMETRICS_st {
     const char *hostport;
@@ -62,6 +63,21 @@ typedef struct lcb_SERVERMETRICS_st {
 
     /** Number of NOT_MY_VBUCKET replies received */
     lcb_SIZE packets_nmv;
+
+    /*
+     * Breakdown of the latency of KV operations, recorded when
+     * LCB_CNTL_KV_OP_TIMINGS is enabled (otherwise NULL). Read them with
+     * lcb_histogram_read().
+     */
+
+    /** Time requests waited in the library before being written */
+    struct lcb_histogram_st *queue_latency;
+
+    /** Round trip time less the time reported by the server */
+    struct lcb_histogram_st *network_latency;
+
+    /** Time the server reported spending on requests */
+    struct lcb_histogram_st *server_latency;
 } lcb_SERVERMETRICS;
 
 typedef struct lcb_METRICS_st {
@@ -70,6 +86,56 @@ typedef struct lcb_METRICS_st {
 
     /** Number of times a packet entered the retry queue */
     lcb_SIZE packets_retried;
+
+    /** Number of cluster maps applied */
+    lcb_SIZE config_updates;
+
+    /**
+     * Number of cluster maps which left the node list unchanged, and were
+     * applied by swapping the map under the existing pipelines. Subset of
+     * config_updates
+     */
+    lcb_SIZE config_updates_incremental;
+
+    /** Number of vBuckets whose master changed, summed over all updates */
+    lcb_SIZE config_vb_changes;
+
+    /** Total time spent applying cluster maps, in microseconds */
+    lcb_U64 config_apply_us;
+
+    /** Time spent applying the most recent cluster map, in microseconds */
+    lcb_U64 config_apply_last_us;
+
+    /** Number of TLS handshakes which resumed a cached session */
+    lcb_SIZE ssl_sessions_resumed;
+
+    /** Number of TLS handshakes which performed a full key exchange */
+    lcb_SIZE ssl_full_handshakes;
+
+    /** Number of packets currently waiting in the retry queue */
+    lcb_SIZE retry_queue_depth;
+
+    /** Largest number of packets seen waiting in the retry queue at once */
+    lcb_SIZE retry_queue_max_depth;
+
+    /**
+     * Number of packets rejected with NOT_MY_VBUCKET which were redirected as
+     * soon as a new cluster map moved their vBucket, rather than on the retry
+     * interval
+     */
+    lcb_SIZE packets_nmv_redirected;
+
+    /** Number of connections handed to HTTP requests by the pool */
+    lcb_SIZE http_pool_requests;
+
+    /**
+     * Number of HTTP requests which found no idle connection and waited for
+     * one to be opened or released. Subset of http_pool_requests
+     */
+    lcb_SIZE http_pool_misses;
+
+    /** Total time HTTP requests spent waiting for a connection, in microseconds */
+    lcb_U64 http_pool_wait_us;
 } lcb_METRICS;
 
 #ifdef __cplusplus
@@ -71,6 +71,7 @@ typedef int lcb_socket_t;
 #endif
 
 struct sockaddr;
+struct addrinfo;
 
 #ifndef _WIN32
 /** Defined if the lcb_IOV structure conforms to `struct iovec` */
@@ -589,6 +590,43 @@ typedef void (*lcb_io_tick_fn)(lcb_io_opt_t iops);
  */
 typedef void (*lcb_io_stop_fn)(lcb_io_opt_t iops);
 
+/**
+ * @brief Callback for lcb_io_resolve_fn()
+ * @param arg the argument passed to lcb_io_resolve_fn()
+ * @param status 0 on success, or a nonzero error from the resolver
+ * @param res the resolved addresses. Ownership passes to the callback, which
+ *  must release the list with `freeaddrinfo()`
+ */
+typedef void (*lcb_io_resolve_callback)(void *arg, int status, struct addrinfo *res);
+
+/**
+ * @brief Resolve a host name without blocking the event loop
+ * @param iops the I/O context
+ * @param host the host name to look up
+ * @param port the service (port) to look up
+ * @param hints hints, as for `getaddrinfo()`
+ * @param callback invoked from the event loop once the lookup completes
+ * @param arg argument passed to the callback
+ * @return an opaque request handle, or NULL if the lookup could not be
+ *  started (in which case the callback will not be invoked)
+ *
+ * This routine is optional. If it is not provided, the library performs the
+ * lookup on a helper thread instead.
+ * @uncommitted
+ */
+typedef void *(*lcb_io_resolve_fn)(lcb_io_opt_t iops, const char *host, const char *port,
+                                   const struct addrinfo *hints, lcb_io_resolve_callback callback, void *arg);
+
+/**
+ * @brief Cancel a lookup started with lcb_io_resolve_fn()
+ * @param iops the I/O context
+ * @param request the handle returned by lcb_io_resolve_fn()
+ *
+ * The callback will not be invoked once this function has been called.
+ * @uncommitted
+ */
+typedef void (*lcb_io_resolve_cancel_fn)(lcb_io_opt_t iops, void *request);
+
 LCB_DEPRECATED(typedef void (*lcb_io_error_cb)(lcb_sockdata_t *socket));
 
 #define LCB_IOPS_BASE_FIELDS                                                                                           \
@@ -651,6 +689,8 @@ typedef struct lcb_loopprocs_st {
     lcb_io_start_fn start;
     lcb_io_stop_fn stop;
     lcb_io_tick_fn tick;
+    lcb_io_resolve_fn resolve;              /**< Since version 5, optional */
+    lcb_io_resolve_cancel_fn resolve_cancel; /**< Since version 5, optional */
 } lcb_loop_procs;
 
 /** @brief Functions wrapping the Berkeley Socket API */
@@ -818,7 +858,7 @@ struct lcb_iops3_st {
  * function tables. This number is backwards compatible (i.e. version 3 contains
  * all the fields of version 2, and some additional ones)
  */
-#define LCB_IOPROCS_VERSION 4
+#define LCB_IOPROCS_VERSION 5
 
 #define LCB_IOPS_BASEFLD(iops, fld) ((iops)->v.base).fld
 #define LCB_IOPS_ERRNO(iops) LCB_IOPS_BASEFLD(iops, error)
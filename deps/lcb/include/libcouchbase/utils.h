@@ -400,6 +400,26 @@ LIBCOUCHBASE_API lcb_STATUS lcb_cmdgetcid_collection(lcb_CMDGETCID *cmd, const c
 LIBCOUCHBASE_API lcb_STATUS lcb_cmdgetcid_timeout(lcb_CMDGETCID *cmd, uint32_t timeout);
 
 LIBCOUCHBASE_API lcb_STATUS lcb_getcid(lcb_INSTANCE *instance, void *cookie, const lcb_CMDGETCID *cmd);
+
+/**
+ * Look up collection ID in the local cache of the instance without sending
+ * anything to the network.
+ *
+ * Successful lcb_getcid() responses populate this cache, so it can be used
+ * to resolve collection once and check that subsequent KV operations will
+ * not need to wait for resolution. Empty scope or collection names refer to
+ * "_default".
+ *
+ * @param instance the library handle
+ * @param scope name of the scope
+ * @param scope_len length of the scope name
+ * @param collection name of the collection
+ * @param collection_len length of the collection name
+ * @param[out] id collection ID, if it is known
+ * @return LCB_SUCCESS if the ID is cached, LCB_ERR_COLLECTION_NOT_FOUND otherwise
+ */
+LIBCOUCHBASE_API lcb_STATUS lcb_collection_id_cached(lcb_INSTANCE *instance, const char *scope, size_t scope_len,
+                                                     const char *collection, size_t collection_len, uint32_t *id);
 /** @} */
 
 /**
@@ -234,6 +234,23 @@ int lcbvb_load_json(lcbvb_CONFIG *vbc, const char *data);
 LIBCOUCHBASE_API
 int lcbvb_load_json_ex(lcbvb_CONFIG *vbc, const char *data, const char *source, char **network);
 
+/**
+ * @uncommitted
+ * @brief Extract the revision of a configuration without parsing it.
+ *
+ * Scans the top level of the JSON document for the `rev` and `revEpoch`
+ * fields without allocating anything, so that callers may discard a config
+ * which is not newer than the one they already have before paying for
+ * lcbvb_load_json_ex().
+ *
+ * @param data the JSON text, NUL-terminated
+ * @param[out] revepoch set to the `revEpoch` field, or -1 if missing
+ * @param[out] revid set to the `rev` field, or -1 if missing
+ * @return 0 on success, nonzero if the text could not be scanned
+ */
+LIBCOUCHBASE_API
+int lcbvb_peek_revision(const char *data, int64_t *revepoch, int64_t *revid);
+
 /**@brief Serialize the current config as a JSON string.
  * @volatile
  * Serialize the current configuration as a JSON string. The string returned is
@@ -529,6 +546,22 @@ typedef enum {
 } lcbvb_CHANGETYPE,
     VBUCKET_CHANGE_STATUS;
 
+/**
+ * @volatile
+ *
+ * @brief Determine the mode of change between two configurations.
+ *
+ * This yields the same result as calling lcbvb_get_changetype() on the diff
+ * returned by lcbvb_compare(), but does not allocate and stops scanning the
+ * vBucket map at the first change.
+ *
+ * @param from the original configuration to use as the base
+ * @param to the new configuration
+ * @return a set of @ref lcbvb_CHANGETYPE flags
+ */
+LIBCOUCHBASE_API
+lcbvb_CHANGETYPE lcbvb_compare_changetype(const lcbvb_CONFIG *from, const lcbvb_CONFIG *to);
+
 /**
  * @volatile
  *
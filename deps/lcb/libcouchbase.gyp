@@ -227,6 +227,7 @@
         'src/lcbio/ioutils.cc',
         'src/lcbio/manager.cc',
         'src/lcbio/protoctx.cc',
+        'src/lcbio/resolve.cc',
         'src/lcbio/timer.cc',
         'src/metrics/caching_meter.cc',
         'src/metrics/logging_meter.cc',
@@ -240,6 +241,7 @@
         'src/n1ql/ixmgmt.cc',
         'src/n1ql/n1ql-internal.cc',
         'src/n1ql/n1ql.cc',
+        'src/n1ql/query_body.cc',
         'src/n1ql/query_handle.cc',
         'src/n1ql/query_utils.cc',
         'src/netbuf/netbuf.c',
@@ -264,8 +266,10 @@
         'src/rdb/chunkalloc.c',
         'src/rdb/libcalloc.c',
         'src/rdb/rope.c',
+        'src/rdb/slaballoc.c',
         'src/search/search_handle.cc',
         'src/search/search.cc',
+        'src/slab/slab.cc',
         'src/strcodecs/base64.cc',
         'src/tracing/span.cc',
         'src/tracing/threshold_logging_tracer.cc',
@@ -564,6 +564,67 @@ static void destroy_timer(lcb_io_opt_t io, void *timer_opaque)
     uv_close((uv_handle_t *)timer_opaque, timer_close_cb);
 }
 
+/******************************************************************************
+ ******************************************************************************
+ ** Name Resolution                                                          **
+ ******************************************************************************
+ ******************************************************************************/
+#if UV_VERSION_HEX >= 0x010000 && LCB_IOPROCS_VERSION >= 5
+typedef struct {
+    uv_getaddrinfo_t uvreq;
+    lcb_io_resolve_callback callback;
+    void *cb_arg;
+    my_iops_t *parent;
+    int cancelled;
+} my_resolve_t;
+
+static void resolve_callback(uv_getaddrinfo_t *req, int status, struct addrinfo *res)
+{
+    my_resolve_t *resolve = (my_resolve_t *)req;
+    my_iops_t *io = resolve->parent;
+
+    if (resolve->cancelled) {
+        if (res) {
+            uv_freeaddrinfo(res);
+        }
+    } else {
+        resolve->callback(resolve->cb_arg, status, res);
+    }
+    free(resolve);
+    decref_iops(io);
+}
+
+static void *start_resolve(lcb_io_opt_t iobase, const char *host, const char *port, const struct addrinfo *hints,
+                           lcb_io_resolve_callback callback, void *arg)
+{
+    my_iops_t *io = (my_iops_t *)iobase;
+    my_resolve_t *resolve = (my_resolve_t *)calloc(1, sizeof(*resolve));
+    if (!resolve) {
+        return NULL;
+    }
+
+    resolve->callback = callback;
+    resolve->cb_arg = arg;
+    resolve->parent = io;
+    if (uv_getaddrinfo(io->loop, &resolve->uvreq, resolve_callback, host, port, hints) != 0) {
+        free(resolve);
+        return NULL;
+    }
+    incref_iops(io);
+    return resolve;
+}
+
+static void cancel_resolve(lcb_io_opt_t iobase, void *request)
+{
+    my_resolve_t *resolve = (my_resolve_t *)request;
+    resolve->cancelled = 1;
+    /* Only succeeds if the lookup has not started yet. Either way the
+     * callback still runs and releases the request */
+    uv_cancel((uv_req_t *)&resolve->uvreq);
+    (void)iobase;
+}
+#endif
+
 static my_uvreq_t *alloc_uvreq(my_sockdata_t *sock, generic_callback_t callback)
 {
     my_uvreq_t *ret = (my_uvreq_t *)calloc(1, sizeof(*ret));
@@ -632,6 +693,12 @@ static void wire_iops2(int version, lcb_loop_procs *loop, lcb_timer_procs *timer
     loop->start = run_event_loop;
     loop->stop = stop_event_loop;
     loop->tick = tick_event_loop;
+#if UV_VERSION_HEX >= 0x010000 && LCB_IOPROCS_VERSION >= 5
+    if (version >= 5) {
+        loop->resolve = start_resolve;
+        loop->resolve_cancel = cancel_resolve;
+    }
+#endif
 
     timer->create = create_timer;
     timer->cancel = delete_timer;
@@ -39,7 +39,7 @@ static void doc_callback(lcb_INSTANCE *, int, const lcb_RESPSTORE *rb)
 
     q->ref();
 
-    q->n_awaiting_response--;
+    q->response_received(dreq);
     dreq->ready = 1;
 
     q->check();
@@ -141,6 +141,13 @@ void Bootstrap::config_callback(EventType event, ConfigInfo *info)
 
         // See if we can enable background polling.
         check_bgpoll();
+
+        if (info->get_origin() == CLCONFIG_FILE && LCBT_SETTING(instance, config_cache_revalidate)) {
+            /* Operations are already flowing using the cached map; fetch the
+             * current one from the cluster without holding anything up. */
+            lcb_log(LOGARGS(instance, INFO), "Bootstrapped from config cache. Revalidating in background");
+            tmpoll.signal();
+        }
     }
 
     lcb_maybe_breakout(instance);
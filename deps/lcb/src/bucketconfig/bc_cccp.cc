@@ -209,6 +209,23 @@ lcb_STATUS CccpProvider::update(const char *host, const char *data)
     lcbvb_CONFIG *vbc;
     int rv;
     ConfigInfo *new_config;
+    ConfigInfo *cur_config = parent->get_config();
+
+    /* Servers push the same configuration to every node, and return it with
+     * each NOT_MY_VBUCKET reply. Peek at the revision first, and drop the
+     * text without parsing it if confmon would not apply it anyway. */
+    if (cur_config && cur_config->vbc->bname) {
+        int64_t epoch, rev;
+        if (lcbvb_peek_revision(data, &epoch, &rev) == 0 && epoch <= cur_config->vbc->revepoch && rev >= 0 &&
+            cur_config->vbc->revid >= rev) {
+            lcb_log(LOGARGS(this, TRACE), "Ignoring stale configuration from %s (rev=%" PRId64 ":%" PRId64
+                    ", current=%" PRId64 ":%" PRId64 ")", host, epoch, rev, cur_config->vbc->revepoch,
+                    cur_config->vbc->revid);
+            parent->stop();
+            return LCB_SUCCESS;
+        }
+    }
+
     vbc = lcbvb_create();
 
     if (!vbc) {
@@ -138,15 +138,7 @@ int Confmon::do_set_next(ConfigInfo *new_config, bool notify_miss)
         return 0;
     }
     if (config) {
-        lcbvb_CONFIGDIFF *diff = lcbvb_compare(config->vbc, new_config->vbc);
-
-        if (!diff) {
-            lcb_log(LOGARGS(this, DEBUG), "Couldn't create vbucket diff");
-            return 0;
-        }
-
-        lcbvb_CHANGETYPE chstatus = lcbvb_get_changetype(diff);
-        lcbvb_free_diff(diff);
+        lcbvb_CHANGETYPE chstatus = lcbvb_compare_changetype(config->vbc, new_config->vbc);
 
         if (config->compare(*new_config, chstatus) >= 0) {
             const lcbvb_CONFIG *ca, *cb;
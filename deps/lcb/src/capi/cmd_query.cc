@@ -22,6 +22,92 @@
 
 #include "cmd_query.hh"
 #include "../mutation_token.hh"
+#include "n1ql/query_utils.hh"
+
+namespace
+{
+bool parse_messages(const std::string *encoded, std::vector<lcb_QUERY_META::Message> &messages)
+{
+    std::vector<std::string> elements;
+    if (encoded == nullptr || !QueryBody::split_array(*encoded, elements)) {
+        return false;
+    }
+    for (const auto &element : elements) {
+        QueryBody fields;
+        if (!fields.parse(element.c_str(), element.size())) {
+            continue;
+        }
+        lcb_QUERY_META::Message msg{0, std::string()};
+        const std::string *code = fields.get("code");
+        std::uint64_t code_val;
+        if (code != nullptr && QueryBody::decode_uint(*code, code_val)) {
+            msg.code = static_cast<std::uint32_t>(code_val);
+        }
+        const std::string *text = fields.get("msg");
+        if (text != nullptr) {
+            QueryBody::decode_string(*text, msg.message);
+        }
+        messages.emplace_back(std::move(msg));
+    }
+    return true;
+}
+
+std::uint64_t duration_us(const std::string *encoded)
+{
+    std::string text;
+    if (encoded == nullptr || !QueryBody::decode_string(*encoded, text)) {
+        return 0;
+    }
+    try {
+        return std::chrono::duration_cast<std::chrono::microseconds>(lcb_parse_golang_duration(text)).count();
+    } catch (const lcb_duration_parse_error &) {
+        return 0;
+    }
+}
+
+lcb_STATUS string_member(const std::string &member, const char **value, size_t *value_len)
+{
+    *value = member.c_str();
+    *value_len = member.size();
+    return LCB_SUCCESS;
+}
+} // namespace
+
+bool lcb_QUERY_META_::parse(const char *json, std::size_t json_len)
+{
+    if (!members.parse(json, json_len)) {
+        return false;
+    }
+    const std::string *member;
+    if ((member = members.get("requestID")) != nullptr) {
+        QueryBody::decode_string(*member, request_id);
+    }
+    if ((member = members.get("clientContextID")) != nullptr) {
+        QueryBody::decode_string(*member, client_context_id);
+    }
+    if ((member = members.get("status")) != nullptr) {
+        QueryBody::decode_string(*member, status);
+    }
+    parse_messages(members.get("errors"), errors);
+    parse_messages(members.get("warnings"), warnings);
+
+    QueryBody fields;
+    member = members.get("metrics");
+    if (member != nullptr && fields.parse(member->c_str(), member->size())) {
+        static const char *const counts[] = {"sortCount",     "resultCount", "resultSize",
+                                             "mutationCount", "errorCount",  "warningCount"};
+        has_metrics = true;
+        metrics[LCB_QUERY_METRIC_ELAPSED_TIME_US] = duration_us(fields.get("elapsedTime"));
+        metrics[LCB_QUERY_METRIC_EXECUTION_TIME_US] = duration_us(fields.get("executionTime"));
+        for (size_t ii = 0; ii < sizeof(counts) / sizeof(counts[0]); ii++) {
+            const std::string *count = fields.get(counts[ii]);
+            if (count != nullptr) {
+                QueryBody::decode_uint(*count, metrics[LCB_QUERY_METRIC_SORT_COUNT + ii]);
+            }
+        }
+    }
+    return true;
+}
 
 LIBCOUCHBASE_API lcb_STATUS lcb_respquery_status(const lcb_RESPQUERY *resp)
 {
@@ -64,6 +150,79 @@ LIBCOUCHBASE_API int lcb_respquery_is_final(const lcb_RESPQUERY *resp)
     return resp->rflags & LCB_RESP_F_FINAL;
 }
 
+LIBCOUCHBASE_API lcb_STATUS lcb_respquery_meta(const lcb_RESPQUERY *resp, const lcb_QUERY_META **meta)
+{
+    if (resp->meta == nullptr) {
+        return LCB_ERR_INVALID_ARGUMENT;
+    }
+    *meta = resp->meta;
+    return LCB_SUCCESS;
+}
+
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_request_id(const lcb_QUERY_META *meta, const char **value, size_t *value_len)
+{
+    return string_member(meta->request_id, value, value_len);
+}
+
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_client_context_id(const lcb_QUERY_META *meta, const char **value,
+                                                            size_t *value_len)
+{
+    return string_member(meta->client_context_id, value, value_len);
+}
+
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_status(const lcb_QUERY_META *meta, const char **value, size_t *value_len)
+{
+    return string_member(meta->status, value, value_len);
+}
+
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_signature(const lcb_QUERY_META *meta, const char **value, size_t *value_len)
+{
+    const std::string *member = meta->members.get("signature");
+    if (member == nullptr) {
+        return LCB_ERR_INVALID_ARGUMENT;
+    }
+    return string_member(*member, value, value_len);
+}
+
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_profile(const lcb_QUERY_META *meta, const char **value, size_t *value_len)
+{
+    const std::string *member = meta->members.get("profile");
+    if (member == nullptr) {
+        return LCB_ERR_INVALID_ARGUMENT;
+    }
+    return string_member(*member, value, value_len);
+}
+
+LIBCOUCHBASE_API int lcb_querymeta_has_metrics(const lcb_QUERY_META *meta)
+{
+    return meta->has_metrics;
+}
+
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_metric(const lcb_QUERY_META *meta, lcb_QUERY_METRIC metric, uint64_t *value)
+{
+    if (metric < 0 || metric >= LCB_QUERY_METRIC__MAX) {
+        return LCB_ERR_INVALID_ARGUMENT;
+    }
+    *value = meta->metrics[metric];
+    return LCB_SUCCESS;
+}
+
+LIBCOUCHBASE_API size_t lcb_querymeta_warning_count(const lcb_QUERY_META *meta)
+{
+    return meta->warnings.size();
+}
+
+LIBCOUCHBASE_API lcb_STATUS lcb_querymeta_warning(const lcb_QUERY_META *meta, size_t index, uint32_t *code,
+                                                  const char **message, size_t *message_len)
+{
+    if (index >= meta->warnings.size()) {
+        return LCB_ERR_INVALID_ARGUMENT;
+    }
+    const auto &warning = meta->warnings[index];
+    *code = warning.code;
+    return string_member(warning.message, message, message_len);
+}
+
 LIBCOUCHBASE_API lcb_STATUS lcb_cmdquery_create(lcb_CMDQUERY **cmd)
 {
     *cmd = new lcb_CMDQUERY();
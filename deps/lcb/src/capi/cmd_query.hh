@@ -21,9 +21,12 @@
 #include <cstddef>
 #include <cstdint>
 #include <chrono>
+#include <string>
+#include <vector>
 
 #include "contrib/lcb-jsoncpp/lcb-jsoncpp.h"
 #include "collection_qualifier.hh"
+#include "n1ql/query_body.hh"
 
 /**
  * @private
@@ -56,23 +59,23 @@ struct lcb_QUERY_ERROR_CONTEXT_ {
 struct lcb_CMDQUERY_ {
     bool empty_statement_and_root_object() const
     {
-        return query_.empty() && root_.empty();
+        return query_.empty() && body_.empty() && scan_vectors_.isNull();
     }
 
-    bool is_query_json() const
+    /** The request body, with the scan vectors of any consistency tokens */
+    QueryBody body() const
     {
-        return query_is_json_;
-    }
-
-    const Json::Value &root() const
-    {
-        return root_;
+        QueryBody body = body_;
+        if (!scan_vectors_.isNull()) {
+            body.set_encoded("scan_vectors", Json::FastWriter().write(scan_vectors_));
+        }
+        return body;
     }
 
-    void root(const Json::Value &new_body)
+    void body(const QueryBody &new_body)
     {
-        root_ = new_body;
-        query_is_json_ = true;
+        body_ = new_body;
+        scan_vectors_ = Json::Value();
     }
 
     void use_multi_bucket_authentication(bool use)
@@ -98,58 +101,58 @@ struct lcb_CMDQUERY_ {
 
     lcb_STATUS pretty(bool pretty)
     {
-        root_["pretty"] = pretty;
+        body_.set_bool("pretty", pretty);
         return LCB_SUCCESS;
     }
 
     lcb_STATUS readonly(bool readonly)
     {
-        root_["readonly"] = readonly;
+        body_.set_bool("readonly", readonly);
         return LCB_SUCCESS;
     }
 
     lcb_STATUS metrics(bool show_metrics)
     {
-        root_["metrics"] = show_metrics;
+        body_.set_bool("metrics", show_metrics);
         return LCB_SUCCESS;
     }
 
     lcb_STATUS scan_cap(int cap_value)
     {
-        root_["scan_cap"] = Json::valueToString(cap_value);
+        body_.set_string("scan_cap", std::to_string(cap_value));
         return LCB_SUCCESS;
     }
 
     lcb_STATUS scan_wait(uint32_t duration_us)
     {
-        root_["scan_wait"] = Json::valueToString(duration_us) + "us";
+        body_.set_string("scan_wait", std::to_string(duration_us) + "us");
         return LCB_SUCCESS;
     }
 
     lcb_STATUS pipeline_cap(int value)
     {
-        root_["pipeline_cap"] = Json::valueToString(value);
+        body_.set_string("pipeline_cap", std::to_string(value));
         return LCB_SUCCESS;
     }
 
     lcb_STATUS pipeline_batch(int value)
     {
-        root_["pipeline_batch"] = Json::valueToString(value);
+        body_.set_string("pipeline_batch", std::to_string(value));
         return LCB_SUCCESS;
     }
 
     lcb_STATUS max_parallelism(int value)
     {
-        root_["max_parallelism"] = Json::valueToString(value);
+        body_.set_string("max_parallelism", std::to_string(value));
         return LCB_SUCCESS;
     }
 
     lcb_STATUS flex_index(bool value)
     {
         if (value) {
-            root_["use_fts"] = true;
+            body_.set_bool("use_fts", true);
         } else {
-            root_.removeMember("use_fts");
+            body_.remove("use_fts");
         }
         return LCB_SUCCESS;
     }
@@ -158,13 +161,13 @@ struct lcb_CMDQUERY_ {
     {
         switch (mode) {
             case LCB_QUERY_PROFILE_OFF:
-                root_["profile"] = "off";
+                body_.set_string("profile", "off");
                 break;
             case LCB_QUERY_PROFILE_PHASES:
-                root_["profile"] = "phases";
+                body_.set_string("profile", "phases");
                 break;
             case LCB_QUERY_PROFILE_TIMINGS:
-                root_["profile"] = "timings";
+                body_.set_string("profile", "timings");
                 break;
             default:
                 return LCB_ERR_INVALID_ARGUMENT;
@@ -176,13 +179,13 @@ struct lcb_CMDQUERY_ {
     {
         switch (mode) {
             case LCB_QUERY_CONSISTENCY_NONE:
-                root_.removeMember("scan_consistency");
+                body_.remove("scan_consistency");
                 break;
             case LCB_QUERY_CONSISTENCY_REQUEST:
-                root_["scan_consistency"] = "request_plus";
+                body_.set_string("scan_consistency", "request_plus");
                 break;
             case LCB_QUERY_CONSISTENCY_STATEMENT:
-                root_["scan_consistency"] = "statement_plus";
+                body_.set_string("scan_consistency", "statement_plus");
                 break;
             default:
                 return LCB_ERR_INVALID_ARGUMENT;
@@ -196,8 +199,10 @@ struct lcb_CMDQUERY_ {
         if (!lcb_mutation_token_is_valid(token)) {
             return LCB_ERR_INVALID_ARGUMENT;
         }
-        root_["scan_consistency"] = "at_plus";
-        auto &vb = root_["scan_vectors"][std::string(keyspace, keyspace_len)][std::to_string(token->vbid_)];
+        body_.set_string("scan_consistency", "at_plus");
+        /* Tokens are usually added for every vBucket, so the vectors are only
+         * encoded once the body is needed */
+        auto &vb = scan_vectors_[std::string(keyspace, keyspace_len)][std::to_string(token->vbid_)];
         vb[0] = static_cast<Json::UInt64>(token->seqno_);
         vb[1] = std::to_string(token->uuid_);
         return LCB_SUCCESS;
@@ -311,17 +316,17 @@ struct lcb_CMDQUERY_ {
 
     lcb_STATUS encode_payload()
     {
-        query_ = Json::FastWriter().write(root_);
+        query_.clear();
+        body().write(query_);
         return LCB_SUCCESS;
     }
 
     lcb_STATUS payload(const char *query, std::size_t query_len)
     {
-        Json::Value value;
-        if (!Json::Reader().parse(query, query + query_len, value)) {
+        if (!body_.parse(query, query_len)) {
             return LCB_ERR_INVALID_ARGUMENT;
         }
-        root_ = value;
+        scan_vectors_ = Json::Value();
         return LCB_SUCCESS;
     }
 
@@ -335,7 +340,7 @@ struct lcb_CMDQUERY_ {
         if (statement == nullptr) {
             return LCB_ERR_INVALID_ARGUMENT;
         }
-        root_["statement"] = std::string(statement, statement_len);
+        body_.set_string("statement", std::string(statement, statement_len));
         return LCB_SUCCESS;
     }
 
@@ -344,11 +349,9 @@ struct lcb_CMDQUERY_ {
         if (name == nullptr || value == nullptr) {
             return LCB_ERR_INVALID_ARGUMENT;
         }
-        Json::Value json_value;
-        if (!Json::Reader().parse(value, value + value_len, json_value)) {
+        if (!body_.set(std::string(name, name_len), value, value_len)) {
             return LCB_ERR_INVALID_ARGUMENT;
         }
-        root_[std::string(name, name_len)] = json_value;
         return LCB_SUCCESS;
     }
 
@@ -357,11 +360,9 @@ struct lcb_CMDQUERY_ {
         if (name.empty() || value == nullptr) {
             return LCB_ERR_INVALID_ARGUMENT;
         }
-        Json::Value json_value;
-        if (!Json::Reader().parse(value, value + value_len, json_value)) {
+        if (!body_.set(name, value, value_len)) {
             return LCB_ERR_INVALID_ARGUMENT;
         }
-        root_[name] = json_value;
         return LCB_SUCCESS;
     }
 
@@ -370,14 +371,11 @@ struct lcb_CMDQUERY_ {
         if (name.empty() || value == nullptr) {
             return LCB_ERR_INVALID_ARGUMENT;
         }
-        Json::Value json_value;
-        if (!Json::Reader().parse(value, value + value_len, json_value)) {
-            return LCB_ERR_INVALID_ARGUMENT;
-        }
-        if (json_value.type() != Json::ValueType::arrayValue) {
+        QueryBody array;
+        if (!array.set(name, value, value_len) || (*array.get(name))[0] != '[') {
             return LCB_ERR_INVALID_ARGUMENT;
         }
-        root_[name] = json_value;
+        body_.set_encoded(name, *array.get(name));
         return LCB_SUCCESS;
     }
 
@@ -386,11 +384,9 @@ struct lcb_CMDQUERY_ {
         if (name.empty() || value == nullptr) {
             return LCB_ERR_INVALID_ARGUMENT;
         }
-        Json::Value json_value;
-        if (!Json::Reader().parse(value, value + value_len, json_value)) {
+        if (!body_.append(name, value, value_len)) {
             return LCB_ERR_INVALID_ARGUMENT;
         }
-        root_[name].append(json_value);
         return LCB_SUCCESS;
     }
 
@@ -399,7 +395,7 @@ struct lcb_CMDQUERY_ {
         if (name.empty() || value == nullptr || value_len == 0) {
             return LCB_ERR_INVALID_ARGUMENT;
         }
-        root_[name] = std::string(value, value_len);
+        body_.set_string(name, std::string(value, value_len));
         return LCB_SUCCESS;
     }
 
@@ -407,7 +403,8 @@ struct lcb_CMDQUERY_ {
     {
         timeout_ = std::chrono::milliseconds::zero();
         parent_span_ = nullptr;
-        root_.clear();
+        body_.clear();
+        scan_vectors_ = Json::Value();
         scope_.clear();
         scope_qualifier_.clear();
         query_.clear();
@@ -415,7 +412,6 @@ struct lcb_CMDQUERY_ {
         callback_ = nullptr;
         handle_ = nullptr;
         prepare_statement_ = false;
-        query_is_json_ = false;
         use_multi_bucket_authentication_ = false;
         return LCB_SUCCESS;
     }
@@ -455,10 +451,12 @@ struct lcb_CMDQUERY_ {
     void *cookie_{nullptr};
 
     bool prepare_statement_{false};
-    bool query_is_json_{false};
     bool use_multi_bucket_authentication_{false};
 
-    Json::Value root_{};
+    /** Request body, as set by the application */
+    QueryBody body_{};
+    /** Scan vectors of the consistency tokens, if any */
+    Json::Value scan_vectors_{};
     /**Query to be placed in the POST request. The library will not perform
      * any conversions or validation on this string, so it is up to the user
      * (or wrapping library) to ensure that the string is well formed.
@@ -483,6 +481,35 @@ struct lcb_CMDQUERY_ {
     std::string impostor_{};
 };
 
+/**
+ * @private
+ *
+ * Metadata of a query response, decoded from the members surrounding the
+ * "results" array
+ */
+struct lcb_QUERY_META_ {
+    struct Message {
+        std::uint32_t code;
+        std::string message;
+    };
+
+    /**
+     * Parse the metadata
+     * @return false if `json` is not a JSON object
+     */
+    bool parse(const char *json, std::size_t json_len);
+
+    /** Top-level members, still encoded */
+    QueryBody members;
+    std::string request_id;
+    std::string client_context_id;
+    std::string status;
+    std::vector<Message> errors;
+    std::vector<Message> warnings;
+    bool has_metrics{false};
+    std::uint64_t metrics[LCB_QUERY_METRIC__MAX]{};
+};
+
 /**
  * Response for a N1QL query. This is delivered in the @ref lcb_N1QLCALLBACK
  * callback function for each result row received. The callback is also called
@@ -504,6 +531,8 @@ struct lcb_RESPQUERY_ {
     /** Raw HTTP response, if applicable */
     const lcb_RESPHTTP *htresp;
     lcb_QUERY_HANDLE *handle;
+    /** Decoded metadata. Only set for the final response */
+    const lcb_QUERY_META *meta;
 };
 
 #endif // LIBCOUCHBASE_CAPI_QUERY_HH
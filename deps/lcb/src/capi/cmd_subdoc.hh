@@ -21,6 +21,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <chrono>
+#include <memory>
 
 #include "key_value_error_context.hh"
 
@@ -204,20 +205,31 @@ struct subdoc_options {
     bool create_as_deleted{false};
 };
 
+/**
+ * Copies of the specs (such as the one made by lcb_cmdsubdoc_specs) share the
+ * same list until one of them is modified, so that a list of specs built once
+ * can be attached to any number of commands without copying each spec.
+ */
 struct lcb_SUBDOCSPECS_ {
   public:
     std::vector<subdoc_spec> &specs()
     {
-        return specs_;
+        if (!specs_) {
+            specs_ = std::make_shared<std::vector<subdoc_spec>>();
+        } else if (specs_.use_count() > 1) {
+            specs_ = std::make_shared<std::vector<subdoc_spec>>(*specs_);
+        }
+        return *specs_;
     }
 
     const std::vector<subdoc_spec> &specs() const
     {
-        return specs_;
+        static const std::vector<subdoc_spec> empty{};
+        return specs_ ? *specs_ : empty;
     }
 
   private:
-    std::vector<subdoc_spec> specs_{};
+    std::shared_ptr<std::vector<subdoc_spec>> specs_{};
 };
 
 struct lcb_CMDSUBDOC_ {
@@ -21,7 +21,6 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
-#include <sstream>
 #include <stdexcept>
 
 namespace lcb
@@ -48,11 +47,6 @@ struct collection_qualifier {
         if (collection_name != nullptr && collection_name_len > 0) {
             collection_.assign(collection_name, collection_name_len);
         }
-        std::stringstream ss;
-        ss << (scope_.empty() ? "_default" : scope_);
-        ss << '.';
-        ss << (collection_.empty() ? "_default" : collection_);
-        spec_ = ss.str();
     }
 
     const std::string &scope() const
@@ -91,12 +85,28 @@ struct collection_qualifier {
         resolved_ = true;
     }
 
+    /**
+     * The "scope.collection" path is only needed to resolve an unknown
+     * collection, so it is built on first use rather than for every command.
+     */
     const std::string &spec() const
     {
+        if (spec_.empty()) {
+            const std::string &scope = scope_.empty() ? default_name() : scope_;
+            const std::string &collection = collection_.empty() ? default_name() : collection_;
+            spec_.reserve(scope.size() + 1 + collection.size());
+            spec_.append(scope).append(1, '.').append(collection);
+        }
         return spec_;
     }
 
   private:
+    static const std::string &default_name()
+    {
+        static const std::string name("_default");
+        return name;
+    }
+
     static bool is_valid_collection_char(char ch)
     {
         if (ch >= 'A' && ch <= 'Z') {
@@ -137,7 +147,7 @@ struct collection_qualifier {
 
     std::string scope_{};
     std::string collection_{};
-    std::string spec_{};
+    mutable std::string spec_{};
     std::uint32_t resolved_collection_id_{0};
     bool resolved_{false};
 };
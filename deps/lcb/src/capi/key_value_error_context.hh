@@ -37,6 +37,11 @@ struct lcb_KEY_VALUE_ERROR_CONTEXT_ {
     std::string ref{};
     std::string context{};
     std::string endpoint{};
+    /* set when LCB_CNTL_KV_OP_TIMINGS is enabled, see lcb_errctx_kv_op_timings() */
+    bool has_op_timings{false};
+    std::uint64_t queue_us{0};
+    std::uint64_t network_us{0};
+    std::uint64_t server_us{0};
 };
 
 #endif // LIBCOUCHBASE_CAPI_KEY_VALUE_ERROR_CONTEXT_HH
@@ -21,6 +21,7 @@
 #include <lcbio/iotable.h>
 #include <mcserver/negotiate.h>
 #include <lcbio/ssl.h>
+#include "slab/slab.h"
 
 #define LOGARGS(instance, lvl) instance->settings, "cntl", LCB_LOG_##lvl, __FILE__, __LINE__
 
@@ -134,6 +135,10 @@ static std::uint32_t *get_timeout_field(lcb_INSTANCE *instance, int cmd)
             return &settings->persistence_timeout_floor;
         case LCB_CNTL_OP_METRICS_FLUSH_INTERVAL:
             return &settings->op_metrics_flush_interval;
+        case LCB_CNTL_SSL_SESSION_LIFETIME:
+            return &settings->ssl_session_lifetime;
+        case LCB_CNTL_DNS_CACHE_TTL:
+            return &settings->dns_cache_ttl;
         default:
             return nullptr;
     }
@@ -244,6 +249,100 @@ HANDLER(enable_errmap_handler){RETURN_GET_SET(int, LCBT_SETTING(instance, use_er
 
 HANDLER(enable_op_metrics_handler){RETURN_GET_SET(int, LCBT_SETTING(instance, op_metrics_enabled))}
 
+HANDLER(config_cache_revalidate_handler){RETURN_GET_SET(int, LCBT_SETTING(instance, config_cache_revalidate))}
+
+HANDLER(ssl_session_cache_size_handler){
+    RETURN_GET_SET(std::uint32_t, LCBT_SETTING(instance, ssl_session_cache_size))}
+
+HANDLER(buffer_pool_limit_handler)
+{
+    size_t limits[2];
+    lcb_slab_get_limits(&limits[0], &limits[1]);
+    size_t &limit = cmd == LCB_CNTL_BUFFER_POOL_LIMIT ? limits[0] : limits[1];
+    if (mode == LCB_CNTL_SET) {
+        limit = *reinterpret_cast<lcb_SIZE *>(arg);
+        lcb_slab_set_limits(limits[0], limits[1]);
+    } else if (mode == LCB_CNTL_GET) {
+        *reinterpret_cast<lcb_SIZE *>(arg) = limit;
+    } else {
+        return LCB_ERR_CONTROL_UNSUPPORTED_MODE;
+    }
+    (void)instance;
+    return LCB_SUCCESS;
+}
+
+HANDLER(buffer_pool_stats_handler)
+{
+    if (mode != LCB_CNTL_GET) {
+        return LCB_ERR_CONTROL_UNSUPPORTED_MODE;
+    }
+    lcb_slab_get_stats(reinterpret_cast<lcb_BUFFER_POOL_STATS *>(arg));
+    (void)instance;
+    (void)cmd;
+    return LCB_SUCCESS;
+}
+
+HANDLER(http_min_idle_handler)
+{
+    std::uint32_t *field;
+    switch (cmd) {
+        case LCB_CNTL_QUERY_MIN_IDLE_CONNECTIONS:
+            field = &LCBT_SETTING(instance, query_min_idle);
+            break;
+        case LCB_CNTL_SEARCH_MIN_IDLE_CONNECTIONS:
+            field = &LCBT_SETTING(instance, search_min_idle);
+            break;
+        default:
+            field = &LCBT_SETTING(instance, analytics_min_idle);
+            break;
+    }
+    if (mode == LCB_CNTL_SET) {
+        *field = *reinterpret_cast<std::uint32_t *>(arg);
+        lcb_update_http_pools(instance);
+    } else if (mode == LCB_CNTL_GET) {
+        *reinterpret_cast<std::uint32_t *>(arg) = *field;
+    } else {
+        return LCB_ERR_CONTROL_UNSUPPORTED_MODE;
+    }
+    return LCB_SUCCESS;
+}
+
+HANDLER(http_max_connections_handler)
+{
+    lcb::io::Pool::Options &options = instance->http_sockpool->get_options();
+    if (mode == LCB_CNTL_SET) {
+        auto limit = *reinterpret_cast<lcb_SIZE *>(arg);
+        if (limit > UINT_MAX) {
+            return LCB_ERR_CONTROL_INVALID_ARGUMENT;
+        }
+        options.maxtotal = static_cast<unsigned>(limit);
+    } else if (mode == LCB_CNTL_GET) {
+        *reinterpret_cast<lcb_SIZE *>(arg) = options.maxtotal;
+    } else {
+        return LCB_ERR_CONTROL_UNSUPPORTED_MODE;
+    }
+    (void)cmd;
+    return LCB_SUCCESS;
+}
+
+HANDLER(kv_op_timings_handler)
+{
+    (void)cmd;
+    if (mode == LCB_CNTL_SET) {
+        int val = *reinterpret_cast<int *>(arg);
+        LCBT_SETTING(instance, kv_op_timings) = val ? 1 : 0;
+        if (val && !instance->settings->metrics) {
+            /* the timings are also collected into the per-server histograms */
+            instance->settings->metrics = lcb_metrics_new();
+        }
+    } else if (mode == LCB_CNTL_GET) {
+        *reinterpret_cast<int *>(arg) = LCBT_SETTING(instance, kv_op_timings);
+    } else {
+        return LCB_ERR_CONTROL_UNSUPPORTED_MODE;
+    }
+    return LCB_SUCCESS;
+}
+
 HANDLER(tracing_orphaned_queue_size_handler){
     RETURN_GET_SET(std::uint32_t, LCBT_SETTING(instance, tracer_orphaned_queue_size))}
 
@@ -831,6 +930,18 @@ static ctl_handler handlers[] = {
     enable_errmap_handler,                /* LCB_CNTL_ENABLE_ERRMAP */
     timeout_common,                       /* LCB_CNTL_OP_METRICS_FLUSH_INTERVAL */
     enable_op_metrics_handler,            /* LCB_CNTL_ENABLE_OP_METRICS */
+    config_cache_revalidate_handler,      /* LCB_CNTL_CONFIGCACHE_REVALIDATE */
+    ssl_session_cache_size_handler,       /* LCB_CNTL_SSL_SESSION_CACHE_SIZE */
+    timeout_common,                       /* LCB_CNTL_SSL_SESSION_LIFETIME */
+    timeout_common,                       /* LCB_CNTL_DNS_CACHE_TTL */
+    buffer_pool_limit_handler,            /* LCB_CNTL_BUFFER_POOL_LIMIT */
+    buffer_pool_limit_handler,            /* LCB_CNTL_BUFFER_POOL_THREAD_LIMIT */
+    buffer_pool_stats_handler,            /* LCB_CNTL_BUFFER_POOL_STATS */
+    http_min_idle_handler,                /* LCB_CNTL_QUERY_MIN_IDLE_CONNECTIONS */
+    http_min_idle_handler,                /* LCB_CNTL_SEARCH_MIN_IDLE_CONNECTIONS */
+    http_min_idle_handler,                /* LCB_CNTL_ANALYTICS_MIN_IDLE_CONNECTIONS */
+    http_max_connections_handler,         /* LCB_CNTL_HTTP_MAX_CONNECTIONS_PER_HOST */
+    kv_op_timings_handler,                /* LCB_CNTL_KV_OP_TIMINGS */
     nullptr
 };
 /* clang-format on */
@@ -1067,6 +1178,17 @@ static cntl_OPCODESTRS stropcode_map[] = {
     {"enable_errmap", LCB_CNTL_ENABLE_ERRMAP, convert_intbool},
     {"operation_metrics_flush_interval", LCB_CNTL_OP_METRICS_FLUSH_INTERVAL, convert_timevalue},
     {"enable_operation_metrics", LCB_CNTL_ENABLE_OP_METRICS, convert_intbool},
+    {"config_cache_revalidate", LCB_CNTL_CONFIGCACHE_REVALIDATE, convert_intbool},
+    {"ssl_session_cache_size", LCB_CNTL_SSL_SESSION_CACHE_SIZE, convert_u32},
+    {"ssl_session_lifetime", LCB_CNTL_SSL_SESSION_LIFETIME, convert_timevalue},
+    {"dns_cache_ttl", LCB_CNTL_DNS_CACHE_TTL, convert_timevalue},
+    {"buffer_pool_limit", LCB_CNTL_BUFFER_POOL_LIMIT, convert_SIZE},
+    {"buffer_pool_thread_limit", LCB_CNTL_BUFFER_POOL_THREAD_LIMIT, convert_SIZE},
+    {"query_min_idle_connections", LCB_CNTL_QUERY_MIN_IDLE_CONNECTIONS, convert_u32},
+    {"search_min_idle_connections", LCB_CNTL_SEARCH_MIN_IDLE_CONNECTIONS, convert_u32},
+    {"analytics_min_idle_connections", LCB_CNTL_ANALYTICS_MIN_IDLE_CONNECTIONS, convert_u32},
+    {"http_max_connections_per_host", LCB_CNTL_HTTP_MAX_CONNECTIONS_PER_HOST, convert_SIZE},
+    {"kv_op_timings", LCB_CNTL_KV_OP_TIMINGS, convert_intbool},
     {nullptr, -1}};
 
 #define CNTL_NUM_HANDLERS (sizeof(handlers) / sizeof(handlers[0]))
@@ -28,6 +28,49 @@
 
 namespace lcb
 {
+static const char default_name[] = "_default";
+static const size_t default_name_len = sizeof(default_name) - 1;
+
+static void normalize_name(const char *&name, size_t &nname)
+{
+    if (name == nullptr || nname == 0) {
+        name = default_name;
+        nname = default_name_len;
+    }
+}
+
+static std::size_t hash_bytes(std::size_t hash, const char *bytes, size_t nbytes)
+{
+    /* FNV-1a */
+    for (size_t ii = 0; ii < nbytes; ++ii) {
+        hash ^= static_cast<unsigned char>(bytes[ii]);
+        hash *= static_cast<std::size_t>(1099511628211ULL);
+    }
+    return hash;
+}
+
+static std::size_t hash_spec(const char *scope, size_t nscope, const char *collection, size_t ncollection)
+{
+    std::size_t hash = static_cast<std::size_t>(14695981039346656037ULL);
+    hash = hash_bytes(hash, scope, nscope);
+    hash = hash_bytes(hash, ".", 1);
+    return hash_bytes(hash, collection, ncollection);
+}
+
+static bool split_spec(const std::string &path, const char **scope, size_t *nscope, const char **collection,
+                       size_t *ncollection)
+{
+    size_t dot = path.find('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    *scope = path.data();
+    *nscope = dot;
+    *collection = path.data() + dot + 1;
+    *ncollection = path.size() - dot - 1;
+    return true;
+}
+
 CollectionCache::CollectionCache()
 {
     static const std::string default_collection("_default._default");
@@ -36,36 +79,88 @@ CollectionCache::CollectionCache()
 
 std::string CollectionCache::id_to_name(uint32_t cid)
 {
-    std::map<uint32_t, std::string>::const_iterator pos = cache_i2n.find(cid);
+    auto pos = cache_i2n.find(cid);
     if (pos != cache_i2n.end()) {
         return pos->second;
     }
     return "";
 }
 
-bool CollectionCache::get(const std::string &path, uint32_t *cid)
+bool CollectionCache::find(std::size_t hash, const char *scope, size_t nscope, const char *collection,
+                           size_t ncollection, uint32_t *cid) const
 {
-    std::map<std::string, uint32_t>::const_iterator pos = cache_n2i.find(path);
-    if (pos != cache_n2i.end()) {
-        *cid = pos->second;
-        return true;
+    auto range = cache_n2i.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        auto name = cache_i2n.find(it->second);
+        if (name == cache_i2n.end()) {
+            continue;
+        }
+        const std::string &path = name->second;
+        if (path.size() == nscope + 1 + ncollection && path.compare(0, nscope, scope, nscope) == 0 &&
+            path[nscope] == '.' && path.compare(nscope + 1, ncollection, collection, ncollection) == 0) {
+            *cid = it->second;
+            return true;
+        }
     }
     return false;
 }
 
+bool CollectionCache::get(const std::string &path, uint32_t *cid)
+{
+    const char *scope, *collection;
+    size_t nscope, ncollection;
+    if (!split_spec(path, &scope, &nscope, &collection, &ncollection)) {
+        return false;
+    }
+    return find(hash_spec(scope, nscope, collection, ncollection), scope, nscope, collection, ncollection, cid);
+}
+
+bool CollectionCache::get(const char *scope, size_t nscope, const char *collection, size_t ncollection, uint32_t *cid)
+{
+    normalize_name(scope, nscope);
+    normalize_name(collection, ncollection);
+    return find(hash_spec(scope, nscope, collection, ncollection), scope, nscope, collection, ncollection, cid);
+}
+
 void CollectionCache::put(const std::string &path, uint32_t cid)
 {
-    cache_n2i[path] = cid;
+    const char *scope, *collection;
+    size_t nscope, ncollection;
+    if (!split_spec(path, &scope, &nscope, &collection, &ncollection)) {
+        return;
+    }
+    uint32_t old_cid;
+    std::size_t hash = hash_spec(scope, nscope, collection, ncollection);
+    if (find(hash, scope, nscope, collection, ncollection, &old_cid)) {
+        if (old_cid == cid) {
+            return;
+        }
+        /* the collection has been re-created with new ID */
+        erase(old_cid);
+    }
+    erase(cid);
     cache_i2n[cid] = path;
+    cache_n2i.emplace(hash, cid);
 }
 
 void CollectionCache::erase(uint32_t cid)
 {
     auto pos = cache_i2n.find(cid);
-    if (pos != cache_i2n.end()) {
-        cache_n2i.erase(pos->second);
-        cache_i2n.erase(pos);
+    if (pos == cache_i2n.end()) {
+        return;
     }
+    const char *scope, *collection;
+    size_t nscope, ncollection;
+    if (split_spec(pos->second, &scope, &nscope, &collection, &ncollection)) {
+        auto range = cache_n2i.equal_range(hash_spec(scope, nscope, collection, ncollection));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == cid) {
+                cache_n2i.erase(it);
+                break;
+            }
+        }
+    }
+    cache_i2n.erase(pos);
 }
 } // namespace lcb
 
@@ -96,8 +191,7 @@ lcb_STATUS collcache_get(lcb_INSTANCE *instance, const char *scope, size_t nscop
         return LCB_ERR_UNSUPPORTED_OPERATION;
     }
 
-    std::string spec = collcache_build_spec(scope, nscope, collection, ncollection);
-    if (instance->collcache->get(spec, cid)) {
+    if (instance->collcache->get(scope, nscope, collection, ncollection, cid)) {
         return LCB_SUCCESS;
     }
     return LCB_ERR_COLLECTION_NOT_FOUND;
@@ -115,6 +209,15 @@ lcb_STATUS collcache_get(lcb_INSTANCE *instance, lcb::collection_qualifier &coll
     return LCB_SUCCESS;
 }
 
+LIBCOUCHBASE_API lcb_STATUS lcb_collection_id_cached(lcb_INSTANCE *instance, const char *scope, size_t scope_len,
+                                                     const char *collection, size_t collection_len, uint32_t *id)
+{
+    if (instance == nullptr || id == nullptr) {
+        return LCB_ERR_INVALID_ARGUMENT;
+    }
+    return collcache_get(instance, scope, scope_len, collection, collection_len, id);
+}
+
 LIBCOUCHBASE_API lcb_STATUS lcb_respgetmanifest_status(const lcb_RESPGETMANIFEST *resp)
 {
     return resp->ctx.rc;
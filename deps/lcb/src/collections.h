@@ -20,6 +20,7 @@
 
 #ifdef __cplusplus
 #include <memory>
+#include <unordered_map>
 
 #include "capi/cmd_getcid.hh"
 #include "capi/collection_qualifier.hh"
@@ -27,10 +28,20 @@
 
 namespace lcb
 {
+/**
+ * Maps "scope.collection" specs to collection IDs and back.
+ *
+ * Lookups by name are keyed by a hash of the spec, which can be computed
+ * directly from separate scope and collection buffers. This lets the KV hot
+ * path resolve a CID without building the spec string for every operation.
+ */
 class CollectionCache
 {
-    std::map<std::string, uint32_t> cache_n2i{};
-    std::map<uint32_t, std::string> cache_i2n{};
+    std::unordered_multimap<std::size_t, uint32_t> cache_n2i{};
+    std::unordered_map<uint32_t, std::string> cache_i2n{};
+
+    bool find(std::size_t hash, const char *scope, size_t nscope, const char *collection, size_t ncollection,
+              uint32_t *cid) const;
 
   public:
     CollectionCache();
@@ -39,6 +50,12 @@ class CollectionCache
 
     bool get(const std::string &path, uint32_t *cid);
 
+    /**
+     * Allocation-free variant of get(). Empty scope or collection name refers
+     * to "_default", as in collcache_build_spec().
+     */
+    bool get(const char *scope, size_t nscope, const char *collection, size_t ncollection, uint32_t *cid);
+
     void put(const std::string &path, uint32_t cid);
 
     std::string id_to_name(uint32_t cid);
@@ -4,6 +4,11 @@
 #include "hostlist.h"
 #include "connspec.h"
 
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #ifndef _WIN32
 #include <string>
 
@@ -22,7 +27,7 @@
 
 #define LCB_NSRESSZ 4096
 
-lcb_STATUS lcb::dnssrv_query(const char *name, lcb::Hostlist &hostlist)
+static lcb_STATUS srv_lookup(const char *name, lcb::Hostlist &hostlist, uint32_t &ttl)
 {
     ns_msg msg;
 
@@ -62,6 +67,9 @@ lcb_STATUS lcb::dnssrv_query(const char *name, lcb::Hostlist &hostlist)
         if (ns_rr_type(rr) != ns_t_srv) {
             continue;
         }
+        if (hostlist.empty() || ns_rr_ttl(rr) < ttl) {
+            ttl = ns_rr_ttl(rr);
+        }
 
         /* Get the rdata and length fields */
         rdata = ns_rr_rdata(rr);
@@ -94,7 +102,7 @@ lcb_STATUS lcb::dnssrv_query(const char *name, lcb::Hostlist &hostlist)
 #include <windns.h>
 #define CAN_SRV_LOOKUP
 /* Implement via DnsQuery() */
-lcb_STATUS lcb::dnssrv_query(const char *addr, Hostlist &hs)
+static lcb_STATUS srv_lookup(const char *addr, lcb::Hostlist &hs, uint32_t &ttl)
 {
     DNS_STATUS status;
     PDNS_RECORDA root, cur;
@@ -107,6 +115,9 @@ lcb_STATUS lcb::dnssrv_query(const char *addr, Hostlist &hs)
     for (cur = root; cur; cur = cur->pNext) {
         // Use the ASCII version of the DNS lookup structure
         const DNS_SRV_DATAA *srv = &cur->Data.SRV;
+        if (hs.empty() || cur->dwTtl < ttl) {
+            ttl = cur->dwTtl;
+        }
         hs.add(srv->pNameTarget, srv->wPort);
     }
     DnsRecordListFree(root, DnsFreeRecordList);
@@ -116,12 +127,64 @@ lcb_STATUS lcb::dnssrv_query(const char *addr, Hostlist &hs)
 #endif /* !WIN32 */
 
 #ifndef CAN_SRV_LOOKUP
-lcb_STATUS lcb::dnssrv_query(const char *, Hostlist &)
+static lcb_STATUS srv_lookup(const char *, lcb::Hostlist &, uint32_t &)
 {
     return LCB_ERR_SDK_FEATURE_UNAVAILABLE;
 }
 #endif
 
+namespace
+{
+struct SrvCacheEntry {
+    std::vector<lcb_host_t> hosts;
+    time_t expires;
+};
+} // namespace
+
+/**
+ * Answers are kept for as long as the records' TTL allows, so that every
+ * instance bootstrapping against the same name (for example one per I/O
+ * shard) does not wait for the resolver again.
+ */
+lcb_STATUS lcb::dnssrv_query(const char *name, Hostlist &hostlist)
+{
+    static std::mutex mutex;
+    static auto *cache = new std::map<std::string, SrvCacheEntry>();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cache->find(name);
+        if (it != cache->end()) {
+            if (it->second.expires > time(nullptr)) {
+                for (const auto &host : it->second.hosts) {
+                    hostlist.add(host);
+                }
+                return LCB_SUCCESS;
+            }
+            cache->erase(it);
+        }
+    }
+
+    Hostlist found;
+    uint32_t ttl = 0;
+    lcb_STATUS rc = srv_lookup(name, found, ttl);
+    if (rc != LCB_SUCCESS) {
+        return rc;
+    }
+
+    SrvCacheEntry ent;
+    ent.hosts.assign(found.hosts.begin(), found.hosts.end());
+    for (const auto &host : ent.hosts) {
+        hostlist.add(host);
+    }
+    if (ttl > 0 && !ent.hosts.empty()) {
+        ent.expires = time(nullptr) + ttl;
+        std::lock_guard<std::mutex> lock(mutex);
+        (*cache)[name] = std::move(ent);
+    }
+    return LCB_SUCCESS;
+}
+
 #define SVCNAME_PLAIN "_couchbase._tcp."
 #define SVCNAME_SSL "_couchbases._tcp."
 
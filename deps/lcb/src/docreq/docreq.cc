@@ -19,6 +19,8 @@
 #include "internal.h"
 #include "sllist-inl.h"
 
+#include <algorithm>
+
 using namespace lcb::docreq;
 
 static void docreq_handler(void *arg);
@@ -26,6 +28,14 @@ static void invoke_pending(Queue *);
 
 #define DOCQ_DELAY_US 200000
 
+/* Minimum length of a period over which the row arrival rate is measured.
+ * Rows arrive in bursts (one per HTTP chunk), so per-row intervals are
+ * meaningless */
+#define DOCQ_RATE_PERIOD_NS LCB_US2NS(LCB_MS2US(10))
+
+/* Weight of a new sample in the smoothed rate and latency */
+#define DOCQ_EWMA_WEIGHT 0.125
+
 Queue::Queue(lcb_INSTANCE *instance_)
     : instance(instance_), timer(lcbio_timer_new(instance->iotable, this, docreq_handler))
 {
@@ -52,6 +62,57 @@ void Queue::cancel()
     cancelled = true;
 }
 
+void Queue::set_throttle(bool enabled)
+{
+    if (throttled && !enabled) {
+        /* Time spent paused says nothing about how fast rows can arrive */
+        period_rows = 0;
+        period_start = 0;
+    }
+    throttled = enabled;
+    cb_throttle(this, enabled);
+}
+
+static void ewma_update(double &avg, double sample)
+{
+    if (avg == 0) {
+        avg = sample;
+    } else {
+        avg += DOCQ_EWMA_WEIGHT * (sample - avg);
+    }
+}
+
+void Queue::adapt_window()
+{
+    if (!adaptive || arrival_rate == 0 || fetch_latency == 0) {
+        return;
+    }
+
+    /* Twice the concurrency needed to keep up with rows, so that a slow
+     * fetch or a burst of rows does not immediately pause the HTTP stream */
+    double needed = 2 * arrival_rate * fetch_latency;
+    unsigned window = default_max_pending_docreq;
+    if (needed > max_adaptive_docreq) {
+        window = max_adaptive_docreq;
+    } else if (needed > window) {
+        window = static_cast<unsigned>(needed);
+    }
+    max_pending_response = window;
+
+    /* Larger windows are better served by larger batches, which are
+     * pipelined together to each node */
+    min_batch_size = std::max<unsigned>(default_min_sched_size, window / 8);
+}
+
+void Queue::response_received(DocRequest *req)
+{
+    n_awaiting_response--;
+    if (adaptive && req->scheduled) {
+        ewma_update(fetch_latency, static_cast<double>(gethrtime() - req->scheduled));
+        adapt_window();
+    }
+}
+
 /* Calling this function ensures that the request will be scheduled in due
  * time. This may be done at the next event loop iteration, or after a delay
  * depending on how many items are actually found within the queue. */
@@ -60,7 +121,7 @@ static void docq_poke(Queue *q)
     if (q->n_awaiting_response < q->max_pending_response) {
         if (q->n_awaiting_schedule > q->min_batch_size) {
             lcbio_async_signal(q->timer);
-            q->cb_throttle(q, 0);
+            q->set_throttle(false);
         }
     }
 
@@ -75,7 +136,22 @@ void Queue::add(DocRequest *req)
     n_awaiting_schedule++;
     req->parent = this;
     req->ready = 0;
+    req->scheduled = 0;
     ref();
+
+    if (adaptive) {
+        hrtime_t now = gethrtime();
+        if (period_start == 0) {
+            period_start = now;
+        }
+        period_rows++;
+        if (now - period_start >= DOCQ_RATE_PERIOD_NS) {
+            ewma_update(arrival_rate, period_rows / static_cast<double>(now - period_start));
+            period_rows = 0;
+            period_start = now;
+            adapt_window();
+        }
+    }
     docq_poke(this);
 }
 
@@ -84,7 +160,10 @@ static void docreq_handler(void *arg)
     auto *q = reinterpret_cast<Queue *>(arg);
     sllist_iterator iter;
     lcb_INSTANCE *instance = q->instance;
+    hrtime_t now = q->adaptive ? gethrtime() : 0;
 
+    /* Every fetch in the batch is scheduled in one bracket, so that the
+     * commands for each node are flushed together */
     lcb_sched_enter(instance);
     SLLIST_ITERFOR(&q->pending_gets, &iter)
     {
@@ -92,7 +171,7 @@ static void docreq_handler(void *arg)
 
         if (q->n_awaiting_response > q->max_pending_response) {
             lcbio_timer_rearm(q->timer, DOCQ_DELAY_US);
-            q->cb_throttle(q, 1);
+            q->set_throttle(true);
             break;
         }
 
@@ -109,6 +188,7 @@ static void docreq_handler(void *arg)
                 cont->docresp.ctx.rc = rc;
                 cont->ready = 1;
             } else {
+                cont->scheduled = now;
                 q->n_awaiting_response++;
             }
         }
@@ -120,7 +200,7 @@ static void docreq_handler(void *arg)
     lcb_sched_flush(instance);
 
     if (q->n_awaiting_schedule < q->min_batch_size) {
-        q->cb_throttle(q, 0);
+        q->set_throttle(false);
     }
 
     /* Ensure we're called again */
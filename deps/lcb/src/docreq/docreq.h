@@ -48,6 +48,9 @@ struct Queue {
     }
     void cancel();
     void check();
+    void response_received(DocRequest *);
+    void set_throttle(bool enabled);
+    void adapt_window();
     bool has_pending() const
     {
         return n_awaiting_response || n_awaiting_schedule;
@@ -92,6 +95,21 @@ struct Queue {
     unsigned min_batch_size{default_min_sched_size};
     unsigned cancelled{false};
     unsigned refcount{1};
+
+    /**If set, max_pending_response follows the number of fetches needed to
+     * keep up with incoming rows: the row arrival rate multiplied by the
+     * latency of a fetch (Little's law), with some headroom. Cleared when the
+     * user asks for a fixed window */
+    bool adaptive{true};
+    static const int max_adaptive_docreq{1024};
+    bool throttled{false};
+
+    /** Rows added since period_start, used to measure the arrival rate */
+    unsigned period_rows{0};
+    hrtime_t period_start{0};
+    /** Smoothed arrival rate (rows per nanosecond) and fetch latency (ns) */
+    double arrival_rate{0};
+    double fetch_latency{0};
 };
 
 struct DocRequest {
@@ -103,6 +121,7 @@ struct DocRequest {
     /* To be filled in by the subclass */
     lcb_IOV docid;
     unsigned ready;
+    hrtime_t scheduled;
 };
 
 } // namespace docreq
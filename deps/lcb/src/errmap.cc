@@ -341,6 +341,18 @@ LIBCOUCHBASE_API lcb_STATUS lcb_errctx_kv_endpoint(const lcb_KEY_VALUE_ERROR_CON
     return LCB_SUCCESS;
 }
 
+LIBCOUCHBASE_API lcb_STATUS lcb_errctx_kv_op_timings(const lcb_KEY_VALUE_ERROR_CONTEXT *ctx, uint64_t *queue_us,
+                                                     uint64_t *network_us, uint64_t *server_us)
+{
+    if (!ctx->has_op_timings) {
+        return LCB_ERR_INVALID_ARGUMENT;
+    }
+    *queue_us = ctx->queue_us;
+    *network_us = ctx->network_us;
+    *server_us = ctx->server_us;
+    return LCB_SUCCESS;
+}
+
 LIBCOUCHBASE_API lcb_STATUS lcb_errctx_http_rc(const lcb_HTTP_ERROR_CONTEXT *ctx)
 {
     return ctx->rc;
@@ -250,6 +250,48 @@ void handle_error_info(const MemcachedResponse *mc_resp, T &resp)
     }
 }
 
+static void record_histogram(lcb_HISTOGRAM *&hg, hrtime_t duration)
+{
+    if (hg == nullptr) {
+        hg = lcb_histogram_create();
+    }
+    lcb_histogram_record(hg, duration);
+}
+
+/**
+ * Splits the round trip of a request into the time it spent queued in the
+ * library, the time the server reported, and the rest, which is attributed
+ * to the network. Only requests which were answered by the server on the
+ * connection they were written to have all of the timestamps needed.
+ */
+static void record_op_timings(mc_PIPELINE *pipeline, const MemcachedResponse *mc_resp, const mc_PACKET *req,
+                              lcb_KEY_VALUE_ERROR_CONTEXT *ctx)
+{
+    const mc_REQDATA *rd = MCREQ_PKT_RDATA(req);
+    if (rd->flushed == 0 || rd->flushed < rd->start || rd->dispatch < rd->flushed) {
+        return;
+    }
+
+    hrtime_t queue = rd->flushed - rd->start;
+    hrtime_t round_trip = rd->dispatch - rd->flushed;
+    hrtime_t server = LCB_US2NS(mc_resp->duration());
+    hrtime_t network = round_trip > server ? round_trip - server : 0;
+
+    ctx->has_op_timings = true;
+    ctx->queue_us = LCB_NS2US(queue);
+    ctx->network_us = LCB_NS2US(network);
+    ctx->server_us = LCB_NS2US(server);
+
+    lcb_SERVERMETRICS *metrics = pipeline->metrics;
+    if (metrics) {
+        record_histogram(metrics->queue_latency, queue);
+        record_histogram(metrics->network_latency, network);
+        if (server) {
+            record_histogram(metrics->server_latency, server);
+        }
+    }
+}
+
 template <typename T>
 void init_resp(lcb_INSTANCE *instance, mc_PIPELINE *pipeline, const MemcachedResponse *mc_resp, const mc_PACKET *req,
                lcb_STATUS immerr, T *resp)
@@ -284,6 +326,10 @@ void init_resp(lcb_INSTANCE *instance, mc_PIPELINE *pipeline, const MemcachedRes
         ss << remote->port;
         resp->ctx.endpoint = ss.str();
     }
+
+    if (instance && instance->settings->kv_op_timings && immerr == LCB_SUCCESS) {
+        record_op_timings(pipeline, mc_resp, req, &resp->ctx);
+    }
 }
 
 /**
@@ -933,6 +979,11 @@ static void H_collections_get_cid(mc_PIPELINE *pipeline, mc_PACKET *request, Mem
         }
         request->u_rdata.exdata->procs->handler(pipeline, request, LCB_CALLBACK_GETCID, resp.ctx.rc, &resp);
     } else {
+        if (resp.ctx.rc == LCB_SUCCESS && (request->flags & MCREQ_F_HASVALUE)) {
+            /* lcb_getcid() pre-resolves the collection for subsequent operations */
+            std::string path(SPAN_BUFFER(&request->u_value.single), request->u_value.single.size);
+            root->collcache->put(path, resp.collection_id);
+        }
         invoke_callback(request, root, &resp, LCB_CALLBACK_GETCID);
     }
 }
@@ -1012,7 +1063,7 @@ static void record_metrics(mc_PIPELINE *pipeline, mc_PACKET *req, MemcachedRespo
 #ifdef HAVE_DTRACE
         1
 #else
-        instance->kv_timings
+        instance->kv_timings || instance->settings->kv_op_timings
 #endif
     ) {
         MCREQ_PKT_RDATA(req)->dispatch = gethrtime();
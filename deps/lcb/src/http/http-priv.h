@@ -314,14 +314,11 @@ struct Request {
     std::vector<Header> request_headers; /**< List of request headers */
 
     /**
-     * Response headers for callback (array of char*). Buffers are mapped to
-     * ::response_headers
+     * Response headers for callback (array of char*). These point into the
+     * current response of ::parser, and are cleared whenever it is reset
      */
     std::vector<const char *> response_headers_clist;
 
-    /** Backing buffers for response headers */
-    std::vector<lcb::htparse::MimeHeader> response_headers;
-
     /** Callback to invoke */
     lcb_RESPCALLBACK callback;
 
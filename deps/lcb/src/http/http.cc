@@ -298,7 +298,7 @@ void Request::init_resp(lcb_RESPHTTP *res)
     res->ctx.path = url.c_str() + url_info.field_data[UF_PATH].off;
     res->ctx.path_len = url_info.field_data[UF_PATH].len;
     res->_htreq = static_cast<lcb_HTTP_HANDLE *>(this);
-    if (!response_headers.empty()) {
+    if (!response_headers_clist.empty()) {
         res->headers = &response_headers_clist[0];
     }
     res->ctx.response_code = htres.status;
@@ -423,7 +423,6 @@ lcb_STATUS Request::submit()
         } else {
             parser = new lcb::htparse::Parser(instance->settings);
         }
-        response_headers.clear();
         response_headers_clist.clear();
         TRACE_HTTP_BEGIN(this);
     }
@@ -34,13 +34,11 @@ using namespace lcb::http;
 
 void Request::assign_response_headers(const lcb::htparse::Response &resp)
 {
-    response_headers.assign(resp.headers.begin(), resp.headers.end());
     response_headers_clist.clear();
-
-    std::vector<lcb::htparse::MimeHeader>::const_iterator ii;
-    for (ii = response_headers.begin(); ii != response_headers.end(); ++ii) {
-        response_headers_clist.push_back(ii->key.c_str());
-        response_headers_clist.push_back(ii->value.c_str());
+    response_headers_clist.reserve(resp.headers.size() * 2 + 1);
+    for (const auto &header : resp.headers) {
+        response_headers_clist.push_back(resp.header_key(header));
+        response_headers_clist.push_back(resp.header_value(header));
     }
     response_headers_clist.push_back(nullptr);
 }
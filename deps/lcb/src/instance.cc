@@ -545,6 +545,7 @@ lcb_STATUS lcb_create(lcb_INSTANCE **instance, const lcb_CREATEOPTS *options)
         pool_opts.tmoidle = LCB_MS2US(10000); // 10 seconds
         obj->memd_sockpool->set_options(pool_opts);
         obj->http_sockpool->set_options(pool_opts);
+        obj->http_sockpool->set_wait_metrics(true);
     }
 
     obj->confmon = new clconfig::Confmon(settings, obj->iotable, obj);
@@ -884,7 +885,19 @@ void lcb_sched_enter(lcb_INSTANCE *instance)
 LIBCOUCHBASE_API
 void lcb_sched_leave(lcb_INSTANCE *instance)
 {
-    mcreq_sched_leave(&instance->cmdq, LCBT_SETTING(instance, sched_implicit_flush));
+    mc_CMDQUEUE *cq = &instance->cmdq;
+    int do_flush = LCBT_SETTING(instance, sched_implicit_flush);
+    bool unflushed = false;
+
+    if (!do_flush && instance->callbacks.schedflush) {
+        for (unsigned ii = 0; ii < cq->_npipelines_ex && !unflushed; ii++) {
+            unflushed = cq->scheds[ii] != 0;
+        }
+    }
+    mcreq_sched_leave(cq, do_flush);
+    if (unflushed) {
+        instance->callbacks.schedflush(instance);
+    }
 }
 LIBCOUCHBASE_API
 void lcb_sched_fail(lcb_INSTANCE *instance)
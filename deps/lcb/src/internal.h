@@ -93,6 +93,7 @@ struct lcb_callback_st {
     lcb_pktfwd_callback pktfwd;
     lcb_pktflushed_callback pktflushed;
     lcb_open_callback open;
+    lcb_sched_flush_callback schedflush;
 };
 
 struct lcb_GUESSVB_st;
@@ -231,6 +232,9 @@ void lcb_maybe_breakout(lcb_INSTANCE *instance);
 
 void lcb_update_vbconfig(lcb_INSTANCE *instance, lcb_pCONFIGINFO config);
 
+/** Apply the idle connection settings of the HTTP services to the current config */
+void lcb_update_http_pools(lcb_INSTANCE *instance);
+
 lcb_STATUS lcb_iops_cntl_handler(int mode, lcb_INSTANCE *instance, int cmd, void *arg);
 
 /**
@@ -33,6 +33,15 @@ class MetricsEntry : public lcb_SERVERMETRICS
         iometrics.hostport = m_hostport.c_str();
     }
 
+    ~MetricsEntry()
+    {
+        for (auto *hg : {queue_latency, network_latency, server_latency}) {
+            if (hg != nullptr) {
+                lcb_histogram_destroy(hg);
+            }
+        }
+    }
+
     MetricsEntry() = delete;
     MetricsEntry(const MetricsEntry &) = delete;
 };
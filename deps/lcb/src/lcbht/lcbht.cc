@@ -24,6 +24,9 @@ using namespace lcb::htparse;
 Parser::Parser(lcb_settings_st *settings_) : http_parser(), settings(settings_)
 {
     lcb_settings_ref(settings);
+    /* Enough for the headers sent by the cluster services */
+    resp.header_data.reserve(1024);
+    resp.headers.reserve(16);
     reset();
 }
 
@@ -38,12 +41,21 @@ static int on_hdr_key(http_parser *pb, const char *s, size_t n)
 }
 int Parser::on_hdr_key(const char *s, size_t n)
 {
+    if (resp.state & S_HEADER) {
+        /* Trailers are not exposed */
+        return 0;
+    }
     if (lastcall != CB_HDR_KEY) {
         /* new key */
-        resp.headers.emplace_back(MimeHeader());
+        if (lastcall == CB_HDR_VALUE) {
+            finish_header_value();
+        }
+        MimeHeader header{};
+        header.key_off = resp.header_data.size();
+        resp.headers.push_back(header);
     }
 
-    resp.headers.back().key.append(s, n);
+    resp.header_data.append(s, n);
     lastcall = CB_HDR_KEY;
     return 0;
 }
@@ -55,18 +67,44 @@ static int on_hdr_value(http_parser *pb, const char *s, size_t n)
 
 int Parser::on_hdr_value(const char *s, size_t n)
 {
-    MimeHeader *header = &resp.headers.back();
-    header->value.append(s, n);
+    if (resp.state & S_HEADER) {
+        return 0;
+    }
+    if (lastcall == CB_HDR_KEY) {
+        finish_header_key();
+    }
+    resp.header_data.append(s, n);
     lastcall = CB_HDR_VALUE;
     return 0;
 }
 
+void Parser::finish_header_key()
+{
+    MimeHeader &header = resp.headers.back();
+    header.key_len = resp.header_data.size() - header.key_off;
+    resp.header_data.push_back('\0');
+    header.value_off = resp.header_data.size();
+}
+
+void Parser::finish_header_value()
+{
+    MimeHeader &header = resp.headers.back();
+    header.value_len = resp.header_data.size() - header.value_off;
+    resp.header_data.push_back('\0');
+}
+
 static int on_hdr_done(http_parser *pb)
 {
     return Parser::from_htp(pb)->on_hdr_done();
 }
 int Parser::on_hdr_done()
 {
+    if (lastcall == CB_HDR_KEY) {
+        finish_header_key();
+        finish_header_value();
+    } else if (lastcall == CB_HDR_VALUE) {
+        finish_header_value();
+    }
     resp.state |= S_HTSTATUS | S_HEADER;
 
     /* extract the status */
@@ -162,15 +200,16 @@ bool Parser::can_keepalive() const
 void Parser::reset()
 {
     resp.clear();
+    lastcall = CB_NONE;
     _lcb_http_parser_init(this, HTTP_RESPONSE);
 }
 
-const MimeHeader *Response::get_header(const std::string &key) const
+const char *Response::get_header_value(const char *key) const
 {
-    std::list<MimeHeader>::const_iterator it;
-    for (it = headers.begin(); it != headers.end(); ++it) {
-        if (it->key == key) {
-            return &*it;
+    size_t nkey = strlen(key);
+    for (const auto &header : headers) {
+        if (header.key_len == nkey && strncasecmp(header_key(header), key, nkey) == 0) {
+            return header_value(header);
         }
     }
     return nullptr;
@@ -20,8 +20,8 @@
 
 #include <libcouchbase/couchbase.h>
 #include "contrib/http_parser/http_parser.h"
-#include <list>
 #include <string>
+#include <vector>
 
 struct lcb_settings_st;
 
@@ -41,9 +41,15 @@ namespace lcb
 namespace htparse
 {
 
+/**
+ * A response header. The key and value are stored in Response::header_data,
+ * each followed by a NUL byte.
+ */
 struct MimeHeader {
-    std::string key;
-    std::string value;
+    unsigned key_off;
+    unsigned key_len;
+    unsigned value_off;
+    unsigned value_len;
 };
 
 struct Response {
@@ -51,40 +57,40 @@ struct Response {
     {
         status = 0;
         state = 0;
+        header_data.clear();
         headers.clear();
         body.clear();
     }
 
     /**
      * Get a header value for a key
-     * @param response The response
-     * @param key The key to look up
+     * @param key The key to look up. The comparison is case-insensitive
      * @return A string containing the value. If the header has no value then the
      * empty string will be returned. If the header does not exist NULL will be
      * returned.
      */
-    const MimeHeader *get_header(const std::string &key) const;
+    const char *get_header_value(const char *key) const;
 
-    /**
-     * Get a header value for a key
-     * @param key The key to look up
-     * @return A string containing the value. If the header has no value then the
-     * empty string will be returned. If the header does not exist NULL will be
-     * returned.
-     */
-    const char *get_header_value(const std::string &key) const
+    const char *header_key(const MimeHeader &header) const
     {
-        const MimeHeader *header = get_header(key);
-        if (header) {
-            return header->value.c_str();
-        }
-        return NULL;
+        return header_data.c_str() + header.key_off;
+    }
+
+    const char *header_value(const MimeHeader &header) const
+    {
+        return header_data.c_str() + header.value_off;
     }
 
     unsigned short status; /**< HTTP Status code */
     unsigned state;
-    typedef std::list<MimeHeader> HeaderList;
-    HeaderList headers;
+
+    /**
+     * Keys and values of all headers. Both this and the `headers` index keep
+     * their capacity across clear(), so a reused response does not allocate
+     * for its headers at all.
+     */
+    std::string header_data;
+    std::vector<MimeHeader> headers;
     std::string body; /**< Body */
 };
 
@@ -193,6 +199,9 @@ class Parser : private http_parser
     }
 
   private:
+    void finish_header_key();
+    void finish_header_value();
+
     Response resp;
     lcb_settings_st *settings;
 
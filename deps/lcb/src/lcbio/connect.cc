@@ -19,6 +19,7 @@
 #include "connect.h"
 #include "ioutils.h"
 #include "iotable.h"
+#include "resolve.h"
 #include "settings.h"
 #include "timer-cxx.h"
 #include "rnd.h"
@@ -64,6 +65,9 @@ struct Connstart : ConnectionRequest {
     void handler();
     void cancel() override;
     void C_connect();
+    void resolved(int status, addrinfo *res);
+    void start_connect();
+    void forget_address();
 
     enum State { CS_PENDING, CS_CANCELLED, CS_CONNECTED, CS_ERROR, CS_ERROR_CANCELLED };
 
@@ -83,6 +87,8 @@ struct Connstart : ConnectionRequest {
     bool in_uhandler; /* Whether we're inside the user-defined handler */
     addrinfo *ai_root;
     addrinfo *ai;
+    ResolveRequest *resolving; /* pending host name lookup */
+    int family;                /* address family requested from the resolver */
     State state;
     lcb_STATUS last_error;
     Timer<Connstart, &Connstart::handler> timer;
@@ -182,11 +188,14 @@ GT_DTOR:
 Connstart::~Connstart()
 {
     timer.release();
+    if (resolving) {
+        resolve_cancel(resolving);
+    }
     if (sock) {
         lcbio_unref(sock)
     }
     if (ai_root) {
-        freeaddrinfo(ai_root);
+        addrinfo_free(ai_root);
     }
 }
 
@@ -319,6 +328,7 @@ static void E_conncb(lcb_socket_t, short events, void *arg)
 
 GT_NEXTSOCK:
     if (!cs->ensure_sock()) {
+        cs->forget_address();
         cs->notify_error(LCB_ERR_CONNECT_ERROR);
         return;
     }
@@ -420,6 +430,7 @@ void Connstart::C_connect()
 GT_NEXTSOCK:
     if (!ensure_sock()) {
         lcbio_mksyserr(IOT_ERRNO(io), &syserr);
+        forget_address();
         notify_error(LCB_ERR_CONNECT_ERROR);
         return;
     }
@@ -459,6 +470,51 @@ GT_CONNECT:
     }
 }
 
+static void resolve_done(void *arg, int status, addrinfo *res)
+{
+    reinterpret_cast<Connstart *>(arg)->resolved(status, res);
+}
+
+void Connstart::resolved(int status, addrinfo *res)
+{
+    const lcb_host_t *dest = &sock->info->ep_remote;
+    resolving = nullptr;
+
+    if (status != 0) {
+        const char *errstr = status != EAI_SYSTEM ? gai_strerror(status) : "";
+        lcb_log(LOGARGS_T(ERR), CSLOGFMT "Couldn't look up %s (%s) [EAI=%d]", CSLOGID_T(), dest->host, errstr,
+                status);
+        notify_error(LCB_ERR_UNKNOWN_HOST);
+        return;
+    }
+
+    dns_cache_put(dest->host, dest->port, family, res, sock->settings->dns_cache_ttl);
+    ai_root = res;
+    start_connect();
+}
+
+void Connstart::start_connect()
+{
+    ai = ai_root;
+
+    /** Figure out how to connect */
+    if (sock->io->is_E()) {
+        E_conncb(-1, LCB_WRITE_EVENT, this);
+    } else {
+        C_connect();
+    }
+}
+
+/**
+ * None of the addresses accepted a connection. The host may have moved, so
+ * make sure the next attempt asks the resolver again.
+ */
+void Connstart::forget_address()
+{
+    const lcb_host_t *dest = &sock->info->ep_remote;
+    dns_cache_remove(dest->host, dest->port, family);
+}
+
 ConnectionRequest *lcbio_connect(lcbio_TABLE *iot, lcb_settings *settings, const lcb_host_t *dest, uint32_t timeout,
                                  lcbio_CONNDONE_cb handler, void *arg)
 {
@@ -468,11 +524,11 @@ ConnectionRequest *lcbio_connect(lcbio_TABLE *iot, lcb_settings *settings, const
 Connstart::Connstart(lcbio_TABLE *iot_, lcb_settings *settings_, const lcb_host_t *dest, uint32_t timeout,
                      lcbio_CONNDONE_cb handler_, void *arg)
     : user_handler(handler_), user_arg(arg), sock(nullptr), syserr(0), event(nullptr), ev_active(false),
-      in_uhandler(false), ai_root(nullptr), ai(nullptr), state(CS_PENDING), last_error(LCB_SUCCESS), timer(iot_, this)
+      in_uhandler(false), ai_root(nullptr), ai(nullptr), resolving(nullptr), family(AF_UNSPEC), state(CS_PENDING),
+      last_error(LCB_SUCCESS), timer(iot_, this)
 {
 
     addrinfo hints{};
-    int rv;
 
     sock = reinterpret_cast<lcbio_SOCKET *>(calloc(1, sizeof(*sock)));
 
@@ -508,19 +564,15 @@ Connstart::Connstart(lcbio_TABLE *iot_, lcb_settings *settings_, const lcb_host_
         hints.ai_family = AF_UNSPEC;
     }
 
-    if ((rv = getaddrinfo(dest->host, dest->port, &hints, &ai_root))) {
-        const char *errstr = rv != EAI_SYSTEM ? gai_strerror(rv) : "";
-        lcb_log(LOGARGS_T(ERR), CSLOGFMT "Couldn't look up %s (%s) [EAI=%d]", CSLOGID_T(), dest->host, errstr, rv);
-        notify_error(LCB_ERR_UNKNOWN_HOST);
-    } else {
-        ai = ai_root;
+    family = hints.ai_family;
 
-        /** Figure out how to connect */
-        if (iot_->is_E()) {
-            E_conncb(-1, LCB_WRITE_EVENT, this);
-        } else {
-            C_connect();
-        }
+    /* Addresses looked up recently are used straight away; anything else is
+     * resolved without blocking the loop */
+    if ((ai_root = dns_cache_get(dest->host, dest->port, family)) != nullptr) {
+        lcb_log(LOGARGS_T(TRACE), CSLOGFMT "Using cached addresses", CSLOGID_T());
+        start_connect();
+    } else {
+        resolving = resolve_start(iot_, dest->host, dest->port, &hints, resolve_done, this);
     }
 }
 
@@ -17,6 +17,7 @@
 
 #include "manager.h"
 
+#include <algorithm>
 #include <utility>
 #include "hostlist.h"
 #include "iotable.h"
@@ -25,6 +26,9 @@
 
 #define LOGARGS(mgr, lvl) mgr->settings, "lcbio_mgr", LCB_LOG_##lvl, __FILE__, __LINE__
 
+/* Delay before opening idle connections again after a connection failed */
+#define POOL_RETRY_INTERVAL LCB_MS2US(1000)
+
 using namespace lcb::io;
 
 namespace lcb
@@ -36,6 +40,8 @@ struct PoolHost {
     inline PoolHost(Pool *, std::string);
     inline void connection_available();
     inline void start_new_connection(uint32_t timeout);
+    inline void maintain();
+    inline void schedule_maintenance();
 
     void ref()
     {
@@ -75,6 +81,10 @@ struct PoolHost {
     {
         return n_total - (num_idle() + num_pending());
     }
+    bool at_limit() const
+    {
+        return parent->options.maxtotal && n_total >= parent->options.maxtotal;
+    }
 
     lcb_clist_t ll_idle{};    /* idle connections */
     lcb_clist_t ll_pending{}; /* pending cinfo */
@@ -82,8 +92,12 @@ struct PoolHost {
     const std::string key;    /* host:port */
     Pool *parent;
     lcb::io::Timer<PoolHost, &PoolHost::connection_available> async;
+    lcb::io::Timer<PoolHost, &PoolHost::maintain> maintenance;
     unsigned n_total; /* number of total connections */
     unsigned refcount;
+    unsigned min_idle{0};       /* idle connections to keep open */
+    bool connect_failed{false}; /* last connection attempt failed */
+    bool closed{false};         /* pool has been shut down */
 };
 } // namespace io
 } // namespace lcb
@@ -139,7 +153,7 @@ namespace io
 struct PoolRequest : ReqNode, ConnectionRequest {
     PoolRequest(PoolHost *host_, lcbio_CONNDONE_cb cb, void *cbarg)
         : host(host_), callback(cb), arg(cbarg), timer(host->parent->io, this), state(PENDING), sock(nullptr),
-          err(LCB_SUCCESS)
+          err(LCB_SUCCESS), start(gethrtime())
     {
     }
 
@@ -180,6 +194,8 @@ struct PoolRequest : ReqNode, ConnectionRequest {
     State state;
     lcbio_SOCKET *sock;
     lcb_STATUS err;
+    hrtime_t start;
+    bool waited{false}; /* no idle connection was available */
 };
 } // namespace io
 } // namespace lcb
@@ -215,6 +231,7 @@ PoolConnInfo::~PoolConnInfo()
         lcbio_protoctx_delptr(sock, this, 0);
         lcbio_unref(sock)
     }
+    parent->schedule_maintenance();
     parent->unref();
 }
 
@@ -248,6 +265,7 @@ void Pool::shutdown()
 
     for (h_it = ht.begin(); h_it != ht.end(); ++h_it) {
         PoolHost *he = h_it->second;
+        he->closed = true;
 
         lcb_list_t *cur, *next;
         LCB_LIST_SAFE_FOR(cur, next, (lcb_list_t *)&he->ll_idle)
@@ -265,6 +283,7 @@ void Pool::shutdown()
     for (auto he : hes) {
         ht.erase(he->key);
         he->async.release();
+        he->maintenance.release();
         he->unref();
     }
 
@@ -328,6 +347,14 @@ void PoolRequest::invoke()
         state = ASSIGNED;
         lcb_log(LOGARGS(info->parent->parent, DEBUG), HE_LOGFMT "Assigning R=%p SOCKET=%p", HE_LOGID(info->parent),
                 (void *)this, (void *)sock);
+
+        Pool *pool = host->parent;
+        lcb_METRICS *metrics = pool->settings->metrics;
+        if (pool->wait_metrics && metrics) {
+            metrics->http_pool_requests++;
+            metrics->http_pool_misses += waited ? 1 : 0;
+            metrics->http_pool_wait_us += LCB_NS2US(gethrtime() - start);
+        }
     }
 
     callback(sock, arg, err, 0);
@@ -350,6 +377,40 @@ void PoolHost::connection_available()
         PoolConnInfo *info = PoolConnInfo::from_llnode(connitem);
         req->sock = info->sock;
         req->invoke();
+        schedule_maintenance();
+    }
+}
+
+/**
+ * Opens connections until there is one for every waiting request, plus the
+ * number of idle connections the host should keep.
+ */
+void PoolHost::maintain()
+{
+    if (closed) {
+        return;
+    }
+    connection_available();
+
+    const PoolHost *he = this;
+    size_t wanted = num_requests() + min_idle;
+    while (num_idle() + num_pending() < wanted && !at_limit()) {
+        lcb_log(LOGARGS(parent, DEBUG), HE_LOGFMT "Opening connection in advance (%lu idle, %u wanted)", HE_LOGID(he),
+                (unsigned long int)num_idle(), min_idle);
+        start_new_connection(parent->min_idle_timeout);
+    }
+}
+
+void PoolHost::schedule_maintenance()
+{
+    if (closed || (min_idle == 0 && num_requests() == 0)) {
+        return;
+    }
+    if (connect_failed) {
+        /* Don't keep hammering a host which is down */
+        maintenance.arm_if_disarmed(POOL_RETRY_INTERVAL);
+    } else {
+        maintenance.signal();
     }
 }
 
@@ -369,6 +430,7 @@ void PoolConnInfo::on_connected(lcbio_SOCKET *sock_, lcb_STATUS err)
     lcb_log(LOGARGS(parent->parent, DEBUG), HE_LOGFMT "Received result for I=%p,C=%p; E=0x%x", HE_LOGID(parent),
             (void *)this, (void *)sock, err);
     lcb_clist_delete(&parent->ll_pending, this);
+    parent->connect_failed = err != LCB_SUCCESS;
 
     if (err != LCB_SUCCESS) {
         /** If the connection failed, fail out all remaining requests */
@@ -389,7 +451,7 @@ void PoolConnInfo::on_connected(lcbio_SOCKET *sock_, lcb_STATUS err)
         lcbio_protoctx_add(sock, this);
 
         lcb_clist_append(&parent->ll_idle, this);
-        idle_timer.rearm(parent->parent->options.maxidle);
+        idle_timer.rearm(parent->parent->options.tmoidle);
         parent->connection_available();
     }
 }
@@ -439,7 +501,8 @@ void PoolRequest::timer_handler()
 }
 
 PoolHost::PoolHost(Pool *parent_, std::string key_)
-    : key(std::move(key_)), parent(parent_), async(parent->io, this), n_total(0), refcount(1)
+    : key(std::move(key_)), parent(parent_), async(parent->io, this), maintenance(parent->io, this), n_total(0),
+      refcount(1)
 {
 
     lcb_clist_init(&ll_idle);
@@ -448,6 +511,33 @@ PoolHost::PoolHost(Pool *parent_, std::string key_)
     parent->ref();
 }
 
+PoolHost *Pool::get_host(const std::string &key)
+{
+    auto m = ht.find(key);
+    if (m != ht.end()) {
+        return m->second;
+    }
+    auto *he = new PoolHost(this, key);
+    ht.insert(std::make_pair(key, he));
+    return he;
+}
+
+void Pool::set_min_idle(const std::map<std::string, unsigned> &min_idle, uint32_t timeout)
+{
+    min_idle_timeout = timeout;
+    for (auto &entry : ht) {
+        entry.second->min_idle = 0;
+    }
+    for (const auto &entry : min_idle) {
+        if (entry.second) {
+            get_host(entry.first)->min_idle = entry.second;
+        }
+    }
+    for (auto &entry : ht) {
+        entry.second->schedule_maintenance();
+    }
+}
+
 ConnectionRequest *Pool::get(const lcb_host_t &dest, uint32_t timeout, lcbio_CONNDONE_cb cb, void *cbarg)
 {
     PoolHost *he;
@@ -460,14 +550,7 @@ ConnectionRequest *Pool::get(const lcb_host_t &dest, uint32_t timeout, lcbio_CON
         key.append(dest.host).append(":").append(dest.port);
     }
 
-    auto m = ht.find(key);
-    if (m == ht.end()) {
-        he = new PoolHost(this, key);
-        ht.insert(std::make_pair(key, he));
-    } else {
-        he = m->second;
-    }
-
+    he = get_host(key);
     auto *req = new PoolRequest(he, cb, cbarg);
 
 GT_POPAGAIN:
@@ -492,12 +575,19 @@ GT_POPAGAIN:
         lcb_log(LOGARGS(this, DEBUG),
                 HE_LOGFMT "Found ready connection in pool. Reusing socket and not creating new connection",
                 HE_LOGID(he));
+        /* Replace it, if the host should have idle connections */
+        he->schedule_maintenance();
 
     } else {
         req->set_pending(timeout);
+        req->waited = true;
 
         lcb_clist_append(&he->requests, req);
-        if (he->num_pending() < he->num_requests()) {
+        if (he->at_limit()) {
+            lcb_log(LOGARGS(this, DEBUG), HE_LOGFMT "Not creating a new connection. Limit of %u reached",
+                    HE_LOGID(he), options.maxtotal);
+
+        } else if (he->num_pending() < he->num_requests()) {
             lcb_log(LOGARGS(this, DEBUG), HE_LOGFMT "Creating new connection because none are available in the pool",
                     HE_LOGID(he));
             he->start_new_connection(timeout);
@@ -528,6 +618,10 @@ void PoolRequest::cancel()
 
 void PoolConnInfo::on_idle_timeout()
 {
+    if (parent->num_idle() <= parent->min_idle) {
+        idle_timer.rearm(parent->parent->options.tmoidle);
+        return;
+    }
     lcb_log(LOGARGS(parent->parent, DEBUG), HE_LOGFMT "Idle connection expired", HE_LOGID(parent));
     lcbio_unref(sock)
 }
@@ -546,7 +640,7 @@ void Pool::put(lcbio_SOCKET *sock)
     he = info->parent;
     mgr = he->parent;
 
-    if (he->num_idle() >= mgr->options.maxidle) {
+    if (he->closed || he->num_idle() >= std::max(mgr->options.maxidle, he->min_idle)) {
         lcb_log(LOGARGS(mgr, INFO), HE_LOGFMT "Closing idle connection. Too many in quota", HE_LOGID(he));
         lcbio_unref(info->sock) return;
     }
@@ -556,6 +650,10 @@ void Pool::put(lcbio_SOCKET *sock)
     info->idle_timer.rearm(mgr->options.tmoidle);
     lcb_clist_append(&he->ll_idle, info);
     info->state = PoolConnInfo::IDLE;
+    if (he->num_requests()) {
+        /* Requests may be waiting because the host is at its limit */
+        he->async.signal();
+    }
 }
 
 void Pool::discard(lcbio_SOCKET *sock)
@@ -150,9 +150,9 @@ class Pool
     struct Options {
         Options() : maxtotal(0), maxidle(0), tmoidle(0) {}
 
-        /** Maximum *total* number of connections opened by the pool. If this
-         * number is exceeded, the pool will black hole future requests until
-         * a new slot becomes available.
+        /** Maximum number of connections opened by the pool to a single host.
+         * Once reached, requests for the host wait until a connection is
+         * released or closed. 0 means no limit.
          */
         unsigned maxtotal;
 
@@ -180,7 +180,29 @@ class Pool
 
     void toJSON(hrtime_t now, Json::Value &node);
 
+    /**
+     * Keep connections open to the given hosts, so that requests for them do
+     * not have to wait for a new connection.
+     * @param min_idle the number of idle connections to maintain for each
+     *  host (in `host:port` form). Hosts which are not in the map, or are
+     *  mapped to 0, no longer have connections opened for them in advance.
+     * @param timeout the connection timeout (in microseconds) for the
+     *  connections opened in advance, as no request supplies one for them
+     */
+    void set_min_idle(const std::map< std::string, unsigned > &min_idle, uint32_t timeout);
+
+    /**
+     * Record the time requests wait for a connection in the `http_pool_*`
+     * fields of the instance metrics, if they are enabled
+     */
+    void set_wait_metrics(bool enabled)
+    {
+        wait_metrics = enabled;
+    }
+
   private:
+    PoolHost *get_host(const std::string &key);
+
     friend struct PoolRequest;
     friend struct PoolConnInfo;
     friend struct PoolHost;
@@ -191,6 +213,8 @@ class Pool
     lcbio_pTABLE io;
     Options options;
     unsigned refcount;
+    uint32_t min_idle_timeout{0};
+    bool wait_metrics{false};
 };
 } // namespace io
 } // namespace lcb
@@ -0,0 +1,357 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "resolve.h"
+#include "connect.h"
+#include "settings.h"
+#include "timer-cxx.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace lcb::io;
+
+/* Bounds for polling a helper thread lookup from the event loop */
+#define RESOLVE_POLL_MIN LCB_MS2US(1)
+#define RESOLVE_POLL_MAX LCB_MS2US(32)
+
+/* Maximum number of hosts kept in the cache */
+#define DNS_CACHE_MAX 1024
+
+/**
+ * Copy an address list into storage owned by this module, alternating the
+ * address families. The family of the first address goes first, as that is
+ * the one the system resolver prefers.
+ */
+static addrinfo *copy_interleaved(const addrinfo *src)
+{
+    std::vector<const addrinfo *> preferred, other;
+    for (const addrinfo *cur = src; cur; cur = cur->ai_next) {
+        if (cur->ai_family == src->ai_family) {
+            preferred.push_back(cur);
+        } else {
+            other.push_back(cur);
+        }
+    }
+
+    addrinfo *head = nullptr, **tail = &head;
+    for (size_t ii = 0; ii < preferred.size() || ii < other.size(); ii++) {
+        const addrinfo *pick[2] = {ii < preferred.size() ? preferred[ii] : nullptr,
+                                   ii < other.size() ? other[ii] : nullptr};
+        for (const addrinfo *orig : pick) {
+            if (orig == nullptr) {
+                continue;
+            }
+            /* One allocation holds the entry and its address */
+            auto *ai = reinterpret_cast<addrinfo *>(calloc(1, sizeof(addrinfo) + orig->ai_addrlen));
+            ai->ai_flags = orig->ai_flags;
+            ai->ai_family = orig->ai_family;
+            ai->ai_socktype = orig->ai_socktype;
+            ai->ai_protocol = orig->ai_protocol;
+            ai->ai_addrlen = orig->ai_addrlen;
+            ai->ai_addr = reinterpret_cast<sockaddr *>(ai + 1);
+            memcpy(ai->ai_addr, orig->ai_addr, orig->ai_addrlen);
+            *tail = ai;
+            tail = &ai->ai_next;
+        }
+    }
+    return head;
+}
+
+void lcb::io::addrinfo_free(addrinfo *ai)
+{
+    while (ai) {
+        addrinfo *next = ai->ai_next;
+        free(ai);
+        ai = next;
+    }
+}
+
+namespace
+{
+struct CacheEntry {
+    addrinfo *ai{nullptr};
+    hrtime_t expires{0};
+};
+
+struct DnsCache {
+    std::mutex mutex;
+    std::map<std::string, CacheEntry> entries;
+
+    static std::string key(const char *host, const char *port, int family)
+    {
+        std::string k(host);
+        k.append(1, '\0').append(port).append(1, '\0').append(std::to_string(family));
+        return k;
+    }
+
+    void purge_expired(hrtime_t now)
+    {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->second.expires <= now) {
+                addrinfo_free(it->second.ai);
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+};
+
+DnsCache &dns_cache()
+{
+    /* Deliberately leaked so that lookups completing during process exit
+     * never race with its destruction */
+    static auto *cache = new DnsCache();
+    return *cache;
+}
+} // namespace
+
+addrinfo *lcb::io::dns_cache_get(const char *host, const char *port, int family)
+{
+    DnsCache &cache = dns_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.entries.find(DnsCache::key(host, port, family));
+    if (it == cache.entries.end()) {
+        return nullptr;
+    }
+    if (it->second.expires <= gethrtime()) {
+        addrinfo_free(it->second.ai);
+        cache.entries.erase(it);
+        return nullptr;
+    }
+    return copy_interleaved(it->second.ai);
+}
+
+void lcb::io::dns_cache_put(const char *host, const char *port, int family, const addrinfo *ai, uint32_t ttl)
+{
+    if (ai == nullptr || ttl == 0) {
+        return;
+    }
+
+    DnsCache &cache = dns_cache();
+    hrtime_t now = gethrtime();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (cache.entries.size() >= DNS_CACHE_MAX) {
+        cache.purge_expired(now);
+    }
+    if (cache.entries.size() >= DNS_CACHE_MAX) {
+        return;
+    }
+
+    CacheEntry &ent = cache.entries[DnsCache::key(host, port, family)];
+    addrinfo_free(ent.ai);
+    /* The list is already interleaved, so this only copies it */
+    ent.ai = copy_interleaved(ai);
+    ent.expires = now + LCB_US2NS(ttl);
+}
+
+void lcb::io::dns_cache_remove(const char *host, const char *port, int family)
+{
+    DnsCache &cache = dns_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.entries.find(DnsCache::key(host, port, family));
+    if (it != cache.entries.end()) {
+        addrinfo_free(it->second.ai);
+        cache.entries.erase(it);
+    }
+}
+
+void lcb::io::dns_cache_clear()
+{
+    DnsCache &cache = dns_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    for (auto &ent : cache.entries) {
+        addrinfo_free(ent.second.ai);
+    }
+    cache.entries.clear();
+}
+
+namespace lcb
+{
+namespace io
+{
+/**
+ * Result slot shared between a helper thread and the request which started
+ * it. The thread owns a reference so that a cancelled request can go away
+ * while the system resolver is still busy.
+ */
+struct ResolveSlot {
+    std::mutex mutex;
+    bool done{false};
+    bool cancelled{false};
+    int status{0};
+    addrinfo *ai{nullptr};
+};
+
+struct ResolveRequest {
+    ResolveRequest(lcbio_TABLE *iot_, resolve_callback callback_, void *arg_)
+        : iot(iot_), callback(callback_), arg(arg_), plugin_req(nullptr), poll_interval(RESOLVE_POLL_MIN),
+          timer(iot_, this)
+    {
+        lcbio_table_ref(iot);
+    }
+
+    ~ResolveRequest()
+    {
+        timer.release();
+        lcbio_table_unref(iot);
+    }
+
+    bool start_plugin(const char *host, const char *port, const addrinfo *hints);
+    void start_thread(const char *host, const char *port, const addrinfo *hints);
+    void poll();
+    void deliver(int status, addrinfo *ai);
+    void cancel();
+
+    lcbio_TABLE *iot;
+    resolve_callback callback;
+    void *arg;
+    void *plugin_req;
+    std::shared_ptr<ResolveSlot> slot;
+    uint32_t poll_interval;
+    Timer<ResolveRequest, &ResolveRequest::poll> timer;
+};
+} // namespace io
+} // namespace lcb
+
+static void plugin_resolved(void *arg, int status, addrinfo *res)
+{
+    auto *req = reinterpret_cast<ResolveRequest *>(arg);
+    req->plugin_req = nullptr;
+    if (status != 0) {
+        if (res) {
+            freeaddrinfo(res);
+        }
+        req->deliver(status, nullptr);
+        return;
+    }
+    addrinfo *ai = copy_interleaved(res);
+    freeaddrinfo(res);
+    req->deliver(0, ai);
+}
+
+bool ResolveRequest::start_plugin(const char *host, const char *port, const addrinfo *hints)
+{
+    if (iot->loop.resolve == nullptr || iot->loop.resolve_cancel == nullptr) {
+        return false;
+    }
+    plugin_req = iot->loop.resolve(IOT_ARG(iot), host, port, hints, plugin_resolved, this);
+    return plugin_req != nullptr;
+}
+
+void ResolveRequest::start_thread(const char *host, const char *port, const addrinfo *hints)
+{
+    slot = std::make_shared<ResolveSlot>();
+    std::shared_ptr<ResolveSlot> tslot = slot;
+    std::string thost(host), tport(port);
+    addrinfo thints = *hints;
+
+    auto lookup = [tslot, thost, tport, thints]() {
+        addrinfo *res = nullptr;
+        int rv = getaddrinfo(thost.c_str(), tport.c_str(), &thints, &res);
+        addrinfo *ai = nullptr;
+        if (rv == 0) {
+            ai = copy_interleaved(res);
+            freeaddrinfo(res);
+        }
+
+        std::lock_guard<std::mutex> lock(tslot->mutex);
+        if (tslot->cancelled) {
+            addrinfo_free(ai);
+            return;
+        }
+        tslot->status = rv;
+        tslot->ai = ai;
+        tslot->done = true;
+    };
+
+    try {
+        std::thread(lookup).detach();
+    } catch (const std::system_error &) {
+        /* Out of threads. Blocking is better than failing the connection */
+        lookup();
+    }
+
+    timer.rearm(poll_interval);
+}
+
+/**
+ * The I/O table has no way of waking the loop from another thread, so the
+ * result of a helper thread lookup is picked up by polling. The interval
+ * starts short, since most lookups are answered by a local cache, and backs
+ * off while the resolver is slow.
+ */
+void ResolveRequest::poll()
+{
+    int status;
+    addrinfo *ai;
+    {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        if (!slot->done) {
+            poll_interval = std::min<uint32_t>(poll_interval * 2, RESOLVE_POLL_MAX);
+            timer.rearm(poll_interval);
+            return;
+        }
+        status = slot->status;
+        ai = slot->ai;
+        slot->ai = nullptr;
+    }
+    deliver(status, ai);
+}
+
+void ResolveRequest::deliver(int status, addrinfo *ai)
+{
+    callback(arg, status, ai);
+    delete this;
+}
+
+void ResolveRequest::cancel()
+{
+    if (plugin_req) {
+        iot->loop.resolve_cancel(IOT_ARG(iot), plugin_req);
+        plugin_req = nullptr;
+    }
+    if (slot) {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        slot->cancelled = true;
+        addrinfo_free(slot->ai);
+        slot->ai = nullptr;
+    }
+    delete this;
+}
+
+ResolveRequest *lcb::io::resolve_start(lcbio_TABLE *iot, const char *host, const char *port, const addrinfo *hints,
+                                       resolve_callback callback, void *arg)
+{
+    auto *req = new ResolveRequest(iot, callback, arg);
+    if (!req->start_plugin(host, port, hints)) {
+        req->start_thread(host, port, hints);
+    }
+    return req;
+}
+
+void lcb::io::resolve_cancel(ResolveRequest *req)
+{
+    req->cancel();
+}
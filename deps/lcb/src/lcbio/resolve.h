@@ -0,0 +1,87 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#ifndef LCBIO_RESOLVE_H
+#define LCBIO_RESOLVE_H
+
+#include "config.h"
+#include "iotable.h"
+
+/**
+ * @file
+ * @brief Non-blocking host name resolution
+ *
+ * Lookups are handed to the I/O plugin when it provides
+ * lcb_loop_procs::resolve, and otherwise run on a helper thread whose result
+ * is collected from the event loop. Successful lookups are kept in a
+ * process-wide cache so that reconnecting to a known host does not need to
+ * wait for the resolver at all.
+ *
+ * Address lists returned by these functions are ordered so that the address
+ * families alternate (RFC 8305, section 4), which keeps a host with a broken
+ * IPv6 route from having to exhaust every IPv6 address before trying IPv4.
+ * They are owned by the caller and must be released with addrinfo_free().
+ */
+
+namespace lcb
+{
+namespace io
+{
+
+/**
+ * Invoked from the event loop with the result of a lookup.
+ * @param arg the argument passed to resolve_start()
+ * @param status 0 on success, or a `getaddrinfo()` error code
+ * @param ai the addresses (owned by the callee), or NULL on error
+ */
+typedef void (*resolve_callback)(void *arg, int status, addrinfo *ai);
+
+struct ResolveRequest;
+
+/**
+ * Start looking up `host`:`port`. The callback is always invoked
+ * asynchronously, and is not invoked at all if the request is cancelled
+ * first.
+ */
+ResolveRequest *resolve_start(lcbio_TABLE *iot, const char *host, const char *port, const addrinfo *hints,
+                              resolve_callback callback, void *arg);
+
+/** Cancel a pending lookup. Must not be called from within its callback */
+void resolve_cancel(ResolveRequest *req);
+
+/** Release an address list returned by this module */
+void addrinfo_free(addrinfo *ai);
+
+/**
+ * Return a copy of the cached addresses for `host`:`port` within `family`,
+ * or NULL if there is no entry or it has expired.
+ */
+addrinfo *dns_cache_get(const char *host, const char *port, int family);
+
+/** Remember `ai` as the addresses of `host`:`port` for `ttl` microseconds */
+void dns_cache_put(const char *host, const char *port, int family, const addrinfo *ai, uint32_t ttl);
+
+/** Forget the addresses of `host`:`port`, e.g. because none of them worked */
+void dns_cache_remove(const char *host, const char *port, int family);
+
+/** Forget every cached address */
+void dns_cache_clear();
+
+} // namespace io
+} // namespace lcb
+
+#endif
@@ -23,6 +23,7 @@ extern "C" {
 typedef struct {
     mc_PIPELINE *pl;
     hrtime_t now;
+    hrtime_t flushed;
 } mc__FLUSHINFO;
 
 /**
@@ -61,6 +62,9 @@ static nb_SIZE mcreq__pktflush_callback(void *p, nb_SIZE hint, void *arg)
 
     /** Packet is flushed */
     pkt->flags |= MCREQ_F_FLUSHED;
+    if (info->flushed) {
+        MCREQ_PKT_RDATA(pkt)->flushed = info->flushed;
+    }
 
     if (pkt->flags & MCREQ_F_INVOKED) {
         mcreq_packet_done(info->pl, pkt);
@@ -82,14 +86,17 @@ static nb_SIZE mcreq__pktflush_callback(void *p, nb_SIZE hint, void *arg)
  *
  * @param now if present, will reset the start time of each traversed packet
  *        to the value passed.
+ * @param flushed if present, is recorded as the time at which each packet
+ *        which was completely flushed left the library.
  *
  * This is a thin wrapper around netbuf_end_flush (and optionally
  * nebtuf_reset_flush())
  */
-static void mcreq_flush_done_ex(mc_PIPELINE *pl, unsigned nflushed, unsigned expected, lcb_U64 now)
+static void mcreq_flush_done_ex(mc_PIPELINE *pl, unsigned nflushed, unsigned expected, lcb_U64 now,
+                                lcb_U64 flushed)
 {
     if (nflushed) {
-        mc__FLUSHINFO info = {pl, now};
+        mc__FLUSHINFO info = {pl, now, flushed};
         netbuf_end_flush2(&pl->nbmgr, nflushed, mcreq__pktflush_callback, offsetof(mc_PACKET, sl_flushq), &info);
     }
     if (nflushed < expected) {
@@ -100,7 +107,7 @@ static void mcreq_flush_done_ex(mc_PIPELINE *pl, unsigned nflushed, unsigned exp
 /* Mainly for tests */
 static void mcreq_flush_done(mc_PIPELINE *pl, unsigned nflushed, unsigned expected)
 {
-    mcreq_flush_done_ex(pl, nflushed, expected, 0);
+    mcreq_flush_done_ex(pl, nflushed, expected, 0, 0);
 }
 
 #ifdef __cplusplus
@@ -319,6 +319,7 @@ mc_PACKET *mcreq_allocate_packet(mc_PIPELINE *pipeline)
     ret->opaque = pipeline->parent->seq++;
     ret->u_rdata.reqdata.span = NULL;
     ret->u_rdata.reqdata.deadline = 0;
+    ret->u_rdata.reqdata.flushed = 0;
     return ret;
 }
 
@@ -150,6 +150,11 @@ typedef struct mc_REQDATA {
      * Used for metrics/tracing. Might be zero, when tracing is not enabled.
      */
     hrtime_t dispatch;
+    /**
+     * Time when the packet has been completely written to the network.
+     * Only set when per-operation timings are enabled, otherwise zero.
+     */
+    hrtime_t flushed;
     lcbtrace_SPAN *span;
     uint32_t nsubreq; /* number of subrequests */
 } mc_REQDATA;
@@ -196,13 +201,18 @@ typedef struct mc_REQDATAEX {
      * Used for metrics/tracing. Might be zero, when tracing is not enabled.
      */
     hrtime_t dispatch;
+    /**
+     * Time when the packet has been completely written to the network.
+     * Only set when per-operation timings are enabled, otherwise zero.
+     */
+    hrtime_t flushed;
     lcbtrace_SPAN *span;
     uint32_t nsubreq;             /* number of subrequests */
     const mc_REQDATAPROCS *procs; /**< Common routines for the packet */
 
 #ifdef __cplusplus
     mc_REQDATAEX(void *cookie_, const mc_REQDATAPROCS &procs_, hrtime_t start_)
-        : cookie(cookie_), start(start_), dispatch(0), span(NULL), nsubreq(0), procs(&procs_)
+        : cookie(cookie_), start(start_), dispatch(0), flushed(0), span(NULL), nsubreq(0), procs(&procs_)
     {
         deadline = start_ + LCB_DEFAULT_TIMEOUT;
     }
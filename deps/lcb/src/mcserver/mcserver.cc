@@ -78,15 +78,17 @@ static void on_flush_ready(lcbio_CTX *ctx)
 static void on_flush_done(lcbio_CTX *ctx, unsigned expected, unsigned actual)
 {
     Server *server = Server::get(ctx);
-    lcb_U64 now = 0;
-    if (server->settings->readj_ts_wait) {
-        now = gethrtime();
+    lcb_U64 now = 0, flushed = 0;
+    if (server->settings->readj_ts_wait || server->settings->kv_op_timings) {
+        lcb_U64 ts = gethrtime();
+        now = server->settings->readj_ts_wait ? ts : 0;
+        flushed = server->settings->kv_op_timings ? ts : 0;
     }
 
 #ifdef LCB_DUMP_PACKETS
     lcb_log(LOGARGS(server, TRACE), LOGFMT "pkt,snd,flush: expected=%u, actual=%u", LOGID(server), expected, actual);
 #endif
-    mcreq_flush_done_ex(server, actual, expected, now);
+    mcreq_flush_done_ex(server, actual, expected, now, flushed);
     server->check_closed();
 }
 
@@ -491,6 +493,9 @@ Server::ReadState Server::try_read(lcbio_CTX *ctx, rdb_IOROPE *ior)
 
     pktsize += mcresp.bodylen();
     if (rdb_get_nused(ior) < pktsize) {
+        /* Have the rest of the body read straight into a buffer large enough
+         * for the whole packet, so it need not be copied together later */
+        rdb_reserve_contig(ior, pktsize);
         RETURN_NEED_MORE(pktsize);
     }
 
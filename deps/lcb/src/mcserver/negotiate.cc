@@ -435,7 +435,7 @@ bool SessionRequestImpl::send_hello()
     if (settings->fetch_mutation_tokens) {
         features[nfeatures++] = PROTOCOL_BINARY_FEATURE_MUTATION_SEQNO;
     }
-    if (settings->use_tracing) {
+    if (settings->use_tracing || settings->kv_op_timings) {
         features[nfeatures++] = PROTOCOL_BINARY_FEATURE_TRACING;
     }
     if (settings->use_collections) {
@@ -0,0 +1,543 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2021 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "query_body.hh"
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/* Same nesting limit as the jsoncpp reader */
+#define MAX_DEPTH 1000
+
+namespace
+{
+/**
+ * Validates JSON text, copying it to `out` without the whitespace between
+ * tokens. Strings are copied as they are, escapes included.
+ */
+class Compactor
+{
+  public:
+    Compactor(const char *begin, std::size_t len, std::string &out) : p_(begin), end_(begin + len), out_(out) {}
+
+    /** Copy a single value, which must be the only thing in the input */
+    bool value_only()
+    {
+        return value(0) && at_end();
+    }
+
+    /**
+     * Split an object into its members, copying each value into `members`
+     * under its decoded name. Later members replace earlier ones of the
+     * same name.
+     */
+    bool object_members(std::map<std::string, std::string> &members)
+    {
+        skip_ws();
+        if (!consume('{')) {
+            return false;
+        }
+        skip_ws();
+        if (consume('}')) {
+            return at_end();
+        }
+        std::string key, name;
+        do {
+            skip_ws();
+            key.clear();
+            if (!string_into(key) || !QueryBody::decode_string(key, name)) {
+                return false;
+            }
+            skip_ws();
+            if (!consume(':')) {
+                return false;
+            }
+            std::string &dst = members[name];
+            dst.clear();
+            if (!value_into(dst, 1)) {
+                return false;
+            }
+            skip_ws();
+        } while (consume(','));
+        return consume('}') && at_end();
+    }
+
+    /** Copy each element of an array into `elements` */
+    bool array_elements(std::vector<std::string> &elements)
+    {
+        skip_ws();
+        if (!consume('[')) {
+            return false;
+        }
+        skip_ws();
+        if (consume(']')) {
+            return at_end();
+        }
+        do {
+            elements.emplace_back();
+            if (!value_into(elements.back(), 1)) {
+                return false;
+            }
+            skip_ws();
+        } while (consume(','));
+        return consume(']') && at_end();
+    }
+
+  private:
+    bool value_into(std::string &dst, int depth)
+    {
+        Compactor inner(p_, end_ - p_, dst);
+        bool ok = inner.value(depth);
+        p_ = inner.p_;
+        return ok;
+    }
+
+    bool string_into(std::string &dst)
+    {
+        Compactor inner(p_, end_ - p_, dst);
+        bool ok = inner.string();
+        p_ = inner.p_;
+        return ok;
+    }
+
+    bool at_end()
+    {
+        skip_ws();
+        return p_ == end_;
+    }
+
+    void skip_ws()
+    {
+        while (p_ != end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) {
+            p_++;
+        }
+    }
+
+    bool consume(char c)
+    {
+        if (p_ != end_ && *p_ == c) {
+            p_++;
+            return true;
+        }
+        return false;
+    }
+
+    bool value(int depth)
+    {
+        if (depth > MAX_DEPTH) {
+            return false;
+        }
+        skip_ws();
+        if (p_ == end_) {
+            return false;
+        }
+        switch (*p_) {
+            case '{':
+                return container('{', '}', depth);
+            case '[':
+                return container('[', ']', depth);
+            case '"':
+                return string();
+            case 't':
+                return literal("true");
+            case 'f':
+                return literal("false");
+            case 'n':
+                return literal("null");
+            default:
+                return number();
+        }
+    }
+
+    bool container(char open, char close, int depth)
+    {
+        out_ += *p_++;
+        skip_ws();
+        if (consume(close)) {
+            out_ += close;
+            return true;
+        }
+        do {
+            if (open == '{') {
+                skip_ws();
+                if (p_ == end_ || *p_ != '"' || !string()) {
+                    return false;
+                }
+                skip_ws();
+                if (!consume(':')) {
+                    return false;
+                }
+                out_ += ':';
+            }
+            if (!value(depth + 1)) {
+                return false;
+            }
+            skip_ws();
+            if (p_ != end_ && *p_ == ',') {
+                out_ += *p_++;
+                continue;
+            }
+            break;
+        } while (true);
+        if (!consume(close)) {
+            return false;
+        }
+        out_ += close;
+        return true;
+    }
+
+    bool string()
+    {
+        const char *start = p_;
+        if (!consume('"')) {
+            return false;
+        }
+        while (p_ != end_) {
+            auto c = static_cast<unsigned char>(*p_++);
+            if (c == '"') {
+                out_.append(start, p_ - start);
+                return true;
+            }
+            if (c < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                continue;
+            }
+            if (p_ == end_) {
+                return false;
+            }
+            c = static_cast<unsigned char>(*p_++);
+            if (c == 'u') {
+                for (int ii = 0; ii < 4; ii++, p_++) {
+                    if (p_ == end_ || !isxdigit(static_cast<unsigned char>(*p_))) {
+                        return false;
+                    }
+                }
+            } else if (c == 0 || strchr("\"\\/bfnrt", c) == nullptr) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    bool literal(const char *lit)
+    {
+        std::size_t len = strlen(lit);
+        if (static_cast<std::size_t>(end_ - p_) < len || memcmp(p_, lit, len) != 0) {
+            return false;
+        }
+        out_.append(p_, len);
+        p_ += len;
+        return true;
+    }
+
+    bool digits()
+    {
+        const char *start = p_;
+        while (p_ != end_ && *p_ >= '0' && *p_ <= '9') {
+            p_++;
+        }
+        return p_ != start;
+    }
+
+    bool number()
+    {
+        const char *start = p_;
+        consume('-');
+        if (consume('0')) {
+            /* no leading zeros */
+        } else if (!digits()) {
+            return false;
+        }
+        if (consume('.') && !digits()) {
+            return false;
+        }
+        if (consume('e') || consume('E')) {
+            if (!consume('+')) {
+                consume('-');
+            }
+            if (!digits()) {
+                return false;
+            }
+        }
+        out_.append(start, p_ - start);
+        return true;
+    }
+
+    const char *p_;
+    const char *end_;
+    std::string &out_;
+};
+
+void append_utf8(std::string &out, unsigned cp)
+{
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+bool read_hex4(const char *&p, const char *end, unsigned &cp)
+{
+    if (end - p < 4) {
+        return false;
+    }
+    cp = 0;
+    for (int ii = 0; ii < 4; ii++, p++) {
+        char c = *p;
+        cp <<= 4;
+        if (c >= '0' && c <= '9') {
+            cp |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            cp |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            cp |= c - 'A' + 10;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+bool QueryBody::parse(const char *json, std::size_t json_len)
+{
+    std::map<std::string, std::string> members;
+    std::string unused;
+    if (!Compactor(json, json_len, unused).object_members(members)) {
+        return false;
+    }
+    members_.swap(members);
+    return true;
+}
+
+bool QueryBody::set(const std::string &name, const char *value, std::size_t value_len)
+{
+    std::string encoded;
+    if (!Compactor(value, value_len, encoded).value_only()) {
+        return false;
+    }
+    members_[name].swap(encoded);
+    return true;
+}
+
+void QueryBody::set_string(const std::string &name, const std::string &value)
+{
+    std::string &encoded = members_[name];
+    encoded.clear();
+    append_quoted(encoded, value.c_str(), value.size());
+}
+
+bool QueryBody::append(const std::string &name, const char *value, std::size_t value_len)
+{
+    std::string encoded;
+    if (!Compactor(value, value_len, encoded).value_only()) {
+        return false;
+    }
+    auto it = members_.find(name);
+    if (it == members_.end()) {
+        members_[name] = "[" + encoded + "]";
+        return true;
+    }
+    std::string &array = it->second;
+    if (array.empty() || array[0] != '[') {
+        return false;
+    }
+    /* Stored values are compact, so the array ends with its bracket */
+    array.pop_back();
+    if (array.size() > 1) {
+        array += ',';
+    }
+    array += encoded;
+    array += ']';
+    return true;
+}
+
+void QueryBody::write(std::string &out, const char *skip, const std::string &extra) const
+{
+    std::size_t size = 2 + extra.size();
+    for (const auto &member : members_) {
+        size += member.first.size() + member.second.size() + 4;
+    }
+    out.reserve(out.size() + size);
+
+    bool first = true;
+    out += '{';
+    for (const auto &member : members_) {
+        if (skip != nullptr && member.first == skip) {
+            continue;
+        }
+        if (!first) {
+            out += ',';
+        }
+        first = false;
+        append_quoted(out, member.first.c_str(), member.first.size());
+        out += ':';
+        out += member.second;
+    }
+    if (!extra.empty()) {
+        if (!first) {
+            out += ',';
+        }
+        out += extra;
+    }
+    out += '}';
+}
+
+bool QueryBody::split_array(const std::string &encoded, std::vector<std::string> &elements)
+{
+    std::string unused;
+    elements.clear();
+    return Compactor(encoded.c_str(), encoded.size(), unused).array_elements(elements);
+}
+
+bool QueryBody::decode_uint(const std::string &encoded, std::uint64_t &value)
+{
+    if (encoded.empty()) {
+        return false;
+    }
+    value = 0;
+    for (char c : encoded) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+    return true;
+}
+
+bool QueryBody::decode_string(const std::string &encoded, std::string &value)
+{
+    if (encoded.size() < 2 || encoded.front() != '"' || encoded.back() != '"') {
+        return false;
+    }
+    value.clear();
+    const char *p = encoded.c_str() + 1;
+    const char *end = encoded.c_str() + encoded.size() - 1;
+    while (p != end) {
+        char c = *p++;
+        if (c != '\\') {
+            value += c;
+            continue;
+        }
+        if (p == end) {
+            return false;
+        }
+        switch (c = *p++) {
+            case 'b':
+                value += '\b';
+                break;
+            case 'f':
+                value += '\f';
+                break;
+            case 'n':
+                value += '\n';
+                break;
+            case 'r':
+                value += '\r';
+                break;
+            case 't':
+                value += '\t';
+                break;
+            case 'u': {
+                unsigned cp;
+                if (!read_hex4(p, end, cp)) {
+                    return false;
+                }
+                if (cp >= 0xD800 && cp < 0xDC00) {
+                    /* High surrogate, which must be followed by a low one */
+                    unsigned low;
+                    if (end - p < 6 || p[0] != '\\' || p[1] != 'u') {
+                        return false;
+                    }
+                    p += 2;
+                    if (!read_hex4(p, end, low) || low < 0xDC00 || low >= 0xE000) {
+                        return false;
+                    }
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                append_utf8(value, cp);
+                break;
+            }
+            default:
+                value += c;
+                break;
+        }
+    }
+    return true;
+}
+
+void QueryBody::append_quoted(std::string &out, const char *value, std::size_t value_len)
+{
+    out.reserve(out.size() + value_len + 2);
+    out += '"';
+    const char *run = value;
+    const char *end = value + value_len;
+    for (const char *p = value; p != end; p++) {
+        auto c = static_cast<unsigned char>(*p);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(run, p - run);
+        run = p + 1;
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\b':
+                out += "\\b";
+                break;
+            case '\f':
+                out += "\\f";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default: {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+                break;
+            }
+        }
+    }
+    out.append(run, end - run);
+    out += '"';
+}
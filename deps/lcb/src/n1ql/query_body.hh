@@ -0,0 +1,132 @@
+/* -*- Mode: C; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2021 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#ifndef LIBCOUCHBASE_N1QL_QUERY_BODY_HH
+#define LIBCOUCHBASE_N1QL_QUERY_BODY_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @private
+ *
+ * Body of a query request, kept as its top-level members with their values
+ * already encoded as JSON.
+ *
+ * Values supplied by the application (parameters, raw options, or a whole
+ * payload) are validated and stripped of whitespace in a single pass, but are
+ * never decoded into a document tree, and write() assembles the request by
+ * appending the encoded members to the output. Members are written in name
+ * order, which makes the output the same as that of Json::FastWriter.
+ *
+ * The metadata of query responses is read the same way, so that only the
+ * members the library needs are ever decoded.
+ */
+class QueryBody
+{
+  public:
+    /**
+     * Replace the body with the members of an encoded JSON object
+     * @return false if `json` is not a valid JSON object
+     */
+    bool parse(const char *json, std::size_t json_len);
+
+    /**
+     * Set a member to an encoded JSON value
+     * @return false if `value` is not valid JSON
+     */
+    bool set(const std::string &name, const char *value, std::size_t value_len);
+
+    /** Set a member to an encoded JSON value which is known to be valid */
+    void set_encoded(const std::string &name, std::string value)
+    {
+        members_[name] = std::move(value);
+    }
+
+    void set_string(const std::string &name, const std::string &value);
+
+    void set_bool(const std::string &name, bool value)
+    {
+        members_[name] = value ? "true" : "false";
+    }
+
+    /**
+     * Append an encoded JSON value to an array member, creating the array if
+     * the member does not exist yet
+     * @return false if `value` is not valid JSON, or the member is not an
+     *  array
+     */
+    bool append(const std::string &name, const char *value, std::size_t value_len);
+
+    void remove(const std::string &name)
+    {
+        members_.erase(name);
+    }
+
+    /** @return the encoded value of a member, or nullptr if it is not set */
+    const std::string *get(const std::string &name) const
+    {
+        auto it = members_.find(name);
+        return it == members_.end() ? nullptr : &it->second;
+    }
+
+    bool empty() const
+    {
+        return members_.empty();
+    }
+
+    void clear()
+    {
+        members_.clear();
+    }
+
+    /**
+     * Append the request to `out`
+     * @param skip name of a member to leave out, or nullptr
+     * @param extra encoded members (`"name":value,...`) to add at the end
+     */
+    void write(std::string &out, const char *skip = nullptr, const std::string &extra = std::string()) const;
+
+    /**
+     * Decode an encoded JSON string
+     * @return false if `encoded` is not a string
+     */
+    static bool decode_string(const std::string &encoded, std::string &value);
+
+    /**
+     * Split an encoded JSON array into its encoded elements
+     * @return false if `encoded` is not a valid JSON array
+     */
+    static bool split_array(const std::string &encoded, std::vector<std::string> &elements);
+
+    /**
+     * Decode an encoded JSON number which is a non-negative integer
+     * @return false if `encoded` is not such a number
+     */
+    static bool decode_uint(const std::string &encoded, std::uint64_t &value);
+
+    /** Append `value` to `out` as a JSON string */
+    static void append_quoted(std::string &out, const char *value, std::size_t value_len);
+
+  private:
+    std::map<std::string, std::string> members_;
+};
+
+#endif // LIBCOUCHBASE_N1QL_QUERY_BODY_HH
@@ -26,6 +26,7 @@
 #include <list>
 
 #include "contrib/lcb-jsoncpp/lcb-jsoncpp.h"
+#include "query_body.hh"
 
 class Plan
 {
@@ -37,26 +38,15 @@ class Plan
 
   public:
     /**
-     * Applies the plan to the output 'bodystr'. We don't assign the
-     * Json::Value directly, as this appears to be horribly slow. On my system
-     * an assignment took about 200ms!
-     * @param body The request body (e.g. lcb_QUERY_HANDLE_::json)
+     * Applies the plan to the output 'bodystr'. The statement is replaced
+     * by the name (and possibly the encoded plan) of the prepared statement.
+     * @param body The request body (e.g. lcb_QUERY_HANDLE_::body_)
      * @param[out] bodystr the actual request payload
      */
-    void apply_plan(Json::Value &body, std::string &bodystr) const
+    void apply_plan(const QueryBody &body, std::string &bodystr) const
     {
-        body.removeMember("statement");
-        bodystr = Json::FastWriter().write(body);
-
-        // Assume bodystr ends with '}'
-        size_t pos = bodystr.rfind('}');
-        bodystr.erase(pos);
-
-        if (!body.empty()) {
-            bodystr.append(",");
-        }
-        bodystr.append(planstr);
-        bodystr.append("}");
+        bodystr.clear();
+        body.write(bodystr, "statement", planstr);
     }
 
   private:
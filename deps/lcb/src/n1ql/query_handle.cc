@@ -93,92 +93,91 @@ static void prepare_rowcb(lcb_INSTANCE *instance, int, const lcb_RESPQUERY *row)
     }
 }
 
-bool lcb_QUERY_HANDLE_::parse_meta(const char *row, size_t row_len, lcb_STATUS &rc)
+bool lcb_QUERY_HANDLE_::parse_meta(lcb_STATUS &rc)
 {
+    if (!meta_parsed_) {
+        lcb_IOV buf;
+        parser_->get_postmortem(buf);
+        meta_ = lcb_QUERY_META();
+        meta_valid_ = meta_.parse(static_cast<const char *>(buf.iov_base), buf.iov_len);
+        meta_parsed_ = true;
+    }
     first_error_message.clear();
     first_error_code = 0;
-
-    Json::Value meta;
-    if (!Json::Reader().parse(row, row + row_len, meta)) {
+    if (!meta_valid_) {
         return false;
     }
-    const Json::Value &errors = meta["errors"];
-    if (errors.isArray() && !errors.empty()) {
-        const Json::Value &err = errors[0];
-        const Json::Value &msg = err["msg"];
-        if (msg.isString()) {
-            first_error_message = msg.asString();
-        }
-        const Json::Value &code = err["code"];
-        if (code.isNumeric()) {
-            first_error_code = code.asUInt();
-            switch (first_error_code) {
-                case 3000:
-                    rc = LCB_ERR_PARSING_FAILURE;
-                    break;
-                case 12009:
-                    rc = LCB_ERR_DML_FAILURE;
-                    if (first_error_message.find("CAS mismatch") != std::string::npos) {
-                        rc = LCB_ERR_CAS_MISMATCH;
+
+    if (!meta_.errors.empty()) {
+        const lcb_QUERY_META::Message &err = meta_.errors[0];
+        first_error_message = err.message;
+        first_error_code = err.code;
+        switch (first_error_code) {
+            case 3000:
+                rc = LCB_ERR_PARSING_FAILURE;
+                break;
+            case 12009:
+                rc = LCB_ERR_DML_FAILURE;
+                if (first_error_message.find("CAS mismatch") != std::string::npos) {
+                    rc = LCB_ERR_CAS_MISMATCH;
+                }
+                break;
+            case 4040:
+            case 4050:
+            case 4060:
+            case 4070:
+            case 4080:
+            case 4090:
+                rc = LCB_ERR_PREPARED_STATEMENT_FAILURE;
+                break;
+            case 4300:
+                rc = LCB_ERR_PLANNING_FAILURE;
+                if (!first_error_message.empty()) {
+                    std::regex already_exists("index.+already exists");
+                    if (std::regex_search(first_error_message, already_exists)) {
+                        rc = LCB_ERR_INDEX_EXISTS;
                     }
-                    break;
-                case 4040:
-                case 4050:
-                case 4060:
-                case 4070:
-                case 4080:
-                case 4090:
-                    rc = LCB_ERR_PREPARED_STATEMENT_FAILURE;
-                    break;
-                case 4300:
-                    rc = LCB_ERR_PLANNING_FAILURE;
-                    if (!first_error_message.empty()) {
-                        std::regex already_exists("index.+already exists");
-                        if (std::regex_search(first_error_message, already_exists)) {
-                            rc = LCB_ERR_INDEX_EXISTS;
+                }
+                break;
+            case 5000:
+                rc = LCB_ERR_INTERNAL_SERVER_FAILURE;
+                if (!first_error_message.empty()) {
+                    std::regex already_exists("Index.+already exists"); /* NOTE: case sensitive */
+                    if (std::regex_search(first_error_message, already_exists)) {
+                        rc = LCB_ERR_INDEX_EXISTS;
+                    } else {
+                        std::regex not_found("index.+not found");
+                        if (std::regex_search(first_error_message, not_found)) {
+                            rc = LCB_ERR_INDEX_NOT_FOUND;
                         }
                     }
-                    break;
-                case 5000:
+                }
+                break;
+            case 12004:
+            case 12016:
+                rc = LCB_ERR_INDEX_NOT_FOUND;
+                break;
+            case 12003:
+                rc = LCB_ERR_KEYSPACE_NOT_FOUND;
+                break;
+            case 12021:
+                rc = LCB_ERR_SCOPE_NOT_FOUND;
+                break;
+            case 13014:
+                rc = LCB_ERR_AUTHENTICATION_FAILURE;
+                break;
+            default:
+                if (first_error_code >= 4000 && first_error_code < 5000) {
+                    rc = LCB_ERR_PLANNING_FAILURE;
+                } else if (first_error_code >= 5000 && first_error_code < 6000) {
                     rc = LCB_ERR_INTERNAL_SERVER_FAILURE;
-                    if (!first_error_message.empty()) {
-                        std::regex already_exists("Index.+already exists"); /* NOTE: case sensitive */
-                        if (std::regex_search(first_error_message, already_exists)) {
-                            rc = LCB_ERR_INDEX_EXISTS;
-                        } else {
-                            std::regex not_found("index.+not found");
-                            if (std::regex_search(first_error_message, not_found)) {
-                                rc = LCB_ERR_INDEX_NOT_FOUND;
-                            }
-                        }
-                    }
-                    break;
-                case 12004:
-                case 12016:
-                    rc = LCB_ERR_INDEX_NOT_FOUND;
-                    break;
-                case 12003:
-                    rc = LCB_ERR_KEYSPACE_NOT_FOUND;
-                    break;
-                case 12021:
-                    rc = LCB_ERR_SCOPE_NOT_FOUND;
-                    break;
-                case 13014:
+                } else if (first_error_code >= 10000 && first_error_code < 11000) {
                     rc = LCB_ERR_AUTHENTICATION_FAILURE;
-                    break;
-                default:
-                    if (first_error_code >= 4000 && first_error_code < 5000) {
-                        rc = LCB_ERR_PLANNING_FAILURE;
-                    } else if (first_error_code >= 5000 && first_error_code < 6000) {
-                        rc = LCB_ERR_INTERNAL_SERVER_FAILURE;
-                    } else if (first_error_code >= 10000 && first_error_code < 11000) {
-                        rc = LCB_ERR_AUTHENTICATION_FAILURE;
-                    } else if ((first_error_code >= 12000 && first_error_code < 13000) ||
-                               (first_error_code >= 14000 && first_error_code < 15000)) {
-                        rc = LCB_ERR_INDEX_FAILURE;
-                    }
-                    break;
-            }
+                } else if ((first_error_code >= 12000 && first_error_code < 13000) ||
+                           (first_error_code >= 14000 && first_error_code < 15000)) {
+                    rc = LCB_ERR_INDEX_FAILURE;
+                }
+                break;
         }
     }
     return true;
@@ -207,7 +206,9 @@ void lcb_QUERY_HANDLE_::invoke_row(lcb_RESPQUERY *resp, bool is_last)
         parser_->get_postmortem(meta_buf);
         resp->row = static_cast<const char *>(meta_buf.iov_base);
         resp->nrow = meta_buf.iov_len;
-        parse_meta(resp->row, resp->nrow, resp->ctx.rc);
+        if (parse_meta(resp->ctx.rc)) {
+            resp->meta = &meta_;
+        }
         if (!first_error_message.empty()) {
             resp->ctx.first_error_message = first_error_message.c_str();
             resp->ctx.first_error_message_len = first_error_message.size();
@@ -294,8 +295,6 @@ lcbauth_RESULT lcb_QUERY_HANDLE_::request_credentials(lcbauth_REASON reason)
 bool lcb_QUERY_HANDLE_::maybe_retry()
 {
     // Examines the buffer to determine the type of error
-    lcb_IOV meta;
-
     if (callback_ == nullptr) {
         // Cancelled
         return false;
@@ -307,8 +306,7 @@ bool lcb_QUERY_HANDLE_::maybe_retry()
     }
 
     lcb_STATUS rc = last_error_;
-    parser_->get_postmortem(meta);
-    if (!parse_meta(static_cast<const char *>(meta.iov_base), meta.iov_len, rc)) {
+    if (!parse_meta(rc)) {
         return false; // Not JSON
     }
 
@@ -333,8 +331,7 @@ bool lcb_QUERY_HANDLE_::maybe_retry()
 
     if (last_error_ == LCB_SUCCESS) {
         // We'll be parsing more rows later on..
-        delete parser_;
-        parser_ = new lcb::jsparse::Parser(lcb::jsparse::Parser::MODE_N1QL, this);
+        reset_parser();
         return true;
     }
 
@@ -432,16 +429,17 @@ lcb_STATUS lcb_QUERY_HANDLE_::issue_htreq(const std::string &body)
 
 lcb_STATUS lcb_QUERY_HANDLE_::request_plan()
 {
-    Json::Value newbody(Json::objectValue);
-    newbody["statement"] = "PREPARE " + statement_;
-    if (json.isMember("query_context") && json["query_context"].isString()) {
-        newbody["query_context"] = json["query_context"];
+    QueryBody newbody;
+    newbody.set_string("statement", "PREPARE " + statement_);
+    const std::string *query_context = body_.get("query_context");
+    if (query_context != nullptr && (*query_context)[0] == '"') {
+        newbody.set_encoded("query_context", *query_context);
     }
     lcb_CMDQUERY newcmd;
     newcmd.callback(prepare_rowcb);
     newcmd.store_handle_refence_to(&prepare_query_);
     newcmd.use_multi_bucket_authentication(use_multi_bucket_authentication_);
-    newcmd.root(newbody);
+    newcmd.body(newbody);
 
     return lcb_query(instance_, this, &newcmd);
 }
@@ -450,7 +448,7 @@ lcb_STATUS lcb_QUERY_HANDLE_::apply_plan(const Plan &plan)
 {
     lcb_log(LOGARGS(this, DEBUG), LOGFMT "Using prepared plan", LOGID(this));
     std::string bodystr;
-    plan.apply_plan(json, bodystr);
+    plan.apply_plan(body_, bodystr);
     return issue_htreq(bodystr);
 }
 
@@ -460,17 +458,9 @@ lcb_QUERY_HANDLE_::lcb_QUERY_HANDLE_(lcb_INSTANCE *obj, void *user_cookie, const
       use_multi_bucket_authentication_(cmd->use_multi_bucket_authentication()),
       timeout_timer_(instance_->iotable, this), backoff_timer_(instance_->iotable, this)
 {
-    if (cmd->is_query_json()) {
-        json = cmd->root();
-    } else {
-        std::string encoded = Json::FastWriter().write(cmd->root());
-        if (!Json::Reader().parse(encoded, json)) {
-            last_error_ = LCB_ERR_INVALID_ARGUMENT;
-            return;
-        }
-    }
+    body_ = cmd->body();
     if (cmd->has_explicit_scope_qualifier()) {
-        json["query_context"] = cmd->scope_qualifier();
+        body_.set_string("query_context", cmd->scope_qualifier());
     } else if (cmd->has_scope()) {
         if (obj->settings->conntype != LCB_TYPE_BUCKET || obj->settings->bucket == nullptr) {
             lcb_log(LOGARGS(this, ERROR),
@@ -482,27 +472,25 @@ lcb_QUERY_HANDLE_::lcb_QUERY_HANDLE_(lcb_INSTANCE *obj, void *user_cookie, const
         }
         std::string scope_qualifier(obj->settings->bucket);
         scope_qualifier += "." + cmd->scope();
-        json["query_context"] = scope_qualifier;
+        body_.set_string("query_context", scope_qualifier);
     }
 
-    const Json::Value &j_statement = json_const()["statement"];
-    if (j_statement.isString()) {
-        statement_ = j_statement.asString();
-    } else if (!j_statement.isNull()) {
+    const std::string *j_statement = body_.get("statement");
+    if (j_statement != nullptr && *j_statement != "null" && !QueryBody::decode_string(*j_statement, statement_)) {
         last_error_ = LCB_ERR_INVALID_ARGUMENT;
         return;
     }
 
     timeout = cmd->timeout_or_default_in_microseconds(LCBT_SETTING(obj, n1ql_timeout));
-    Json::Value &tmoval = json["timeout"];
-    if (tmoval.isNull()) {
+    const std::string *tmoval = body_.get("timeout");
+    std::string tmostr;
+    if (tmoval == nullptr || *tmoval == "null") {
         char buf[64] = {0};
         sprintf(buf, "%uus", timeout);
-        tmoval = buf;
-        json["timeout"] = buf;
-    } else if (tmoval.isString()) {
+        body_.set_string("timeout", buf);
+    } else if (QueryBody::decode_string(*tmoval, tmostr)) {
         try {
-            auto tmo_ns = lcb_parse_golang_duration(tmoval.asString());
+            auto tmo_ns = lcb_parse_golang_duration(tmostr);
             timeout = std::chrono::duration_cast<std::chrono::microseconds>(tmo_ns).count();
         } catch (const lcb_duration_parse_error &) {
             last_error_ = LCB_ERR_INVALID_ARGUMENT;
@@ -513,16 +501,17 @@ lcb_QUERY_HANDLE_::lcb_QUERY_HANDLE_(lcb_INSTANCE *obj, void *user_cookie, const
         last_error_ = LCB_ERR_INVALID_ARGUMENT;
         return;
     }
-    const Json::Value &ccid = json["client_context_id"];
-    if (ccid.isNull()) {
+    const std::string *ccid = body_.get("client_context_id");
+    if (ccid == nullptr || *ccid == "null") {
         char buf[32];
         size_t nbuf = snprintf(buf, sizeof(buf), "%016" PRIx64, lcb_next_rand64());
         client_context_id.assign(buf, nbuf);
-        json["client_context_id"] = client_context_id;
-    } else {
-        client_context_id = ccid.asString();
+        body_.set_string("client_context_id", client_context_id);
+    } else if (!QueryBody::decode_string(*ccid, client_context_id)) {
+        client_context_id = *ccid;
     }
-    if (json.isMember("readonly") && json["readonly"].asBool()) {
+    const std::string *readonly = body_.get("readonly");
+    if (readonly != nullptr && *readonly == "true") {
         idempotent_ = true;
     }
     timeout_timer_.rearm(timeout + LCBT_SETTING(obj, n1ql_grace_period));
@@ -534,19 +523,23 @@ lcb_QUERY_HANDLE_::lcb_QUERY_HANDLE_(lcb_INSTANCE *obj, void *user_cookie, const
     const lcb::Authenticator &auth = *instance_->settings->auth;
     if (auth.buckets().size() > 1 && cmd->use_multi_bucket_authentication()) {
         use_multi_bucket_authentication_ = true;
-        Json::Value &creds = json["creds"];
-        auto ii = auth.buckets().begin();
-        if (!(creds.isNull() || creds.isArray())) {
+        const std::string *creds = body_.get("creds");
+        if (creds != nullptr && *creds == "null") {
+            body_.remove("creds");
+        } else if (creds != nullptr && (*creds)[0] != '[') {
             last_error_ = LCB_ERR_INVALID_ARGUMENT;
             return;
         }
-        for (; ii != auth.buckets().end(); ++ii) {
+        for (auto ii = auth.buckets().begin(); ii != auth.buckets().end(); ++ii) {
             if (ii->second.empty()) {
                 continue;
             }
-            Json::Value &curCreds = creds.append(Json::Value(Json::objectValue));
-            curCreds["user"] = ii->first;
-            curCreds["pass"] = ii->second;
+            std::string cur_creds("{\"user\":");
+            QueryBody::append_quoted(cur_creds, ii->first.c_str(), ii->first.size());
+            cur_creds += ",\"pass\":";
+            QueryBody::append_quoted(cur_creds, ii->second.c_str(), ii->second.size());
+            cur_creds += '}';
+            body_.append("creds", cur_creds.c_str(), cur_creds.size());
         }
     }
     if (cmd->want_impersonation()) {
@@ -604,12 +597,18 @@ void lcb_QUERY_HANDLE_::fail_prepared(const lcb_RESPQUERY *orig, lcb_STATUS err)
     }
     delete this;
 }
+void lcb_QUERY_HANDLE_::reset_parser()
+{
+    delete parser_;
+    parser_ = new lcb::jsparse::Parser(lcb::jsparse::Parser::MODE_N1QL, this);
+    meta_parsed_ = false;
+}
+
 void lcb_QUERY_HANDLE_::on_backoff()
 {
     lcb_aspend_del(&instance_->pendops, LCB_PENDTYPE_COUNTER, nullptr);
     backoff_timer_.cancel();
-    delete parser_;
-    parser_ = new lcb::jsparse::Parser(lcb::jsparse::Parser::MODE_N1QL, this);
+    reset_parser();
     if (use_prepcache()) {
         const Plan *cached = cache().get_entry(statement_);
         if (cached != nullptr) {
@@ -78,11 +78,6 @@ struct lcb_QUERY_HANDLE_ : lcb::jsparse::Parser::Actions {
         }
     }
 
-    const Json::Value &json_const() const
-    {
-        return json;
-    }
-
     lcb_QUERY_CACHE &cache() const
     {
         return *instance_->n1ql_cache;
@@ -90,7 +85,7 @@ struct lcb_QUERY_HANDLE_ : lcb::jsparse::Parser::Actions {
 
     /**
      * Creates the sub-lcb_QUERY_HANDLE_ for the PREPARE statement. This inspects the
-     * current request (see ::json) and copies it so that we execute the
+     * current request (see ::body_) and copies it so that we execute the
      * PREPARE instead of the actual query.
      * @return see issue_htreq()
      */
@@ -112,7 +107,8 @@ struct lcb_QUERY_HANDLE_ : lcb::jsparse::Parser::Actions {
 
     lcb_STATUS issue_htreq()
     {
-        std::string s = Json::FastWriter().write(json);
+        std::string s;
+        body_.write(s);
         return issue_htreq(s);
     }
 
@@ -156,7 +152,13 @@ struct lcb_QUERY_HANDLE_ : lcb::jsparse::Parser::Actions {
      */
     void invoke_row(lcb_RESPQUERY *resp, bool is_last);
 
-    bool parse_meta(const char *row, size_t row_len, lcb_STATUS &rc);
+    /**
+     * Parse the metadata left over by the row parser, unless it has been
+     * parsed already, and map its first error to a status code
+     * @param rc set to the status for the first error, if there is one
+     * @return false if the metadata is not a JSON object
+     */
+    bool parse_meta(lcb_STATUS &rc);
 
     /**
      * Fail an application-level query because the prepared statement failed
@@ -248,6 +250,8 @@ struct lcb_QUERY_HANDLE_ : lcb::jsparse::Parser::Actions {
 
   private:
     void on_backoff();
+    /** Replace the row parser before the request is issued again */
+    void reset_parser();
 
     const lcb_RESPHTTP *http_response_{nullptr};
     lcb_HTTP_HANDLE *http_request_{nullptr};
@@ -266,12 +270,16 @@ struct lcb_QUERY_HANDLE_ : lcb::jsparse::Parser::Actions {
     struct lcb_QUERY_HANDLE_ *prepare_query_{nullptr};
 
     /** Request body as received from the application */
-    Json::Value json;
-    /** String of the original statement. Cached here to avoid jsoncpp lookups */
+    QueryBody body_;
+    /** String of the original statement, decoded from the body */
     std::string statement_;
     std::string client_context_id;
     std::string first_error_message{};
     uint32_t first_error_code{};
+    /** Metadata of the current response, valid once meta_parsed_ is set */
+    lcb_QUERY_META meta_{};
+    bool meta_parsed_{false};
+    bool meta_valid_{false};
 
     /** Whether we're retrying this */
     int retries_{0};
@@ -28,6 +28,9 @@
 
 #include "netbuf.h"
 #include "sllist-inl.h"
+#ifndef NETBUF_LIBC_PROXY
+#include "slab/slab.h"
+#endif
 
 #include <libcouchbase/assert.h>
 
@@ -41,6 +44,20 @@
 
 #define BLOCK_IS_EMPTY(block) ((block)->start == (block)->cursor)
 
+/* Block buffers come from the shared buffer pool, except when proxying to libc */
+#ifdef NETBUF_LIBC_PROXY
+#define BLOCK_ALLOC(size) malloc(size)
+#define BLOCK_FREE(root, size) free(root)
+#else
+static char *block_alloc(nb_SIZE size)
+{
+    size_t capacity;
+    return lcb_slab_alloc(size, &capacity);
+}
+#define BLOCK_ALLOC(size) block_alloc(size)
+#define BLOCK_FREE(root, size) lcb_slab_free(root, size)
+#endif
+
 #define FIRST_BLOCK(pool) (SLLIST_ITEM(SLLIST_FIRST(&(pool)->active), nb_MBLOCK, slnode))
 
 #define LAST_BLOCK(mgr) (SLLIST_ITEM((mgr)->active_blocks.last, nb_BLOCKHDR, slnode))
@@ -103,7 +120,7 @@ static nb_MBLOCK *alloc_new_block(nb_MBPOOL *pool, nb_SIZE capacity)
 
     ret->wrap = 0;
     ret->cursor = 0;
-    ret->root = malloc(ret->nalloc);
+    ret->root = BLOCK_ALLOC(ret->nalloc);
 
     if (!ret->root) {
         if (mblock_is_standalone(ret)) {
@@ -427,7 +444,7 @@ static int mblock_get_next_size(const nb_MBPOOL *pool, int allow_wrap)
 static void mblock_wipe_block(nb_MBLOCK *block)
 {
     if (block->root) {
-        free(block->root);
+        BLOCK_FREE(block->root, block->nalloc);
     }
     if (block->deallocs) {
         sllist_iterator dea_iter;
@@ -20,6 +20,8 @@
 #include "bucketconfig/clconfig.h"
 #include "vbucket/aliases.h"
 #include "sllist-inl.h"
+#include <algorithm>
+#include <map>
 
 #define LOGARGS(instance, lvl) (instance)->settings, "newconfig", LCB_LOG_##lvl, __FILE__, __LINE__
 #define LOG(instance, lvlbase, msg) lcb_log(instance->settings, "newconfig", LCB_LOG_##lvlbase, __FILE__, __LINE__, msg)
@@ -149,6 +151,15 @@ static int find_new_data_index(lcbvb_CONFIG *oldconfig, lcbvb_CONFIG *newconfig,
         return -1;
     }
 
+    /* Most updates leave the node at the same position */
+    int oldix = server->get_index();
+    if (oldix > -1 && (size_t)oldix < LCBVB_NSERVERS(newconfig)) {
+        const char *new_datahost = lcbvb_get_hostport(newconfig, oldix, LCBVB_SVCTYPE_DATA, mode);
+        if (new_datahost && strcmp(new_datahost, old_datahost) == 0) {
+            return oldix;
+        }
+    }
+
     for (size_t ii = 0; ii < LCBVB_NSERVERS(newconfig); ii++) {
         const char *new_datahost = lcbvb_get_hostport(newconfig, ii, LCBVB_SVCTYPE_DATA, mode);
         if (new_datahost && strcmp(new_datahost, old_datahost) == 0) {
@@ -158,6 +169,53 @@ static int find_new_data_index(lcbvb_CONFIG *oldconfig, lcbvb_CONFIG *newconfig,
     return -1;
 }
 
+/**
+ * Checks whether every node in the old config is present at the same index,
+ * and with the same addresses, in the new config. If so the existing
+ * pipelines (and their sockets and queued packets) remain valid as they are,
+ * and only the map beneath them needs to be swapped.
+ */
+static bool is_same_topology(lcb_INSTANCE *instance, lcbvb_CONFIG *oldconfig, lcbvb_CONFIG *newconfig)
+{
+    lcbvb_SVCMODE mode = LCBT_SETTING_SVCMODE(instance);
+    const lcbvb_SVCTYPE types[] = {LCBVB_SVCTYPE_DATA, LCBVB_SVCTYPE_MGMT};
+
+    if (LCBVB_NSERVERS(oldconfig) != LCBVB_NSERVERS(newconfig) ||
+        LCBVB_DISTTYPE(oldconfig) != LCBVB_DISTTYPE(newconfig)) {
+        return false;
+    }
+
+    for (size_t ii = 0; ii < LCBVB_NSERVERS(newconfig); ii++) {
+        if (strcmp(oldconfig->servers[ii].authority, newconfig->servers[ii].authority) != 0) {
+            return false;
+        }
+        for (auto type : types) {
+            const char *oldhost = lcbvb_get_hostport(oldconfig, ii, type, mode);
+            const char *newhost = lcbvb_get_hostport(newconfig, ii, type, mode);
+            if ((oldhost == nullptr) != (newhost == nullptr) || (oldhost && strcmp(oldhost, newhost) != 0)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** Counts the vBuckets whose master has moved */
+static unsigned count_vb_changes(lcbvb_CONFIG *oldconfig, lcbvb_CONFIG *newconfig)
+{
+    if (oldconfig->nvb != newconfig->nvb) {
+        return newconfig->nvb;
+    }
+
+    unsigned nchanged = 0;
+    for (unsigned ii = 0; ii < newconfig->nvb; ii++) {
+        if (oldconfig->vbuckets[ii].servers[0] != newconfig->vbuckets[ii].servers[0]) {
+            nchanged++;
+        }
+    }
+    return nchanged;
+}
+
 static void log_vbdiff(lcb_INSTANCE *instance, lcbvb_CONFIGDIFF *diff)
 {
     lcb_log(LOGARGS(instance, INFO), "Config Diff: [ vBuckets Modified=%d ], [Sequence Changed=%d]", diff->n_vb_changes,
@@ -308,6 +366,73 @@ static void replace_config(lcb_INSTANCE *instance, lcbvb_CONFIG *oldconfig, lcbv
     free(ppold);
 }
 
+/**
+ * Applies a config whose node list is unchanged. The pipelines stay in place
+ * with their connections and queues; packets already queued for a vBucket
+ * which has moved are redirected by the NOT_MY_VBUCKET handling as usual.
+ */
+static void swap_config(lcb_INSTANCE *instance, lcbvb_CONFIG *newconfig)
+{
+    mc_CMDQUEUE *cq = &instance->cmdq;
+
+    lcb_assert(LCBT_VBCONFIG(instance) == newconfig);
+    cq->config = newconfig;
+
+    for (unsigned ii = 0; ii < cq->npipelines; ii++) {
+        auto *server = static_cast<lcb::Server *>(cq->pipelines[ii]);
+        if (server->has_pending()) {
+            server->flush_start(server);
+        }
+    }
+}
+
+/** Update the list of nodes here for server list */
+static void update_http_nodes(lcb_INSTANCE *instance, lcbvb_CONFIG *config)
+{
+    instance->ht_nodes->clear();
+    for (size_t ii = 0; ii < LCBVB_NSERVERS(config); ++ii) {
+        const char *hp = lcbvb_get_hostport(config, ii, LCBVB_SVCTYPE_MGMT, LCBT_SETTING_SVCMODE(instance));
+        if (hp) {
+            instance->ht_nodes->add(hp, LCB_CONFIG_HTTP_PORT);
+        }
+    }
+}
+
+/** Tell the HTTP pool how many idle connections to keep to each service node */
+static void update_http_pools(lcb_INSTANCE *instance, lcbvb_CONFIG *config)
+{
+    const struct {
+        lcbvb_SVCTYPE svc;
+        unsigned min_idle;
+    } services[] = {{LCBVB_SVCTYPE_QUERY, LCBT_SETTING(instance, query_min_idle)},
+                    {LCBVB_SVCTYPE_SEARCH, LCBT_SETTING(instance, search_min_idle)},
+                    {LCBVB_SVCTYPE_ANALYTICS, LCBT_SETTING(instance, analytics_min_idle)}};
+
+    std::map<std::string, unsigned> min_idle;
+    for (const auto &service : services) {
+        if (service.min_idle == 0) {
+            continue;
+        }
+        for (size_t ii = 0; ii < LCBVB_NSERVERS(config); ++ii) {
+            const char *hp = lcbvb_get_hostport(config, ii, service.svc, LCBT_SETTING_SVCMODE(instance));
+            if (hp) {
+                unsigned &cur = min_idle[hp];
+                cur = std::max(cur, service.min_idle);
+            }
+        }
+    }
+    /* Connections opened in advance get the timeout HTTP requests use unless
+     * they ask for their own */
+    instance->http_sockpool->set_min_idle(min_idle, LCBT_SETTING(instance, http_timeout));
+}
+
+void lcb_update_http_pools(lcb_INSTANCE *instance)
+{
+    if (LCBT_VBCONFIG(instance)) {
+        update_http_pools(instance, LCBT_VBCONFIG(instance));
+    }
+}
+
 void lcb_update_vbconfig(lcb_INSTANCE *instance, lcb_pCONFIGINFO config)
 {
     lcb::clconfig::ConfigInfo *old_config = instance->cur_configinfo;
@@ -319,18 +444,46 @@ void lcb_update_vbconfig(lcb_INSTANCE *instance, lcb_pCONFIGINFO config)
     q->cqdata = instance;
 
     if (old_config) {
-        lcbvb_CONFIGDIFF *diff = lcbvb_compare(old_config->vbc, config->vbc);
+        hrtime_t start = gethrtime();
+        unsigned nvb_changes = count_vb_changes(old_config->vbc, config->vbc);
+        bool incremental = is_same_topology(instance, old_config->vbc, config->vbc);
 
-        if (diff) {
-            log_vbdiff(instance, diff);
-            lcbvb_free_diff(diff);
+        if (incremental) {
+            lcb_log(LOGARGS(instance, INFO), "Config Diff: [ vBuckets Modified=%u ], [Sequence Changed=0]",
+                    nvb_changes);
+        } else {
+            lcbvb_CONFIGDIFF *diff = lcbvb_compare(old_config->vbc, config->vbc);
+            if (diff) {
+                log_vbdiff(instance, diff);
+                lcbvb_free_diff(diff);
+            }
         }
 
         /* Apply the vb guesses */
         lcb_vbguess_newconfig(instance, config->vbc, instance->vbguess);
 
-        replace_config(instance, old_config->vbc, config->vbc);
+        if (incremental) {
+            swap_config(instance, config->vbc);
+        } else {
+            replace_config(instance, old_config->vbc, config->vbc);
+            update_http_nodes(instance, config->vbc);
+            update_http_pools(instance, config->vbc);
+        }
+        instance->retryq->config_changed(old_config->vbc, config->vbc);
         old_config->decref();
+
+        uint64_t elapsed = LCB_NS2US(gethrtime() - start);
+        lcb_log(LOGARGS(instance, DEBUG), "Applied new config in %" PRIu64 "us (%s)", elapsed,
+                incremental ? "incremental" : "pipelines rebuilt");
+
+        lcb_METRICS *metrics = LCBT_SETTING(instance, metrics);
+        if (metrics) {
+            metrics->config_updates++;
+            metrics->config_updates_incremental += incremental ? 1 : 0;
+            metrics->config_vb_changes += nvb_changes;
+            metrics->config_apply_us += elapsed;
+            metrics->config_apply_last_us = elapsed;
+        }
     } else {
         size_t nservers = VB_NSERVERS(config->vbc);
         std::vector<mc_PIPELINE *> servers;
@@ -340,15 +493,8 @@ void lcb_update_vbconfig(lcb_INSTANCE *instance, lcb_pCONFIGINFO config)
         }
 
         mcreq_queue_add_pipelines(q, &servers[0], nservers, config->vbc);
-    }
-
-    /* Update the list of nodes here for server list */
-    instance->ht_nodes->clear();
-    for (size_t ii = 0; ii < LCBVB_NSERVERS(config->vbc); ++ii) {
-        const char *hp = lcbvb_get_hostport(config->vbc, ii, LCBVB_SVCTYPE_MGMT, LCBT_SETTING_SVCMODE(instance));
-        if (hp) {
-            instance->ht_nodes->add(hp, LCB_CONFIG_HTTP_PORT);
-        }
+        update_http_nodes(instance, config->vbc);
+        update_http_pools(instance, config->vbc);
     }
 
     lcb_maybe_breakout(instance);
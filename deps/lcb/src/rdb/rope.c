@@ -228,6 +228,40 @@ void rdb_consolidate(rdb_IOROPE *ior, unsigned nr)
     rope_consolidate(&ior->recvd, nr);
 }
 
+void rdb_reserve_contig(rdb_IOROPE *ior, unsigned n)
+{
+    rdb_ROPEBUF *rope = &ior->recvd;
+    rdb_ROPESEG *seg, *newseg;
+    lcb_list_t *llcur, *llnext;
+    unsigned nr = n;
+
+    seg = RDB_SEG_FIRST(rope);
+    if (seg == NULL || seg->nused + RDB_SEG_SPACE(seg) >= n) {
+        return;
+    }
+
+    /* Only what has been received so far is copied, which is at most a
+     * single read's worth rather than the whole packet */
+    newseg = ROPE_SALLOC(rope, n);
+    LCB_LIST_SAFE_FOR(llcur, llnext, &rope->segments)
+    {
+        unsigned to_copy;
+        seg = LCB_LIST_ITEM(llcur, rdb_ROPESEG, llnode);
+        to_copy = MINIMUM(nr, seg->nused);
+
+        memcpy(RDB_SEG_WBUF(newseg), RDB_SEG_RBUF(seg), to_copy);
+        newseg->nused += to_copy;
+
+        seg_consumed(rope, seg, to_copy);
+        if (!(nr -= to_copy)) {
+            break;
+        }
+    }
+
+    lcb_list_prepend(&rope->segments, &newseg->llnode);
+    rope->nused += newseg->nused;
+}
+
 void rdb_copyread(rdb_IOROPE *ior, void *tgt, unsigned n)
 {
     lcb_list_t *ll;
@@ -167,6 +167,7 @@ enum rdb_ALLOCID {
     RDB_ALLOCATOR_BIGALLOC = 1,
     RDB_ALLOCATOR_CHUNKED,
     RDB_ALLOCATOR_LIBCALLOC,
+    RDB_ALLOCATOR_SLAB,
 
     /** use constants higher than this for your own allocator(s) */
     RDB_ALLOCATOR_MAX
@@ -312,6 +313,20 @@ void rdb_consolidate(rdb_IOROPE *ior, unsigned n);
  */
 char *rdb_get_consolidated(rdb_IOROPE *ior, unsigned n);
 
+/**
+ * Ensure that the first n bytes of the rope will be contiguous once they have
+ * been read, even though fewer than n bytes may have been received so far.
+ *
+ * If the first segment cannot hold n bytes, the data received so far is moved
+ * into a new segment of exactly n bytes. Subsequent reads fill this segment
+ * first, so a large packet arrives in a single buffer and rdb_consolidate()
+ * becomes a no-op for it.
+ *
+ * @param ior the IOROPE structure
+ * @param n number of bytes which must be contiguous
+ */
+void rdb_reserve_contig(rdb_IOROPE *ior, unsigned n);
+
 /**
  * @}
  */
@@ -438,6 +453,13 @@ rdb_ALLOCATOR *rdb_chunkalloc_new(unsigned chunksize);
 LCB_INTERNAL_API
 rdb_ALLOCATOR *rdb_libcalloc_new(void);
 
+/**
+ * Returns the allocator backed by the process-wide buffer pool (see slab.h).
+ * Like the libc allocator, it is a shared singleton.
+ */
+LCB_INTERNAL_API
+rdb_ALLOCATOR *rdb_slaballoc_new(void);
+
 /**
  * Dump information about the iorope structure to a file
  * @param ior The rope structure to dump
@@ -0,0 +1,111 @@
+/* -*- Mode: C; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/**
+ * This allocator takes segment buffers from the process-wide slab pool, so
+ * that a buffer released by one connection can be reused by any other.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "rope.h"
+#include "list.h"
+#include "slab/slab.h"
+
+static rdb_ROPESEG *seg_alloc(rdb_pALLOCATOR alloc, unsigned size)
+{
+    size_t capacity;
+    rdb_ROPESEG *ret = calloc(1, sizeof(*ret));
+    ret->root = lcb_slab_alloc(size, &capacity);
+    ret->nalloc = (unsigned)capacity;
+    ret->shflags = RDB_ROPESEG_F_LIB;
+    ret->allocator = alloc;
+    ret->allocid = RDB_ALLOCATOR_SLAB;
+    return ret;
+}
+
+static rdb_ROPESEG *seg_realloc(rdb_pALLOCATOR alloc, rdb_ROPESEG *seg, unsigned size)
+{
+    size_t capacity;
+    char *root;
+
+    if (size <= seg->nalloc) {
+        return seg;
+    }
+    root = lcb_slab_alloc(size, &capacity);
+    memcpy(root, seg->root, seg->nalloc);
+    lcb_slab_free(seg->root, seg->nalloc);
+    seg->root = root;
+    seg->nalloc = (unsigned)capacity;
+
+    (void)alloc;
+    return seg;
+}
+
+static void seg_free(rdb_pALLOCATOR alloc, rdb_ROPESEG *seg)
+{
+    (void)alloc;
+    lcb_slab_free(seg->root, seg->nalloc);
+    free(seg);
+}
+
+static void buf_reserve(rdb_pALLOCATOR alloc, rdb_ROPEBUF *buf, unsigned cap)
+{
+    rdb_ROPESEG *newseg, *lastseg;
+    unsigned to_alloc;
+    lastseg = RDB_SEG_LAST(buf);
+    if (lastseg && RDB_SEG_SPACE(lastseg) + buf->nused >= cap) {
+        return;
+    }
+
+    to_alloc = cap;
+    if (lastseg) {
+        to_alloc -= lastseg->nalloc - lastseg->start;
+    }
+    newseg = alloc->s_alloc(alloc, to_alloc);
+    lcb_list_append(&buf->segments, &newseg->llnode);
+}
+
+static void release_noop(rdb_pALLOCATOR alloc)
+{
+    (void)alloc;
+}
+
+static void dump_stats(rdb_pALLOCATOR alloc, FILE *fp)
+{
+    static const char *indent = "  ";
+    lcb_BUFFER_POOL_STATS stats;
+    size_t pool_limit, thread_limit;
+
+    lcb_slab_get_stats(&stats);
+    lcb_slab_get_limits(&pool_limit, &thread_limit);
+    fprintf(fp, "SLABALLOC @%p\n", (void *)alloc);
+    fprintf(fp, "%sPoolLimit: %lu\n", indent, (unsigned long int)pool_limit);
+    fprintf(fp, "%sThreadLimit: %lu\n", indent, (unsigned long int)thread_limit);
+    fprintf(fp, "%sBytesPooled: %llu\n", indent, (unsigned long long)stats.bytes_pooled);
+    fprintf(fp, "%sAllocations: %llu\n", indent, (unsigned long long)stats.allocations);
+    fprintf(fp, "%sHits: %llu\n", indent, (unsigned long long)stats.hits);
+    fprintf(fp, "%sBytesReleased: %llu\n", indent, (unsigned long long)stats.bytes_released);
+}
+
+static rdb_ALLOCATOR slaballoc = {buf_reserve, seg_alloc, seg_realloc, seg_free, release_noop, dump_stats};
+
+rdb_ALLOCATOR *rdb_slaballoc_new(void)
+{
+    return &slaballoc;
+}
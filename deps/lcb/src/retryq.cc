@@ -28,12 +28,13 @@
 #define RETRY_PKT_KEY "retry_queue"
 
 using namespace lcb;
-struct SchedNode : lcb_list_t {
-};
-struct TmoNode : lcb_list_t {
+
+#define NOT_QUEUED ((size_t)-1)
+
+struct ParkNode : lcb_list_t {
 };
 
-struct lcb::RetryOp : mc_EPKTDATUM, SchedNode, TmoNode {
+struct lcb::RetryOp : mc_EPKTDATUM, ParkNode {
     /**Cache the actual start time of the command. Since the start time may
      * change if read_ts_wait is enabled, and we don't want to end up looping
      * on a command forever. */
@@ -44,6 +45,10 @@ struct lcb::RetryOp : mc_EPKTDATUM, SchedNode, TmoNode {
     lcb_STATUS origerr;
     protocol_binary_response_status origstatus;
     errmap::RetrySpec *spec;
+    uint64_t seqno;  /**< Position in insertion order, breaks ties between equal keys */
+    size_t sched_ix; /**< Index in RetryQueue::schedops, or NOT_QUEUED */
+    size_t tmo_ix;   /**< Index in RetryQueue::tmoops, or NOT_QUEUED */
+    int park_vbid;   /**< vBucket under which the op is parked, or -1 */
     explicit RetryOp(errmap::RetrySpec *spec);
     ~RetryOp()
     {
@@ -53,25 +58,106 @@ struct lcb::RetryOp : mc_EPKTDATUM, SchedNode, TmoNode {
     }
 };
 
-static RetryOp *from_schednode(lcb_list_t *ll)
-{
-    return static_cast<RetryOp *>(static_cast<SchedNode *>(ll));
-}
-static RetryOp *from_tmonode(lcb_list_t *ll)
+static RetryOp *from_parknode(lcb_list_t *ll)
 {
-    return static_cast<RetryOp *>(static_cast<TmoNode *>(ll));
+    return static_cast< RetryOp * >(static_cast< ParkNode * >(ll));
 }
-template <typename T>
-int list_cmp(const T &a, const T &b)
-{
-    if (a == b) {
-        return 0;
-    } else if (a > b) {
-        return 1;
-    } else {
-        return -1;
+
+/**
+ * Binary min-heap over one of the time fields of RetryOp. Each operation keeps
+ * its own position in the heap so that it can be removed in O(log n) once it
+ * is retried or failed.
+ */
+template < hrtime_t RetryOp::*Key, size_t RetryOp::*Index >
+struct RetryHeap {
+    typedef std::vector< RetryOp * > Heap;
+
+    static bool less(const RetryOp *a, const RetryOp *b)
+    {
+        if (a->*Key != b->*Key) {
+            return a->*Key < b->*Key;
+        }
+        return a->seqno < b->seqno;
     }
-}
+
+    static void place(Heap &heap, size_t ix, RetryOp *op)
+    {
+        heap[ix] = op;
+        op->*Index = ix;
+    }
+
+    static void sift_up(Heap &heap, size_t ix)
+    {
+        RetryOp *op = heap[ix];
+        while (ix > 0) {
+            size_t parent = (ix - 1) / 2;
+            if (!less(op, heap[parent])) {
+                break;
+            }
+            place(heap, ix, heap[parent]);
+            ix = parent;
+        }
+        place(heap, ix, op);
+    }
+
+    static void sift_down(Heap &heap, size_t ix)
+    {
+        RetryOp *op = heap[ix];
+        size_t n = heap.size();
+        for (;;) {
+            size_t child = ix * 2 + 1;
+            if (child >= n) {
+                break;
+            }
+            if (child + 1 < n && less(heap[child + 1], heap[child])) {
+                child++;
+            }
+            if (!less(heap[child], op)) {
+                break;
+            }
+            place(heap, ix, heap[child]);
+            ix = child;
+        }
+        place(heap, ix, op);
+    }
+
+    static void push(Heap &heap, RetryOp *op)
+    {
+        heap.push_back(op);
+        sift_up(heap, heap.size() - 1);
+    }
+
+    static void remove(Heap &heap, RetryOp *op)
+    {
+        size_t ix = op->*Index;
+        if (ix == NOT_QUEUED) {
+            return;
+        }
+        op->*Index = NOT_QUEUED;
+        RetryOp *last = heap.back();
+        heap.pop_back();
+        if (last == op) {
+            return;
+        }
+        place(heap, ix, last);
+        if (ix > 0 && less(last, heap[(ix - 1) / 2])) {
+            sift_up(heap, ix);
+        } else {
+            sift_down(heap, ix);
+        }
+    }
+
+    /** Restore the heap property after the keys were changed in place */
+    static void rebuild(Heap &heap)
+    {
+        for (size_t ix = heap.size() / 2; ix-- > 0;) {
+            sift_down(heap, ix);
+        }
+    }
+};
+
+typedef RetryHeap< &RetryOp::trytime, &RetryOp::sched_ix > SchedHeap;
+typedef RetryHeap< &RetryOp::deadline, &RetryOp::tmo_ix > TmoHeap;
 
 hrtime_t RetryQueue::get_retry_interval() const
 {
@@ -110,17 +196,6 @@ void RetryQueue::update_trytime(RetryOp *op, hrtime_t now)
     }
 }
 
-/** Comparison routine for sorting by timeout */
-static int cmpfn_tmo(lcb_list_t *ll_a, lcb_list_t *ll_b)
-{
-    return list_cmp(from_tmonode(ll_a)->deadline, from_tmonode(ll_b)->deadline);
-}
-
-static int cmpfn_retry(lcb_list_t *ll_a, lcb_list_t *ll_b)
-{
-    return list_cmp(from_schednode(ll_a)->trytime, from_schednode(ll_b)->trytime);
-}
-
 static void assign_error(RetryOp *op, lcb_STATUS err)
 {
     if (err == LCB_ERR_NOT_MY_VBUCKET) {
@@ -143,10 +218,53 @@ static void assign_error(RetryOp *op, lcb_STATUS err)
     op->origerr = err;
 }
 
+void RetryQueue::park(RetryOp *op, int vbid)
+{
+    lcb_clist_t &bucket = parked[vbid];
+    if (LCB_CLIST_SIZE(&bucket) == 0) {
+        lcb_clist_init(&bucket);
+    }
+    lcb_clist_append(&bucket, static_cast< ParkNode * >(op));
+    op->park_vbid = vbid;
+}
+
+void RetryQueue::unpark(RetryOp *op)
+{
+    if (op->park_vbid < 0) {
+        return;
+    }
+    auto it = parked.find(op->park_vbid);
+    lcb_clist_delete(&it->second, static_cast< ParkNode * >(op));
+    if (LCB_CLIST_SIZE(&it->second) == 0) {
+        parked.erase(it);
+    }
+    op->park_vbid = -1;
+}
+
 void RetryQueue::erase(RetryOp *op)
 {
-    lcb_list_delete(static_cast<SchedNode *>(op));
-    lcb_list_delete(static_cast<TmoNode *>(op));
+    unpark(op);
+    SchedHeap::remove(schedops, op);
+    TmoHeap::remove(tmoops, op);
+    if (settings->metrics) {
+        settings->metrics->retry_queue_depth = schedops.size();
+    }
+}
+
+void RetryQueue::insert(RetryOp *op)
+{
+    /* An operation is queued at most once */
+    erase(op);
+    op->seqno = seqno++;
+    SchedHeap::push(schedops, op);
+    TmoHeap::push(tmoops, op);
+    if (settings->metrics) {
+        lcb_METRICS *metrics = settings->metrics;
+        metrics->retry_queue_depth = schedops.size();
+        if (metrics->retry_queue_depth > metrics->retry_queue_max_depth) {
+            metrics->retry_queue_max_depth = metrics->retry_queue_depth;
+        }
+    }
 }
 
 void RetryQueue::fail(RetryOp *op, lcb_STATUS err, hrtime_t now)
@@ -190,8 +308,8 @@ void RetryQueue::schedule(hrtime_t now)
     }
 
     /** Figure out which is first */
-    RetryOp *first_tmo = from_tmonode(LCB_LIST_HEAD(&tmoops));
-    RetryOp *first_sched = from_schednode(LCB_LIST_HEAD(&schedops));
+    RetryOp *first_tmo = tmoops.front();
+    RetryOp *first_sched = schedops.front();
 
     hrtime_t schednext = first_sched->trytime;
     hrtime_t tmonext = first_tmo->deadline;
@@ -219,33 +337,20 @@ void RetryQueue::schedule(hrtime_t now)
 void RetryQueue::flush(bool throttle)
 {
     hrtime_t now = gethrtime();
-    lcb_list_t *ll, *ll_next;
-    lcb_list_t resched_next;
+    std::vector< RetryOp * > resched_next;
+    std::vector< bool > flush_pipelines(cq->npipelines);
 
     /** Check timeouts first */
-    LCB_LIST_SAFE_FOR(ll, ll_next, &tmoops)
-    {
-        RetryOp *op = from_tmonode(ll);
-        hrtime_t curtmo = op->deadline;
-
-        if (curtmo <= now) {
-            fail(op, LCB_ERR_TIMEOUT, now);
-        } else {
-            break;
-        }
+    while (!tmoops.empty() && tmoops.front()->deadline <= now) {
+        fail(tmoops.front(), LCB_ERR_TIMEOUT, now);
     }
 
-    lcb_list_init(&resched_next);
-    LCB_LIST_SAFE_FOR(ll, ll_next, &schedops)
-    {
+    while (!schedops.empty()) {
         protocol_binary_request_header hdr;
         int vbid, srvix;
-        hrtime_t curnext;
-
-        RetryOp *op = from_schednode(ll);
-        curnext = op->trytime - TIMEFUZZ_NS;
 
-        if (curnext > now && throttle) {
+        RetryOp *op = schedops.front();
+        if (throttle && op->trytime - TIMEFUZZ_NS > now) {
             break;
         }
 
@@ -263,10 +368,8 @@ void RetryQueue::flush(bool throttle)
              */
             get_instance()->bootstrap(lcb::BS_REFRESH_THROTTLE);
             if (get_instance()->confmon->is_refreshing() || settings->retry[LCB_RETRY_ON_MISSINGNODE]) {
-
-                lcb_list_delete(static_cast<SchedNode *>(op));
-                lcb_list_delete(static_cast<TmoNode *>(op));
-                lcb_list_append(&resched_next, static_cast<SchedNode *>(op));
+                erase(op);
+                resched_next.push_back(op);
                 op->pkt->retries++;
                 update_trytime(op, now);
             } else {
@@ -279,18 +382,24 @@ void RetryQueue::flush(bool throttle)
                     "us, deadline_in=%" PRIu64 "us",
                     (void *)op->pkt, op->pkt->retries, cid, op->pkt->opaque, srvix, LCB_NS2US(now - op->start),
                     LCB_NS2US(op->deadline - now));
-            mc_PIPELINE *newpl = cq->pipelines[srvix];
-            mcreq_enqueue_packet(newpl, op->pkt);
-            newpl->flush_start(newpl);
+            mcreq_enqueue_packet(cq->pipelines[srvix], op->pkt);
+            if ((unsigned)srvix < flush_pipelines.size()) {
+                flush_pipelines[srvix] = true;
+            }
             erase(op);
         }
     }
 
-    LCB_LIST_SAFE_FOR(ll, ll_next, &resched_next)
-    {
-        RetryOp *op = from_schednode(ll);
-        lcb_list_add_sorted(&schedops, static_cast<SchedNode *>(op), cmpfn_retry);
-        lcb_list_add_sorted(&tmoops, static_cast<TmoNode *>(op), cmpfn_tmo);
+    /* Start a single flush per pipeline for everything enqueued above */
+    for (size_t ii = 0; ii < flush_pipelines.size() && ii < cq->npipelines; ii++) {
+        if (flush_pipelines[ii]) {
+            mc_PIPELINE *pl = cq->pipelines[ii];
+            pl->flush_start(pl);
+        }
+    }
+
+    for (auto op : resched_next) {
+        insert(op);
     }
 
     schedule(now);
@@ -318,7 +427,8 @@ static void op_dtorfn(mc_EPKTDATUM *d)
 
 RetryOp::RetryOp(errmap::RetrySpec *spec_)
     : mc_EPKTDATUM(), start(0), deadline(0), trytime(0), pkt(nullptr), origerr(LCB_SUCCESS),
-      origstatus(PROTOCOL_BINARY_RESPONSE_SUCCESS), spec(spec_)
+      origstatus(PROTOCOL_BINARY_RESPONSE_SUCCESS), spec(spec_), seqno(0), sched_ix(NOT_QUEUED), tmo_ix(NOT_QUEUED),
+      park_vbid(-1)
 {
     mc_EPKTDATUM::dtorfn = op_dtorfn;
     mc_EPKTDATUM::key = RETRY_PKT_KEY;
@@ -419,8 +529,7 @@ void RetryQueue::add(mc_EXPACKET *pkt, const lcb_STATUS err, protocol_binary_res
         update_trytime(op);
     }
 
-    lcb_list_add_sorted(&schedops, static_cast<SchedNode *>(op), cmpfn_retry);
-    lcb_list_add_sorted(&tmoops, static_cast<TmoNode *>(op), cmpfn_tmo);
+    insert(op);
 
     uint32_t cid = mcreq_get_cid(get_instance(), &pkt->base);
     lcb_log(LOGARGS(this, DEBUG),
@@ -437,16 +546,12 @@ void RetryQueue::add(mc_EXPACKET *pkt, const lcb_STATUS err, protocol_binary_res
 
 bool RetryQueue::empty(bool ignore_cfgreq) const
 {
-    bool is_empty = LCB_LIST_IS_EMPTY(&schedops);
-    if (is_empty) {
+    if (schedops.empty()) {
         return true;
     }
     if (ignore_cfgreq) {
-        lcb_list_t *ll, *llnext;
-        LCB_LIST_SAFE_FOR(ll, llnext, &schedops)
-        {
+        for (auto op : schedops) {
             protocol_binary_request_header hdr = {};
-            RetryOp *op = from_schednode(ll);
             mcreq_read_hdr(op->pkt, &hdr);
             if (hdr.request.opcode != PROTOCOL_BINARY_CMD_GET_CLUSTER_CONFIG &&
                 hdr.request.opcode != PROTOCOL_BINARY_CMD_SELECT_BUCKET) {
@@ -465,6 +570,95 @@ void RetryQueue::nmvadd(mc_EXPACKET *detchpkt)
         flags = RETRY_SCHED_IMM;
     }
     add(detchpkt, LCB_ERR_NOT_MY_VBUCKET, PROTOCOL_BINARY_RESPONSE_NOT_MY_VBUCKET, nullptr, flags);
+
+    mc_EPKTDATUM *d = mcreq_epkt_find(detchpkt, RETRY_PKT_KEY);
+    if (d && LCBVB_DISTTYPE(cq->config) == LCBVB_DIST_VBUCKET) {
+        protocol_binary_request_header hdr;
+        mcreq_read_hdr(&detchpkt->base, &hdr);
+        park(static_cast< RetryOp * >(d), ntohs(hdr.request.vbucket));
+    }
+}
+
+static const char *vbmaster_authority(lcbvb_CONFIG *config, int vbid)
+{
+    int ix = lcbvb_vbmaster(config, vbid);
+    if (ix < 0 || (unsigned)ix >= LCBVB_NSERVERS(config)) {
+        return nullptr;
+    }
+    return LCBVB_GET_SERVER(config, ix)->authority;
+}
+
+void RetryQueue::config_changed(lcbvb_CONFIG *oldconfig, lcbvb_CONFIG *newconfig)
+{
+    if (parked.empty() || LCBVB_DISTTYPE(newconfig) != LCBVB_DIST_VBUCKET) {
+        return;
+    }
+
+    hrtime_t now = gethrtime();
+    std::vector< bool > flush_pipelines(cq->npipelines);
+    size_t nmoved = 0;
+
+    for (auto it = parked.begin(); it != parked.end();) {
+        int vbid = it->first;
+
+        if ((unsigned)vbid >= newconfig->nvb) {
+            ++it;
+            continue;
+        }
+        int srvix = lcbvb_vbmaster(newconfig, vbid);
+        if (srvix < 0 || (unsigned)srvix >= cq->npipelines) {
+            ++it;
+            continue;
+        }
+        const char *oldmaster = nullptr;
+        if ((unsigned)vbid < oldconfig->nvb) {
+            oldmaster = vbmaster_authority(oldconfig, vbid);
+        }
+        const char *newmaster = LCBVB_GET_SERVER(newconfig, srvix)->authority;
+        if (oldmaster && newmaster && strcmp(oldmaster, newmaster) == 0) {
+            /* Same node, leave it to the retry interval */
+            ++it;
+            continue;
+        }
+
+        /* Splice the whole bucket out of the map before touching its ops */
+        lcb_list_t batch;
+        lcb_clist_t *bucket = &it->second;
+        size_t nops = LCB_CLIST_SIZE(bucket);
+        batch.next = bucket->next;
+        batch.prev = bucket->prev;
+        batch.next->prev = &batch;
+        batch.prev->next = &batch;
+        it = parked.erase(it);
+
+        mc_PIPELINE *pl = cq->pipelines[srvix];
+        lcb_list_t *ll, *ll_next;
+        LCB_LIST_SAFE_FOR(ll, ll_next, &batch)
+        {
+            RetryOp *op = from_parknode(ll);
+            op->park_vbid = -1;
+            erase(op);
+            mcreq_enqueue_packet(pl, op->pkt);
+        }
+        flush_pipelines[srvix] = true;
+        nmoved += nops;
+        lcb_log(LOGARGS(this, DEBUG), "Redirected %lu parked packet(s) for vb=%d to IX=%d", (unsigned long)nops, vbid,
+                srvix);
+    }
+
+    for (size_t ii = 0; ii < flush_pipelines.size(); ii++) {
+        if (flush_pipelines[ii]) {
+            mc_PIPELINE *pl = cq->pipelines[ii];
+            pl->flush_start(pl);
+        }
+    }
+
+    if (settings->metrics) {
+        settings->metrics->packets_nmv_redirected += nmoved;
+    }
+    if (nmoved) {
+        schedule(now);
+    }
 }
 
 void RetryQueue::ucadd(mc_EXPACKET *pkt, lcb_STATUS orig_err, protocol_binary_response_status status)
@@ -487,13 +681,11 @@ void RetryQueue::add_fallback(mc_PACKET *pkt)
 
 void RetryQueue::reset_timeouts(lcb_U64 now)
 {
-    lcb_list_t *ll;
-    LCB_LIST_FOR(ll, &schedops)
-    {
-        RetryOp *op = from_schednode(ll);
+    for (auto op : schedops) {
         op->deadline = now + (op->deadline - op->start);
         op->start = now;
     }
+    TmoHeap::rebuild(tmoops);
 }
 
 RetryQueue::RetryQueue(mc_CMDQUEUE *cq_, lcbio_pTABLE table, lcb_settings *settings_)
@@ -503,20 +695,15 @@ RetryQueue::RetryQueue(mc_CMDQUEUE *cq_, lcbio_pTABLE table, lcb_settings *setti
     timer = lcbio_timer_new(table, this, rq_tick);
 
     lcb_settings_ref(settings);
-    lcb_list_init(&tmoops);
-    lcb_list_init(&schedops);
     mcreq_set_fallback_handler(cq, fallback_handler);
 }
 
 RetryQueue::~RetryQueue()
 {
-    lcb_list_t *llcur, *llnext;
     hrtime_t now = gethrtime();
 
-    LCB_LIST_SAFE_FOR(llcur, llnext, &schedops)
-    {
-        RetryOp *op = from_schednode(llcur);
-        fail(op, LCB_ERR_GENERIC, now);
+    while (!schedops.empty()) {
+        fail(schedops.front(), LCB_ERR_GENERIC, now);
     }
 
     lcbio_timer_destroy(timer);
@@ -538,10 +725,7 @@ lcb_STATUS RetryQueue::error_for(const mc_PACKET *packet)
 
 void RetryQueue::dump(FILE *fp, mcreq_payload_dump_fn dumpfn)
 {
-    lcb_list_t *cur;
-    LCB_LIST_FOR(cur, &schedops)
-    {
-        RetryOp *op = from_schednode(cur);
+    for (auto op : schedops) {
         mcreq_dump_packet(op->pkt, fp, dumpfn);
     }
 }
@@ -24,6 +24,8 @@
 #include "list.h"
 
 #ifdef __cplusplus
+#include <map>
+#include <vector>
 
 /**
  * @file
@@ -80,13 +82,26 @@ class RetryQueue
     }
 
     /**
-     * Retries the given packet as a result of a NOT_MY_VBUCKET failure. Currently
-     * this is provided to allow for different behavior when handling these types
-     * of responses.
+     * Retries the given packet as a result of a NOT_MY_VBUCKET failure. Besides
+     * being scheduled like any other retried packet, the packet is parked under
+     * its vBucket so that config_changed() can redirect it as soon as a new
+     * map moves the vBucket, without waiting for the retry interval.
      *
      * @param detchpkt The new packet
      */
     void nmvadd(mc_EXPACKET *detchpkt);
+
+    /**
+     * @brief Redirect parked NOT_MY_VBUCKET packets after a map update
+     *
+     * Every vBucket with parked packets whose master node differs between the
+     * two configurations has all of its packets moved to the new master at
+     * once, with a single flush per pipeline.
+     *
+     * @param oldconfig the configuration the packets were rejected under
+     * @param newconfig the configuration now installed in the command queue
+     */
+    void config_changed(lcbvb_CONFIG *oldconfig, lcbvb_CONFIG *newconfig);
     void ucadd(mc_EXPACKET *pkt, lcb_STATUS orig_err, protocol_binary_response_status status);
 
     /**
@@ -143,7 +158,10 @@ class RetryQueue
     inline void add_fallback(mc_PACKET *pkt);
 
   private:
-    static void erase(RetryOp *);
+    void erase(RetryOp *);
+    void insert(RetryOp *);
+    void park(RetryOp *, int vbid);
+    void unpark(RetryOp *);
     void fail(RetryOp *, lcb_STATUS, hrtime_t);
     void schedule(hrtime_t now = 0);
     void flush(bool throttle);
@@ -157,10 +175,14 @@ class RetryQueue
     enum AddOptions { RETRY_SCHED_IMM = 0x01 };
     void add(mc_EXPACKET *pkt, lcb_STATUS, protocol_binary_response_status, errmap::RetrySpec *, int options);
 
-    /** List of operations in retry ordering. Sorted by 'crtime' */
-    lcb_list_t schedops{};
-    /** List of operations in timeout ordering. Ordered by 'start_time' */
-    lcb_list_t tmoops{};
+    /** Binary min-heap of operations in retry ordering. Keyed by 'trytime' */
+    std::vector< RetryOp * > schedops;
+    /** Binary min-heap of operations in timeout ordering. Keyed by 'deadline' */
+    std::vector< RetryOp * > tmoops;
+    /** Insertion counter, keeps operations with equal keys in FIFO order */
+    uint64_t seqno{0};
+    /** NOT_MY_VBUCKET packets waiting for their vBucket to move, by vBucket */
+    std::map< int, lcb_clist_t > parked;
     /** Parent command queue */
     mc_CMDQUEUE *cq;
     lcb_settings *settings;
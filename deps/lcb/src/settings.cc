@@ -51,7 +51,7 @@ void lcb_default_settings(lcb_settings *settings)
     settings->compressopts = LCB_DEFAULT_COMPRESSOPTS;
     settings->compress_min_size = LCB_DEFAULT_COMPRESS_MIN_SIZE;
     settings->compress_min_ratio = (float)LCB_DEFAULT_COMPRESS_MIN_RATIO;
-    settings->allocator_factory = rdb_bigalloc_new;
+    settings->allocator_factory = rdb_slaballoc_new;
     settings->detailed_neterr = 1;
     settings->refresh_on_hterr = 1;
     settings->sched_implicit_flush = 1;
@@ -64,11 +64,16 @@ void lcb_default_settings(lcb_settings *settings)
     settings->select_bucket = LCB_DEFAULT_SELECT_BUCKET;
     settings->tcp_keepalive = LCB_DEFAULT_TCP_KEEPALIVE;
     settings->config_poll_interval = LCB_DEFAULT_CONFIG_POLL_INTERVAL;
+    settings->ssl_session_cache_size = LCB_DEFAULT_SSL_SESSION_CACHE_SIZE;
+    settings->ssl_session_lifetime = LCB_DEFAULT_SSL_SESSION_LIFETIME;
+    settings->dns_cache_ttl = LCB_DEFAULT_DNS_CACHE_TTL;
     settings->use_collections = 1;
     settings->log_redaction = 0;
     settings->use_tracing = 1;
+    settings->kv_op_timings = 0;
     settings->network = nullptr;
     settings->allow_static_config = 0;
+    settings->config_cache_revalidate = 1;
     settings->tracer_orphaned_queue_flush_interval = LCBTRACE_DEFAULT_ORPHANED_QUEUE_FLUSH_INTERVAL;
     settings->tracer_orphaned_queue_size = LCBTRACE_DEFAULT_ORPHANED_QUEUE_SIZE;
     settings->tracer_threshold_queue_flush_interval = LCBTRACE_DEFAULT_THRESHOLD_QUEUE_FLUSH_INTERVAL;
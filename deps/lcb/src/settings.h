@@ -97,6 +97,11 @@
 #define LCB_DEFAULT_TCP_KEEPALIVE 1
 /* 2.5 s */
 #define LCB_DEFAULT_CONFIG_POLL_INTERVAL LCB_MS2US(2500)
+#define LCB_DEFAULT_SSL_SESSION_CACHE_SIZE 256
+/* 5 min */
+#define LCB_DEFAULT_SSL_SESSION_LIFETIME LCB_MS2US(300000)
+/* 10 s */
+#define LCB_DEFAULT_DNS_CACHE_TTL LCB_MS2US(10000)
 /* 50 ms */
 #define LCB_CONFIG_POLL_INTERVAL_FLOOR LCB_MS2US(50)
 
@@ -166,6 +171,14 @@ typedef struct lcb_settings_st {
 
     /** Time to wait in between background config polls. 0 disables this */
     lcb_U32 config_poll_interval;
+    lcb_U32 ssl_session_cache_size;
+    lcb_U32 ssl_session_lifetime;
+    lcb_U32 dns_cache_ttl;
+
+    /** Number of idle HTTP connections kept open to each node of a service */
+    lcb_U32 query_min_idle;
+    lcb_U32 search_min_idle;
+    lcb_U32 analytics_min_idle;
 
     unsigned bc_http_urltype : 4;
 
@@ -191,6 +204,8 @@ typedef struct lcb_settings_st {
     unsigned use_collections : 1;
     unsigned log_redaction : 1;
     unsigned use_tracing : 1;
+    /** Record where the time of each KV operation goes (see LCB_CNTL_KV_OP_TIMINGS) */
+    unsigned kv_op_timings : 1;
     unsigned use_errmap : 1;
     unsigned allow_static_config : 1;
     /** Do not use remap vbuckets (do not use fast forward map, or any other heuristics) */
@@ -200,6 +215,9 @@ typedef struct lcb_settings_st {
     unsigned wait_for_config : 1;
     unsigned enable_durable_write : 1;
     unsigned enable_unordered_execution : 1;
+    /** Refresh the configuration in the background after bootstrapping from
+     * the config cache */
+    unsigned config_cache_revalidate : 1;
 
     lcb_RETRY_STRATEGY retry_strategy;
     short max_redir;
@@ -0,0 +1,232 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "slab.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+#define NUM_CLASSES (LCB_SLAB_MAX_SHIFT - LCB_SLAB_MIN_SHIFT + 1)
+
+namespace
+{
+/** Released buffers are chained through their first bytes */
+struct FreeBuf {
+    FreeBuf *next;
+};
+
+struct FreeList {
+    FreeBuf *head{nullptr};
+
+    void push(void *ptr)
+    {
+        auto *buf = static_cast<FreeBuf *>(ptr);
+        buf->next = head;
+        head = buf;
+    }
+
+    void *pop()
+    {
+        FreeBuf *buf = head;
+        if (buf) {
+            head = buf->next;
+        }
+        return buf;
+    }
+};
+
+struct SharedPool {
+    std::mutex mutex;
+    FreeList classes[NUM_CLASSES];
+    size_t nbytes{0};
+
+    std::atomic<size_t> pool_limit{LCB_SLAB_DEFAULT_POOL_LIMIT};
+    std::atomic<size_t> thread_limit{LCB_SLAB_DEFAULT_THREAD_LIMIT};
+
+    std::atomic<lcb_U64> bytes_pooled{0};
+    std::atomic<lcb_U64> allocations{0};
+    std::atomic<lcb_U64> hits{0};
+    std::atomic<lcb_U64> bytes_released{0};
+};
+
+SharedPool &shared_pool()
+{
+    /* Deliberately leaked: thread caches are flushed into it when their
+     * threads exit, which may happen after static destructors have run */
+    static auto *pool = new SharedPool();
+    return *pool;
+}
+
+/** Returns the size class for `size`, or -1 if it is too big to pool */
+int size_class(size_t size)
+{
+    if (size > LCB_SLAB_MAX_SIZE) {
+        return -1;
+    }
+    int ix = 0;
+    while ((size_t(LCB_SLAB_MIN_SIZE) << ix) < size) {
+        ix++;
+    }
+    return ix;
+}
+
+size_t class_size(int ix)
+{
+    return size_t(LCB_SLAB_MIN_SIZE) << ix;
+}
+
+void release_to_system(SharedPool &pool, void *ptr, size_t capacity)
+{
+    free(ptr);
+    pool.bytes_released.fetch_add(capacity, std::memory_order_relaxed);
+}
+
+void release_to_shared(SharedPool &pool, int ix, void *ptr)
+{
+    size_t capacity = class_size(ix);
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (pool.nbytes + capacity <= pool.pool_limit.load(std::memory_order_relaxed)) {
+            pool.classes[ix].push(ptr);
+            pool.nbytes += capacity;
+            pool.bytes_pooled.fetch_add(capacity, std::memory_order_relaxed);
+            return;
+        }
+    }
+    release_to_system(pool, ptr, capacity);
+}
+
+struct ThreadCache {
+    FreeList classes[NUM_CLASSES];
+    size_t nbytes{0};
+
+    ~ThreadCache()
+    {
+        SharedPool &pool = shared_pool();
+        for (int ix = 0; ix < NUM_CLASSES; ix++) {
+            void *ptr;
+            while ((ptr = classes[ix].pop()) != nullptr) {
+                pool.bytes_pooled.fetch_sub(class_size(ix), std::memory_order_relaxed);
+                release_to_shared(pool, ix, ptr);
+            }
+        }
+    }
+};
+
+thread_local ThreadCache thread_cache;
+} // namespace
+
+void *lcb_slab_alloc(size_t size, size_t *capacity)
+{
+    SharedPool &pool = shared_pool();
+    int ix = size_class(size);
+    void *ptr;
+
+    pool.allocations.fetch_add(1, std::memory_order_relaxed);
+    if (ix < 0) {
+        *capacity = size;
+        return malloc(size);
+    }
+
+    *capacity = class_size(ix);
+    ThreadCache &cache = thread_cache;
+    if ((ptr = cache.classes[ix].pop()) != nullptr) {
+        cache.nbytes -= *capacity;
+    } else {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if ((ptr = pool.classes[ix].pop()) != nullptr) {
+            pool.nbytes -= *capacity;
+        }
+    }
+
+    if (ptr) {
+        pool.hits.fetch_add(1, std::memory_order_relaxed);
+        pool.bytes_pooled.fetch_sub(*capacity, std::memory_order_relaxed);
+        return ptr;
+    }
+    return malloc(*capacity);
+}
+
+void lcb_slab_free(void *ptr, size_t capacity)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+
+    SharedPool &pool = shared_pool();
+    int ix = size_class(capacity);
+    if (ix < 0) {
+        release_to_system(pool, ptr, capacity);
+        return;
+    }
+
+    capacity = class_size(ix);
+    ThreadCache &cache = thread_cache;
+    if (cache.nbytes + capacity <= pool.thread_limit.load(std::memory_order_relaxed)) {
+        cache.classes[ix].push(ptr);
+        cache.nbytes += capacity;
+        pool.bytes_pooled.fetch_add(capacity, std::memory_order_relaxed);
+        return;
+    }
+    release_to_shared(pool, ix, ptr);
+}
+
+void lcb_slab_set_limits(size_t pool_limit, size_t thread_limit)
+{
+    SharedPool &pool = shared_pool();
+    pool.pool_limit = pool_limit;
+    pool.thread_limit = thread_limit;
+}
+
+void lcb_slab_get_limits(size_t *pool_limit, size_t *thread_limit)
+{
+    SharedPool &pool = shared_pool();
+    *pool_limit = pool.pool_limit;
+    *thread_limit = pool.thread_limit;
+}
+
+void lcb_slab_get_stats(lcb_BUFFER_POOL_STATS *stats)
+{
+    SharedPool &pool = shared_pool();
+    stats->bytes_pooled = pool.bytes_pooled.load(std::memory_order_relaxed);
+    stats->allocations = pool.allocations.load(std::memory_order_relaxed);
+    stats->hits = pool.hits.load(std::memory_order_relaxed);
+    stats->bytes_released = pool.bytes_released.load(std::memory_order_relaxed);
+}
+
+void lcb_slab_trim(void)
+{
+    SharedPool &pool = shared_pool();
+    FreeList classes[NUM_CLASSES];
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        for (int ix = 0; ix < NUM_CLASSES; ix++) {
+            classes[ix] = pool.classes[ix];
+            pool.classes[ix].head = nullptr;
+        }
+        pool.nbytes = 0;
+    }
+
+    for (int ix = 0; ix < NUM_CLASSES; ix++) {
+        void *ptr;
+        while ((ptr = classes[ix].pop()) != nullptr) {
+            pool.bytes_pooled.fetch_sub(class_size(ix), std::memory_order_relaxed);
+            release_to_system(pool, ptr, class_size(ix));
+        }
+    }
+}
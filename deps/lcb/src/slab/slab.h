@@ -0,0 +1,84 @@
+/* -*- Mode: C; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#ifndef LCB_SLAB_H
+#define LCB_SLAB_H
+
+#include <libcouchbase/couchbase.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Process-wide buffer pool
+ *
+ * Network buffers (read rope segments and netbuf blocks) are taken from a
+ * single pool shared by every socket and pipeline in the process, rather than
+ * from many small per-connection pools.
+ *
+ * Requests are rounded up to a power-of-two size class between
+ * LCB_SLAB_MIN_SIZE and LCB_SLAB_MAX_SIZE. Released buffers are kept first in
+ * a small cache private to the releasing thread, which is used without
+ * locking, and then in a shared pool. Once both are at their limits, buffers
+ * are given back to the system. Requests larger than LCB_SLAB_MAX_SIZE are
+ * never pooled.
+ */
+
+#define LCB_SLAB_MIN_SHIFT 8
+#define LCB_SLAB_MAX_SHIFT 20
+#define LCB_SLAB_MIN_SIZE (1 << LCB_SLAB_MIN_SHIFT)
+#define LCB_SLAB_MAX_SIZE (1 << LCB_SLAB_MAX_SHIFT)
+
+/** Default limit of the shared pool, in bytes */
+#define LCB_SLAB_DEFAULT_POOL_LIMIT (16 * 1024 * 1024)
+/** Default limit of each thread's private cache, in bytes */
+#define LCB_SLAB_DEFAULT_THREAD_LIMIT (1024 * 1024)
+
+/**
+ * Allocate a buffer of at least `size` bytes.
+ * @param size the required size
+ * @param[out] capacity the usable size of the returned buffer, which must be
+ *  passed back to lcb_slab_free()
+ * @return the buffer, or NULL if memory is exhausted
+ */
+void *lcb_slab_alloc(size_t size, size_t *capacity);
+
+/**
+ * Release a buffer returned by lcb_slab_alloc().
+ * @param ptr the buffer
+ * @param capacity the capacity reported by lcb_slab_alloc(), or the size
+ *  originally requested
+ */
+void lcb_slab_free(void *ptr, size_t capacity);
+
+/** Set the number of bytes the shared pool and each thread cache may hold */
+void lcb_slab_set_limits(size_t pool_limit, size_t thread_limit);
+
+void lcb_slab_get_limits(size_t *pool_limit, size_t *thread_limit);
+
+void lcb_slab_get_stats(lcb_BUFFER_POOL_STATS *stats);
+
+/** Give every buffer in the shared pool back to the system */
+void lcb_slab_trim(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -19,12 +19,19 @@
 #include "sllist.h"
 #include "sllist-inl.h"
 
-/* throw-away write buffer structure (for encoded data) */
+/* write buffer structure (for encoded data). One of these is kept around by
+ * the socket for reuse */
 typedef struct {
     void *parent;
+    lcb_SIZE cap;
     char buf[1];
 } my_WBUF;
 
+/* Encoded output buffers are allocated with at least enough room for a full
+ * record and its framing, and are only kept for reuse up to this size */
+#define WBUF_MINSIZE (IOTSSL_RECORD_MAX + 1024)
+#define WBUF_MAXCACHED (4 * WBUF_MINSIZE)
+
 /* throw-away write buffer structure (for application data) */
 typedef struct {
     sllist_node slnode;
@@ -43,6 +50,10 @@ typedef struct {
     lcb_IOV urd_iov;       /**< User-defined buffer to read in applicataion data */
     void *urd_arg;         /**< User-defined argument for read callback */
     my_WCTX *wctx_cached;
+    my_WBUF *wbuf_cached;
+    char *wstage;     /**< Application data gathered into the next record */
+    lcb_SIZE nwstage; /**< Number of bytes in wstage */
+    int wstage_blocked; /**< Whether SSL_write() must be retried with wstage */
     lcb_ioC_read2_callback urd_cb; /**< User defined read callback */
     sllist_root writes;            /**< List of pending user writes */
 
@@ -98,6 +109,100 @@ static void appdata_free_flushed(lcbio_CSSL *cs)
     }
 }
 
+/* Hands a buffer of application data to SSL_write(). Returns 0 on success
+ * and -1 if the data could not be written */
+static int appdata_write(lcbio_CSSL *cs, const void *buf, lcb_size_t len)
+{
+    int rv = SSL_write(cs->ssl, buf, len);
+    if (rv > 0) {
+        return 0;
+    } else if (maybe_set_error(cs, rv) == 0) {
+        /* SSL_ERROR_WANT_READ. Should schedule a read here.
+         * XXX: Note that the pending buffer will not be returned to the user
+         * until the _next_ time the appdata_free_flushed function is
+         * invoked; the call chain for appdata_free_flushed is like this:
+         *
+         * start_write2 => async_schedule(async_write) => appdata_free_flushed.
+         * OR
+         * start_write2 => write_callback => appdata_free_flushed
+         */
+        SCHEDULE_WANT_SAFE(cs)
+    } else {
+        IOTSSL_ERRNO(cs) = EINVAL;
+        cs->error = 1;
+    }
+    return -1;
+}
+
+/* Encodes the gathered application data as a single record. Returns 0 if the
+ * staging buffer is empty afterwards */
+static int appdata_flush_stage(lcbio_CSSL *cs)
+{
+    if (cs->nwstage == 0) {
+        return 0;
+    }
+    if (cs->error || appdata_write(cs, cs->wstage, cs->nwstage) != 0) {
+        /* SSL_write() must be retried with the same data, so nothing more may
+         * be gathered until it goes through */
+        cs->wstage_blocked = 1;
+        return -1;
+    }
+    cs->nwstage = 0;
+    cs->wstage_blocked = 0;
+    return 0;
+}
+
+/* Feeds an array of user buffers to SSL. Small buffers are copied into the
+ * staging buffer until it holds a full record, while buffers of at least a
+ * record in size are written directly once the staging buffer is empty.
+ *
+ * Returns the number of IOVs consumed. If not all of them could be consumed,
+ * `offset` is set to the number of bytes already taken from the next one */
+static lcb_size_t appdata_gather(lcbio_CSSL *cs, const lcb_IOV *iov, lcb_size_t niov, lcb_size_t *offset)
+{
+    lcb_size_t ii = 0, off = 0;
+
+    while (ii < niov && cs->error == 0) {
+        const char *buf = (const char *)iov[ii].iov_base + off;
+        lcb_size_t len = iov[ii].iov_len - off;
+        lcb_size_t ncopy;
+
+        if (cs->nwstage == 0 && len >= IOTSSL_RECORD_MAX) {
+            if (appdata_write(cs, buf, len) != 0) {
+                break;
+            }
+            ii++;
+            off = 0;
+            continue;
+        }
+
+        if (cs->wstage_blocked || cs->nwstage == IOTSSL_RECORD_MAX) {
+            if (appdata_flush_stage(cs) != 0) {
+                break;
+            }
+            continue;
+        }
+
+        if (cs->wstage == NULL) {
+            cs->wstage = malloc(IOTSSL_RECORD_MAX);
+        }
+        ncopy = IOTSSL_RECORD_MAX - cs->nwstage;
+        if (ncopy > len) {
+            ncopy = len;
+        }
+        memcpy(cs->wstage + cs->nwstage, buf, ncopy);
+        cs->nwstage += ncopy;
+        off += ncopy;
+        if (off == iov[ii].iov_len) {
+            ii++;
+            off = 0;
+        }
+    }
+
+    *offset = off;
+    return ii;
+}
+
 /* This function will attempt to encode pending user data into SSL data. This
  * will be output to the wbio. */
 static void appdata_encode(lcbio_CSSL *cs)
@@ -108,31 +213,25 @@ static void appdata_encode(lcbio_CSSL *cs)
     SLLIST_FOREACH(&cs->writes, cur)
     {
         my_WCTX *ctx = SLLIST_ITEM(cur, my_WCTX, slnode);
+        lcb_size_t nused, offset;
 
-        for (; ctx->niov && cs->error == 0; ctx->niov--, ctx->iov++) {
-            int rv;
-
-            lcb_assert(ctx->iov->iov_len);
-            rv = SSL_write(cs->ssl, ctx->iov->iov_base, ctx->iov->iov_len);
-            if (rv > 0) {
-                continue;
-            } else if (maybe_set_error(cs, rv) == 0) {
-                /* SSL_ERROR_WANT_READ. Should schedule a read here.
-                 * XXX: Note that this buffer will not be returned to the user
-                 * until the _next_ time the appdata_free_flushed function is
-                 * invoked; the call chain for appdata_free_flushed is like this:
-                 *
-                 * start_write2 => async_schedule(async_write) => appdata_free_flushed.
-                 * OR
-                 * start_write2 => write_callback => appdata_free_flushed
-                 */
-                SCHEDULE_WANT_SAFE(cs)
-                return;
-            } else {
-                IOTSSL_ERRNO(cs) = EINVAL;
-            }
+        if (ctx->niov == 0) {
+            continue;
+        }
+
+        nused = appdata_gather(cs, ctx->iov, ctx->niov, &offset);
+        ctx->iov += nused;
+        ctx->niov -= nused;
+        if (ctx->niov) {
+            ctx->iov->iov_base = (char *)ctx->iov->iov_base + offset;
+            ctx->iov->iov_len -= offset;
+            return;
         }
     }
+
+    /* Everything pending has been gathered; whatever remains in the staging
+     * buffer forms the last record of this batch */
+    appdata_flush_stage(cs);
 }
 
 static void async_write(void *arg)
@@ -154,7 +253,11 @@ static void write_callback(lcb_sockdata_t *sd, int status, void *arg)
         cs->error = 1;
     }
 
-    free(wb);
+    if (cs->wbuf_cached == NULL && wb->cap <= WBUF_MAXCACHED) {
+        cs->wbuf_cached = wb;
+    } else {
+        free(wb);
+    }
 
     appdata_free_flushed(cs);
     lcbio_table_unref(&cs->base_);
@@ -248,8 +351,16 @@ static void schedule_wants(lcbio_CSSL *cs)
          * BIO structure doesn't support "lockdown" semantics like netbuf/rdb
          * do. We might transplant this with a different sort of BIO eventually..
          */
-        my_WBUF *wb = malloc(sizeof(*wb) + npend);
+        my_WBUF *wb = cs->wbuf_cached;
         lcb_IOV iov;
+
+        if (wb && wb->cap >= npend) {
+            cs->wbuf_cached = NULL;
+        } else {
+            lcb_SIZE cap = npend < WBUF_MINSIZE ? WBUF_MINSIZE : npend;
+            wb = malloc(sizeof(*wb) + cap);
+            wb->cap = cap;
+        }
         BIO_read(cs->wbio, wb->buf, npend);
         iov.iov_base = wb->buf;
         iov.iov_len = npend;
@@ -332,6 +443,7 @@ static int Cssl_write2(lcb_io_opt_t io, lcb_sockdata_t *sd, lcb_IOV *iov, lcb_si
 {
     lcbio_CSSL *cs = CS_FROM_IOPS(io);
     my_WCTX *wc;
+    lcb_size_t offset = 0;
 
     /* We keep one of these cached inside the cs structure so we don't have
      * to make a new malloc for each write */
@@ -350,17 +462,9 @@ static int Cssl_write2(lcb_io_opt_t io, lcb_sockdata_t *sd, lcb_IOV *iov, lcb_si
     /* If the socket does not have a pending error and there are no other
      * writes before this, then try to write the current buffer immediately. */
     if (cs->error == 0 && SLLIST_IS_EMPTY(&cs->writes)) {
-        unsigned ii;
-        for (ii = 0; ii < niov; ++ii) {
-            int rv = SSL_write(cs->ssl, iov->iov_base, iov->iov_len);
-            if (rv > 0) {
-                iov++;
-                niov--;
-            } else {
-                maybe_set_error(cs, rv);
-                break;
-            }
-        }
+        lcb_size_t nused = appdata_gather(cs, iov, niov, &offset);
+        iov += nused;
+        niov -= nused;
     }
 
     /* We add this now in order for the SLLIST_IS_EMPTY to be false before, if
@@ -374,13 +478,18 @@ static int Cssl_write2(lcb_io_opt_t io, lcb_sockdata_t *sd, lcb_IOV *iov, lcb_si
         wc->iov = malloc(sizeof(*iov) * wc->niov);
         wc->iovroot_ = wc->iov;
         memcpy(wc->iov, iov, sizeof(*iov) * niov);
+        wc->iov->iov_base = (char *)wc->iov->iov_base + offset;
+        wc->iov->iov_len -= offset;
         /* This function will try to schedule the proper events. We need at least
          * one SSL_write() in order to advance the state machine. In the future
          * we could determine if we performed a previous SSL_write above */
         appdata_encode(cs);
     }
 
-    /* In most cases we will want to deliver the "flushed" notification */
+    /* In most cases we will want to deliver the "flushed" notification. This
+     * also encodes whatever was left in the staging buffer, so that the
+     * buffers of every write issued before then share as few records as
+     * possible */
     lcbio_async_signal(cs->as_write);
     (void)sd;
     return 0;
@@ -411,6 +520,8 @@ static void Cssl_dtor(void *arg)
     lcbio_timer_destroy(cs->as_write);
     iotssl_destroy_common((lcbio_XSSL *)cs);
     free(cs->wctx_cached);
+    free(cs->wbuf_cached);
+    free(cs->wstage);
     free(arg);
 }
 
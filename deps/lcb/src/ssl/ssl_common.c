@@ -135,6 +135,12 @@ void iotssl_init_common(lcbio_XSSL *xs, lcbio_TABLE *orig, SSL_CTX *sctx)
 void iotssl_destroy_common(lcbio_XSSL *xs)
 {
     free(xs->iops_dummy_);
+    if (xs->errcode == LCB_SUCCESS) {
+        /* The socket is closed without sending a close_notify. Unless it
+         * failed, mark it as shut down cleanly anyway, as OpenSSL would
+         * otherwise invalidate its session for resumption */
+        SSL_set_shutdown(xs->ssl, SSL_SENT_SHUTDOWN);
+    }
     SSL_free(xs->ssl);
     lcbio_table_unref(xs->orig);
 }
@@ -217,6 +223,28 @@ int iotssl_maybe_error(lcbio_XSSL *xs, int rv)
  ** Higher Level SSL_CTX Wrappers                                            **
  ******************************************************************************
  ******************************************************************************/
+/* Invoked whenever a handshake completes. With TLS 1.3 this also happens for
+ * every session ticket received afterwards, so only the first one counts */
+static void count_handshake(lcbio_SOCKET *sock, const SSL *ssl)
+{
+    lcbio_XSSL *xs = (lcbio_XSSL *)sock->io;
+    lcb_METRICS *metrics = sock->settings->metrics;
+
+    if (xs->handshake_done) {
+        return;
+    }
+    xs->handshake_done = 1;
+
+    if (SSL_session_reused((SSL *)ssl)) {
+        lcb_log(LOGARGS(ssl, LCB_LOG_DEBUG), "sock=%p. Resumed TLS session", (void *)sock);
+        if (metrics) {
+            metrics->ssl_sessions_resumed++;
+        }
+    } else if (metrics) {
+        metrics->ssl_full_handshakes++;
+    }
+}
+
 static void log_callback(const SSL *ssl, int where, int ret)
 {
     const char *retstr;
@@ -230,6 +258,9 @@ static void log_callback(const SSL *ssl, int where, int ret)
     if (where == SSL_CB_HANDSHAKE_START || where == SSL_CB_HANDSHAKE_DONE) {
         should_log = 1;
     }
+    if (where == SSL_CB_HANDSHAKE_DONE && sock) {
+        count_handshake(sock, ssl);
+    }
     if ((where & SSL_CB_EXIT) && ret == 0) {
         should_log = 1;
     }
@@ -274,12 +305,115 @@ msg_callback(int write_p, int version, int ctype, const void *buf, size_t n,
 }
 #endif
 
+/* A session negotiated with a given endpoint, which can be offered to the
+ * server again when reconnecting to it */
+typedef struct {
+    char *key; /**< "host:port" of the endpoint */
+    SSL_SESSION *session;
+    hrtime_t created;
+} ssl_SESSION_ENTRY;
+
 struct lcbio_SSLCTX {
     SSL_CTX *ctx;
+    ssl_SESSION_ENTRY *sessions;
+    unsigned nsessions;
 };
 
 #define LOGARGS_S(settings, lvl) settings, "SSL", lvl, __FILE__, __LINE__
 
+static void session_key(lcbio_SOCKET *sock, char *buf, size_t nbuf)
+{
+    const lcb_host_t *host = &sock->info->ep_remote;
+    snprintf(buf, nbuf, "%s:%s", host->host, host->port);
+}
+
+static void session_entry_clear(ssl_SESSION_ENTRY *ent)
+{
+    free(ent->key);
+    SSL_SESSION_free(ent->session);
+}
+
+/* Looks up the session for the given key, discarding it if it has expired */
+static ssl_SESSION_ENTRY *session_find(lcbio_pSSLCTX sctx, const char *key, lcb_U32 lifetime)
+{
+    unsigned ii;
+    for (ii = 0; ii < sctx->nsessions; ii++) {
+        ssl_SESSION_ENTRY *ent = sctx->sessions + ii;
+        if (strcmp(ent->key, key) != 0) {
+            continue;
+        }
+        if (gethrtime() - ent->created > (hrtime_t)lifetime * 1000) {
+            session_entry_clear(ent);
+            *ent = sctx->sessions[--sctx->nsessions];
+            return NULL;
+        }
+        return ent;
+    }
+    return NULL;
+}
+
+/* Invoked by OpenSSL whenever the server issues a new session, which for
+ * TLS 1.3 happens after the handshake has completed */
+static int session_new_callback(SSL *ssl, SSL_SESSION *session)
+{
+    lcbio_SOCKET *sock = SSL_get_app_data(ssl);
+    lcbio_pSSLCTX sctx = SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl));
+    ssl_SESSION_ENTRY *ent;
+    lcb_U32 maxsessions;
+    char key[NI_MAXHOST + NI_MAXSERV + 2];
+
+    if (!sock || !sctx) {
+        return 0;
+    }
+    maxsessions = sock->settings->ssl_session_cache_size;
+    if (maxsessions == 0) {
+        return 0;
+    }
+
+    session_key(sock, key, sizeof key);
+    ent = session_find(sctx, key, sock->settings->ssl_session_lifetime);
+    if (ent) {
+        SSL_SESSION_free(ent->session);
+    } else {
+        if (sctx->nsessions >= maxsessions) {
+            /* evict the oldest session */
+            unsigned ii, oldest = 0;
+            for (ii = 1; ii < sctx->nsessions; ii++) {
+                if (sctx->sessions[ii].created < sctx->sessions[oldest].created) {
+                    oldest = ii;
+                }
+            }
+            session_entry_clear(sctx->sessions + oldest);
+            sctx->sessions[oldest] = sctx->sessions[--sctx->nsessions];
+        }
+        sctx->sessions = realloc(sctx->sessions, sizeof(*sctx->sessions) * (sctx->nsessions + 1));
+        ent = sctx->sessions + sctx->nsessions++;
+        ent->key = strdup(key);
+    }
+
+    /* we keep the reference OpenSSL hands us */
+    ent->session = session;
+    ent->created = gethrtime();
+    return 1;
+}
+
+/* Offers the cached session (if any) for the socket's endpoint to the server */
+static void session_resume(lcbio_pSSLCTX sctx, lcbio_SOCKET *sock, SSL *ssl)
+{
+    ssl_SESSION_ENTRY *ent;
+    char key[NI_MAXHOST + NI_MAXSERV + 2];
+
+    if (sock->settings->ssl_session_cache_size == 0 || sctx->nsessions == 0) {
+        return;
+    }
+
+    session_key(sock, key, sizeof key);
+    ent = session_find(sctx, key, sock->settings->ssl_session_lifetime);
+    if (ent) {
+        SSL_set_session(ssl, ent->session);
+    }
+}
+
 static long decode_ssl_protocol(const char *protocol)
 {
     long disallow = SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3;
@@ -410,6 +544,13 @@ lcbio_pSSLCTX lcbio_ssl_new(const char *tsfile, const char *cafile, const char *
      */
     SSL_CTX_set_mode(ret->ctx, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
     SSL_CTX_set_options(ret->ctx, decode_ssl_protocol(minimum_tls));
+
+    /* Sessions are cached by endpoint in the context itself (rather than in
+     * OpenSSL's internal cache, which is keyed by session ID and of no use to
+     * a client), so that reconnecting sockets can resume them. */
+    SSL_CTX_set_app_data(ret->ctx, ret);
+    SSL_CTX_set_session_cache_mode(ret->ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ret->ctx, session_new_callback);
     return ret;
 
 GT_ERR:
@@ -446,8 +587,9 @@ lcb_STATUS lcbio_ssl_apply(lcbio_SOCKET *sock, lcbio_pSSLCTX sctx)
         lcbio_protoctx_add(sock, sproto);
         lcbio_table_unref(old_iot);
         sock->io = new_iot;
-        /* just for logging */
+        /* for logging and session caching */
         SSL_set_app_data(((lcbio_XSSL *)new_iot)->ssl, sock);
+        session_resume(sctx, sock, ((lcbio_XSSL *)new_iot)->ssl);
         return LCB_SUCCESS;
 
     } else {
@@ -468,6 +610,11 @@ lcb_STATUS lcbio_ssl_get_error(lcbio_SOCKET *sock)
 
 void lcbio_ssl_free(lcbio_pSSLCTX ctx)
 {
+    unsigned ii;
+    for (ii = 0; ii < ctx->nsessions; ii++) {
+        session_entry_clear(ctx->sessions + ii);
+    }
+    free(ctx->sessions);
     SSL_CTX_free(ctx->ctx);
     free(ctx);
 }
@@ -42,6 +42,7 @@ typedef struct {
     lcb_socket_t fd; /**< Socket descriptor */
     lcbio_pTIMER as_fake;
     lcb_SIZE last_nw; /**< Last failed call to SSL_write() */
+    char *wstage;     /**< Buffers gathered by sendv into a single record */
 } lcbio_ESSL;
 
 #ifdef USE_EAGAIN
@@ -361,12 +362,14 @@ static lcb_ssize_t Essl_send(lcb_io_opt_t iops, lcb_socket_t sock, const void *b
     rv = SSL_write(es->ssl, buf, nbuf);
     if (rv >= 0) {
         /* still need to schedule data to get flushed to the network */
+        es->last_nw = 0;
         SCHEDULE_PENDING_SAFE(es);
         return rv;
     } else if (maybe_error(es, rv)) {
         IOTSSL_ERRNO(es) = EINVAL;
         return -1;
     } else {
+        es->last_nw = nbuf;
         IOTSSL_ERRNO(es) = EWOULDBLOCK;
         return -1;
     }
@@ -380,8 +383,26 @@ static lcb_ssize_t Essl_recvv(lcb_io_opt_t iops, lcb_socket_t sock, lcb_IOV *iov
 
 static lcb_ssize_t Essl_sendv(lcb_io_opt_t iops, lcb_socket_t sock, lcb_IOV *iov, lcb_size_t niov)
 {
-    (void)niov;
-    return Essl_send(iops, sock, iov->iov_base, iov->iov_len, 0);
+    lcbio_ESSL *es = ES_FROM_IOPS(iops);
+    lcb_size_t ii, nbuf = 0, limit;
+
+    if (niov == 1 || iov->iov_len >= IOTSSL_RECORD_MAX) {
+        return Essl_send(iops, sock, iov->iov_base, iov->iov_len, 0);
+    }
+
+    /* Gather the buffers so they are encrypted as one record rather than one
+     * apiece. If the last SSL_write() has to be retried, it must be handed the
+     * same bytes again, so only as many are gathered as it was given. */
+    limit = es->last_nw ? MINIMUM(es->last_nw, IOTSSL_RECORD_MAX) : IOTSSL_RECORD_MAX;
+    if (es->wstage == NULL) {
+        es->wstage = malloc(IOTSSL_RECORD_MAX);
+    }
+    for (ii = 0; ii < niov && nbuf < limit; ++ii) {
+        lcb_size_t ncopy = MINIMUM(iov[ii].iov_len, limit - nbuf);
+        memcpy(es->wstage + nbuf, iov[ii].iov_base, ncopy);
+        nbuf += ncopy;
+    }
+    return Essl_send(iops, sock, es->wstage, nbuf, 0);
 }
 
 static void Essl_close(lcb_io_opt_t iops, lcb_socket_t fd)
@@ -397,6 +418,8 @@ static void Essl_dtor(void *arg)
     IOT_V0EV(es->orig).destroy(IOT_ARG(es->orig), es->event);
     lcbio_timer_destroy(es->as_fake);
     iotssl_destroy_common((lcbio_XSSL *)es);
+    free(es->wstage);
+    es->wstage = NULL;
     if (es->entered) {
         /* defer free while inside the handler */
         return;
@@ -34,6 +34,7 @@
     BIO *rbio;                /**< BIO used for reading data from network */                                           \
     lcb_io_opt_t iops_dummy_; /**< Dummy IOPS structure which is exposed to LCB */                                     \
     int error;                /**< Internal error flag set once a fatal error is detect */                             \
+    int handshake_done;       /**< Set once the initial handshake has completed */                                     \
     lcb_STATUS errcode;       /**< The error, converted into libcouchbase */
 
 /**
@@ -49,6 +50,14 @@ typedef struct {
     IOTSSL_COMMON_FIELDS
 } lcbio_XSSL;
 
+/**
+ * Largest amount of application data carried by a single TLS record. Small
+ * buffers handed to the SSL tables are gathered up to this size before being
+ * passed to `SSL_write()`, so that they are framed and encrypted as a single
+ * record rather than as one record apiece.
+ */
+#define IOTSSL_RECORD_MAX 16384
+
 /**
  * @brief Get the associated lcbio_XSSL from an iops pointer
  * @param iops the IOPS structure
@@ -105,7 +105,7 @@ static lcbvb_SERVER *find_server_memd(lcbvb_SERVER *servers, unsigned n, const c
 {
     unsigned ii;
     for (ii = 0; ii < n; ii++) {
-        char buf[4096] = {0};
+        char buf[4096];
         lcbvb_SERVER *cur = servers + ii;
         copy_address(buf, sizeof(buf), cur->hostname, cur->svc.data);
         if (!strncmp(s, buf, sizeof(buf))) {
@@ -162,7 +162,7 @@ static void set_vb_count(lcbvb_CONFIG *cfg, lcbvb_VBUCKET *vbs)
 
 static int pair_server_list(lcbvb_CONFIG *cfg, cJSON *vbconfig)
 {
-    cJSON *servers;
+    cJSON *servers, *jst;
     lcbvb_SERVER *newlist = NULL;
     unsigned ii, nsrv;
 
@@ -187,11 +187,10 @@ static int pair_server_list(lcbvb_CONFIG *cfg, cJSON *vbconfig)
     /* allocate an array for the reordered server list */
     newlist = calloc(nsrv, sizeof(*cfg->servers));
 
-    for (ii = 0; ii < nsrv; ii++) {
+    jst = servers->child;
+    for (ii = 0; ii < nsrv && jst; ii++, jst = jst->next) {
         char *tmp;
-        cJSON *jst;
         lcbvb_SERVER *cur;
-        jst = cJSON_GetArrayItem(servers, ii);
         tmp = jst->valuestring;
         cur = find_server_memd(cfg->servers, cfg->nsrv, tmp);
 
@@ -588,7 +587,7 @@ static void guess_network(cJSON *jnodes, int nsrv, const char *source, char **ne
 
 int lcbvb_load_json_ex(lcbvb_CONFIG *cfg, const char *data, const char *source, char **network)
 {
-    cJSON *cj = NULL, *jnodes_ext = NULL, *jnodes = NULL, *buckets = NULL;
+    cJSON *cj = NULL, *jnodes_ext = NULL, *jnodes = NULL, *buckets = NULL, *jsrv;
     char *tmp = NULL;
     unsigned ii, jnodes_size = 0;
     int jnodes_defined = 0;
@@ -706,9 +705,9 @@ int lcbvb_load_json_ex(lcbvb_CONFIG *cfg, const char *data, const char *source,
 
     /** Allocate a temporary one on the heap */
     cfg->servers = calloc(cfg->nsrv, sizeof(*cfg->servers));
-    for (ii = 0; ii < cfg->nsrv; ii++) {
+    jsrv = jnodes->child;
+    for (ii = 0; ii < cfg->nsrv; ii++, jsrv = jsrv->next) {
         int rv;
-        cJSON *jsrv = cJSON_GetArrayItem(jnodes, ii);
 
         if (cfg->is3x) {
             rv = build_server_3x(cfg, cfg->servers + ii, jsrv, network);
@@ -768,6 +767,89 @@ int lcbvb_load_json(lcbvb_CONFIG *cfg, const char *data)
     return lcbvb_load_json_ex(cfg, data, NULL, NULL);
 }
 
+/* Returns a pointer past the closing quote of the string starting at @p (which
+ * points just past the opening quote), or NULL if the string is unterminated */
+static const char *skip_jstring(const char *p)
+{
+    for (; *p; p++) {
+        if (*p == '\\') {
+            if (!*++p) {
+                return NULL;
+            }
+        } else if (*p == '"') {
+            return p + 1;
+        }
+    }
+    return NULL;
+}
+
+static const char *skip_jspace(const char *p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+        p++;
+    }
+    return p;
+}
+
+int lcbvb_peek_revision(const char *data, int64_t *revepoch, int64_t *revid)
+{
+    const char *p = data;
+    int depth = 0, found = 0;
+
+    *revepoch = -1;
+    *revid = -1;
+
+    while (*p) {
+        if (*p == '"') {
+            const char *key = p + 1;
+            size_t nkey;
+            if ((p = skip_jstring(key)) == NULL) {
+                return -1;
+            }
+            if (depth != 1) {
+                continue;
+            }
+            nkey = p - key - 1;
+            /* Only a string followed by a colon is a key */
+            p = skip_jspace(p);
+            if (*p == ':') {
+                int64_t *dst = NULL;
+                int bit = 0;
+
+                if (nkey == 3 && memcmp(key, "rev", 3) == 0) {
+                    dst = revid;
+                    bit = 1;
+                } else if (nkey == 8 && memcmp(key, "revEpoch", 8) == 0) {
+                    dst = revepoch;
+                    bit = 2;
+                }
+                p = skip_jspace(p + 1);
+                if (dst) {
+                    char *end = NULL;
+                    *dst = strtoll(p, &end, 10);
+                    if (end == p) {
+                        return -1;
+                    }
+                    p = end;
+                    if ((found |= bit) == 3) {
+                        return 0;
+                    }
+                }
+            }
+            continue;
+        }
+        if (*p == '{' || *p == '[') {
+            depth++;
+        } else if (*p == '}' || *p == ']') {
+            if (--depth == 0) {
+                return 0;
+            }
+        }
+        p++;
+    }
+    return -1;
+}
+
 static void replace_hoststr(char **orig, const char *replacement)
 {
     char *match;
@@ -1333,6 +1415,40 @@ lcbvb_CHANGETYPE lcbvb_get_changetype(lcbvb_CONFIGDIFF *diff)
     return ret;
 }
 
+lcbvb_CHANGETYPE lcbvb_compare_changetype(const lcbvb_CONFIG *from, const lcbvb_CONFIG *to)
+{
+    lcbvb_CHANGETYPE ret = 0;
+    unsigned ii;
+
+    if (from->nsrv != to->nsrv) {
+        ret |= LCBVB_SERVERS_MODIFIED;
+    } else {
+        for (ii = 0; ii < from->nsrv; ii++) {
+            if (strcmp(from->servers[ii].authority, to->servers[ii].authority) != 0) {
+                ret |= LCBVB_SERVERS_MODIFIED;
+                break;
+            }
+        }
+    }
+
+    if (from->nrepl != to->nrepl) {
+        ret |= LCBVB_REPLICAS_MODIFIED;
+    }
+
+    if (from->nvb != to->nvb) {
+        ret |= LCBVB_MAP_MODIFIED;
+    } else {
+        /* Replicas are only compared if their count is unchanged */
+        unsigned ncmp = (ret & LCBVB_REPLICAS_MODIFIED) ? 1 : from->nrepl + 1;
+        for (ii = 0; ii < from->nvb && !(ret & LCBVB_MAP_MODIFIED); ii++) {
+            if (memcmp(from->vbuckets[ii].servers, to->vbuckets[ii].servers, sizeof(int) * ncmp) != 0) {
+                ret |= LCBVB_MAP_MODIFIED;
+            }
+        }
+    }
+    return ret;
+}
+
 /******************************************************************************
  ******************************************************************************
  ** String/Port Getters                                                      **
@@ -238,7 +238,7 @@ static void doc_callback(lcb_INSTANCE *, int, const lcb_RESPGET *resp)
 
     q->ref();
 
-    q->n_awaiting_response--;
+    q->response_received(dreq);
     dreq->docresp = *resp;
     dreq->ready = 1;
     dreq->docresp.ctx.key.assign((const char *)dreq->docid.iov_base, dreq->docid.iov_len);
@@ -377,6 +377,7 @@ lcb_VIEW_HANDLE_::lcb_VIEW_HANDLE_(lcb_INSTANCE *instance, void *cookie, const l
         document_queue_->cb_throttle = cb_docq_throttle;
         if (cmd->max_concurrent_documents() > 0) {
             document_queue_->max_pending_response = cmd->max_concurrent_documents();
+            document_queue_->adaptive = false;
         }
     }
 
@@ -0,0 +1,82 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2021 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "config.h"
+#include "internal.h"
+#include "collections.h"
+#include <gtest/gtest.h>
+
+class CollectionCacheTest : public ::testing::Test
+{
+};
+
+TEST_F(CollectionCacheTest, testDefaultCollection)
+{
+    lcb::CollectionCache cache;
+    uint32_t cid = 42;
+    ASSERT_TRUE(cache.get("_default._default", &cid));
+    ASSERT_EQ(0, cid);
+
+    cid = 42;
+    ASSERT_TRUE(cache.get(nullptr, 0, nullptr, 0, &cid));
+    ASSERT_EQ(0, cid);
+
+    cid = 42;
+    ASSERT_TRUE(cache.get("_default", 8, nullptr, 0, &cid));
+    ASSERT_EQ(0, cid);
+}
+
+TEST_F(CollectionCacheTest, testLookupByParts)
+{
+    lcb::CollectionCache cache;
+    cache.put("inventory.airline", 8);
+    cache.put("inventory.airport", 9);
+    cache.put("_default.hotel", 10);
+
+    uint32_t cid = 0;
+    ASSERT_TRUE(cache.get("inventory", 9, "airline", 7, &cid));
+    ASSERT_EQ(8, cid);
+    ASSERT_TRUE(cache.get("inventory", 9, "airport", 7, &cid));
+    ASSERT_EQ(9, cid);
+    ASSERT_TRUE(cache.get(nullptr, 0, "hotel", 5, &cid));
+    ASSERT_EQ(10, cid);
+    ASSERT_TRUE(cache.get("inventory.airline", &cid));
+    ASSERT_EQ(8, cid);
+
+    ASSERT_FALSE(cache.get("inventory", 9, "route", 5, &cid));
+    ASSERT_FALSE(cache.get("inventor", 8, "yairline", 8, &cid));
+    ASSERT_FALSE(cache.get("nodot", &cid));
+    ASSERT_EQ("inventory.airport", cache.id_to_name(9));
+}
+
+TEST_F(CollectionCacheTest, testReplaceAndErase)
+{
+    lcb::CollectionCache cache;
+    cache.put("inventory.airline", 8);
+    /* collection re-created with new ID */
+    cache.put("inventory.airline", 12);
+
+    uint32_t cid = 0;
+    ASSERT_TRUE(cache.get("inventory", 9, "airline", 7, &cid));
+    ASSERT_EQ(12, cid);
+    ASSERT_EQ("", cache.id_to_name(8));
+    ASSERT_EQ("inventory.airline", cache.id_to_name(12));
+
+    cache.erase(12);
+    ASSERT_FALSE(cache.get("inventory", 9, "airline", 7, &cid));
+    ASSERT_EQ("", cache.id_to_name(12));
+}
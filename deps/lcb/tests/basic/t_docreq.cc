@@ -0,0 +1,167 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2021 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "config.h"
+#include "internal.h"
+#include "docreq/docreq.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using lcb::docreq::DocRequest;
+using lcb::docreq::Queue;
+
+/* One row every 100us */
+#define ROW_RATE 1e-5
+
+static std::vector< int > throttle_calls;
+
+static void throttle_callback(Queue *, int enabled)
+{
+    throttle_calls.push_back(enabled);
+}
+
+class DocreqTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(LCB_SUCCESS, lcb_create(&instance, nullptr));
+        queue = new Queue(instance);
+        queue->cb_throttle = throttle_callback;
+        throttle_calls.clear();
+    }
+
+    void TearDown() override
+    {
+        queue->unref();
+        lcb_destroy(instance);
+    }
+
+    /* Completes a fetch which was scheduled `latency` nanoseconds ago */
+    void respond(hrtime_t latency)
+    {
+        DocRequest req{};
+        req.scheduled = gethrtime() - latency;
+        queue->n_awaiting_response++;
+        queue->response_received(&req);
+    }
+
+    lcb_INSTANCE *instance{nullptr};
+    Queue *queue{nullptr};
+};
+
+TEST_F(DocreqTest, testWindowFollowsLatency)
+{
+    queue->arrival_rate = ROW_RATE;
+
+    /* 10ms fetches need ~100 in flight to keep up, twice that with headroom */
+    respond(LCB_US2NS(LCB_MS2US(10)));
+    ASSERT_GE(queue->max_pending_response, 200U);
+    ASSERT_LT(queue->max_pending_response, 210U);
+    ASSERT_EQ(queue->max_pending_response / 8, queue->min_batch_size);
+    ASSERT_EQ(0U, queue->n_awaiting_response);
+
+    /* Fast fetches shrink it back, one step at a time */
+    unsigned prev = queue->max_pending_response;
+    for (int ii = 0; ii < 100; ii++) {
+        respond(LCB_US2NS(10));
+        ASSERT_LE(queue->max_pending_response, prev);
+        prev = queue->max_pending_response;
+    }
+    ASSERT_EQ(static_cast< unsigned >(Queue::default_max_pending_docreq), queue->max_pending_response);
+    ASSERT_EQ(static_cast< unsigned >(Queue::default_min_sched_size), queue->min_batch_size);
+
+    /* And slow ones grow it again */
+    for (int ii = 0; ii < 100; ii++) {
+        respond(LCB_US2NS(LCB_MS2US(5)));
+        ASSERT_GE(queue->max_pending_response, prev);
+        prev = queue->max_pending_response;
+    }
+    ASSERT_GE(queue->max_pending_response, 95U);
+    ASSERT_LT(queue->max_pending_response, 110U);
+}
+
+TEST_F(DocreqTest, testWindowLimits)
+{
+    queue->arrival_rate = ROW_RATE;
+
+    respond(LCB_US2NS(LCB_MS2US(10000)));
+    ASSERT_EQ(static_cast< unsigned >(Queue::max_adaptive_docreq), queue->max_pending_response);
+    ASSERT_EQ(static_cast< unsigned >(Queue::max_adaptive_docreq / 8), queue->min_batch_size);
+
+    queue->fetch_latency = 0;
+    respond(1);
+    ASSERT_EQ(static_cast< unsigned >(Queue::default_max_pending_docreq), queue->max_pending_response);
+    ASSERT_EQ(static_cast< unsigned >(Queue::default_min_sched_size), queue->min_batch_size);
+}
+
+TEST_F(DocreqTest, testWindowNeedsSamples)
+{
+    /* Without an arrival rate there is nothing to size the window from */
+    respond(LCB_US2NS(LCB_MS2US(10)));
+    ASSERT_EQ(static_cast< unsigned >(Queue::default_max_pending_docreq), queue->max_pending_response);
+    ASSERT_NE(0, queue->fetch_latency);
+
+    /* Requests which were never scheduled say nothing about latency */
+    queue->arrival_rate = ROW_RATE;
+    queue->fetch_latency = 0;
+    DocRequest req{};
+    queue->n_awaiting_response++;
+    queue->response_received(&req);
+    ASSERT_EQ(0, queue->fetch_latency);
+    ASSERT_EQ(static_cast< unsigned >(Queue::default_max_pending_docreq), queue->max_pending_response);
+    ASSERT_EQ(0U, queue->n_awaiting_response);
+}
+
+TEST_F(DocreqTest, testFixedWindow)
+{
+    queue->adaptive = false;
+    queue->max_pending_response = 3;
+    queue->arrival_rate = ROW_RATE;
+
+    respond(LCB_US2NS(LCB_MS2US(10)));
+    ASSERT_EQ(3U, queue->max_pending_response);
+    ASSERT_EQ(0, queue->fetch_latency);
+    ASSERT_EQ(0U, queue->n_awaiting_response);
+}
+
+TEST_F(DocreqTest, testThrottle)
+{
+    queue->period_rows = 7;
+    queue->period_start = 1;
+
+    queue->set_throttle(true);
+    ASSERT_TRUE(queue->throttled);
+    ASSERT_EQ(7U, queue->period_rows);
+    ASSERT_EQ(1U, queue->period_start);
+
+    /* Resuming discards the period which was paused */
+    queue->set_throttle(false);
+    ASSERT_FALSE(queue->throttled);
+    ASSERT_EQ(0U, queue->period_rows);
+    ASSERT_EQ(0U, queue->period_start);
+
+    /* Unthrottling when not throttled keeps the period going */
+    queue->period_rows = 2;
+    queue->period_start = 1;
+    queue->set_throttle(false);
+    ASSERT_EQ(2U, queue->period_rows);
+    ASSERT_EQ(1U, queue->period_start);
+
+    std::vector< int > expected = {1, 0, 0};
+    ASSERT_EQ(expected, throttle_calls);
+}
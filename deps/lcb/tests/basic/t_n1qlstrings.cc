@@ -18,7 +18,11 @@
 #include "config.h"
 #include <gtest/gtest.h>
 #include <libcouchbase/couchbase.h>
+#include <chrono>
+#include "contrib/lcb-jsoncpp/lcb-jsoncpp.h"
 
+#include "capi/cmd_query.hh"
+#include "n1ql/query_body.hh"
 #include "n1ql/query_utils.hh"
 #include "../iotests/testutil.h"
 
@@ -108,3 +112,166 @@ TEST_F(N1qLStringTests, testAnalyticsPositionalParams)
         R"({"args":["Universe","life","Everything"],"statement":"SELECT 42 AS the_answer WHERE question IN (?, ?, ?) "})",
         std::string(payload, payload_len));
 }
+
+TEST_F(N1qLStringTests, testQueryPayloadIsCompacted)
+{
+    lcb_CMDQUERY *cmd = nullptr;
+    ASSERT_STATUS_EQ(LCB_SUCCESS, lcb_cmdquery_create(&cmd));
+
+    std::string raw = R"( { "statement" : "SELECT $1, \"x\"" ,
+        "args": [ 1, -2.5e3, true, null, {"a" : [ ]} ], "readonly":false } )";
+    ASSERT_STATUS_EQ(LCB_SUCCESS, lcb_cmdquery_payload(cmd, raw.c_str(), raw.size()));
+
+    std::string param = R"( { "k" : "v w" } )";
+    ASSERT_STATUS_EQ(LCB_SUCCESS, lcb_cmdquery_positional_param(cmd, param.c_str(), param.size()));
+    ASSERT_STATUS_EQ(LCB_SUCCESS, lcb_cmdquery_named_param(cmd, "name", 4, "\"x\\ty\"", 6));
+
+    const char *payload = nullptr;
+    size_t payload_len = 0;
+    ASSERT_STATUS_EQ(LCB_SUCCESS, lcb_cmdquery_encoded_payload(cmd, &payload, &payload_len));
+    ASSERT_EQ(
+        R"({"$name":"x\ty","args":[1,-2.5e3,true,null,{"a":[]},{"k":"v w"}],"readonly":false,"statement":"SELECT $1, \"x\""})",
+        std::string(payload, payload_len));
+
+    const char *bad[] = {"", "{", "[1,]", "{\"a\":1,}", "01", "1.", "\"\\x\"", "tru", "{} {}", "\"\x01\""};
+    for (const char *value : bad) {
+        ASSERT_STATUS_EQ(LCB_ERR_INVALID_ARGUMENT, lcb_cmdquery_option(cmd, "opt", 3, value, strlen(value))) << value;
+    }
+    // Payloads must be objects
+    ASSERT_STATUS_EQ(LCB_ERR_INVALID_ARGUMENT, lcb_cmdquery_payload(cmd, "[]", 2));
+    // Appending requires an array
+    ASSERT_STATUS_EQ(LCB_SUCCESS, lcb_cmdquery_option(cmd, "args", 4, "{}", 2));
+    ASSERT_STATUS_EQ(LCB_ERR_INVALID_ARGUMENT, lcb_cmdquery_positional_param(cmd, "1", 1));
+
+    lcb_cmdquery_destroy(cmd);
+}
+
+TEST_F(N1qLStringTests, testQueryBodyStrings)
+{
+    std::string value;
+    ASSERT_TRUE(QueryBody::decode_string(R"("a\"b\\c\/\n\u00e9\ud83d\ude00")", value));
+    ASSERT_EQ("a\"b\\c/\n\xc3\xa9\xf0\x9f\x98\x80", value);
+    ASSERT_FALSE(QueryBody::decode_string("42", value));
+    ASSERT_FALSE(QueryBody::decode_string(R"("\ud83d")", value));
+
+    std::string quoted;
+    std::string raw("say \"hi\"\\\n\x01");
+    QueryBody::append_quoted(quoted, raw.c_str(), raw.size());
+    ASSERT_EQ(R"("say \"hi\"\\\n\u0001")", quoted);
+    ASSERT_TRUE(QueryBody::decode_string(quoted, value));
+    ASSERT_EQ(raw, value);
+}
+
+TEST_F(N1qLStringTests, testQueryBodyWrite)
+{
+    QueryBody body;
+    std::string raw = R"({"statement":"SELECT 1","timeout":"75s"})";
+    ASSERT_TRUE(body.parse(raw.c_str(), raw.size()));
+
+    std::string out;
+    body.write(out, "statement", R"("prepared":"p1")");
+    ASSERT_EQ(R"({"timeout":"75s","prepared":"p1"})", out);
+
+    QueryBody empty;
+    out.clear();
+    empty.write(out, "statement", R"("prepared":"p1")");
+    ASSERT_EQ(R"({"prepared":"p1"})", out);
+}
+
+TEST_F(N1qLStringTests, testQueryMeta)
+{
+    std::string raw = R"({
+        "requestID": "a1b2",
+        "clientContextID": "ctx\"1",
+        "signature": {"*": "*"},
+        "status": "success",
+        "warnings": [{"code": 1100, "msg": "first"}, {"code": 1101, "msg": "second\n"}],
+        "metrics": {"elapsedTime": "1.5ms", "executionTime": "1ms", "resultCount": 3, "resultSize": 42}
+    })";
+    lcb_QUERY_META meta;
+    ASSERT_TRUE(meta.parse(raw.c_str(), raw.size()));
+
+    const char *value;
+    size_t value_len;
+    ASSERT_EQ(LCB_SUCCESS, lcb_querymeta_request_id(&meta, &value, &value_len));
+    ASSERT_EQ("a1b2", std::string(value, value_len));
+    ASSERT_EQ(LCB_SUCCESS, lcb_querymeta_client_context_id(&meta, &value, &value_len));
+    ASSERT_EQ("ctx\"1", std::string(value, value_len));
+    ASSERT_EQ(LCB_SUCCESS, lcb_querymeta_status(&meta, &value, &value_len));
+    ASSERT_EQ("success", std::string(value, value_len));
+    ASSERT_EQ(LCB_SUCCESS, lcb_querymeta_signature(&meta, &value, &value_len));
+    ASSERT_EQ(R"({"*":"*"})", std::string(value, value_len));
+    ASSERT_EQ(LCB_ERR_INVALID_ARGUMENT, lcb_querymeta_profile(&meta, &value, &value_len));
+
+    ASSERT_NE(0, lcb_querymeta_has_metrics(&meta));
+    uint64_t metric;
+    ASSERT_EQ(LCB_SUCCESS, lcb_querymeta_metric(&meta, LCB_QUERY_METRIC_ELAPSED_TIME_US, &metric));
+    ASSERT_EQ(1500, metric);
+    ASSERT_EQ(LCB_SUCCESS, lcb_querymeta_metric(&meta, LCB_QUERY_METRIC_EXECUTION_TIME_US, &metric));
+    ASSERT_EQ(1000, metric);
+    ASSERT_EQ(LCB_SUCCESS, lcb_querymeta_metric(&meta, LCB_QUERY_METRIC_RESULT_COUNT, &metric));
+    ASSERT_EQ(3, metric);
+    ASSERT_EQ(LCB_SUCCESS, lcb_querymeta_metric(&meta, LCB_QUERY_METRIC_RESULT_SIZE, &metric));
+    ASSERT_EQ(42, metric);
+    ASSERT_EQ(LCB_SUCCESS, lcb_querymeta_metric(&meta, LCB_QUERY_METRIC_SORT_COUNT, &metric));
+    ASSERT_EQ(0, metric);
+
+    ASSERT_EQ(2, lcb_querymeta_warning_count(&meta));
+    uint32_t code;
+    ASSERT_EQ(LCB_SUCCESS, lcb_querymeta_warning(&meta, 1, &code, &value, &value_len));
+    ASSERT_EQ(1101, code);
+    ASSERT_EQ("second\n", std::string(value, value_len));
+    ASSERT_EQ(LCB_ERR_INVALID_ARGUMENT, lcb_querymeta_warning(&meta, 2, &code, &value, &value_len));
+
+    lcb_QUERY_META errors;
+    raw = R"({"errors":[{"code":12009,"msg":"CAS mismatch"}],"status":"errors"})";
+    ASSERT_TRUE(errors.parse(raw.c_str(), raw.size()));
+    ASSERT_EQ(1, errors.errors.size());
+    ASSERT_EQ(12009, errors.errors[0].code);
+    ASSERT_EQ("CAS mismatch", errors.errors[0].message);
+    ASSERT_EQ(0, lcb_querymeta_has_metrics(&errors));
+
+    lcb_QUERY_META invalid;
+    raw = R"({"status":)";
+    ASSERT_FALSE(invalid.parse(raw.c_str(), raw.size()));
+}
+
+TEST_F(N1qLStringTests, benchEncodeQuery)
+{
+    const int iterations = 20000;
+    std::string statement = "SELECT * FROM `travel-sample` WHERE type = $1 AND country = $2 LIMIT 10";
+    std::string args = R"(["airline", "United States"])";
+
+    // What encoding a query cost before: parameters were parsed into a
+    // document and the document was serialized again
+    auto start = std::chrono::steady_clock::now();
+    size_t total = 0;
+    for (int ii = 0; ii < iterations; ii++) {
+        Json::Value root;
+        root["statement"] = statement;
+        Json::Value params;
+        Json::Reader().parse(args, params);
+        root["args"] = params;
+        root["timeout"] = "75000000us";
+        root["client_context_id"] = "0000000000000001";
+        total += Json::FastWriter().write(root).size();
+    }
+    auto tree_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    for (int ii = 0; ii < iterations; ii++) {
+        QueryBody body;
+        body.set_string("statement", statement);
+        body.set("args", args.c_str(), args.size());
+        body.set_string("timeout", "75000000us");
+        body.set_string("client_context_id", "0000000000000001");
+        std::string out;
+        body.write(out);
+        total -= out.size();
+    }
+    auto body_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_EQ(0, total);
+
+    fprintf(stderr, "Encoded %d queries: %.0fns/query with Json::Value, %.0fns/query with QueryBody\n", iterations,
+            double(tree_ns.count()) / iterations, double(body_ns.count()) / iterations);
+}
@@ -0,0 +1,90 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2021 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "config.h"
+#include "internal.h"
+#include "collections.h"
+#include "capi/cmd_subdoc.hh"
+#include <gtest/gtest.h>
+
+class SubdocSpecsTest : public ::testing::Test
+{
+};
+
+TEST_F(SubdocSpecsTest, testAttachSharesSpecs)
+{
+    lcb_SUBDOCSPECS *specs = nullptr;
+    ASSERT_EQ(LCB_SUCCESS, lcb_subdocspecs_create(&specs, 2));
+    ASSERT_EQ(LCB_SUCCESS, lcb_subdocspecs_get(specs, 0, 0, "foo", 3));
+    ASSERT_EQ(LCB_SUCCESS, lcb_subdocspecs_exists(specs, 1, 0, "bar", 3));
+
+    lcb_CMDSUBDOC *cmd1 = nullptr;
+    lcb_CMDSUBDOC *cmd2 = nullptr;
+    ASSERT_EQ(LCB_SUCCESS, lcb_cmdsubdoc_create(&cmd1));
+    ASSERT_EQ(LCB_SUCCESS, lcb_cmdsubdoc_create(&cmd2));
+    ASSERT_EQ(LCB_SUCCESS, lcb_cmdsubdoc_specs(cmd1, specs));
+    ASSERT_EQ(LCB_SUCCESS, lcb_cmdsubdoc_specs(cmd2, specs));
+
+    const lcb_SUBDOCSPECS *constSpecs = specs;
+    ASSERT_EQ(&constSpecs->specs(), &cmd1->specs().specs());
+    ASSERT_EQ(&constSpecs->specs(), &cmd2->specs().specs());
+
+    // The commands outlive the specs they were given
+    lcb_subdocspecs_destroy(specs);
+    ASSERT_EQ(2, cmd1->specs().specs().size());
+    ASSERT_EQ("foo", cmd1->specs().specs()[0].path());
+    ASSERT_EQ("bar", cmd2->specs().specs()[1].path());
+
+    lcb_cmdsubdoc_destroy(cmd1);
+    ASSERT_EQ("bar", cmd2->specs().specs()[1].path());
+    lcb_cmdsubdoc_destroy(cmd2);
+}
+
+TEST_F(SubdocSpecsTest, testModifyAfterAttach)
+{
+    lcb_SUBDOCSPECS *specs = nullptr;
+    ASSERT_EQ(LCB_SUCCESS, lcb_subdocspecs_create(&specs, 1));
+    ASSERT_EQ(LCB_SUCCESS, lcb_subdocspecs_get(specs, 0, 0, "foo", 3));
+
+    lcb_CMDSUBDOC *cmd = nullptr;
+    ASSERT_EQ(LCB_SUCCESS, lcb_cmdsubdoc_create(&cmd));
+    ASSERT_EQ(LCB_SUCCESS, lcb_cmdsubdoc_specs(cmd, specs));
+
+    // Changing the specs must not change what was attached already
+    ASSERT_EQ(LCB_SUCCESS, lcb_subdocspecs_get(specs, 0, 0, "baz", 3));
+    const lcb_SUBDOCSPECS *constSpecs = specs;
+    ASSERT_NE(&constSpecs->specs(), &cmd->specs().specs());
+    ASSERT_EQ("baz", constSpecs->specs()[0].path());
+    ASSERT_EQ("foo", cmd->specs().specs()[0].path());
+
+    lcb_subdocspecs_destroy(specs);
+    lcb_cmdsubdoc_destroy(cmd);
+}
+
+TEST_F(SubdocSpecsTest, testEmptySpecs)
+{
+    lcb_CMDSUBDOC *cmd = nullptr;
+    ASSERT_EQ(LCB_SUCCESS, lcb_cmdsubdoc_create(&cmd));
+    ASSERT_TRUE(cmd->specs().specs().empty());
+
+    lcb_SUBDOCSPECS *specs = nullptr;
+    ASSERT_EQ(LCB_SUCCESS, lcb_subdocspecs_create(&specs, 0));
+    ASSERT_EQ(LCB_ERR_INVALID_ARGUMENT, lcb_cmdsubdoc_specs(cmd, specs));
+
+    lcb_subdocspecs_destroy(specs);
+    lcb_cmdsubdoc_destroy(cmd);
+}
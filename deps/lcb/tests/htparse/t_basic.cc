@@ -80,6 +80,44 @@ TEST_F(HtparseTest, testHeaderFunctions)
     lcb_settings_unref(settings);
 }
 
+TEST_F(HtparseTest, testHeaderSplitAcrossReads)
+{
+    lcb_settings *settings = lcb_settings_new();
+    Parser *parser = new Parser(settings);
+
+    string buf = "HTTP/1.1 200 OK\r\n"
+                 "Content-Type: application/json\r\n"
+                 "X-Empty:\r\n"
+                 "Content-Length: 0\r\n"
+                 "\r\n";
+    // Feed one byte at a time, so that every key and value is split
+    unsigned state = 0;
+    for (size_t ii = 0; ii < buf.size(); ii++) {
+        state = parser->parse(buf.c_str() + ii, 1);
+        ASSERT_EQ(0, state & Parser::S_ERROR);
+    }
+    ASSERT_NE(0, state & Parser::S_DONE);
+
+    Response &resp = parser->get_cur_response();
+    ASSERT_EQ(3, resp.headers.size());
+    ASSERT_STREQ("Content-Type", resp.header_key(resp.headers[0]));
+    ASSERT_STREQ("application/json", resp.header_value(resp.headers[0]));
+    ASSERT_EQ(12, resp.headers[0].key_len);
+    ASSERT_EQ(16, resp.headers[0].value_len);
+
+    // Lookups ignore case
+    ASSERT_STREQ("application/json", resp.get_header_value("content-type"));
+    ASSERT_STREQ("0", resp.get_header_value("CONTENT-LENGTH"));
+    ASSERT_STREQ("", resp.get_header_value("X-Empty"));
+    ASSERT_TRUE(resp.get_header_value("Content") == NULL);
+
+    parser->reset();
+    ASSERT_EQ(0, resp.headers.size());
+    ASSERT_TRUE(resp.get_header_value("Content-Type") == NULL);
+    delete parser;
+    lcb_settings_unref(settings);
+}
+
 TEST_F(HtparseTest, testParseErrors)
 {
     lcb_settings *settings = lcb_settings_new();
@@ -0,0 +1,77 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <lcbht/lcbht.h>
+#include <chrono>
+#include "settings.h"
+
+using std::string;
+using namespace lcb::htparse;
+
+/**
+ * Parses the response headers of a typical query service reply over and
+ * over, the way each query, search or analytics request does, and reports
+ * the throughput. The body is parsed with parse_ex() so that only the header
+ * handling is measured.
+ */
+class HtparseBench : public ::testing::Test
+{
+};
+
+TEST_F(HtparseBench, benchResponseHeaders)
+{
+    const size_t nresponses = 100000;
+    const string response = "HTTP/1.1 200 OK\r\n"
+                            "Content-Type: application/json\r\n"
+                            "Date: Tue, 01 Sep 2020 12:00:00 GMT\r\n"
+                            "Transfer-Encoding: chunked\r\n"
+                            "X-Content-Type-Options: nosniff\r\n"
+                            "Cache-Control: no-cache, no-store, must-revalidate\r\n"
+                            "Pragma: no-cache\r\n"
+                            "Server: Couchbase Server\r\n"
+                            "\r\n"
+                            "2\r\n{}\r\n"
+                            "0\r\n\r\n";
+
+    lcb_settings *settings = lcb_settings_new();
+    Parser parser(settings);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t ii = 0; ii < nresponses; ii++) {
+        const char *buf = response.c_str();
+        unsigned nbuf = response.size();
+        unsigned state;
+        do {
+            const char *body;
+            unsigned nused, nbody;
+            state = parser.parse_ex(buf, nbuf, &nused, &nbody, &body);
+            ASSERT_EQ(0, state & Parser::S_ERROR);
+            buf += nused;
+            nbuf -= nused;
+        } while ((state & Parser::S_DONE) == 0 && nbuf);
+        ASSERT_NE(0, state & Parser::S_DONE);
+        ASSERT_STREQ("application/json", parser.get_cur_response().get_header_value("content-type"));
+        parser.reset();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin);
+
+    double secs = elapsed.count() / 1000000.0;
+    fprintf(stderr, "HTTP response headers: %lu responses in %.3fs (%.0f responses/sec)\n",
+            (unsigned long)nresponses, secs, secs > 0 ? nresponses / secs : 0.0);
+    lcb_settings_unref(settings);
+}
@@ -102,9 +102,15 @@ static void genCertificate(SSL_CTX *ctx)
     EVP_PKEY_free(pkey);
 }
 
-SslSocket::SslSocket(SockFD *inner) : SockFD(inner->getFD())
+// All connections share one context (and thus one certificate and session
+// ticket key), so that clients are able to resume their sessions.
+static SSL_CTX *sharedContext()
 {
-    sfd = inner;
+    static SSL_CTX *ctx = nullptr;
+    if (ctx) {
+        return ctx;
+    }
+
     ctx = SSL_CTX_new(SSLv23_server_method());
     assert(ctx != nullptr);
 
@@ -114,6 +120,14 @@ SslSocket::SslSocket(SockFD *inner) : SockFD(inner->getFD())
     SSL_CTX_set_options(ctx, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
     SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
     SSL_CTX_load_verify_locations(ctx, nullptr, nullptr);
+    SSL_CTX_set_session_id_context(ctx, (const unsigned char *)"lcbtest", 7);
+    return ctx;
+}
+
+SslSocket::SslSocket(SockFD *inner) : SockFD(inner->getFD())
+{
+    sfd = inner;
+    ctx = sharedContext();
 
     ssl = SSL_new(ctx);
     assert(ssl != nullptr);
@@ -140,7 +154,6 @@ void SslSocket::close()
 SslSocket::~SslSocket()
 {
     SSL_free(ssl);
-    SSL_CTX_free(ctx);
     delete sfd;
 }
 
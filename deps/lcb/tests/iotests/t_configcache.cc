@@ -21,6 +21,8 @@
 #include "rnd.h"
 
 #include <cstdio>
+#include <fstream>
+#include <iterator>
 
 class ConfigCacheUnitTest : public MockUnitTest
 {
@@ -139,3 +141,75 @@ TEST_F(ConfigCacheUnitTest, testConfigCache)
 
     lcb_createopts_destroy(cropts);
 }
+
+/*
+ * Drop the revision from a cached map. The cluster then always serves a map
+ * which replaces it, rather than one with the same revision, which would not
+ * be applied.
+ */
+static void strip_cached_revision(const std::string &filename)
+{
+    std::ifstream ifs(filename.c_str());
+    std::string contents((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    ifs.close();
+
+    /* the map is followed by the magic marker of the cache file */
+    size_t magic = contents.find("{{{");
+    ASSERT_NE(std::string::npos, magic);
+
+    lcbvb_CONFIG *vbc = lcbvb_create();
+    ASSERT_EQ(0, lcbvb_load_json(vbc, contents.substr(0, magic).c_str()));
+    vbc->revid = -1;
+    char *json = lcbvb_save_json(vbc);
+
+    std::ofstream ofs(filename.c_str(), std::ios::trunc);
+    ofs << json << contents.substr(magic);
+    free(json);
+    lcbvb_destroy(vbc);
+}
+
+TEST_F(ConfigCacheUnitTest, testConfigCacheRevalidate)
+{
+    lcb_INSTANCE *instance;
+    lcb_STATUS err;
+    lcb_CREATEOPTS *cropts = nullptr;
+
+    std::string filename = random_cache_path();
+    MockEnvironment::getInstance()->makeConnectParams(cropts, nullptr);
+
+    // Populate the cache
+    doLcbCreate(&instance, cropts, MockEnvironment::getInstance());
+    err = lcb_cntl(instance, LCB_CNTL_SET, LCB_CNTL_CONFIGCACHE, (void *)filename.c_str());
+    ASSERT_EQ(LCB_SUCCESS, err);
+    ASSERT_EQ(LCB_SUCCESS, lcb_connect(instance));
+    ASSERT_EQ(LCB_SUCCESS, lcb_wait(instance, LCB_WAIT_DEFAULT));
+    lcb_destroy(instance);
+    strip_cached_revision(filename);
+
+    doLcbCreate(&instance, cropts, MockEnvironment::getInstance());
+    err = lcb_cntl(instance, LCB_CNTL_SET, LCB_CNTL_CONFIGCACHE_RO, (void *)filename.c_str());
+    ASSERT_EQ(LCB_SUCCESS, err);
+    int revalidate = 0;
+    err = lcb_cntl(instance, LCB_CNTL_GET, LCB_CNTL_CONFIGCACHE_REVALIDATE, &revalidate);
+    ASSERT_EQ(LCB_SUCCESS, err);
+    ASSERT_NE(0, revalidate);
+
+    ASSERT_EQ(LCB_SUCCESS, lcb_connect(instance));
+    ASSERT_EQ(LCB_SUCCESS, lcb_wait(instance, LCB_WAIT_DEFAULT));
+
+    int is_loaded = 0;
+    lcb_cntl(instance, LCB_CNTL_GET, LCB_CNTL_CONFIG_CACHE_LOADED, &is_loaded);
+    ASSERT_NE(0, is_loaded);
+
+    /* Operations are served from the cached map while it is being replaced,
+     * which takes a single round trip to the cluster */
+    for (int ii = 0; ii < 10 && is_loaded; ii++) {
+        storeKey(instance, "a_key", "a_value");
+        lcb_cntl(instance, LCB_CNTL_GET, LCB_CNTL_CONFIG_CACHE_LOADED, &is_loaded);
+    }
+    ASSERT_EQ(0, is_loaded);
+
+    lcb_destroy(instance);
+    remove(filename.c_str());
+    lcb_createopts_destroy(cropts);
+}
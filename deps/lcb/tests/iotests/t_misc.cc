@@ -304,6 +304,127 @@ TEST_F(MockUnitTest, testOpMetrics)
     lcbmetrics_meter_destroy(meter);
 }
 
+struct KvOpTimingsCookie {
+    size_t called{0};
+    lcb_STATUS timings_rc{LCB_SUCCESS};
+    uint64_t queue_us{0};
+    uint64_t network_us{0};
+    uint64_t server_us{0};
+};
+
+extern "C" {
+static void kv_op_timings_get_cb(lcb_INSTANCE *, lcb_CALLBACK_TYPE, const lcb_RESPGET *resp)
+{
+    KvOpTimingsCookie *cookie;
+    lcb_respget_cookie(resp, (void **)&cookie);
+    ++cookie->called;
+    EXPECT_EQ(LCB_SUCCESS, lcb_respget_status(resp));
+
+    const lcb_KEY_VALUE_ERROR_CONTEXT *ctx = nullptr;
+    lcb_respget_error_context(resp, &ctx);
+    cookie->timings_rc = lcb_errctx_kv_op_timings(ctx, &cookie->queue_us, &cookie->network_us, &cookie->server_us);
+}
+
+static void count_histogram_cb(const void *cookie, lcb_timeunit_t, lcb_U32, lcb_U32, lcb_U32 total, lcb_U32)
+{
+    *(size_t *)cookie += total;
+}
+} // extern "C"
+
+static size_t countHistogram(const lcb_HISTOGRAM *hg)
+{
+    size_t count = 0;
+    if (hg != nullptr) {
+        lcb_histogram_read(hg, &count, count_histogram_cb);
+    }
+    return count;
+}
+
+static void countKvOpTimings(lcb_INSTANCE *instance, size_t *queue, size_t *network)
+{
+    lcb_METRICS *metrics = nullptr;
+    ASSERT_EQ(LCB_SUCCESS, lcb_cntl(instance, LCB_CNTL_GET, LCB_CNTL_METRICS, &metrics));
+    ASSERT_NE(nullptr, metrics);
+
+    *queue = 0;
+    *network = 0;
+    for (size_t ii = 0; ii < metrics->nservers; ii++) {
+        *queue += countHistogram(metrics->servers[ii]->queue_latency);
+        *network += countHistogram(metrics->servers[ii]->network_latency);
+    }
+}
+
+static void getWithKvOpTimings(lcb_INSTANCE *instance, const std::string &key, KvOpTimingsCookie &cookie)
+{
+    lcb_install_callback(instance, LCB_CALLBACK_GET, (lcb_RESPCALLBACK)kv_op_timings_get_cb);
+
+    lcb_CMDGET *cmd;
+    lcb_cmdget_create(&cmd);
+    lcb_cmdget_key(cmd, key.c_str(), key.size());
+    ASSERT_EQ(LCB_SUCCESS, lcb_get(instance, &cookie, cmd));
+    lcb_cmdget_destroy(cmd);
+    lcb_wait(instance, LCB_WAIT_DEFAULT);
+}
+
+TEST_F(MockUnitTest, testKvOpTimings)
+{
+    lcb_INSTANCE *instance;
+    HandleWrap hw;
+
+    // Must be enabled before connecting
+    MockEnvironment::getInstance()->createConnection(hw, &instance);
+    int enable = 1;
+    ASSERT_EQ(LCB_SUCCESS, lcb_cntl(instance, LCB_CNTL_SET, LCB_CNTL_KV_OP_TIMINGS, &enable));
+    ASSERT_EQ(LCB_SUCCESS, lcb_connect(instance));
+    lcb_wait(instance, LCB_WAIT_DEFAULT);
+    ASSERT_EQ(LCB_SUCCESS, lcb_get_bootstrap_status(instance));
+
+    int enabled = 0;
+    ASSERT_EQ(LCB_SUCCESS, lcb_cntl(instance, LCB_CNTL_GET, LCB_CNTL_KV_OP_TIMINGS, &enabled));
+    ASSERT_EQ(1, enabled);
+
+    std::string key("kvOpTimingsKey");
+    storeKey(instance, key, "value");
+
+    size_t queueBefore, networkBefore;
+    countKvOpTimings(instance, &queueBefore, &networkBefore);
+    ASSERT_EQ(queueBefore, networkBefore);
+    ASSERT_GE(queueBefore, 1);
+
+    const size_t numGets = 5;
+    for (size_t ii = 0; ii < numGets; ii++) {
+        KvOpTimingsCookie cookie;
+        getWithKvOpTimings(instance, key, cookie);
+        ASSERT_EQ(1, cookie.called);
+        ASSERT_EQ(LCB_SUCCESS, cookie.timings_rc);
+
+        // Nothing in the breakdown can exceed a generous bound on a local mock
+        ASSERT_LT(cookie.queue_us + cookie.network_us + cookie.server_us, 60 * 1000 * 1000);
+    }
+
+    // Every response is recorded exactly once, into the histograms of the
+    // server which answered it
+    size_t queueAfter, networkAfter;
+    countKvOpTimings(instance, &queueAfter, &networkAfter);
+    ASSERT_EQ(queueBefore + numGets, queueAfter);
+    ASSERT_EQ(networkBefore + numGets, networkAfter);
+}
+
+TEST_F(MockUnitTest, testKvOpTimingsDisabled)
+{
+    lcb_INSTANCE *instance;
+    HandleWrap hw;
+    createConnection(hw, &instance);
+
+    std::string key("kvOpTimingsKey");
+    storeKey(instance, key, "value");
+
+    KvOpTimingsCookie cookie;
+    getWithKvOpTimings(instance, key, cookie);
+    ASSERT_EQ(1, cookie.called);
+    ASSERT_EQ(LCB_ERR_INVALID_ARGUMENT, cookie.timings_rc);
+}
+
 struct async_ctx {
     int count;
     lcbio_pTABLE table;
@@ -89,6 +89,66 @@ TEST_F(SchedUnitTests, testSched)
     lcb_cmdstore_destroy(scmd);
 }
 
+static void schedFlushCallback(lcb_INSTANCE *instance)
+{
+    size_t *nflush = (size_t *)lcb_get_cookie(instance);
+    *nflush += 1;
+}
+
+TEST_F(SchedUnitTests, testSchedFlushCallback)
+{
+    HandleWrap hw;
+    lcb_INSTANCE *instance;
+    size_t counter = 0;
+    size_t nflush = 0;
+    createConnection(hw, &instance);
+
+    lcb_install_callback(instance, LCB_CALLBACK_STORE, (lcb_RESPCALLBACK)opCallback);
+    lcb_set_cookie(instance, &nflush);
+    ASSERT_EQ(NULL, lcb_set_sched_flush_callback(instance, schedFlushCallback));
+
+    int flushMode = 0;
+    ASSERT_EQ(LCB_SUCCESS, lcb_cntl(instance, LCB_CNTL_SET, LCB_CNTL_SCHED_IMPLICIT_FLUSH, &flushMode));
+
+    lcb_CMDSTORE *scmd;
+    lcb_cmdstore_create(&scmd, LCB_STORE_UPSERT);
+    lcb_cmdstore_key(scmd, "key", 3);
+    lcb_cmdstore_value(scmd, "val", 3);
+
+    // Every scheduling context which leaves commands unflushed asks for a flush
+    ASSERT_STATUS_EQ(LCB_SUCCESS, lcb_store(instance, &counter, scmd));
+    ASSERT_EQ(1, nflush);
+    ASSERT_TRUE(hasPendingOps(instance));
+    lcb_sched_flush(instance);
+    lcb_wait(instance, LCB_WAIT_NOCHECK);
+    ASSERT_EQ(1, counter);
+
+    lcb_sched_enter(instance);
+    ASSERT_STATUS_EQ(LCB_SUCCESS, lcb_store(instance, &counter, scmd));
+    ASSERT_STATUS_EQ(LCB_SUCCESS, lcb_store(instance, &counter, scmd));
+    ASSERT_EQ(1, nflush);
+    lcb_sched_leave(instance);
+    ASSERT_EQ(2, nflush);
+    lcb_sched_flush(instance);
+    lcb_wait(instance, LCB_WAIT_NOCHECK);
+    ASSERT_EQ(3, counter);
+
+    // Nothing was queued
+    lcb_sched_enter(instance);
+    lcb_sched_leave(instance);
+    ASSERT_EQ(2, nflush);
+
+    // With implicit flushing the library flushes by itself
+    flushMode = 1;
+    ASSERT_EQ(LCB_SUCCESS, lcb_cntl(instance, LCB_CNTL_SET, LCB_CNTL_SCHED_IMPLICIT_FLUSH, &flushMode));
+    ASSERT_STATUS_EQ(LCB_SUCCESS, lcb_store(instance, &counter, scmd));
+    lcb_wait(instance, LCB_WAIT_NOCHECK);
+    ASSERT_EQ(2, nflush);
+    ASSERT_EQ(4, counter);
+
+    lcb_cmdstore_destroy(scmd);
+}
+
 static void counterCallback(lcb_INSTANCE *, int, const lcb_RESPCOUNTER *resp)
 {
     size_t *counter;
@@ -199,3 +199,34 @@ TEST_F(McFlush, testPartialFlush)
     mcreq_packet_handled(pw.pipeline, pw.pkt);
     ASSERT_EQ(1, cookie.ncalled);
 }
+
+TEST_F(McFlush, testFlushTimestamp)
+{
+    CQWrap cq;
+    PacketWrap pw;
+    MyCookie cookie;
+
+    cq.setBufFreeCallback(buf_free_callback);
+    pw.setContigKey("1234");
+    ASSERT_TRUE(pw.reservePacket(&cq));
+    pw.setCookie(&cookie);
+    cookie.exp_kbuf = pw.pktbuf;
+    pw.setHeaderSize();
+    pw.copyHeader();
+    mcreq_enqueue_packet(pw.pipeline, pw.pkt);
+    ASSERT_EQ(0, MCREQ_PKT_RDATA(pw.pkt)->flushed);
+
+    nb_IOV iovs[10];
+    unsigned toFlush = mcreq_flush_iov_fill(pw.pipeline, iovs, 10, nullptr);
+    mcreq_flush_done_ex(pw.pipeline, 8, toFlush, 0, 100);
+    // Only stamped once the whole packet is written
+    ASSERT_EQ(0, MCREQ_PKT_RDATA(pw.pkt)->flushed);
+
+    toFlush = mcreq_flush_iov_fill(pw.pipeline, iovs, 10, nullptr);
+    mcreq_flush_done_ex(pw.pipeline, toFlush, toFlush, 0, 200);
+    ASSERT_EQ(200, MCREQ_PKT_RDATA(pw.pkt)->flushed);
+
+    mcreq_pipeline_remove(pw.pipeline, pw.pkt->opaque);
+    mcreq_packet_handled(pw.pipeline, pw.pkt);
+    ASSERT_EQ(1, cookie.ncalled);
+}
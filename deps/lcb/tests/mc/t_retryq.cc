@@ -0,0 +1,304 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2011-2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "mctest.h"
+#include "mc/mcreq-flush-inl.h"
+#include "internal.h"
+#include "retryq.h"
+
+#include <vector>
+
+using lcb::RetryQueue;
+
+class McRetryQueue : public ::testing::Test
+{
+};
+
+static int flush_calls[NUM_PIPELINES];
+
+struct RetryCookie {
+    int id;
+    std::vector< int > *failed;
+};
+
+extern "C" {
+static void count_flush(mc_PIPELINE *pipeline)
+{
+    flush_calls[pipeline->index]++;
+}
+
+static void get_callback(lcb_INSTANCE *, int, const lcb_RESPGET *resp)
+{
+    RetryCookie *cookie = nullptr;
+    lcb_respget_cookie(resp, (void **)&cookie);
+    EXPECT_EQ(LCB_ERR_TIMEOUT, lcb_respget_status(resp));
+    cookie->failed->push_back(cookie->id);
+}
+}
+
+/**
+ * Retry queue driven by a bare command queue. The command queue pipelines
+ * never touch the network: flushes are only counted, and whatever the retry
+ * queue hands them is drained by the test.
+ */
+struct RetryQueueWrap {
+    lcb_INSTANCE *instance{nullptr};
+    CQWrap cq;
+    RetryQueue *rq{nullptr};
+    std::vector< PacketWrap * > wrappers;
+    std::vector< RetryCookie * > cookies;
+    std::vector< int > failed;
+
+    RetryQueueWrap()
+    {
+        EXPECT_EQ(LCB_SUCCESS, lcb_create(&instance, nullptr));
+        EXPECT_EQ(LCB_SUCCESS, lcb_cntl_string(instance, "metrics", "true"));
+        lcb_install_callback(instance, LCB_CALLBACK_GET, (lcb_RESPCALLBACK)get_callback);
+        cq.cqdata = instance;
+        /* Responses for failed packets report the bucket name of this map */
+        instance->cmdq.config = cq.config;
+        for (unsigned ii = 0; ii < cq.npipelines; ii++) {
+            cq.pipelines[ii]->flush_start = count_flush;
+            flush_calls[ii] = 0;
+        }
+        rq = new RetryQueue(&cq, instance->iotable, instance->settings);
+    }
+
+    ~RetryQueueWrap()
+    {
+        delete rq;
+        drain();
+        for (auto pw : wrappers) {
+            delete pw;
+        }
+        for (auto cookie : cookies) {
+            delete cookie;
+        }
+        instance->cmdq.config = nullptr;
+        lcb_destroy(instance);
+    }
+
+    lcb_METRICS *metrics() const
+    {
+        return instance->settings->metrics;
+    }
+
+    /**
+     * Create a detached packet for the given key, as the retry queue would
+     * receive it from a failed command.
+     *
+     * @param retries how many times the packet was already retried
+     * @param deadline_ms milliseconds from now until the packet times out,
+     * negative for a packet which is already overdue
+     */
+    mc_EXPACKET *makePacket(const char *key, int id, unsigned retries, int deadline_ms)
+    {
+        auto *pw = new PacketWrap;
+        wrappers.push_back(pw);
+        pw->setCopyKey(key);
+        EXPECT_TRUE(pw->reservePacket(&cq));
+        pw->setHeaderSize();
+        pw->copyHeader();
+
+        auto *cookie = new RetryCookie{id, &failed};
+        cookies.push_back(cookie);
+        pw->setCookie(cookie);
+
+        hrtime_t now = gethrtime();
+        mc_REQDATA *rd = MCREQ_PKT_RDATA(pw->pkt);
+        rd->start = now;
+        rd->deadline = now + (hrtime_t)((int64_t)LCB_MS2NS(1) * deadline_ms);
+        pw->pkt->retries = retries;
+
+        mc_PACKET *copy = mcreq_renew_packet(pw->pkt);
+        mcreq_wipe_packet(pw->pipeline, pw->pkt);
+        mcreq_release_packet(pw->pipeline, pw->pkt);
+        return reinterpret_cast< mc_EXPACKET * >(copy);
+    }
+
+    /** Identifiers of the packets enqueued to the pipeline, in order */
+    std::vector< int > enqueued(mc_PIPELINE *pipeline) const
+    {
+        std::vector< int > ids;
+        sllist_node *ll;
+        SLLIST_FOREACH(&pipeline->requests, ll)
+        {
+            mc_PACKET *pkt = SLLIST_ITEM(ll, mc_PACKET, slnode);
+            ids.push_back(static_cast< const RetryCookie * >(MCREQ_PKT_COOKIE(pkt))->id);
+        }
+        return ids;
+    }
+
+    void drain()
+    {
+        for (unsigned ii = 0; ii < cq.npipelines; ii++) {
+            mc_PIPELINE *pipeline = cq.pipelines[ii];
+            nb_IOV iovs[16];
+            unsigned toFlush;
+            while ((toFlush = mcreq_flush_iov_fill(pipeline, iovs, 16, nullptr)) != 0) {
+                mcreq_flush_done(pipeline, toFlush, toFlush);
+            }
+        }
+        cq.clearPipelines();
+    }
+
+    RetryQueueWrap(RetryQueueWrap &);
+};
+
+static int vbucket_of(mc_EXPACKET *pkt)
+{
+    protocol_binary_request_header hdr;
+    mcreq_read_hdr(&pkt->base, &hdr);
+    return ntohs(hdr.request.vbucket);
+}
+
+TEST_F(McRetryQueue, testRetryTimeOrdering)
+{
+    RetryQueueWrap rw;
+
+    /* Retry times grow with the number of retries: 4, 1, 3 and 2 intervals */
+    const unsigned retries[] = {3, 0, 2, 1};
+    mc_PIPELINE *pipeline = nullptr;
+    for (int ii = 0; ii < 4; ii++) {
+        mc_EXPACKET *pkt = rw.makePacket("retry_key", ii, retries[ii], 10000);
+        rw.rq->add(pkt, LCB_ERR_NETWORK, PROTOCOL_BINARY_RESPONSE_UNSPECIFIED, nullptr);
+        pipeline = rw.cq.pipelines[lcbvb_vbmaster(rw.cq.config, vbucket_of(pkt))];
+    }
+    ASSERT_FALSE(rw.rq->empty());
+
+    rw.rq->signal();
+    ASSERT_TRUE(rw.rq->empty());
+    ASSERT_TRUE(rw.failed.empty());
+
+    std::vector< int > expected = {1, 3, 2, 0};
+    ASSERT_EQ(expected, rw.enqueued(pipeline));
+    /* Everything went to one pipeline, which is flushed once */
+    ASSERT_EQ(1, flush_calls[pipeline->index]);
+}
+
+TEST_F(McRetryQueue, testEqualRetryTimesKeepInsertionOrder)
+{
+    RetryQueueWrap rw;
+
+    mc_PIPELINE *pipeline = nullptr;
+    for (int ii = 0; ii < 5; ii++) {
+        mc_EXPACKET *pkt = rw.makePacket("fifo_key", ii, 0, 10000);
+        rw.rq->add(pkt, LCB_ERR_NETWORK, PROTOCOL_BINARY_RESPONSE_UNSPECIFIED, nullptr);
+        pipeline = rw.cq.pipelines[lcbvb_vbmaster(rw.cq.config, vbucket_of(pkt))];
+    }
+    rw.rq->signal();
+
+    std::vector< int > expected = {0, 1, 2, 3, 4};
+    ASSERT_EQ(expected, rw.enqueued(pipeline));
+}
+
+TEST_F(McRetryQueue, testDeadlineOrdering)
+{
+    RetryQueueWrap rw;
+
+    /* Packets 3 and 1 are overdue and sit in the middle of the retry heap */
+    const int deadlines[] = {10000, -2, 10000, -3, 10000};
+    mc_PIPELINE *pipeline = nullptr;
+    for (int ii = 0; ii < 5; ii++) {
+        mc_EXPACKET *pkt = rw.makePacket("deadline_key", ii, 0, deadlines[ii]);
+        rw.rq->add(pkt, LCB_ERR_NETWORK, PROTOCOL_BINARY_RESPONSE_UNSPECIFIED, nullptr);
+        pipeline = rw.cq.pipelines[lcbvb_vbmaster(rw.cq.config, vbucket_of(pkt))];
+    }
+    ASSERT_EQ(5, rw.metrics()->retry_queue_depth);
+
+    rw.rq->signal();
+    ASSERT_TRUE(rw.rq->empty());
+
+    std::vector< int > expected_failed = {3, 1};
+    ASSERT_EQ(expected_failed, rw.failed);
+
+    /* The remaining packets keep their retry ordering */
+    std::vector< int > expected_flushed = {0, 2, 4};
+    ASSERT_EQ(expected_flushed, rw.enqueued(pipeline));
+}
+
+TEST_F(McRetryQueue, testQueueDepthCounters)
+{
+    RetryQueueWrap rw;
+
+    std::vector< mc_EXPACKET * > pkts;
+    for (int ii = 0; ii < 3; ii++) {
+        pkts.push_back(rw.makePacket("depth_key", ii, 0, 10000));
+        rw.rq->add(pkts.back(), LCB_ERR_NETWORK, PROTOCOL_BINARY_RESPONSE_UNSPECIFIED, nullptr);
+    }
+    lcb_METRICS *metrics = rw.metrics();
+    ASSERT_EQ(3, metrics->retry_queue_depth);
+    ASSERT_EQ(3, metrics->retry_queue_max_depth);
+    ASSERT_EQ(3, metrics->packets_retried);
+
+    /* Retrying a queued packet again moves it rather than queueing it twice */
+    rw.rq->add(pkts[1], LCB_ERR_NETWORK, PROTOCOL_BINARY_RESPONSE_UNSPECIFIED, nullptr);
+    ASSERT_EQ(3, metrics->retry_queue_depth);
+    ASSERT_EQ(3, metrics->retry_queue_max_depth);
+    ASSERT_EQ(4, metrics->packets_retried);
+
+    rw.rq->signal();
+    ASSERT_TRUE(rw.rq->empty());
+    ASSERT_EQ(0, metrics->retry_queue_depth);
+    ASSERT_EQ(3, metrics->retry_queue_max_depth);
+}
+
+TEST_F(McRetryQueue, testUnparkOnConfigChange)
+{
+    RetryQueueWrap rw;
+
+    std::vector< mc_EXPACKET * > moved;
+    for (int ii = 0; ii < 3; ii++) {
+        moved.push_back(rw.makePacket("moved_key", ii, 0, 10000));
+        rw.rq->nmvadd(moved.back());
+    }
+    mc_EXPACKET *stays = rw.makePacket("stays_key", 3, 0, 10000);
+    rw.rq->nmvadd(stays);
+
+    int vbid = vbucket_of(moved[0]);
+    int stays_vbid = vbucket_of(stays);
+    ASSERT_NE(vbid, stays_vbid);
+    lcb_METRICS *metrics = rw.metrics();
+    ASSERT_EQ(4, metrics->retry_queue_depth);
+
+    /* Same topology, with only the first vBucket moved to another node */
+    lcbvb_CONFIG *newconfig = lcbvb_create();
+    ASSERT_EQ(0, lcbvb_genconfig(newconfig, NUM_PIPELINES, 3, 1024));
+    int oldix = lcbvb_vbmaster(rw.cq.config, vbid);
+    int newix = (oldix + 1) % NUM_PIPELINES;
+    newconfig->vbuckets[vbid].servers[0] = newix;
+
+    rw.rq->config_changed(rw.cq.config, newconfig);
+    lcbvb_destroy(newconfig);
+
+    std::vector< int > expected = {0, 1, 2};
+    ASSERT_EQ(expected, rw.enqueued(rw.cq.pipelines[newix]));
+    ASSERT_EQ(1, flush_calls[newix]);
+    ASSERT_TRUE(rw.enqueued(rw.cq.pipelines[oldix]).empty());
+    ASSERT_EQ(3, metrics->packets_nmv_redirected);
+    ASSERT_EQ(1, metrics->retry_queue_depth);
+    ASSERT_FALSE(rw.rq->empty());
+
+    /* The packet whose vBucket did not move waits for the regular retry */
+    rw.rq->signal();
+    ASSERT_TRUE(rw.rq->empty());
+    ASSERT_EQ(0, metrics->retry_queue_depth);
+    std::vector< int > expected_stays = {3};
+    ASSERT_EQ(expected_stays, rw.enqueued(rw.cq.pipelines[lcbvb_vbmaster(rw.cq.config, stays_vbid)]));
+    ASSERT_EQ(3, metrics->packets_nmv_redirected);
+    ASSERT_TRUE(rw.failed.empty());
+}
@@ -114,6 +114,43 @@ TEST_F(RopeTest, testConsolidatedReadAhead)
     ASSERT_EQ(*(char *)iovs[2].iov_base, '8');
 }
 
+// A large packet whose header has arrived should be read into one buffer of
+// exactly the packet's size, without consolidating it afterwards.
+TEST_F(RopeTest, testReserveContig)
+{
+    IORope ior(rdb_chunkalloc_new(16));
+    ior.rdsize = 256;
+
+    const unsigned pktsize = 100000;
+    string header(24, 'H');
+    string body(pktsize - header.size(), 'B');
+
+    // Only part of the header is in the first segment
+    ior.feed(header.substr(0, 8));
+    ior.feed(header.substr(8));
+    ASSERT_LT(rdb_get_contigsize(&ior), header.size());
+
+    rdb_reserve_contig(&ior, pktsize);
+    rdb_ROPESEG *seg = rdb_get_first_segment(&ior);
+    ASSERT_EQ(pktsize, seg->nalloc);
+    ASSERT_EQ(header.size(), rdb_get_contigsize(&ior));
+
+    // Subsequent reads land in the reserved segment
+    nb_IOV iov;
+    ASSERT_EQ(1, rdb_rdstart(&ior, &iov, 1));
+    ASSERT_EQ(pktsize - header.size(), iov.iov_len);
+
+    ior.feed(body);
+    ASSERT_EQ(pktsize, rdb_get_contigsize(&ior));
+    ASSERT_EQ(seg, rdb_get_first_segment(&ior));
+    ASSERT_EQ(RDB_SEG_RBUF(seg), rdb_get_consolidated(&ior, pktsize));
+    ASSERT_EQ(header + body, ior.stlstr(pktsize));
+
+    // Reserving room that already exists changes nothing
+    rdb_reserve_contig(&ior, 10);
+    ASSERT_EQ(seg, rdb_get_first_segment(&ior));
+}
+
 // When I was integrating this into LCBIO, I realized this scenario. Trying to
 // figure out what the intended outcome is.
 // Apparently this cannot work because we can't consume a buffer which is also
@@ -0,0 +1,135 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "rdbtest.h"
+#include <slab/slab.h>
+#include <thread>
+
+class SlabTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        lcb_slab_get_limits(&pool_limit, &thread_limit);
+    }
+
+    void TearDown() override
+    {
+        lcb_slab_set_limits(pool_limit, thread_limit);
+    }
+
+    size_t pool_limit{0};
+    size_t thread_limit{0};
+};
+
+TEST_F(SlabTest, testSizeClasses)
+{
+    size_t capacity;
+    void *ptr = lcb_slab_alloc(1, &capacity);
+    ASSERT_EQ(LCB_SLAB_MIN_SIZE, capacity);
+    lcb_slab_free(ptr, capacity);
+
+    ptr = lcb_slab_alloc(LCB_SLAB_MIN_SIZE + 1, &capacity);
+    ASSERT_EQ(LCB_SLAB_MIN_SIZE * 2, capacity);
+    lcb_slab_free(ptr, capacity);
+
+    // Too big to pool
+    ptr = lcb_slab_alloc(LCB_SLAB_MAX_SIZE + 1, &capacity);
+    ASSERT_EQ(LCB_SLAB_MAX_SIZE + 1, capacity);
+    lcb_BUFFER_POOL_STATS before, after;
+    lcb_slab_get_stats(&before);
+    lcb_slab_free(ptr, capacity);
+    lcb_slab_get_stats(&after);
+    ASSERT_EQ(before.bytes_pooled, after.bytes_pooled);
+    ASSERT_EQ(before.bytes_released + capacity, after.bytes_released);
+}
+
+TEST_F(SlabTest, testReuse)
+{
+    RdbAllocator a(rdb_slaballoc_new());
+    rdb_ROPESEG *seg = a.alloc(4000);
+    ASSERT_EQ(4096, seg->nalloc);
+    char *root = seg->root;
+    a.free(seg);
+
+    lcb_BUFFER_POOL_STATS before, after;
+    lcb_slab_get_stats(&before);
+    seg = a.alloc(3000);
+    lcb_slab_get_stats(&after);
+    ASSERT_EQ(root, seg->root);
+    ASSERT_EQ(before.hits + 1, after.hits);
+    ASSERT_EQ(before.allocations + 1, after.allocations);
+    ASSERT_EQ(before.bytes_pooled - 4096, after.bytes_pooled);
+
+    // Growing keeps the contents
+    memcpy(seg->root, "Hello", 5);
+    seg = a.realloc(seg, 10000);
+    ASSERT_EQ(16384, seg->nalloc);
+    ASSERT_EQ(0, memcmp(seg->root, "Hello", 5));
+    a.free(seg);
+    a.release();
+}
+
+TEST_F(SlabTest, testLimits)
+{
+    lcb_slab_trim();
+    lcb_slab_set_limits(0, 0);
+
+    lcb_BUFFER_POOL_STATS before, after;
+    size_t capacity;
+    void *ptr = lcb_slab_alloc(LCB_SLAB_MIN_SIZE, &capacity);
+    lcb_slab_get_stats(&before);
+    lcb_slab_free(ptr, capacity);
+    lcb_slab_get_stats(&after);
+    ASSERT_EQ(before.bytes_pooled, after.bytes_pooled);
+    ASSERT_EQ(before.bytes_released + capacity, after.bytes_released);
+
+    // Without a thread cache, buffers go straight to the shared pool
+    lcb_slab_set_limits(capacity, 0);
+    void *ptrs[2];
+    ptrs[0] = lcb_slab_alloc(capacity, &capacity);
+    ptrs[1] = lcb_slab_alloc(capacity, &capacity);
+    lcb_slab_get_stats(&before);
+    lcb_slab_free(ptrs[0], capacity);
+    lcb_slab_free(ptrs[1], capacity);
+    lcb_slab_get_stats(&after);
+    ASSERT_EQ(before.bytes_pooled + capacity, after.bytes_pooled);
+    ASSERT_EQ(before.bytes_released + capacity, after.bytes_released);
+
+    lcb_slab_trim();
+    lcb_slab_get_stats(&after);
+    ASSERT_EQ(before.bytes_released + capacity * 2, after.bytes_released);
+}
+
+TEST_F(SlabTest, testThreadExit)
+{
+    lcb_slab_trim();
+    lcb_slab_set_limits(LCB_SLAB_DEFAULT_POOL_LIMIT, LCB_SLAB_DEFAULT_THREAD_LIMIT);
+
+    void *ptr = nullptr;
+    size_t capacity = 0;
+    std::thread([&ptr, &capacity]() {
+        ptr = lcb_slab_alloc(LCB_SLAB_MAX_SIZE, &capacity);
+        lcb_slab_free(ptr, capacity);
+    }).join();
+
+    // The exiting thread handed its cache over to the shared pool
+    size_t reused;
+    void *other = lcb_slab_alloc(LCB_SLAB_MAX_SIZE, &reused);
+    ASSERT_EQ(ptr, other);
+    lcb_slab_free(other, reused);
+}
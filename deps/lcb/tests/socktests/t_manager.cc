@@ -160,3 +160,104 @@ TEST_F(SockMgrTest, testMaxIdle)
         delete otherSocks[ii];
     }
 }
+
+/** Breaks the loop once the pool holds a given number of idle connections */
+class IdleConnections : public BreakCondition
+{
+  public:
+    IdleConnections(lcb::io::Pool *pool_, unsigned wanted_) : pool(pool_), wanted(wanted_) {}
+
+    /* toJSON() lists idle and connecting sockets, but not leased ones */
+    unsigned count()
+    {
+        Json::Value node;
+        pool->toJSON(gethrtime(), node);
+        unsigned n = 0;
+        for (const auto &svc : node) {
+            for (const auto &endpoint : svc) {
+                n += endpoint["status"].asString() == "connected" ? 1 : 0;
+            }
+        }
+        return n;
+    }
+
+  protected:
+    bool shouldBreakImpl() override
+    {
+        return count() >= wanted;
+    }
+
+  private:
+    lcb::io::Pool *pool;
+    unsigned wanted;
+};
+
+TEST_F(SockMgrTest, testMinIdle)
+{
+    lcb_host_t host = {0};
+    loop->populateHost(&host);
+    std::map<string, unsigned> min_idle;
+    min_idle[string(host.host) + ":" + host.port] = 2;
+    loop->sockpool->set_min_idle(min_idle, LCB_MS2US(1000));
+
+    // Connections are opened without anyone asking for them
+    IdleConnections prewarmed(loop->sockpool, 2);
+    loop->setBreakCondition(&prewarmed);
+    loop->start();
+    ASSERT_TRUE(prewarmed.didBreak());
+
+    // Leasing one of them opens a replacement
+    ESocket *sock1 = new ESocket();
+    loop->connectPooled(sock1);
+    ASSERT_FALSE(sock1->sock == NULL);
+
+    IdleConnections replaced(loop->sockpool, 2);
+    loop->setBreakCondition(&replaced);
+    loop->start();
+    ASSERT_TRUE(replaced.didBreak());
+    delete sock1;
+
+    loop->sockpool->set_min_idle(std::map<string, unsigned>(), 0);
+}
+
+struct PoolWaiter {
+    Loop *loop;
+    lcbio_SOCKET *sock;
+    int calls;
+};
+extern "C" {
+static void waiter_cb(lcbio_SOCKET *sock, void *arg, lcb_STATUS, lcbio_OSERR)
+{
+    PoolWaiter *w = (PoolWaiter *)arg;
+    w->calls++;
+    w->sock = sock;
+    if (sock) {
+        lcbio_ref(sock);
+    }
+    w->loop->stop();
+}
+}
+
+TEST_F(SockMgrTest, testMaxTotal)
+{
+    loop->sockpool->get_options().maxtotal = 1;
+    lcb_host_t host = {0};
+    loop->populateHost(&host);
+
+    ESocket *sock1 = new ESocket();
+    loop->connectPooled(sock1);
+    lcbio_SOCKET *rawsock = sock1->sock;
+    ASSERT_FALSE(rawsock == NULL);
+
+    // At the limit, so this waits for the first connection to be released
+    PoolWaiter waiter = {loop, NULL, 0};
+    lcb::io::ConnectionRequest *req = loop->sockpool->get(host, LCB_MS2US(1000), waiter_cb, &waiter);
+    ASSERT_FALSE(req == NULL);
+    ASSERT_EQ(0, waiter.calls);
+
+    delete sock1;
+    loop->start();
+    ASSERT_EQ(1, waiter.calls);
+    ASSERT_EQ(rawsock, waiter.sock);
+    lcb::io::Pool::put(waiter.sock);
+}
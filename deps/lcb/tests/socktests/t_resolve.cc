@@ -0,0 +1,207 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "socktest.h"
+#include <lcbio/resolve.h>
+#include <chrono>
+#include <thread>
+using namespace LCBTest;
+using namespace lcb::io;
+
+/* Reserved by RFC 2606, so it never resolves for real */
+#define STUB_HOST "resolver-stub.invalid"
+
+/**
+ * Instead of depending on a particular resolver configuration, these tests
+ * mostly seed the address cache with the entries they need, which acts as a
+ * stub resolver for the connections they make.
+ */
+class ResolveTest : public SockTest
+{
+  protected:
+    void SetUp() override
+    {
+        SockTest::SetUp();
+        loop->settings->ipv6 = LCB_IPV6_DISABLED;
+        dns_cache_clear();
+    }
+
+    void TearDown() override
+    {
+        dns_cache_clear();
+        SockTest::TearDown();
+    }
+
+    static addrinfo *mkaddr(int family, const char *ip, int port, addrinfo *next = nullptr)
+    {
+        auto *ai = new addrinfo();
+        ai->ai_family = family;
+        ai->ai_socktype = SOCK_STREAM;
+        ai->ai_next = next;
+        if (family == AF_INET) {
+            auto *sin = new sockaddr_in();
+            sin->sin_family = AF_INET;
+            sin->sin_port = htons(port);
+            inet_pton(AF_INET, ip, &sin->sin_addr);
+            ai->ai_addr = reinterpret_cast<sockaddr *>(sin);
+            ai->ai_addrlen = sizeof(*sin);
+        } else {
+            auto *sin6 = new sockaddr_in6();
+            sin6->sin6_family = AF_INET6;
+            sin6->sin6_port = htons(port);
+            inet_pton(AF_INET6, ip, &sin6->sin6_addr);
+            ai->ai_addr = reinterpret_cast<sockaddr *>(sin6);
+            ai->ai_addrlen = sizeof(*sin6);
+        }
+        return ai;
+    }
+
+    static void freeaddr(addrinfo *ai)
+    {
+        while (ai) {
+            addrinfo *next = ai->ai_next;
+            if (ai->ai_family == AF_INET) {
+                delete reinterpret_cast<sockaddr_in *>(ai->ai_addr);
+            } else {
+                delete reinterpret_cast<sockaddr_in6 *>(ai->ai_addr);
+            }
+            delete ai;
+            ai = next;
+        }
+    }
+};
+
+TEST_F(ResolveTest, testInterleavedFamilies)
+{
+    addrinfo *list = mkaddr(AF_INET6, "::1", 11210,
+                            mkaddr(AF_INET6, "::2", 11210,
+                                   mkaddr(AF_INET6, "::3", 11210,
+                                          mkaddr(AF_INET, "127.0.0.1", 11210, mkaddr(AF_INET, "127.0.0.2", 11210)))));
+    dns_cache_put(STUB_HOST, "11210", AF_UNSPEC, list, LCB_MS2US(10000));
+    freeaddr(list);
+
+    addrinfo *res = dns_cache_get(STUB_HOST, "11210", AF_UNSPEC);
+    ASSERT_FALSE(res == nullptr);
+
+    int expected[] = {AF_INET6, AF_INET, AF_INET6, AF_INET, AF_INET6};
+    size_t count = 0;
+    for (addrinfo *cur = res; cur; cur = cur->ai_next, count++) {
+        ASSERT_LT(count, sizeof(expected) / sizeof(expected[0]));
+        ASSERT_EQ(expected[count], cur->ai_family);
+    }
+    ASSERT_EQ(5, count);
+    addrinfo_free(res);
+
+    // Entries are per family
+    ASSERT_TRUE(dns_cache_get(STUB_HOST, "11210", AF_INET) == nullptr);
+}
+
+TEST_F(ResolveTest, testExpiry)
+{
+    addrinfo *list = mkaddr(AF_INET, "127.0.0.1", 11210);
+    dns_cache_put(STUB_HOST, "11210", AF_INET, list, 1);
+    dns_cache_put(STUB_HOST, "11211", AF_INET, list, 0);
+    freeaddr(list);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    ASSERT_TRUE(dns_cache_get(STUB_HOST, "11210", AF_INET) == nullptr);
+    // A zero TTL is never cached
+    ASSERT_TRUE(dns_cache_get(STUB_HOST, "11211", AF_INET) == nullptr);
+}
+
+TEST_F(ResolveTest, testConnectCached)
+{
+    lcb_host_t host = {0};
+    loop->populateHost(&host);
+
+    addrinfo *list = mkaddr(AF_INET, host.host, atoi(host.port));
+    strcpy(host.host, STUB_HOST);
+    dns_cache_put(host.host, host.port, AF_INET, list, LCB_MS2US(10000));
+    freeaddr(list);
+
+    ESocket sock;
+    loop->connect(&sock, &host);
+    ASSERT_FALSE(sock.sock == nullptr);
+    sock.close();
+}
+
+TEST_F(ResolveTest, testRefusedForgetsAddress)
+{
+    lcb_host_t host = {0};
+    strcpy(host.host, STUB_HOST);
+    strcpy(host.port, "1");
+
+    addrinfo *list = mkaddr(AF_INET, "127.0.0.1", 1);
+    dns_cache_put(host.host, host.port, AF_INET, list, LCB_MS2US(10000));
+    freeaddr(list);
+
+    ESocket sock;
+    loop->connect(&sock, &host, 1000);
+    ASSERT_TRUE(sock.sock == nullptr);
+    ASSERT_TRUE(dns_cache_get(host.host, host.port, AF_INET) == nullptr);
+}
+
+struct LookupResult {
+    int calls{0};
+    int status{-1};
+    addrinfo *ai{nullptr};
+};
+
+extern "C" {
+static void lookup_cb(void *arg, int status, addrinfo *ai)
+{
+    auto *res = reinterpret_cast<LookupResult *>(arg);
+    res->calls++;
+    res->status = status;
+    res->ai = ai;
+}
+}
+
+TEST_F(ResolveTest, testAsyncLookup)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICHOST;
+
+    LookupResult res;
+    ResolveRequest *req = resolve_start(loop->iot, "127.0.0.1", "11210", &hints, lookup_cb, &res);
+    ASSERT_FALSE(req == nullptr);
+    // Never completes before returning, even for numeric addresses
+    ASSERT_EQ(0, res.calls);
+
+    loop->start();
+    ASSERT_EQ(1, res.calls);
+    ASSERT_EQ(0, res.status);
+    ASSERT_FALSE(res.ai == nullptr);
+    ASSERT_EQ(AF_INET, res.ai->ai_family);
+    addrinfo_free(res.ai);
+}
+
+TEST_F(ResolveTest, testCancelLookup)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICHOST;
+
+    LookupResult res;
+    ResolveRequest *req = resolve_start(loop->iot, "127.0.0.1", "11210", &hints, lookup_cb, &res);
+    resolve_cancel(req);
+    loop->start();
+    ASSERT_EQ(0, res.calls);
+}
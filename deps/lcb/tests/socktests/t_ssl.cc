@@ -42,6 +42,11 @@ class SSLTest : public SockTest
 
     void TearDown() override
     {
+        // Set by tests which count handshakes
+        if (loop->settings->metrics != nullptr) {
+            lcb_metrics_destroy(loop->settings->metrics);
+            loop->settings->metrics = nullptr;
+        }
         lcbio_ssl_free(loop->settings->ssl_ctx);
         loop->settings->ssl_ctx = nullptr;
         SockTest::TearDown();
@@ -91,6 +96,36 @@ TEST_F(SSLTest, testBasic)
     sock.close();
 }
 
+TEST_F(SSLTest, testSessionResumption)
+{
+    lcb_METRICS *metrics = lcb_metrics_new();
+    loop->settings->metrics = metrics;
+
+    for (int ii = 0; ii < 3; ii++) {
+        ESocket sock;
+        loop->connect(&sock);
+        ASSERT_FALSE(sock.sock == nullptr);
+
+        // Reading application data also processes any session tickets
+        // which the server sent after the handshake.
+        string recvStr("Hello World!");
+        SendFuture sf(recvStr);
+        ReadBreakCondition rbc(&sock, recvStr.size());
+        sock.conn->setSend(&sf);
+        sock.reqrd(recvStr.size());
+        sock.schedule();
+        loop->setBreakCondition(&rbc);
+        loop->start();
+        sf.wait();
+        ASSERT_TRUE(sf.isOk());
+        ASSERT_EQ(recvStr, sock.getReceived());
+        sock.close();
+    }
+
+    ASSERT_EQ(1, metrics->ssl_full_handshakes);
+    ASSERT_EQ(2, metrics->ssl_sessions_resumed);
+}
+
 #else
 class SSLTest : public ::testing::Test
 {
@@ -0,0 +1,165 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "socktest.h"
+
+#ifndef LCB_NO_SSL
+
+#include <lcbio/ssl.h>
+#include <netbuf/netbuf.h>
+#include <chrono>
+using namespace LCBTest;
+using std::string;
+using std::vector;
+
+/**
+ * Pushes a stream of small key-value shaped writes through a TLS connection
+ * to the loopback test server and reports the throughput. Each operation is
+ * handed to the socket as three separate buffers (header, key and value) the
+ * same way netbuf_start_flush() hands over memcached packets.
+ */
+
+class SSLBenchActions : public IOActions
+{
+  public:
+    nb_MGR mgr;
+
+    SSLBenchActions()
+    {
+        netbuf_init(&mgr, nullptr);
+    }
+
+    ~SSLBenchActions() override
+    {
+        netbuf_cleanup(&mgr);
+    }
+
+    void onFlushReady(ESocket *s) override
+    {
+        int ready = 1;
+        nb_SIZE nbytes = 0;
+
+        while (ready) {
+            nb_IOV iovs[32];
+            lcb_IOV lciovs[32];
+            int niov = 0;
+
+            nbytes = netbuf_start_flush(&mgr, iovs, 32, &niov);
+            if (!nbytes) {
+                break;
+            }
+            for (int ii = 0; ii < niov; ii++) {
+                lciovs[ii].iov_base = iovs[ii].iov_base;
+                lciovs[ii].iov_len = iovs[ii].iov_len;
+            }
+            ready = lcbio_ctx_put_ex(s->ctx, lciovs, niov, nbytes);
+        }
+
+        if (nbytes) {
+            lcbio_ctx_wwant(s->ctx);
+            s->schedule();
+        }
+    }
+
+    void onFlushDone(ESocket *, size_t expected, size_t nflushed) override
+    {
+        netbuf_end_flush(&mgr, nflushed);
+        if (expected != nflushed) {
+            netbuf_reset_flush(&mgr);
+        }
+    }
+};
+
+class SSLBenchTest : public SockTest
+{
+  protected:
+    void SetUp() override
+    {
+        lcbio_ssl_global_init();
+        lcb_STATUS errp = LCB_SUCCESS;
+
+        SockTest::SetUp();
+        loop->settings->sslopts = LCB_SSL_ENABLED | LCB_SSL_NOVERIFY;
+        loop->settings->ssl_ctx = lcbio_ssl_new(nullptr, nullptr, nullptr, 1, &errp, loop->settings);
+        loop->server->factory = TestServer::sslSocketFactory;
+        EXPECT_FALSE(loop->settings->ssl_ctx == nullptr) << lcb_strerror_short(errp);
+    }
+
+    void TearDown() override
+    {
+        lcbio_ssl_free(loop->settings->ssl_ctx);
+        loop->settings->ssl_ctx = nullptr;
+        SockTest::TearDown();
+    }
+};
+
+TEST_F(SSLBenchTest, benchSmallWrites)
+{
+    const size_t nops = 20000;
+    const string header(24, 'H');
+    const string value(64, 'V');
+
+    vector< string > keys;
+    string expected;
+    keys.reserve(nops);
+    for (size_t ii = 0; ii < nops; ii++) {
+        keys.push_back("key_" + std::to_string(ii));
+        expected += header + keys.back() + value;
+    }
+
+    SSLBenchActions actions;
+    ESocket sock;
+    sock.setActions(&actions);
+    loop->connect(&sock);
+    ASSERT_FALSE(sock.sock == nullptr);
+
+    for (size_t ii = 0; ii < nops; ii++) {
+        nb_IOV iov;
+        iov.iov_base = const_cast< char * >(header.data());
+        iov.iov_len = header.size();
+        netbuf_enqueue(&actions.mgr, &iov, nullptr);
+        iov.iov_base = const_cast< char * >(keys[ii].data());
+        iov.iov_len = keys[ii].size();
+        netbuf_enqueue(&actions.mgr, &iov, nullptr);
+        iov.iov_base = const_cast< char * >(value.data());
+        iov.iov_len = value.size();
+        netbuf_enqueue(&actions.mgr, &iov, nullptr);
+    }
+
+    RecvFuture rf(expected.size());
+    FutureBreakCondition wbc(&rf);
+    sock.conn->setRecv(&rf);
+
+    auto begin = std::chrono::steady_clock::now();
+    lcbio_ctx_wwant(sock.ctx);
+    sock.schedule();
+    loop->setBreakCondition(&wbc);
+    loop->start();
+    rf.wait();
+    auto elapsed = std::chrono::duration_cast< std::chrono::microseconds >(std::chrono::steady_clock::now() - begin);
+
+    ASSERT_TRUE(rf.isOk());
+    ASSERT_EQ(expected, rf.getString());
+
+    double secs = elapsed.count() / 1000000.0;
+    fprintf(stderr, "TLS small writes: %lu ops in %.3fs (%.0f ops/sec)\n", (unsigned long)nops, secs,
+            secs > 0 ? nops / secs : 0.0);
+
+    sock.close();
+}
+
+#endif
@@ -21,6 +21,7 @@
 #include <fstream>
 #include <vector>
 #include <map>
+#include <chrono>
 #include "contrib/lcb-jsoncpp/lcb-jsoncpp.h"
 #include "check_config.h"
 #include "contrib/cJSON/cJSON.h"
@@ -208,6 +209,54 @@ TEST_F(ConfigTest, testGetReplicaNode)
     lcbvb_destroy(cfg);
 }
 
+static lcbvb_CHANGETYPE diffChangetype(lcbvb_CONFIG *from, lcbvb_CONFIG *to)
+{
+    lcbvb_CONFIGDIFF *diff = lcbvb_compare(from, to);
+    lcbvb_CHANGETYPE ret = lcbvb_get_changetype(diff);
+    lcbvb_free_diff(diff);
+    return ret;
+}
+
+TEST_F(ConfigTest, testCompareChangetype)
+{
+    lcbvb_CONFIG *cfg_old = lcbvb_create();
+    lcbvb_genconfig(cfg_old, 4, 1, 1024);
+
+    lcbvb_CONFIG *cfg_new = lcbvb_create();
+    lcbvb_genconfig(cfg_new, 4, 1, 1024);
+    ASSERT_EQ(LCBVB_NO_CHANGES, lcbvb_compare_changetype(cfg_old, cfg_new));
+    ASSERT_EQ(diffChangetype(cfg_old, cfg_new), lcbvb_compare_changetype(cfg_old, cfg_new));
+
+    // Move a replica
+    cfg_new->vbuckets[1023].servers[1] = (cfg_new->vbuckets[1023].servers[1] + 1) % 4;
+    ASSERT_EQ(LCBVB_MAP_MODIFIED, lcbvb_compare_changetype(cfg_old, cfg_new));
+    ASSERT_EQ(diffChangetype(cfg_old, cfg_new), lcbvb_compare_changetype(cfg_old, cfg_new));
+
+    // Move a master
+    cfg_new->vbuckets[1023].servers[1] = cfg_old->vbuckets[1023].servers[1];
+    cfg_new->vbuckets[0].servers[0] = (cfg_new->vbuckets[0].servers[0] + 1) % 4;
+    ASSERT_EQ(LCBVB_MAP_MODIFIED, lcbvb_compare_changetype(cfg_old, cfg_new));
+    ASSERT_EQ(diffChangetype(cfg_old, cfg_new), lcbvb_compare_changetype(cfg_old, cfg_new));
+    lcbvb_destroy(cfg_new);
+
+    // Add a node and a replica
+    cfg_new = lcbvb_create();
+    lcbvb_genconfig(cfg_new, 5, 2, 1024);
+    ASSERT_EQ(diffChangetype(cfg_old, cfg_new), lcbvb_compare_changetype(cfg_old, cfg_new));
+    ASSERT_NE(0, lcbvb_compare_changetype(cfg_old, cfg_new) & LCBVB_SERVERS_MODIFIED);
+    ASSERT_NE(0, lcbvb_compare_changetype(cfg_old, cfg_new) & LCBVB_REPLICAS_MODIFIED);
+    lcbvb_destroy(cfg_new);
+
+    // Change the number of vBuckets
+    cfg_new = lcbvb_create();
+    lcbvb_genconfig(cfg_new, 4, 1, 64);
+    ASSERT_EQ(LCBVB_MAP_MODIFIED, lcbvb_compare_changetype(cfg_old, cfg_new));
+    ASSERT_EQ(diffChangetype(cfg_old, cfg_new), lcbvb_compare_changetype(cfg_old, cfg_new));
+    lcbvb_destroy(cfg_new);
+
+    lcbvb_destroy(cfg_old);
+}
+
 TEST_F(ConfigTest, testBadInput)
 {
     lcbvb_CONFIG *cfg = lcbvb_create();
@@ -456,3 +505,60 @@ TEST_F(ConfigTest, testLargeRevision)
         ASSERT_EQ(18446744073709551615UL, json["max_uint64"].asUInt64());
     }
 }
+
+TEST_F(ConfigTest, testPeekRevision)
+{
+    int64_t epoch, rev;
+
+    ASSERT_EQ(0, lcbvb_peek_revision("{\"rev\":42,\"revEpoch\":7}", &epoch, &rev));
+    ASSERT_EQ(7, epoch);
+    ASSERT_EQ(42, rev);
+
+    // Nested and quoted occurrences of the keys must not be picked up
+    ASSERT_EQ(0, lcbvb_peek_revision("{\"a\":{\"rev\":1},\"b\":[\"rev\",\"x\\\"rev\"],\"name\":\"rev\",\"rev\" : 9}",
+                                     &epoch, &rev));
+    ASSERT_EQ(-1, epoch);
+    ASSERT_EQ(9, rev);
+
+    ASSERT_EQ(0, lcbvb_peek_revision("{\"name\":\"default\"}", &epoch, &rev));
+    ASSERT_EQ(-1, epoch);
+    ASSERT_EQ(-1, rev);
+
+    ASSERT_NE(0, lcbvb_peek_revision("{\"rev\":\"abc\"}", &epoch, &rev));
+    ASSERT_NE(0, lcbvb_peek_revision("{\"rev", &epoch, &rev));
+}
+
+TEST_F(ConfigTest, benchLargeConfig)
+{
+    const unsigned nsrv = 100, nvb = 1024, niter = 50;
+    lcbvb_CONFIG *vbc = lcbvb_create();
+    ASSERT_EQ(0, lcbvb_genconfig(vbc, nsrv, 1, nvb));
+    vbc->revepoch = 2;
+    vbc->revid = 1234;
+    char *js = lcbvb_save_json(vbc);
+    lcbvb_destroy(vbc);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (unsigned ii = 0; ii < niter; ii++) {
+        vbc = lcbvb_create();
+        ASSERT_EQ(0, lcbvb_load_json(vbc, js));
+        ASSERT_EQ(nsrv, vbc->nsrv);
+        ASSERT_EQ(nvb, vbc->nvb);
+        lcbvb_destroy(vbc);
+    }
+    auto parsed = std::chrono::steady_clock::now();
+    for (unsigned ii = 0; ii < niter; ii++) {
+        int64_t epoch, rev;
+        ASSERT_EQ(0, lcbvb_peek_revision(js, &epoch, &rev));
+        ASSERT_EQ(2, epoch);
+        ASSERT_EQ(1234, rev);
+    }
+    auto peeked = std::chrono::steady_clock::now();
+    free(js);
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    fprintf(stderr, "%u nodes, %u vbuckets: full parse %.1fus, revision peek %.1fus\n", nsrv, nvb,
+            duration_cast< microseconds >(parsed - begin).count() / (double)niter,
+            duration_cast< microseconds >(peeked - parsed).count() / (double)niter);
+}
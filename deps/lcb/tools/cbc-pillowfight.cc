@@ -1238,10 +1238,11 @@ static void diag_callback(lcb_INSTANCE *instance, int, const lcb_RESPDIAG *resp)
             size_t ii;
             lcb_cntl(instance, LCB_CNTL_GET, LCB_CNTL_METRICS, &metrics);
 
-            fprintf(stderr, "%p: total: %lu, etmpfail: %lu, eexist: %lu, etimeout: %lu, retried: %lu, rq: %lu\n",
+            fprintf(stderr, "%p: total: %lu, etmpfail: %lu, eexist: %lu, etimeout: %lu, retried: %lu, rq: %lu, rqd: %lu\n",
                     (void *)instance, (unsigned long)cookie->stats.total, (unsigned long)cookie->stats.etmpfail,
                     (unsigned long)cookie->stats.eexist, (unsigned long)cookie->stats.etimeout,
-                    (unsigned long)cookie->stats.retried, (unsigned long)metrics->packets_retried);
+                    (unsigned long)cookie->stats.retried, (unsigned long)metrics->packets_retried,
+                    (unsigned long)metrics->retry_queue_depth);
             for (ii = 0; ii < metrics->nservers; ii++) {
                 fprintf(stderr, "  [srv-%d] snt: %lu, rcv: %lu, q: %lu, err: %lu, tmo: %lu, nmv: %lu, orph: %lu\n",
                         (int)ii, (unsigned long)metrics->servers[ii]->packets_sent,
@@ -13,6 +13,7 @@ export enum CppSdCmdType {}
 export enum CppSdOpFlag {}
 export enum CppSdSpecFlag {}
 export enum CppConnType {}
+export enum CppCasMode {}
 export enum CppViewQueryFlags {}
 export enum CppQueryFlags {}
 export enum CppSearchQueryFlags {}
@@ -59,6 +60,25 @@ export type CppTranscoder = any
 export type CppCas = any
 export type CppMutationToken = any
 
+export interface CppKvOpTimings {
+  queue: number
+  network: number
+  server: number
+}
+
+export interface CppKvOpTimingsBucket {
+  min: number
+  max: number
+  count: number
+}
+
+export interface CppKvOpNodeTimings {
+  endpoint: string
+  queue: CppKvOpTimingsBucket[]
+  network: CppKvOpTimingsBucket[]
+  server: CppKvOpTimingsBucket[]
+}
+
 export interface CppErrorBase extends Error {
   code: number
 }
@@ -139,7 +159,9 @@ export interface CppConnection {
     password: string | undefined,
     logFn: CppLogFunc,
     tracer: CppTracer | undefined,
-    meter: CppMeter | undefined
+    meter: CppMeter | undefined,
+    ioThreads?: number,
+    casMode?: CppCasMode
   ): any
 
   connect(callback: (err: CppError | null) => void): void
@@ -158,7 +180,12 @@ export interface CppConnection {
     lockTime: number | undefined,
     parentSpan: CppRequestSpan | undefined,
     timeoutMs: number | undefined,
-    callback: (err: CppError | null, cas: CppCas, value: any) => void
+    callback: (
+      err: CppError | null,
+      cas: CppCas,
+      value: any,
+      timings?: CppKvOpTimings
+    ) => void
   ): void
 
   exists(
@@ -167,7 +194,12 @@ export interface CppConnection {
     key: CppBytes,
     parentSpan: CppRequestSpan | undefined,
     timeoutMs: number | undefined,
-    callback: (err: CppError | null, cas: CppCas, exists: boolean) => void
+    callback: (
+      err: CppError | null,
+      cas: CppCas,
+      exists: boolean,
+      timings?: CppKvOpTimings
+    ) => void
   ): void
 
   getReplica(
@@ -182,7 +214,8 @@ export interface CppConnection {
       err: CppError | null,
       rflags: number,
       cas: CppCas,
-      value: any
+      value: any,
+      timings?: CppKvOpTimings
     ) => void
   ): void
 
@@ -203,7 +236,8 @@ export interface CppConnection {
     callback: (
       err: CppError | null,
       cas: CppCas,
-      token: CppMutationToken
+      token: CppMutationToken,
+      timings?: CppKvOpTimings
     ) => void
   ): void
 
@@ -217,7 +251,11 @@ export interface CppConnection {
     replicateTo: number | undefined,
     parentSpan: CppRequestSpan | undefined,
     timeoutMs: number | undefined,
-    callback: (err: CppError | null, cas: CppCas) => void
+    callback: (
+      err: CppError | null,
+      cas: CppCas,
+      timings?: CppKvOpTimings
+    ) => void
   ): void
 
   touch(
@@ -230,7 +268,11 @@ export interface CppConnection {
     replicateTo: number | undefined,
     parentSpan: CppRequestSpan | undefined,
     timeoutMs: number | undefined,
-    callback: (err: CppError | null, cas: CppCas) => void
+    callback: (
+      err: CppError | null,
+      cas: CppCas,
+      timings?: CppKvOpTimings
+    ) => void
   ): void
 
   unlock(
@@ -240,7 +282,7 @@ export interface CppConnection {
     cas: CppCas,
     parentSpan: CppRequestSpan | undefined,
     timeoutMs: number | undefined,
-    callback: (err: CppError | null) => void
+    callback: (err: CppError | null, timings?: CppKvOpTimings) => void
   ): void
 
   counter(
@@ -259,7 +301,8 @@ export interface CppConnection {
       err: CppError | null,
       cas: CppCas,
       token: CppMutationToken,
-      value: number
+      value: number,
+      timings?: CppKvOpTimings
     ) => void
   ): void
 
@@ -276,7 +319,11 @@ export interface CppConnection {
     ],
     parentSpan: CppRequestSpan | undefined,
     timeoutMs: number | undefined,
-    callback: (err: CppError | null, res: any) => void
+    callback: (
+      err: CppError | null,
+      res: any,
+      timings?: CppKvOpTimings
+    ) => void
   ): void
 
   mutateIn(
@@ -298,7 +345,11 @@ export interface CppConnection {
     replicateTo: number | undefined,
     parentSpan: CppRequestSpan | undefined,
     timeoutMs: number | undefined,
-    callback: (err: CppError | null, res: any) => void
+    callback: (
+      err: CppError | null,
+      res: any,
+      timings?: CppKvOpTimings
+    ) => void
   ): void
 
   viewQuery(
@@ -377,12 +428,19 @@ export interface CppConnection {
     reportId: string | undefined,
     callback: (err: CppError | null, data: string) => void
   ): void
+
+  kvOpTimings(): CppKvOpNodeTimings[]
+}
+
+export interface CppSubdocTemplate {
+  new (isMutation: boolean, specs: any[]): any
 }
 
 export interface CppBinding {
   lcbVersion: string
 
   Connection: CppConnection
+  SubdocTemplate: CppSubdocTemplate
 
   LCB_SUCCESS: CppErrType
   LCB_ERR_GENERIC: CppErrType
@@ -582,6 +640,10 @@ export interface CppBinding {
   LCB_TYPE_BUCKET: CppConnType
   LCB_TYPE_CLUSTER: CppConnType
 
+  CAS_MODE_BUFFER: CppCasMode
+  CAS_MODE_COMPACT: CppCasMode
+  CAS_MODE_BIGINT: CppCasMode
+
   LCBX_RESP_F_NONFINAL:
     | CppViewQueryRespFlags
     | CppQueryRespFlags
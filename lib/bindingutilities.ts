@@ -95,17 +95,8 @@ export function translateCppContext(err: CppError | null): ErrorContext | null {
 
   let context = null
   if (err.ctxtype === 'kv') {
-    context = new errctxs.KeyValueErrorContext({
-      status_code: err.status_code,
-      opaque: err.opaque,
-      cas: err.cas,
-      key: err.key,
-      bucket: err.bucket,
-      collection: err.collection,
-      scope: err.scope,
-      context: err.context,
-      ref: err.ref,
-    })
+    // The native error only creates the values which are actually read.
+    context = new errctxs.KeyValueErrorContext(err)
   } else if (err.ctxtype === 'views') {
     context = new errctxs.ViewErrorContext({
       first_error_code: err.first_error_code,
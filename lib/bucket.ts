@@ -3,7 +3,11 @@ import { Collection } from './collection'
 import { CollectionManager } from './collectionmanager'
 import { Connection } from './connection'
 import { PingExecutor } from './diagnosticsexecutor'
-import { PingOptions, PingResult } from './diagnosticstypes'
+import {
+  KvOpNodeTimings,
+  PingOptions,
+  PingResult,
+} from './diagnosticstypes'
 import { Scope } from './scope'
 import { StreamableRowPromise } from './streamablepromises'
 import { Transcoder } from './transcoders'
@@ -177,4 +181,14 @@ export class Bucket {
     const options_ = options
     return PromiseHelper.wrapAsync(() => exec.ping(options_), callback)
   }
+
+  /**
+   * Returns histograms of where the time of the key-value operations
+   * performed against this bucket was spent, for each node.  They are only
+   * recorded when {@link ConnectOptions.kvOpTimings} is enabled, and do not
+   * include operations dispatched to {@link ConnectOptions.kvIoThreads}.
+   */
+  kvOpTimings(): KvOpNodeTimings[] {
+    return this.conn.kvOpTimings()
+  }
 }
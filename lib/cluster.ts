@@ -128,6 +128,47 @@ export interface ConnectOptions {
    * Specifies a logging function to use when outputting logging.
    */
   logFunc?: LogFunc
+
+  /**
+   * Specifies the number of native I/O threads which key-value operations
+   * against a bucket are dispatched to, off of the main event loop.  Each
+   * thread maintains its own connections to the cluster.  When unset, all
+   * operations are performed on the event loop.
+   *
+   * The threads are shared process-wide: worker threads which connect to the
+   * same bucket with the same connection string, credentials and thread count
+   * dispatch their key-value operations over the same threads and cluster
+   * connections.  Each worker still bootstraps its own connection to the
+   * bucket for everything else.  Operations still in flight when a
+   * connection is closed fail with a {@link RequestCanceledError}.
+   */
+  kvIoThreads?: number
+
+  /**
+   * Specifies a file (or a directory, when ending in a path separator) used to
+   * persist the cluster map of each opened bucket.  When a cached map is
+   * available, key-value operations are dispatched with it immediately, while
+   * the current map is fetched from the cluster in the background.
+   */
+  configCachePath?: string
+
+  /**
+   * Specifies whether to record where the time of each key-value operation
+   * is spent: waiting in the SDK, on the network, or on the server.  When
+   * enabled, results carry the breakdown of their operation in `timings`,
+   * and {@link Bucket.kvOpTimings} returns histograms of it for each node.
+   * Unlike tracing, this adds no allocations per operation.
+   */
+  kvOpTimings?: boolean
+
+  /**
+   * Specifies how CAS values are represented.  By default they are opaque
+   * objects backed by a buffer.  `'compact'` keeps the value inside the
+   * object itself, avoiding the buffer allocation, while `'bigint'` returns
+   * plain BigInt values.  Either form, as well as decimal strings, is
+   * accepted wherever a CAS is passed back to the SDK.
+   */
+  casMode?: 'buffer' | 'compact' | 'bigint'
 }
 
 /**
@@ -155,6 +196,10 @@ export class Cluster {
   private _tracer: RequestTracer
   private _meter: Meter
   private _logFunc: LogFunc
+  private _kvIoThreads: number
+  private _configCachePath: string
+  private _kvOpTimings: boolean
+  private _casMode: 'buffer' | 'compact' | 'bigint' | undefined
 
   /**
   @internal
@@ -181,6 +226,10 @@ export class Cluster {
     this._analyticsTimeout = options.analyticsTimeout || 0
     this._searchTimeout = options.searchTimeout || 0
     this._managementTimeout = options.managementTimeout || 0
+    this._kvIoThreads = options.kvIoThreads || 0
+    this._configCachePath = options.configCachePath || ''
+    this._kvOpTimings = options.kvOpTimings || false
+    this._casMode = options.casMode
 
     if (options.transcoder) {
       this._transcoder = options.transcoder
@@ -497,6 +546,7 @@ export class Cluster {
       analyticsTimeout: this._analyticsTimeout,
       searchTimeout: this._searchTimeout,
       managementTimeout: this._managementTimeout,
+      casMode: this._casMode,
       ...extraOpts,
     }
 
@@ -582,6 +632,9 @@ export class Cluster {
     // cluster-level connection available.
     const connOpts = this._buildConnOpts({
       bucketName: options.bucketName,
+      kvIoThreads: this._kvIoThreads,
+      configCachePath: this._configCachePath,
+      kvOpTimings: this._kvOpTimings,
     })
 
     let conn = this._conns[options.bucketName]
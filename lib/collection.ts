@@ -27,7 +27,13 @@ import {
 import { PathNotFoundError } from './errors'
 import { DurabilityLevel, StoreSemantics } from './generaltypes'
 import { Scope } from './scope'
-import { LookupInMacro, LookupInSpec, MutateInSpec } from './sdspecs'
+import {
+  LookupInMacro,
+  LookupInSpec,
+  LookupInSpecTemplate,
+  MutateInSpec,
+  MutateInSpecTemplate,
+} from './sdspecs'
 import { SdUtils } from './sdutils'
 import { StreamableReplicasPromise } from './streamablepromises'
 import { RequestSpan } from './tracing'
@@ -580,7 +586,7 @@ export class Collection {
         undefined,
         parentSpan,
         lcbTimeout,
-        (err, cas, value) => {
+        (err, cas, value, timings) => {
           if (err) {
             return wrapCallback(err, null)
           }
@@ -590,6 +596,7 @@ export class Collection {
             new GetResult({
               content: value,
               cas: cas,
+              timings: timings,
             })
           )
         }
@@ -677,6 +684,7 @@ export class Collection {
         content: content,
         cas: res.cas,
         expiryTime: expiry,
+        timings: res.timings,
       })
     }, callback)
   }
@@ -710,7 +718,7 @@ export class Collection {
         key,
         parentSpan,
         lcbTimeout,
-        (err, cas, exists) => {
+        (err, cas, exists, timings) => {
           if (err) {
             return wrapCallback(err, null)
           }
@@ -720,6 +728,7 @@ export class Collection {
             new ExistsResult({
               cas,
               exists,
+              timings,
             })
           )
         }
@@ -860,7 +869,7 @@ export class Collection {
         replicateTo,
         parentSpan,
         lcbTimeout,
-        (err, cas) => {
+        (err, cas, timings) => {
           if (err) {
             return wrapCallback(err, null)
           }
@@ -869,6 +878,7 @@ export class Collection {
             err,
             new MutationResult({
               cas: cas,
+              timings: timings,
             })
           )
         }
@@ -912,7 +922,7 @@ export class Collection {
         undefined,
         parentSpan,
         lcbTimeout,
-        (err, cas, value) => {
+        (err, cas, value, timings) => {
           if (err) {
             return wrapCallback(err, null)
           }
@@ -922,6 +932,7 @@ export class Collection {
             new GetResult({
               content: value,
               cas: cas,
+              timings: timings,
             })
           )
         }
@@ -967,7 +978,7 @@ export class Collection {
         replicateTo,
         parentSpan,
         lcbTimeout,
-        (err, cas) => {
+        (err, cas, timings) => {
           if (err) {
             return wrapCallback(err, null)
           }
@@ -976,6 +987,7 @@ export class Collection {
             err,
             new MutationResult({
               cas: cas,
+              timings: timings,
             })
           )
         }
@@ -1018,7 +1030,7 @@ export class Collection {
         lockTime,
         parentSpan,
         lcbTimeout,
-        (err, cas, value) => {
+        (err, cas, value, timings) => {
           if (err) {
             return wrapCallback(err, null)
           }
@@ -1028,6 +1040,7 @@ export class Collection {
             new GetResult({
               cas: cas,
               content: value,
+              timings: timings,
             })
           )
         }
@@ -1083,13 +1096,14 @@ export class Collection {
    * information about specific fields inside the document value.
    *
    * @param key The document key to look in.
-   * @param specs A list of specs describing the data to fetch from the document.
+   * @param specs A list of specs describing the data to fetch from the document,
+   * or a template created from such a list.
    * @param options Optional parameters for this operation.
    * @param callback A node-style callback to be invoked after execution.
    */
   lookupIn(
     key: string,
-    specs: LookupInSpec[],
+    specs: LookupInSpec[] | LookupInSpecTemplate,
     options?: LookupInOptions,
     callback?: NodeCallback<LookupInResult>
   ): Promise<LookupInResult> {
@@ -1103,10 +1117,17 @@ export class Collection {
 
     const flags: CppSdOpFlag = 0
 
-    let cmdData: any = []
-    for (let i = 0; i < specs.length; ++i) {
-      cmdData = [...cmdData, specs[i]._op, specs[i]._flags, specs[i]._path]
+    let cmdData: any
+    if (specs instanceof LookupInSpecTemplate) {
+      cmdData = [specs._native]
+      specs = specs._specs
+    } else {
+      cmdData = []
+      for (let i = 0; i < specs.length; ++i) {
+        cmdData.push(specs[i]._op, specs[i]._flags, specs[i]._path)
+      }
     }
+    const lookupSpecs = specs
 
     const parentSpan = options.parentSpan
     const lcbTimeout = options.timeout ? options.timeout * 1000 : undefined
@@ -1119,7 +1140,7 @@ export class Collection {
         cmdData,
         parentSpan,
         lcbTimeout,
-        (err, res) => {
+        (err, res, timings) => {
           if (res && res.content) {
             for (let i = 0; i < res.content.length; ++i) {
               const itemRes = res.content[i]
@@ -1132,7 +1153,7 @@ export class Collection {
 
               // TODO(brett19): BUG JSCBC-632 - This conversion logic should not be required,
               // it is expected that when JSCBC-632 is fixed, this code is removed as well.
-              if (specs[i]._op === binding.LCBX_SDCMD_EXISTS) {
+              if (lookupSpecs[i]._op === binding.LCBX_SDCMD_EXISTS) {
                 if (!itemRes.error) {
                   itemRes.value = true
                 } else if (itemRes.error instanceof PathNotFoundError) {
@@ -1147,6 +1168,7 @@ export class Collection {
               new LookupInResult({
                 content: res.content,
                 cas: res.cas,
+                timings: timings,
               })
             )
             return
@@ -1163,13 +1185,14 @@ export class Collection {
    * specific fields within a document.  Also enables access to document extended-attributes.
    *
    * @param key The document key to mutate.
-   * @param specs A list of specs describing the operations to perform on the document.
+   * @param specs A list of specs describing the operations to perform on the document,
+   * or a template created from such a list.
    * @param options Optional parameters for this operation.
    * @param callback A node-style callback to be invoked after execution.
    */
   mutateIn(
     key: string,
-    specs: MutateInSpec[],
+    specs: MutateInSpec[] | MutateInSpecTemplate,
     options?: MutateInOptions,
     callback?: NodeCallback<MutateInResult>
   ): Promise<MutateInResult> {
@@ -1192,15 +1215,19 @@ export class Collection {
       flags |= binding.LCBX_SDFLAG_UPSERT_DOC
     }
 
-    let cmdData: any = []
-    for (let i = 0; i < specs.length; ++i) {
-      cmdData = [
-        ...cmdData,
-        specs[i]._op,
-        specs[i]._flags,
-        specs[i]._path,
-        specs[i]._data,
-      ]
+    let cmdData: any
+    if (specs instanceof MutateInSpecTemplate) {
+      cmdData = [specs._native, ...specs._data]
+    } else {
+      cmdData = []
+      for (let i = 0; i < specs.length; ++i) {
+        cmdData.push(
+          specs[i]._op,
+          specs[i]._flags,
+          specs[i]._path,
+          specs[i]._data
+        )
+      }
     }
 
     const expiry = options.preserveExpiry ? -1 : options.expiry
@@ -1224,7 +1251,7 @@ export class Collection {
         replicateTo,
         parentSpan,
         lcbTimeout,
-        (err, res) => {
+        (err, res, timings) => {
           if (res && res.content) {
             for (let i = 0; i < res.content.length; ++i) {
               const itemRes = res.content[i]
@@ -1242,6 +1269,7 @@ export class Collection {
               new MutateInResult({
                 content: res.content,
                 cas: res.cas,
+                timings: timings,
               })
             )
             return
@@ -1330,7 +1358,7 @@ export class Collection {
       mode,
       options.parentSpan,
       lcbTimeout,
-      (err, rflags, cas, value) => {
+      (err, rflags, cas, value, timings) => {
         if (!err) {
           emitter.emit(
             'replica',
@@ -1338,6 +1366,7 @@ export class Collection {
               content: value,
               cas: cas,
               isReplica: true,
+              timings: timings,
             })
           )
         }
@@ -1399,7 +1428,7 @@ export class Collection {
         parentSpan,
         lcbTimeout,
         opType,
-        (err, cas, token) => {
+        (err, cas, token, timings) => {
           if (err) {
             return wrapCallback(err, null)
           }
@@ -1409,6 +1438,7 @@ export class Collection {
             new MutationResult({
               cas: cas,
               token: token,
+              timings: timings,
             })
           )
         }
@@ -1458,7 +1488,7 @@ export class Collection {
         replicateTo,
         parentSpan,
         lcbTimeout,
-        (err, cas, token, value) => {
+        (err, cas, token, value, timings) => {
           if (err) {
             return wrapCallback(err, null)
           }
@@ -1469,6 +1499,7 @@ export class Collection {
               cas: cas,
               token: token,
               value: value,
+              timings: timings,
             })
           )
         }
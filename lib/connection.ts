@@ -1,6 +1,7 @@
 /* eslint jsdoc/require-jsdoc: off */
 import binding, {
   CppConnection,
+  CppKvOpNodeTimings,
   CppLogFunc,
   CppError,
   CppTracer,
@@ -45,6 +46,10 @@ export interface ConnectionOptions {
   tracer?: RequestTracer
   meter?: Meter
   logFunc?: LogFunc
+  kvIoThreads?: number
+  configCachePath?: string
+  kvOpTimings?: boolean
+  casMode?: 'buffer' | 'compact' | 'bigint'
 }
 
 type ErrCallback = (err: Error | null) => void
@@ -114,6 +119,12 @@ export class Connection {
     if (options.bucketName) {
       lcbDsnObj.bucket = options.bucketName
     }
+    if (options.configCachePath) {
+      lcbDsnObj.options.config_cache = options.configCachePath
+    }
+    if (options.kvOpTimings) {
+      lcbDsnObj.options.kv_op_timings = 'on'
+    }
     if (options.kvConnectTimeout) {
       lcbDsnObj.options.config_total_timeout = fmtTmt(options.kvConnectTimeout)
     }
@@ -217,6 +228,13 @@ export class Connection {
     // always being in sync.  There is a test that ensures this.
     const lcbLogFunc = options.logFunc as any as CppLogFunc
 
+    let lcbCasMode = binding.CAS_MODE_BUFFER
+    if (options.casMode === 'compact') {
+      lcbCasMode = binding.CAS_MODE_COMPACT
+    } else if (options.casMode === 'bigint') {
+      lcbCasMode = binding.CAS_MODE_BIGINT
+    }
+
     this._inst = new binding.Connection(
       lcbConnType,
       lcbConnStr,
@@ -224,7 +242,9 @@ export class Connection {
       options.password,
       lcbLogFunc,
       lcbTracer,
-      lcbMeter
+      lcbMeter,
+      options.kvIoThreads,
+      lcbCasMode
     )
 
     // If a bucket name is specified, this connection is immediately marked as
@@ -383,6 +403,10 @@ export class Connection {
     return this._proxyToConn(this._inst, this._inst.diag, ...args)
   }
 
+  kvOpTimings(): CppKvOpNodeTimings[] {
+    return this._inst.kvOpTimings()
+  }
+
   private _proxyOnBootstrap<FArgs extends any[], CbArgs extends any[]>(
     thisArg: CppConnection,
     fn: (
@@ -1,6 +1,31 @@
 import { MutationToken } from './mutationstate'
 import { Cas } from './utilities'
 
+/**
+ * Where the time of a single key-value operation was spent, in microseconds.
+ * Only available when {@link ConnectOptions.kvOpTimings} is enabled.
+ *
+ * @category Key-Value
+ */
+export interface KvOpTimings {
+  /**
+   * The time the operation waited in the SDK before being written out.
+   */
+  queue: number
+
+  /**
+   * The rest of the round trip, after the time reported by the server.  This
+   * includes the server time too when the server did not report it.
+   */
+  network: number
+
+  /**
+   * The time the server reported spending on the operation, or zero if it
+   * did not report it.
+   */
+  server: number
+}
+
 /**
  * Contains the results of a Get operation.
  *
@@ -24,13 +49,25 @@ export class GetResult {
    */
   expiryTime?: number
 
+  /**
+   * Where the time of the operation was spent, when
+   * {@link ConnectOptions.kvOpTimings} is enabled.
+   */
+  timings?: KvOpTimings
+
   /**
    * @internal
    */
-  constructor(data: { content: any; cas: Cas; expiryTime?: number }) {
+  constructor(data: {
+    content: any
+    cas: Cas
+    expiryTime?: number
+    timings?: KvOpTimings
+  }) {
     this.content = data.content
     this.cas = data.cas
     this.expiryTime = data.expiryTime
+    this.timings = data.timings
   }
 
   /**
@@ -71,12 +108,19 @@ export class ExistsResult {
    */
   cas: Cas
 
+  /**
+   * Where the time of the operation was spent, when
+   * {@link ConnectOptions.kvOpTimings} is enabled.
+   */
+  timings?: KvOpTimings
+
   /**
    * @internal
    */
   constructor(data: ExistsResult) {
     this.exists = data.exists
     this.cas = data.cas
+    this.timings = data.timings
   }
 }
 
@@ -96,12 +140,19 @@ export class MutationResult {
    */
   token?: MutationToken
 
+  /**
+   * Where the time of the operation was spent, when
+   * {@link ConnectOptions.kvOpTimings} is enabled.
+   */
+  timings?: KvOpTimings
+
   /**
    * @internal
    */
   constructor(data: MutationResult) {
     this.cas = data.cas
     this.token = data.token
+    this.timings = data.timings
   }
 }
 
@@ -126,13 +177,25 @@ export class GetReplicaResult {
    */
   isReplica: boolean
 
+  /**
+   * Where the time of the operation was spent, when
+   * {@link ConnectOptions.kvOpTimings} is enabled.
+   */
+  timings?: KvOpTimings
+
   /**
    * @internal
    */
-  constructor(data: { content: any; cas: Cas; isReplica: boolean }) {
+  constructor(data: {
+    content: any
+    cas: Cas
+    isReplica: boolean
+    timings?: KvOpTimings
+  }) {
     this.content = data.content
     this.cas = data.cas
     this.isReplica = data.isReplica
+    this.timings = data.timings
   }
 
   /**
@@ -188,12 +251,23 @@ export class LookupInResult {
    */
   cas: Cas
 
+  /**
+   * Where the time of the operation was spent, when
+   * {@link ConnectOptions.kvOpTimings} is enabled.
+   */
+  timings?: KvOpTimings
+
   /**
    * @internal
    */
-  constructor(data: { content: LookupInResultEntry[]; cas: Cas }) {
+  constructor(data: {
+    content: LookupInResultEntry[]
+    cas: Cas
+    timings?: KvOpTimings
+  }) {
     this.content = data.content
     this.cas = data.cas
+    this.timings = data.timings
   }
 
   /**
@@ -246,12 +320,19 @@ export class MutateInResult {
    */
   cas: Cas
 
+  /**
+   * Where the time of the operation was spent, when
+   * {@link ConnectOptions.kvOpTimings} is enabled.
+   */
+  timings?: KvOpTimings
+
   /**
    * @internal
    */
   constructor(data: MutateInResult) {
     this.content = data.content
     this.cas = data.cas
+    this.timings = data.timings
   }
 }
 
@@ -276,6 +357,12 @@ export class CounterResult {
    */
   token?: MutationToken
 
+  /**
+   * Where the time of the operation was spent, when
+   * {@link ConnectOptions.kvOpTimings} is enabled.
+   */
+  timings?: KvOpTimings
+
   /**
    * @internal
    */
@@ -283,5 +370,6 @@ export class CounterResult {
     this.value = data.value
     this.cas = data.cas
     this.token = data.token
+    this.timings = data.timings
   }
 }
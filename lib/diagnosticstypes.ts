@@ -52,3 +52,55 @@ export interface DiagnosticsOptions {
    */
   reportId?: string
 }
+
+/**
+ * A bucket of a latency histogram, with its bounds in microseconds.
+ *
+ * @category Diagnostics
+ */
+export interface KvOpTimingsBucket {
+  /**
+   * The lower bound of the bucket, in microseconds.
+   */
+  min: number
+
+  /**
+   * The upper bound of the bucket, in microseconds.
+   */
+  max: number
+
+  /**
+   * The number of operations which fell into the bucket.
+   */
+  count: number
+}
+
+/**
+ * The latency breakdown of the key-value operations performed against a
+ * single node, recorded when {@link ConnectOptions.kvOpTimings} is enabled.
+ * Only the non-empty buckets of each histogram are listed.
+ *
+ * @category Diagnostics
+ */
+export interface KvOpNodeTimings {
+  /**
+   * The address of the node.
+   */
+  endpoint: string
+
+  /**
+   * The time operations waited in the SDK before being written out.
+   */
+  queue: KvOpTimingsBucket[]
+
+  /**
+   * The time operations spent on the network, which is the round trip less
+   * the time reported by the server.
+   */
+  network: KvOpTimingsBucket[]
+
+  /**
+   * The time the server reported spending on operations.
+   */
+  server: KvOpTimingsBucket[]
+}
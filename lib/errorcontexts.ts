@@ -7,72 +7,169 @@ import { Cas } from './utilities'
  */
 export class ErrorContext {}
 
+/**
+ * The fields of a {@link KeyValueErrorContext}, as they are handed over by
+ * the binding.
+ *
+ * @internal
+ */
+export interface KeyValueErrorContextData {
+  status_code: number
+  opaque: number
+  cas: Cas
+  key: string
+  bucket: string
+  collection: string
+  scope: string
+  context: string
+  ref: string
+}
+
 /**
  * The error context information for a key-value operation.
  *
+ * The fields are only read from the underlying error when they are first
+ * accessed, as most failed operations (such as a get of a missing document)
+ * never look at them.  Once read or assigned, a field behaves like any other
+ * property of the context.
+ *
  * @category Error Handling
  */
 export class KeyValueErrorContext extends ErrorContext {
+  private _data: KeyValueErrorContextData
+
+  /**
+   * @internal
+   */
+  constructor(data: KeyValueErrorContextData) {
+    super()
+
+    this._data = data
+  }
+
+  /**
+   * Replaces the accessor of a field on this context with a plain property
+   * holding its value, so that later reads neither go back to the binding
+   * nor produce a different value.
+   */
+  private _settle<K extends keyof KeyValueErrorContextData>(
+    name: K,
+    value: KeyValueErrorContextData[K]
+  ): KeyValueErrorContextData[K] {
+    Object.defineProperty(this, name, {
+      value: value,
+      writable: true,
+      enumerable: true,
+      configurable: true,
+    })
+    return value
+  }
+
   /**
    * The memcached status code returned by the server.
    */
-  status_code: number
+  get status_code(): number {
+    return this._settle('status_code', this._data.status_code)
+  }
+  set status_code(value: number) {
+    this._settle('status_code', value)
+  }
 
   /**
    * The opaque identifier for the request.
    */
-  opaque: number
+  get opaque(): number {
+    return this._settle('opaque', this._data.opaque)
+  }
+  set opaque(value: number) {
+    this._settle('opaque', value)
+  }
 
   /**
    * The cas returned by the server.
    */
-  cas: Cas
+  get cas(): Cas {
+    return this._settle('cas', this._data.cas)
+  }
+  set cas(value: Cas) {
+    this._settle('cas', value)
+  }
 
   /**
    * The key that was being operated on.
    */
-  key: string
+  get key(): string {
+    return this._settle('key', this._data.key)
+  }
+  set key(value: string) {
+    this._settle('key', value)
+  }
 
   /**
    * The name of the bucket that was being operated on.
    */
-  bucket: string
+  get bucket(): string {
+    return this._settle('bucket', this._data.bucket)
+  }
+  set bucket(value: string) {
+    this._settle('bucket', value)
+  }
 
   /**
    * The name of the collection that was being operated on.
    */
-  collection: string
+  get collection(): string {
+    return this._settle('collection', this._data.collection)
+  }
+  set collection(value: string) {
+    this._settle('collection', value)
+  }
 
   /**
    * The name of the scope that was being operated on.
    */
-  scope: string
+  get scope(): string {
+    return this._settle('scope', this._data.scope)
+  }
+  set scope(value: string) {
+    this._settle('scope', value)
+  }
 
   /**
    * The context returned by the server helping describing the error.
    */
-  context: string
+  get context(): string {
+    return this._settle('context', this._data.context)
+  }
+  set context(value: string) {
+    this._settle('context', value)
+  }
 
   /**
    * The reference id returned by the server for correlation in server logs.
    */
-  ref: string
+  get ref(): string {
+    return this._settle('ref', this._data.ref)
+  }
+  set ref(value: string) {
+    this._settle('ref', value)
+  }
 
   /**
    * @internal
    */
-  constructor(data: KeyValueErrorContext) {
-    super()
-
-    this.status_code = data.status_code
-    this.opaque = data.opaque
-    this.cas = data.cas
-    this.key = data.key
-    this.bucket = data.bucket
-    this.collection = data.collection
-    this.scope = data.scope
-    this.context = data.context
-    this.ref = data.ref
+  toJSON(): any {
+    return {
+      status_code: this.status_code,
+      opaque: this.opaque,
+      cas: this.cas,
+      key: this.key,
+      bucket: this.bucket,
+      collection: this.collection,
+      scope: this.scope,
+      context: this.context,
+      ref: this.ref,
+    }
   }
 }
 
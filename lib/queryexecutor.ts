@@ -9,7 +9,7 @@ import {
   QueryWarning,
 } from './querytypes'
 import { StreamableRowPromise } from './streamablepromises'
-import { msToGoDurationStr, goDurationStrToMs } from './utilities'
+import { msToGoDurationStr } from './utilities'
 
 /**
  * @internal
@@ -127,7 +127,9 @@ export class QueryExecutor {
             return
           }
 
-          const metaData = JSON.parse(data)
+          // The binding passes the metadata already decoded, leaving only
+          // the signature and profile encoded as JSON.
+          const metaData = data || {}
 
           let warnings: QueryWarning[]
           if (metaData.warnings) {
@@ -144,30 +146,25 @@ export class QueryExecutor {
 
           let metrics: QueryMetrics | undefined
           if (metaData.metrics) {
-            const metricsData = metaData.metrics
-
-            metrics = new QueryMetrics({
-              elapsedTime: goDurationStrToMs(metricsData.elapsedTime) || 0,
-              executionTime: goDurationStrToMs(metricsData.executionTime) || 0,
-              sortCount: metricsData.sortCount || 0,
-              resultCount: metricsData.resultCount || 0,
-              resultSize: metricsData.resultSize || 0,
-              mutationCount: metricsData.mutationCount || 0,
-              errorCount: metricsData.errorCount || 0,
-              warningCount: metricsData.warningCount || 0,
-            })
+            metrics = new QueryMetrics(metaData.metrics)
           } else {
             metrics = undefined
           }
 
           const meta = new QueryMetaData({
-            requestId: metaData.requestID,
-            clientContextId: metaData.clientContextID,
+            requestId: metaData.requestId,
+            clientContextId: metaData.clientContextId,
             status: metaData.status,
-            signature: metaData.signature,
+            signature:
+              metaData.signature !== undefined
+                ? JSON.parse(metaData.signature)
+                : undefined,
             warnings: warnings,
             metrics: metrics,
-            profile: metaData.profile,
+            profile:
+              metaData.profile !== undefined
+                ? JSON.parse(metaData.profile)
+                : undefined,
           })
 
           emitter.emit('meta', meta)
@@ -258,6 +258,11 @@ export class MutateInSpec {
    */
   _data: any
 
+  /**
+   * @internal
+   */
+  _multi: boolean
+
   private constructor(
     op: CppSdCmdType,
     path: string,
@@ -268,6 +273,7 @@ export class MutateInSpec {
     this._path = path
     this._flags = flags
     this._data = data
+    this._multi = false
   }
 
   private static _create(
@@ -300,21 +306,30 @@ export class MutateInSpec {
     }
 
     if (value !== undefined) {
-      // BUG(JSCBC-755): As a solution to our oversight of not accepting arrays of
-      // values to various sub-document operations, we have exposed an option instead.
-      if (!options.multi) {
-        value = JSON.stringify(value)
-      } else {
-        if (!Array.isArray(value)) {
-          throw new Error('value must be an array for a multi operation')
-        }
+      value = this._encodeValue(value, !!options.multi)
+    }
 
-        value = JSON.stringify(value)
-        value = value.substr(1, value.length - 2)
-      }
+    const spec = new MutateInSpec(op, path, flags, value)
+    spec._multi = !!options.multi
+    return spec
+  }
+
+  /**
+   * @internal
+   */
+  static _encodeValue(value: any, multi: boolean): string {
+    // BUG(JSCBC-755): As a solution to our oversight of not accepting arrays of
+    // values to various sub-document operations, we have exposed an option instead.
+    if (!multi) {
+      return JSON.stringify(value)
+    }
+
+    if (!Array.isArray(value)) {
+      throw new Error('value must be an array for a multi operation')
     }
 
-    return new MutateInSpec(op, path, flags, value)
+    const encoded = JSON.stringify(value)
+    return encoded.substr(1, encoded.length - 2)
   }
 
   /**
@@ -544,3 +559,107 @@ export class MutateInSpec {
     return this._create(binding.LCBX_SDCMD_COUNTER, path, +value, options)
   }
 }
+
+/**
+ * A set of lookup-in specs which is validated and encoded once, and can then
+ * be passed to any number of lookup-in operations in place of the list of
+ * specs it was created from.
+ *
+ * @category Key-Value
+ */
+export class LookupInSpecTemplate {
+  /**
+   * @internal
+   */
+  _specs: LookupInSpec[]
+
+  /**
+   * @internal
+   */
+  _native: any
+
+  constructor(specs: LookupInSpec[]) {
+    const cmdData: any[] = []
+    for (let i = 0; i < specs.length; ++i) {
+      cmdData.push(specs[i]._op, specs[i]._flags, specs[i]._path)
+    }
+
+    this._specs = specs.slice()
+    this._native = new binding.SubdocTemplate(false, cmdData)
+  }
+}
+
+/**
+ * A set of mutate-in specs whose operations, flags and paths are validated
+ * and encoded once.  It can be passed to a mutate-in operation as-is, which
+ * writes the values the specs were created with, or bound to a new set of
+ * values first using {@link MutateInSpecTemplate.bind}.
+ *
+ * @category Key-Value
+ */
+export class MutateInSpecTemplate {
+  /**
+   * @internal
+   */
+  _specs: MutateInSpec[]
+
+  /**
+   * @internal
+   */
+  _native: any
+
+  /**
+   * @internal
+   */
+  _data: any[]
+
+  constructor(specs: MutateInSpec[] | MutateInSpecTemplate, data?: any[]) {
+    if (specs instanceof MutateInSpecTemplate) {
+      this._specs = specs._specs
+      this._native = specs._native
+      this._data = data || specs._data
+      return
+    }
+
+    const cmdData: any[] = []
+    for (let i = 0; i < specs.length; ++i) {
+      cmdData.push(specs[i]._op, specs[i]._flags, specs[i]._path)
+    }
+
+    this._specs = specs.slice()
+    this._native = new binding.SubdocTemplate(true, cmdData)
+    this._data = specs.map((spec) => spec._data)
+  }
+
+  /**
+   * Returns a copy of this template which writes the passed values instead,
+   * one for each spec in the template.  The value for a remove spec is
+   * ignored, and counter specs take the delta to apply.
+   *
+   * @param values The values to write.
+   */
+  bind(values: any[]): MutateInSpecTemplate {
+    if (values.length !== this._specs.length) {
+      throw new Error('must pass one value per spec')
+    }
+
+    const data = values.map((value, i) => {
+      const spec = this._specs[i]
+      if (spec._op === binding.LCBX_SDCMD_REMOVE) {
+        return undefined
+      }
+      if (value instanceof MutateInMacro) {
+        if (!(spec._flags & binding.LCB_SUBDOCSPECS_F_XATTR_MACROVALUES)) {
+          throw new Error('macro values must be used by macro specs')
+        }
+        return value._value
+      }
+      if (spec._op === binding.LCBX_SDCMD_COUNTER) {
+        value = +value
+      }
+      return MutateInSpec._encodeValue(value, spec._multi)
+    })
+
+    return new MutateInSpecTemplate(this, data)
+  }
+}
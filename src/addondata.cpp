@@ -4,15 +4,52 @@
 namespace couchnode
 {
 
+static void uvFlushHandler(uv_prepare_t *handle)
+{
+    AddonData *data = reinterpret_cast<AddonData *>(handle->data);
+
+    // Flushing may invoke callbacks which schedule further operations, those
+    // are picked up on the next pass.
+    std::vector<Instance *> pending;
+    pending.swap(data->_flushPending);
+    for (Instance *inst : pending) {
+        inst->_flushScheduled = false;
+    }
+    for (Instance *inst : pending) {
+        if (inst->_instance) {
+            lcb_sched_flush(inst->_instance);
+        }
+    }
+
+    if (data->_flushPending.empty()) {
+        uv_prepare_stop(handle);
+    }
+}
+
 AddonData::AddonData()
+    : _exiting(false)
 {
+    _flushWatch = new uv_prepare_t();
+    uv_prepare_init(Nan::GetCurrentEventLoop(), _flushWatch);
+    _flushWatch->data = this;
 }
 
 AddonData::~AddonData()
 {
+    _exiting = true;
+
     auto instances = _instances;
     std::for_each(instances.begin(), instances.end(),
                   [](Instance *inst) { delete inst; });
+
+    uv_prepare_stop(_flushWatch);
+    uv_close(reinterpret_cast<uv_handle_t *>(_flushWatch),
+             [](uv_handle_t *handle) { delete handle; });
+    _flushWatch = nullptr;
+
+    for (auto &entry : _sharedErrors) {
+        delete entry.second;
+    }
 }
 
 void AddonData::add_instance(class Instance *conn)
@@ -26,6 +63,28 @@ void AddonData::remove_instance(class Instance *conn)
     if (connIter != _instances.end()) {
         _instances.erase(connIter);
     }
+
+    if (conn->_flushScheduled) {
+        auto flushIter =
+            std::find(_flushPending.begin(), _flushPending.end(), conn);
+        if (flushIter != _flushPending.end()) {
+            _flushPending.erase(flushIter);
+        }
+        conn->_flushScheduled = false;
+    }
+}
+
+void AddonData::schedule_flush(class Instance *conn)
+{
+    if (conn->_flushScheduled) {
+        return;
+    }
+
+    conn->_flushScheduled = true;
+    if (_flushPending.empty()) {
+        uv_prepare_start(_flushWatch, &uvFlushHandler);
+    }
+    _flushPending.push_back(conn);
 }
 
 namespace addondata
@@ -3,8 +3,11 @@
 #define ADDONDATA_H
 
 #include <list>
+#include <map>
 #include <nan.h>
 #include <node.h>
+#include <uv.h>
+#include <vector>
 
 namespace couchnode
 {
@@ -20,10 +23,30 @@ public:
     void add_instance(class Instance *conn);
     void remove_instance(class Instance *conn);
 
+    // Requests that the operations scheduled on the instance are flushed
+    // before the loop next polls.  All instances with pending operations are
+    // flushed in a single pass, and nothing runs while none are pending.
+    void schedule_flush(class Instance *conn);
+
     std::list<class Instance *> _instances;
+    bool _exiting;
+    uv_prepare_t *_flushWatch;
+    std::vector<class Instance *> _flushPending;
     Nan::Persistent<Function> _connectionConstructor;
+    Nan::Persistent<FunctionTemplate> _casTemplate;
     Nan::Persistent<Function> _casConstructor;
+    Nan::Persistent<FunctionTemplate> _mutationtokenTemplate;
     Nan::Persistent<Function> _mutationtokenConstructor;
+    Nan::Persistent<FunctionTemplate> _subdocTemplateClass;
+    Nan::Persistent<Function> _kvErrorConstructor;
+    std::map<int, Nan::Persistent<Object> *> _sharedErrors;
+    Nan::Persistent<ObjectTemplate> _sdLookupItemTemplate;
+    Nan::Persistent<ObjectTemplate> _sdMutateItemTemplate;
+    Nan::Persistent<ObjectTemplate> _sdResultTemplate;
+    Nan::Persistent<String> _errorKey;
+    Nan::Persistent<String> _valueKey;
+    Nan::Persistent<String> _casKey;
+    Nan::Persistent<String> _contentKey;
 };
 
 namespace addondata
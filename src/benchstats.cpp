@@ -0,0 +1,205 @@
+#include "benchstats.h"
+
+#ifdef LCBX_BENCH
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+#include <time.h>
+#include <uv.h>
+
+namespace couchnode
+{
+
+namespace bench
+{
+
+struct StageStats {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> cpuNs;
+};
+
+static StageStats stageStats[STAGE__MAX];
+static std::atomic<uint64_t> allocCount;
+
+static thread_local StageTimer *currentTimer = nullptr;
+
+static const char *const stageNames[STAGE__MAX] = {
+    "encode",
+    "schedule",
+    "decode",
+    "callback",
+};
+
+static uint64_t threadCpuNs()
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    // No per-thread CPU clock, so stages are timed by the wall clock
+    return uv_hrtime();
+#endif
+}
+
+StageTimer::StageTimer(Stage stage)
+    : _parent(currentTimer)
+{
+    currentTimer = this;
+    start(stage);
+}
+
+StageTimer::~StageTimer()
+{
+    stop();
+    currentTimer = _parent;
+}
+
+void StageTimer::switchTo(Stage stage)
+{
+    stop();
+    start(stage);
+}
+
+void StageTimer::start(Stage stage)
+{
+    _stage = stage;
+    _nestedNs = 0;
+    _running = true;
+    _startNs = threadCpuNs();
+}
+
+void StageTimer::stop()
+{
+    if (!_running) {
+        return;
+    }
+    _running = false;
+
+    uint64_t elapsedNs = threadCpuNs() - _startNs;
+    uint64_t ownNs = elapsedNs > _nestedNs ? elapsedNs - _nestedNs : 0;
+
+    StageStats &stats = stageStats[_stage];
+    stats.count.fetch_add(1, std::memory_order_relaxed);
+    stats.cpuNs.fetch_add(ownNs, std::memory_order_relaxed);
+
+    if (_parent) {
+        _parent->_nestedNs += elapsedNs;
+    }
+}
+
+static NAN_METHOD(fnBenchStats)
+{
+    Local<Object> stagesObj = Nan::New<Object>();
+    for (int i = 0; i < STAGE__MAX; ++i) {
+        Local<Object> stageObj = Nan::New<Object>();
+        Nan::Set(stageObj, Nan::New("count").ToLocalChecked(),
+                 Nan::New<Number>(static_cast<double>(
+                     stageStats[i].count.load(std::memory_order_relaxed))));
+        Nan::Set(stageObj, Nan::New("cpuNs").ToLocalChecked(),
+                 Nan::New<Number>(static_cast<double>(
+                     stageStats[i].cpuNs.load(std::memory_order_relaxed))));
+        Nan::Set(stagesObj, Nan::New(stageNames[i]).ToLocalChecked(),
+                 stageObj);
+    }
+
+    Local<Object> statsObj = Nan::New<Object>();
+    Nan::Set(statsObj, Nan::New("stages").ToLocalChecked(), stagesObj);
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    Nan::Set(statsObj, Nan::New("clock").ToLocalChecked(),
+             Nan::New("thread_cpu").ToLocalChecked());
+#else
+    Nan::Set(statsObj, Nan::New("clock").ToLocalChecked(),
+             Nan::New("wall").ToLocalChecked());
+#endif
+#ifdef LCBX_BENCH_ALLOCS
+    Nan::Set(statsObj, Nan::New("allocations").ToLocalChecked(),
+             Nan::New<Number>(static_cast<double>(
+                 allocCount.load(std::memory_order_relaxed))));
+#endif
+
+    info.GetReturnValue().Set(statsObj);
+}
+
+static NAN_METHOD(fnBenchReset)
+{
+    for (int i = 0; i < STAGE__MAX; ++i) {
+        stageStats[i].count = 0;
+        stageStats[i].cpuNs = 0;
+    }
+    allocCount = 0;
+}
+
+void Init(Local<Object> target)
+{
+    Nan::SetMethod(target, "benchStats", fnBenchStats);
+    Nan::SetMethod(target, "benchReset", fnBenchReset);
+}
+
+} // namespace bench
+
+} // namespace couchnode
+
+#ifdef LCBX_BENCH_ALLOCS
+
+// Counts the C++ allocations made by the binding and by libcouchbase.  The
+// target links with -Bsymbolic-functions, so these only replace the
+// allocator for code inside of the addon, and the rest of the process keeps
+// using its own.  Both end up in malloc(), so memory may be released by
+// either side.  Allocations made with malloc() directly (most of the C parts
+// of libcouchbase) are not counted.
+
+static void *countedAlloc(size_t size)
+{
+    couchnode::bench::allocCount.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void *operator new(size_t size)
+{
+    void *ptr = countedAlloc(size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+#endif // LCBX_BENCH_ALLOCS
+
+#endif // LCBX_BENCH
@@ -0,0 +1,80 @@
+#pragma once
+#ifndef BENCHSTATS_H
+#define BENCHSTATS_H
+
+#include <nan.h>
+#include <node.h>
+#include <stdint.h>
+
+namespace couchnode
+{
+
+using namespace v8;
+
+// Per-stage accounting for the benchmark build of the binding (the
+// couchbase_bench target, which defines LCBX_BENCH).  In the regular build
+// the timers below are empty and compile away.
+//
+// Each stage records the CPU time of the thread which runs it, excluding
+// any stage nested inside of it, so that a JS callback which schedules more
+// operations does not count their encoding as callback time.
+namespace bench
+{
+
+enum Stage {
+    // Parsing the JS arguments of an operation into a command
+    STAGE_ENCODE = 0,
+    // Handing the command to libcouchbase (or to an I/O shard)
+    STAGE_SCHEDULE,
+    // Turning a response into JS values, including the transcoder
+    STAGE_DECODE,
+    // Running the JS callback of the operation
+    STAGE_CALLBACK,
+    STAGE__MAX
+};
+
+#ifdef LCBX_BENCH
+
+class StageTimer
+{
+public:
+    explicit StageTimer(Stage stage);
+    ~StageTimer();
+
+    // Ends the current stage and starts another one in its place.
+    void switchTo(Stage stage);
+
+private:
+    void start(Stage stage);
+    void stop();
+
+    Stage _stage;
+    uint64_t _startNs;
+    uint64_t _nestedNs;
+    StageTimer *_parent;
+    bool _running;
+};
+
+void Init(Local<Object> target);
+
+#else
+
+class StageTimer
+{
+public:
+    explicit StageTimer(Stage)
+    {
+    }
+
+    void switchTo(Stage)
+    {
+    }
+};
+
+#endif
+
+} // namespace bench
+
+} // namespace couchnode
+
+#endif // BENCHSTATS_H
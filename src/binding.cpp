@@ -2,11 +2,14 @@
 #include <node.h>
 
 #include "addondata.h"
+#include "benchstats.h"
 #include "cas.h"
 #include "connection.h"
 #include "constants.h"
 #include "error.h"
 #include "mutationtoken.h"
+#include "sdresult.h"
+#include "sdtemplate.h"
 
 namespace couchnode
 {
@@ -20,9 +23,15 @@ static NAN_MODULE_INIT(init)
     Connection::Init(target);
     Error::Init(target);
     MutationToken::Init(target);
+    SubdocResult::Init(target);
+    SubdocTemplate::Init(target);
 
     Nan::Set(target, Nan::New("lcbVersion").ToLocalChecked(),
              Nan::New<String>(lcb_get_version(NULL)).ToLocalChecked());
+
+#ifdef LCBX_BENCH
+    bench::Init(target);
+#endif
 }
 
 NAN_MODULE_WORKER_ENABLED(couchbase_impl, couchnode::init)
@@ -3,15 +3,24 @@
 namespace couchnode
 {
 
+// In compact mode the value is split into two 32-bit halves, each of which
+// is held in an internal field of the CbCas object.
+static const int CAS_FIELD_LOW = 0;
+static const int CAS_FIELD_HIGH = 1;
+static const int CAS_FIELD_COMPACT = 2;
+static const int CAS_FIELD_COUNT = 3;
+
 NAN_MODULE_INIT(Cas::Init)
 {
     Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>();
     tpl->SetClassName(Nan::New<String>("CbCas").ToLocalChecked());
+    tpl->InstanceTemplate()->SetInternalFieldCount(CAS_FIELD_COUNT);
 
     Nan::SetPrototypeMethod(tpl, "toString", fnToString);
     Nan::SetPrototypeMethod(tpl, "toJSON", fnToString);
     Nan::SetPrototypeMethod(tpl, "inspect", fnInspect);
 
+    functionTemplate().Reset(tpl);
     constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
 }
 
@@ -39,31 +48,105 @@ NAN_METHOD(Cas::fnInspect)
     return info.GetReturnValue().Set(Nan::New<String>(casStr).ToLocalChecked());
 }
 
-Local<Value> Cas::create(uint64_t cas)
+Local<Value> Cas::create(uint64_t cas, CasMode mode)
 {
+#ifdef COUCHNODE_HAS_BIGINT
+    if (mode == CAS_MODE_BIGINT) {
+        return BigInt::NewFromUnsigned(Isolate::GetCurrent(), cas);
+    }
+#endif
+
     Local<Object> ret =
         Nan::NewInstance(Nan::New<Function>(constructor())).ToLocalChecked();
 
-    Local<Value> casData =
-        Nan::CopyBuffer((char *)&cas, sizeof(uint64_t)).ToLocalChecked();
-    Nan::Set(ret, 0, casData);
+    if (mode == CAS_MODE_BUFFER) {
+        Local<Value> casData =
+            Nan::CopyBuffer((char *)&cas, sizeof(uint64_t)).ToLocalChecked();
+        Nan::Set(ret, 0, casData);
+    } else {
+        ret->SetInternalField(CAS_FIELD_LOW,
+                              Nan::New<Uint32>(static_cast<uint32_t>(cas)));
+        ret->SetInternalField(
+            CAS_FIELD_HIGH, Nan::New<Uint32>(static_cast<uint32_t>(cas >> 32)));
+        ret->SetInternalField(CAS_FIELD_COMPACT, Nan::True());
+    }
 
     return ret;
 }
 
-bool _StrToCas(Local<Value> obj, uint64_t *p)
+bool Cas::parseDecimal(const char *str, size_t len, uint64_t *p)
 {
-    if (sscanf(*Nan::Utf8String(
-                   obj->ToString(Nan::GetCurrentContext()).ToLocalChecked()),
-               "%llu", (unsigned long long int *)p) != 1) {
+    if (len == 0) {
         return false;
     }
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < len; ++i) {
+        if (str[i] < '0' || str[i] > '9') {
+            return false;
+        }
+
+        uint64_t digit = static_cast<uint64_t>(str[i] - '0');
+        if (value > (UINT64_MAX - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+
+    *p = value;
     return true;
 }
 
+bool _StrToCas(Local<Value> obj, uint64_t *p)
+{
+    // The longest 64-bit value has 20 digits, anything longer is invalid
+    // and can be rejected without decoding it.
+    uint16_t units[20];
+    Local<String> str = obj.As<String>();
+    int len = str->Length();
+    if (len <= 0 || len > static_cast<int>(sizeof(units) / sizeof(units[0]))) {
+        return false;
+    }
+
+    // Read the full UTF-16 code units rather than a narrowed copy, so that
+    // a character outside ASCII can't be truncated into a digit.
+    int written = str->Write(Isolate::GetCurrent(), units, 0, len,
+                             String::NO_NULL_TERMINATION);
+    if (written != len) {
+        return false;
+    }
+
+    char casStr[20];
+    for (int i = 0; i < len; ++i) {
+        if (units[i] > 0x7F) {
+            return false;
+        }
+        casStr[i] = static_cast<char>(units[i]);
+    }
+
+    return Cas::parseDecimal(casStr, len, p);
+}
+
 bool _ObjToCas(Local<Value> obj, uint64_t *p)
 {
     Local<Object> realObj = obj.As<Object>();
+
+    if (Nan::New<FunctionTemplate>(Cas::functionTemplate())
+            ->HasInstance(realObj) &&
+        realObj->GetInternalField(CAS_FIELD_COMPACT)
+            .As<Value>()
+            ->IsTrue()) {
+        uint32_t low = Nan::To<uint32_t>(
+                           realObj->GetInternalField(CAS_FIELD_LOW).As<Value>())
+                           .FromMaybe(0);
+        uint32_t high =
+            Nan::To<uint32_t>(
+                realObj->GetInternalField(CAS_FIELD_HIGH).As<Value>())
+                .FromMaybe(0);
+        *p = (static_cast<uint64_t>(high) << 32) | low;
+        return true;
+    }
+
     Local<Value> casData = Nan::Get(realObj, 0).ToLocalChecked();
 
     if (!node::Buffer::HasInstance(casData)) {
@@ -87,6 +170,12 @@ bool Cas::parse(Local<Value> obj, uint64_t *p)
     if (obj->IsNull() || obj->IsUndefined()) {
         *p = 0;
         return true;
+#ifdef COUCHNODE_HAS_BIGINT
+    } else if (obj->IsBigInt()) {
+        bool lossless = false;
+        *p = obj.As<BigInt>()->Uint64Value(&lossless);
+        return lossless;
+#endif
     } else if (obj->IsObject()) {
         return _ObjToCas(obj, p);
     } else if (obj->IsString()) {
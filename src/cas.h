@@ -7,25 +7,52 @@
 #include <nan.h>
 #include <node.h>
 
+#if V8_MAJOR_VERSION > 6 || (V8_MAJOR_VERSION == 6 && V8_MINOR_VERSION >= 7)
+#define COUCHNODE_HAS_BIGINT 1
+#endif
+
 namespace couchnode
 {
 
 using namespace v8;
 
+// How CAS values are handed to JavaScript.
+enum CasMode {
+    // A CbCas object carrying the value in a buffer at index 0.
+    CAS_MODE_BUFFER = 0,
+
+    // A CbCas object carrying the value in its internal fields, which saves
+    // allocating the buffer but leaves the object without own properties.
+    CAS_MODE_COMPACT = 1,
+
+    // A BigInt, falling back to CAS_MODE_COMPACT on runtimes without them.
+    CAS_MODE_BIGINT = 2,
+};
+
 class Cas
 {
 public:
     static NAN_MODULE_INIT(Init);
 
-    static v8::Local<v8::Value> create(uint64_t);
+    static v8::Local<v8::Value> create(uint64_t cas,
+                                       CasMode mode = CAS_MODE_BUFFER);
 
     static bool parse(Local<Value>, uint64_t *);
 
+    // Parses an unsigned decimal integer, rejecting anything which is not
+    // made up entirely of digits or which does not fit in 64 bits.
+    static bool parseDecimal(const char *str, size_t len, uint64_t *p);
+
     static inline Nan::Persistent<Function> &constructor()
     {
         return addondata::Get()->_casConstructor;
     }
 
+    static inline Nan::Persistent<FunctionTemplate> &functionTemplate()
+    {
+        return addondata::Get()->_casTemplate;
+    }
+
 private:
     static NAN_METHOD(fnToString);
     static NAN_METHOD(fnInspect);
@@ -3,6 +3,8 @@
 #include "error.h"
 #include "logger.h"
 
+#include <libcouchbase/utils.h>
+
 namespace couchnode
 {
 
@@ -29,6 +31,7 @@ NAN_MODULE_INIT(Connection::Init)
     Nan::SetPrototypeMethod(tpl, "selectBucket", fnSelectBucket);
     Nan::SetPrototypeMethod(tpl, "shutdown", fnShutdown);
     Nan::SetPrototypeMethod(tpl, "cntl", fnCntl);
+    Nan::SetPrototypeMethod(tpl, "kvOpTimings", fnKvOpTimings);
     Nan::SetPrototypeMethod(tpl, "get", fnGet);
     Nan::SetPrototypeMethod(tpl, "exists", fnExists);
     Nan::SetPrototypeMethod(tpl, "getReplica", fnGetReplica);
@@ -57,8 +60,8 @@ NAN_METHOD(Connection::fnNew)
 {
     Nan::HandleScope scope;
 
-    if (info.Length() != 7) {
-        return Nan::ThrowError(Error::create("expected 7 parameters"));
+    if (info.Length() < 7 || info.Length() > 9) {
+        return Nan::ThrowError(Error::create("expected 7 to 9 parameters"));
     }
 
     lcb_STATUS err;
@@ -171,10 +174,65 @@ NAN_METHOD(Connection::fnNew)
         }
     }
 
+    uint32_t numIoThreads = 0;
+    if (info.Length() > 7 && !info[7]->IsUndefined() && !info[7]->IsNull()) {
+        if (!info[7]->IsNumber()) {
+            return Nan::ThrowError(
+                Error::create("must pass integer for ioThreads"));
+        }
+
+        numIoThreads = Nan::To<uint32_t>(info[7]).ToChecked();
+    }
+
+    CasMode casMode = CAS_MODE_BUFFER;
+    if (info.Length() > 8 && !info[8]->IsUndefined() && !info[8]->IsNull()) {
+        if (!info[8]->IsNumber()) {
+            return Nan::ThrowError(
+                Error::create("must pass enum integer for casMode"));
+        }
+
+        uint32_t casModeVal = Nan::To<uint32_t>(info[8]).ToChecked();
+        if (casModeVal > CAS_MODE_BIGINT) {
+            return Nan::ThrowError(Error::create("invalid casMode"));
+        }
+        casMode = static_cast<CasMode>(casModeVal);
+    }
+
     lcb_createopts_io(createOpts, iops);
 
-    lcb_INSTANCE *instance;
-    err = lcb_create(&instance, createOpts);
+    // Key-value operations are only sharded for bucket connections, as
+    // that is the only place they can be performed.  The shards report
+    // back on our queue, which also carries what they log and meter.  They
+    // are attached before our own instance exists, so that failing to do so
+    // leaves our hooks owned by nobody but us.
+    IoShards *shards = nullptr;
+    CompletionQueue *completions = nullptr;
+    if (numIoThreads > 0 && connType == LCB_TYPE_BUCKET) {
+        completions = new CompletionQueue(Nan::GetCurrentEventLoop());
+        shards = IoShards::acquire(
+            connType, utfConnStr ? **utfConnStr : nullptr,
+            utfConnStr ? utfConnStr->length() : 0,
+            utfUsername ? **utfUsername : nullptr,
+            utfUsername ? utfUsername->length() : 0,
+            utfPassword ? **utfPassword : nullptr,
+            utfPassword ? utfPassword->length() : 0, numIoThreads,
+            ShardSink{completions, logger, meter}, &err);
+        if (err != LCB_SUCCESS) {
+            completions->close(false);
+            completions = nullptr;
+        }
+    }
+
+    lcb_INSTANCE *instance = nullptr;
+    if (err == LCB_SUCCESS) {
+        err = lcb_create(&instance, createOpts);
+        if (err != LCB_SUCCESS && shards) {
+            completions->close(false);
+            shards->release(ShardSink{completions, logger, meter});
+            shards = nullptr;
+            completions = nullptr;
+        }
+    }
 
     lcb_createopts_destroy(createOpts);
 
@@ -189,6 +247,9 @@ NAN_METHOD(Connection::fnNew)
     }
 
     if (err != LCB_SUCCESS) {
+        // No instance took ownership of our io ops or hooks, so they are
+        // still ours to clean up.
+        lcb_destroy_io_ops(iops);
         if (logger) {
             delete logger;
         }
@@ -203,6 +264,10 @@ NAN_METHOD(Connection::fnNew)
     }
 
     Instance *inst = new Instance(instance, logger, tracer, meter);
+    inst->_casMode = casMode;
+    if (shards) {
+        inst->enableShards(shards, completions);
+    }
 
     Connection *obj = new Connection(inst);
     obj->Wrap(info.This());
@@ -225,12 +290,26 @@ NAN_METHOD(Connection::fnConnect)
         inst->_bootstrapCookie = nullptr;
     }
     inst->_bootstrapCookie = new Cookie("connect", info[0].As<Function>());
+    inst->_pendingBootstraps = 1;
+    inst->_bootstrapErr = LCB_SUCCESS;
 
     lcb_STATUS ec = lcb_connect(inst->_instance);
     if (ec != LCB_SUCCESS) {
+        inst->_pendingBootstraps = 0;
         return Nan::ThrowError(Error::create(ec));
     }
 
+    // The I/O shards bootstrap on their own, and the connection is not
+    // ready until they have too.
+    if (inst->_shards) {
+        for (size_t i = 0; i < inst->_shards->size(); ++i) {
+            ShardBootstrapOp *op = new ShardBootstrapOp(inst);
+            inst->_completions->begin(op);
+            inst->_shards->submitAfterBootstrap(i, op);
+            inst->_pendingBootstraps++;
+        }
+    }
+
     info.GetReturnValue().Set(true);
 }
 
@@ -256,6 +335,7 @@ NAN_METHOD(Connection::fnSelectBucket)
         inst->_openCookie = nullptr;
     }
     inst->_openCookie = new Cookie("open", info[1].As<Function>());
+    inst->resetBucketNameValue();
 
     lcb_STATUS ec = lcb_open(inst->_instance, *bucketName, bucketName.length());
     if (ec != LCB_SUCCESS) {
@@ -337,4 +417,97 @@ NAN_METHOD(Connection::fnCntl)
     Nan::ThrowError(Error::create("unexpected cntl cmd"));
 }
 
+static uint32_t histogramUnitToUs(lcb_timeunit_t timeunit, uint32_t value)
+{
+    switch (timeunit) {
+    case LCB_TIMEUNIT_NSEC:
+        return value / 1000;
+    case LCB_TIMEUNIT_MSEC:
+        return value * 1000;
+    case LCB_TIMEUNIT_SEC:
+        return value * 1000000;
+    default:
+        return value;
+    }
+}
+
+static void histogramBucketCallback(const void *cookie,
+                                    lcb_timeunit_t timeunit, lcb_U32 min,
+                                    lcb_U32 max, lcb_U32 total,
+                                    lcb_U32 /* maxtotal */)
+{
+    if (total == 0) {
+        return;
+    }
+
+    Local<Array> bucketsArr =
+        *reinterpret_cast<const Local<Array> *>(cookie);
+
+    Local<Object> bucketObj = Nan::New<Object>();
+    Nan::Set(bucketObj, Nan::New("min").ToLocalChecked(),
+             Nan::New<Number>(histogramUnitToUs(timeunit, min)));
+    Nan::Set(bucketObj, Nan::New("max").ToLocalChecked(),
+             Nan::New<Number>(histogramUnitToUs(timeunit, max)));
+    Nan::Set(bucketObj, Nan::New("count").ToLocalChecked(),
+             Nan::New<Number>(total));
+    Nan::Set(bucketsArr, bucketsArr->Length(), bucketObj);
+}
+
+static Local<Value> decodeHistogram(const lcb_HISTOGRAM *hg)
+{
+    Local<Array> bucketsArr = Nan::New<Array>();
+    if (hg) {
+        lcb_histogram_read(hg, &bucketsArr, histogramBucketCallback);
+    }
+    return bucketsArr;
+}
+
+// Returns the per-node histograms recorded when kv_op_timings is enabled, as
+// lists of the non-empty buckets with their bounds in microseconds.  These
+// only cover operations dispatched by this connection, and not those which
+// go through the I/O shards.
+NAN_METHOD(Connection::fnKvOpTimings)
+{
+    Connection *me = ObjectWrap::Unwrap<Connection>(info.This());
+    Instance *inst = me->_instance;
+    Nan::HandleScope scope;
+
+    // The instance is gone once the connection is closed or has failed to
+    // bootstrap, along with the timings it collected.
+    if (!inst || !inst->_instance) {
+        return Nan::ThrowError(
+            Error::create("cannot read kv timings of a closed connection"));
+    }
+
+    lcb_METRICS *metrics = nullptr;
+    lcb_STATUS err =
+        lcb_cntl(inst->_instance, LCB_CNTL_GET, LCB_CNTL_METRICS, &metrics);
+    if (err != LCB_SUCCESS) {
+        Nan::ThrowError(Error::create(err));
+        return;
+    }
+
+    Local<Array> nodesArr = Nan::New<Array>();
+    for (size_t i = 0; metrics && i < metrics->nservers; ++i) {
+        const lcb_SERVERMETRICS *server = metrics->servers[i];
+        if (!server->queue_latency) {
+            // No operation has completed on this node yet
+            continue;
+        }
+
+        Local<Object> nodeObj = Nan::New<Object>();
+        Nan::Set(nodeObj, Nan::New("endpoint").ToLocalChecked(),
+                 Nan::New(server->iometrics.hostport).ToLocalChecked());
+        Nan::Set(nodeObj, Nan::New("queue").ToLocalChecked(),
+                 decodeHistogram(server->queue_latency));
+        Nan::Set(nodeObj, Nan::New("network").ToLocalChecked(),
+                 decodeHistogram(server->network_latency));
+        Nan::Set(nodeObj, Nan::New("server").ToLocalChecked(),
+                 decodeHistogram(server->server_latency));
+        Nan::Set(nodesArr, nodesArr->Length(), nodeObj);
+    }
+
+    info.GetReturnValue().Set(nodesArr);
+}
+
 } // namespace couchnode
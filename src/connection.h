@@ -42,6 +42,7 @@ private:
     static NAN_METHOD(fnSelectBucket);
     static NAN_METHOD(fnShutdown);
     static NAN_METHOD(fnCntl);
+    static NAN_METHOD(fnKvOpTimings);
 
     static NAN_METHOD(fnGet);
     static NAN_METHOD(fnExists);
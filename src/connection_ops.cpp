@@ -1,6 +1,7 @@
 #include "connection.h"
 #include "error.h"
 #include "opbuilder.h"
+#include "sdtemplate.h"
 
 namespace couchnode
 {
@@ -20,7 +21,7 @@ NAN_METHOD(Connection::fnGet)
     if (!enc.parseOption<&lcb_cmdget_collection>(info[0], info[1])) {
         return Nan::ThrowError(Error::create("bad scope/collection passed"));
     }
-    if (!enc.parseOption<&lcb_cmdget_key>(info[2])) {
+    if (!enc.parseKey<&lcb_cmdget_key>(info[2])) {
         return Nan::ThrowError(Error::create("bad key passed"));
     }
     if (!enc.parseTranscoder(info[3])) {
@@ -43,7 +44,7 @@ NAN_METHOD(Connection::fnGet)
         return Nan::ThrowError(Error::create("bad callback passed"));
     }
 
-    lcb_STATUS err = enc.execute<&lcb_get>();
+    lcb_STATUS err = enc.executeKv<&lcb_get>();
     if (err) {
         return Nan::ThrowError(Error::create(err));
     }
@@ -66,7 +67,7 @@ NAN_METHOD(Connection::fnExists)
     if (!enc.parseOption<&lcb_cmdexists_collection>(info[0], info[1])) {
         return Nan::ThrowError(Error::create("bad scope/collection passed"));
     }
-    if (!enc.parseOption<&lcb_cmdexists_key>(info[2])) {
+    if (!enc.parseKey<&lcb_cmdexists_key>(info[2])) {
         return Nan::ThrowError(Error::create("bad key passed"));
     }
     if (!enc.parseOption<&lcb_cmdexists_timeout>(info[4])) {
@@ -76,7 +77,7 @@ NAN_METHOD(Connection::fnExists)
         return Nan::ThrowError(Error::create("bad callback passed"));
     }
 
-    lcb_STATUS err = enc.execute<&lcb_exists>();
+    lcb_STATUS err = enc.executeKv<&lcb_exists>();
     if (err) {
         return Nan::ThrowError(Error::create(err));
     }
@@ -163,7 +164,7 @@ NAN_METHOD(Connection::fnStore)
     if (!enc.parseOption<&lcb_cmdstore_collection>(info[0], info[1])) {
         return Nan::ThrowError(Error::create("bad scope/collection passed"));
     }
-    if (!enc.parseOption<&lcb_cmdstore_key>(info[2])) {
+    if (!enc.parseKey<&lcb_cmdstore_key>(info[2])) {
         return Nan::ThrowError(Error::create("bad key passed"));
     }
     if (!enc.parseTranscoder(info[3])) {
@@ -233,7 +234,7 @@ NAN_METHOD(Connection::fnStore)
         // No need to do anything special for everyone else
     }
 
-    lcb_STATUS err = enc.execute<&lcb_store>();
+    lcb_STATUS err = enc.executeKv<&lcb_store>();
     if (err) {
         return Nan::ThrowError(Error::create(err));
     }
@@ -256,7 +257,7 @@ NAN_METHOD(Connection::fnRemove)
     if (!enc.parseOption<&lcb_cmdremove_collection>(info[0], info[1])) {
         return Nan::ThrowError(Error::create("bad scope/collection passed"));
     }
-    if (!enc.parseOption<&lcb_cmdremove_key>(info[2])) {
+    if (!enc.parseKey<&lcb_cmdremove_key>(info[2])) {
         return Nan::ThrowError(Error::create("bad key passed"));
     }
     if (!enc.parseCasOption<&lcb_cmdremove_cas>(info[3])) {
@@ -280,7 +281,7 @@ NAN_METHOD(Connection::fnRemove)
         return Nan::ThrowError(Error::create("bad callback passed"));
     }
 
-    lcb_STATUS err = enc.execute<&lcb_remove>();
+    lcb_STATUS err = enc.executeKv<&lcb_remove>();
     if (err) {
         return Nan::ThrowError(Error::create(err));
     }
@@ -303,7 +304,7 @@ NAN_METHOD(Connection::fnTouch)
     if (!enc.parseOption<&lcb_cmdtouch_collection>(info[0], info[1])) {
         return Nan::ThrowError(Error::create("bad scope/collection passed"));
     }
-    if (!enc.parseOption<&lcb_cmdtouch_key>(info[2])) {
+    if (!enc.parseKey<&lcb_cmdtouch_key>(info[2])) {
         return Nan::ThrowError(Error::create("bad key passed"));
     }
     if (!enc.parseOption<&lcb_cmdtouch_expiry>(info[3])) {
@@ -327,7 +328,7 @@ NAN_METHOD(Connection::fnTouch)
         return Nan::ThrowError(Error::create("bad callback passed"));
     }
 
-    lcb_STATUS err = enc.execute<&lcb_touch>();
+    lcb_STATUS err = enc.executeKv<&lcb_touch>();
     if (err) {
         return Nan::ThrowError(Error::create(err));
     }
@@ -350,7 +351,7 @@ NAN_METHOD(Connection::fnUnlock)
     if (!enc.parseOption<&lcb_cmdunlock_collection>(info[0], info[1])) {
         return Nan::ThrowError(Error::create("bad scope/collection passed"));
     }
-    if (!enc.parseOption<&lcb_cmdunlock_key>(info[2])) {
+    if (!enc.parseKey<&lcb_cmdunlock_key>(info[2])) {
         return Nan::ThrowError(Error::create("bad key passed"));
     }
     if (!enc.parseCasOption<&lcb_cmdunlock_cas>(info[3])) {
@@ -363,7 +364,7 @@ NAN_METHOD(Connection::fnUnlock)
         return Nan::ThrowError(Error::create("bad callback passed"));
     }
 
-    lcb_STATUS err = enc.execute<&lcb_unlock>();
+    lcb_STATUS err = enc.executeKv<&lcb_unlock>();
     if (err) {
         return Nan::ThrowError(Error::create(err));
     }
@@ -386,7 +387,7 @@ NAN_METHOD(Connection::fnCounter)
     if (!enc.parseOption<&lcb_cmdcounter_collection>(info[0], info[1])) {
         return Nan::ThrowError(Error::create("bad scope/collection passed"));
     }
-    if (!enc.parseOption<&lcb_cmdcounter_key>(info[2])) {
+    if (!enc.parseKey<&lcb_cmdcounter_key>(info[2])) {
         return Nan::ThrowError(Error::create("bad key passed"));
     }
     if (!enc.parseOption<&lcb_cmdcounter_delta>(info[3])) {
@@ -416,7 +417,7 @@ NAN_METHOD(Connection::fnCounter)
         return Nan::ThrowError(Error::create("bad callback passed"));
     }
 
-    lcb_STATUS err = enc.execute<&lcb_counter>();
+    lcb_STATUS err = enc.executeKv<&lcb_counter>();
     if (err) {
         return Nan::ThrowError(Error::create(err));
     }
@@ -455,6 +456,24 @@ NAN_METHOD(Connection::fnLookupIn)
 
     Local<Array> cmds = info[4].As<v8::Array>();
 
+    SubdocTemplate *tmpl = SubdocTemplate::fromCmds(cmds);
+    if (tmpl) {
+        if (tmpl->isMutation()) {
+            return Nan::ThrowError(Error::create("unexpected optype"));
+        }
+
+        // The command shares the specs of the template instead of copying
+        // them.
+        lcb_cmdsubdoc_specs(enc.cmd(), tmpl->lookupSpecs());
+
+        lcb_STATUS err = enc.execute<&lcb_subdoc>();
+        if (err) {
+            return Nan::ThrowError(Error::create(err));
+        }
+
+        return info.GetReturnValue().Set(true);
+    }
+
     size_t numCmds = cmds->Length() / 3;
     CmdBuilder<lcb_SUBDOCSPECS> cmdsEnc =
         enc.makeSubCmdBuilder<lcb_SUBDOCSPECS>(numCmds);
@@ -551,6 +570,28 @@ NAN_METHOD(Connection::fnMutateIn)
 
     Local<Array> cmds = info[6].As<v8::Array>();
 
+    SubdocTemplate *tmpl = SubdocTemplate::fromCmds(cmds);
+    if (tmpl) {
+        if (!tmpl->isMutation()) {
+            return Nan::ThrowError(Error::create("unexpected optype"));
+        }
+
+        CmdBuilder<lcb_SUBDOCSPECS> cmdsEnc =
+            enc.makeSubCmdBuilder<lcb_SUBDOCSPECS>(tmpl->size());
+        if (!tmpl->encodeMutation(cmdsEnc, cmds)) {
+            return Nan::ThrowError(Error::create("bad spec values passed"));
+        }
+
+        lcb_cmdsubdoc_specs(enc.cmd(), cmdsEnc.cmd());
+
+        lcb_STATUS err = enc.execute<&lcb_subdoc>();
+        if (err) {
+            return Nan::ThrowError(Error::create(err));
+        }
+
+        return info.GetReturnValue().Set(true);
+    }
+
     size_t numCmds = cmds->Length() / 4;
     CmdBuilder<lcb_SUBDOCSPECS> cmdsEnc =
         enc.makeSubCmdBuilder<lcb_SUBDOCSPECS>(numCmds);
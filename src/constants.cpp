@@ -1,5 +1,6 @@
 #include "constants.h"
 
+#include "cas.h"
 #include "lcbx.h"
 #include <libcouchbase/couchbase.h>
 
@@ -254,6 +255,10 @@ NAN_MODULE_INIT(Init)
 
     X(LCBX_RESP_F_NONFINAL)
 
+    X(CAS_MODE_BUFFER)
+    X(CAS_MODE_COMPACT)
+    X(CAS_MODE_BIGINT)
+
 #undef X
 }
 
@@ -3,8 +3,38 @@
 namespace couchnode
 {
 
+void KvErrorContext::assign(const lcb_KEY_VALUE_ERROR_CONTEXT *ctx)
+{
+    const char *value;
+    size_t nvalue;
+
+    valid = true;
+    lcb_errctx_kv_status_code(ctx, &statusCode);
+    lcb_errctx_kv_opaque(ctx, &opaque);
+    lcb_errctx_kv_cas(ctx, &cas);
+    if (lcb_errctx_kv_key(ctx, &value, &nvalue) == LCB_SUCCESS) {
+        key.assign(value, nvalue);
+    }
+    if (lcb_errctx_kv_bucket(ctx, &value, &nvalue) == LCB_SUCCESS) {
+        bucket.assign(value, nvalue);
+    }
+    if (lcb_errctx_kv_collection(ctx, &value, &nvalue) == LCB_SUCCESS) {
+        collection.assign(value, nvalue);
+    }
+    if (lcb_errctx_kv_scope(ctx, &value, &nvalue) == LCB_SUCCESS) {
+        scope.assign(value, nvalue);
+    }
+    if (lcb_errctx_kv_context(ctx, &value, &nvalue) == LCB_SUCCESS) {
+        context.assign(value, nvalue);
+    }
+    if (lcb_errctx_kv_ref(ctx, &value, &nvalue) == LCB_SUCCESS) {
+        ref.assign(value, nvalue);
+    }
+}
+
 NAN_MODULE_INIT(Error::Init)
 {
+    KvError::Init(target);
 }
 
 Local<Value> Error::create(const std::string &msg, lcb_STATUS err)
@@ -29,4 +59,141 @@ Local<Value> Error::create(lcb_STATUS err)
     return errObj;
 }
 
+Local<Value> Error::shared(lcb_STATUS err)
+{
+    if (err == LCB_SUCCESS) {
+        return Nan::Null();
+    }
+
+    auto &cache = addondata::Get()->_sharedErrors;
+    auto iter = cache.find(err);
+    if (iter != cache.end()) {
+        return Nan::New<Object>(*iter->second);
+    }
+
+    Local<Object> errObj = Nan::New<Object>();
+    Nan::Set(errObj, Nan::New<String>("code").ToLocalChecked(),
+             Nan::New<Integer>(err));
+    Nan::Set(errObj, Nan::New<String>("message").ToLocalChecked(),
+             Nan::New<String>(lcb_strerror_long(err)).ToLocalChecked());
+    errObj->SetIntegrityLevel(Nan::GetCurrentContext(), IntegrityLevel::kFrozen)
+        .FromJust();
+
+    cache[err] = new Nan::Persistent<Object>(errObj);
+    return errObj;
+}
+
+NAN_MODULE_INIT(KvError::Init)
+{
+    Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>();
+    tpl->SetClassName(Nan::New<String>("CbKvError").ToLocalChecked());
+
+    Local<ObjectTemplate> inst = tpl->InstanceTemplate();
+    inst->SetInternalFieldCount(1);
+    Nan::SetAccessor(inst, Nan::New<String>("code").ToLocalChecked(),
+                     fnGetCode);
+    Nan::SetAccessor(inst, Nan::New<String>("message").ToLocalChecked(),
+                     fnGetMessage);
+    Nan::SetAccessor(inst, Nan::New<String>("ctxtype").ToLocalChecked(),
+                     fnGetCtxType);
+    Nan::SetAccessor(inst, Nan::New<String>("status_code").ToLocalChecked(),
+                     fnGetStatusCode);
+    Nan::SetAccessor(inst, Nan::New<String>("opaque").ToLocalChecked(),
+                     fnGetOpaque);
+    Nan::SetAccessor(inst, Nan::New<String>("cas").ToLocalChecked(),
+                     fnGetCas);
+    Nan::SetAccessor(inst, Nan::New<String>("key").ToLocalChecked(),
+                     fnGetKey);
+    Nan::SetAccessor(inst, Nan::New<String>("bucket").ToLocalChecked(),
+                     fnGetBucket);
+    Nan::SetAccessor(inst, Nan::New<String>("collection").ToLocalChecked(),
+                     fnGetCollection);
+    Nan::SetAccessor(inst, Nan::New<String>("scope").ToLocalChecked(),
+                     fnGetScope);
+    Nan::SetAccessor(inst, Nan::New<String>("context").ToLocalChecked(),
+                     fnGetContext);
+    Nan::SetAccessor(inst, Nan::New<String>("ref").ToLocalChecked(),
+                     fnGetRef);
+
+    constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
+}
+
+KvError::KvError(lcb_STATUS err, const KvErrorContext &ctx, CasMode casMode)
+    : _err(err)
+    , _ctx(ctx)
+    , _casMode(casMode)
+{
+}
+
+Local<Value> KvError::create(lcb_STATUS err, const KvErrorContext &ctx,
+                             CasMode casMode)
+{
+    if (err == LCB_SUCCESS) {
+        return Nan::Null();
+    }
+
+    Local<Object> ret =
+        Nan::NewInstance(Nan::New<Function>(constructor())).ToLocalChecked();
+    KvError *kvErr = new KvError(err, ctx, casMode);
+    kvErr->Wrap(ret);
+    return ret;
+}
+
+#define KVERROR_SELF()                                                         \
+    KvError *self = Nan::ObjectWrap::Unwrap<KvError>(info.Holder())
+
+NAN_GETTER(KvError::fnGetCode)
+{
+    KVERROR_SELF();
+    info.GetReturnValue().Set(Nan::New<Integer>(self->_err));
+}
+
+NAN_GETTER(KvError::fnGetMessage)
+{
+    KVERROR_SELF();
+    info.GetReturnValue().Set(
+        Nan::New<String>(lcb_strerror_long(self->_err)).ToLocalChecked());
+}
+
+NAN_GETTER(KvError::fnGetCtxType)
+{
+    info.GetReturnValue().Set(Nan::New<String>("kv").ToLocalChecked());
+}
+
+NAN_GETTER(KvError::fnGetStatusCode)
+{
+    KVERROR_SELF();
+    info.GetReturnValue().Set(Nan::New<Number>(self->_ctx.statusCode));
+}
+
+NAN_GETTER(KvError::fnGetOpaque)
+{
+    KVERROR_SELF();
+    info.GetReturnValue().Set(Nan::New<Number>(self->_ctx.opaque));
+}
+
+NAN_GETTER(KvError::fnGetCas)
+{
+    KVERROR_SELF();
+    info.GetReturnValue().Set(Cas::create(self->_ctx.cas, self->_casMode));
+}
+
+#define KVERROR_STRING_GETTER(name, field)                                     \
+    NAN_GETTER(KvError::name)                                                  \
+    {                                                                          \
+        KVERROR_SELF();                                                        \
+        info.GetReturnValue().Set(                                             \
+            Nan::New<String>(self->_ctx.field).ToLocalChecked());              \
+    }
+
+KVERROR_STRING_GETTER(fnGetKey, key)
+KVERROR_STRING_GETTER(fnGetBucket, bucket)
+KVERROR_STRING_GETTER(fnGetCollection, collection)
+KVERROR_STRING_GETTER(fnGetScope, scope)
+KVERROR_STRING_GETTER(fnGetContext, context)
+KVERROR_STRING_GETTER(fnGetRef, ref)
+
+#undef KVERROR_STRING_GETTER
+#undef KVERROR_SELF
+
 } // namespace couchnode
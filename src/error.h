@@ -2,15 +2,43 @@
 #ifndef ERROR_H
 #define ERROR_H
 
+#include "addondata.h"
+#include "cas.h"
 #include <libcouchbase/couchbase.h>
 #include <nan.h>
 #include <node.h>
+#include <string>
 
 namespace couchnode
 {
 
 using namespace v8;
 
+// The parts of a key-value error context which are surfaced to JS, copied
+// out of the response before it is released.
+struct KvErrorContext {
+    KvErrorContext()
+        : valid(false)
+        , statusCode(0)
+        , opaque(0)
+        , cas(0)
+    {
+    }
+
+    void assign(const lcb_KEY_VALUE_ERROR_CONTEXT *ctx);
+
+    bool valid;
+    uint16_t statusCode;
+    uint32_t opaque;
+    uint64_t cas;
+    std::string key;
+    std::string bucket;
+    std::string collection;
+    std::string scope;
+    std::string context;
+    std::string ref;
+};
+
 class Error
 {
 public:
@@ -19,6 +47,49 @@ public:
     static Local<Value> create(const std::string &msg,
                                lcb_STATUS err = LCB_ERR_GENERIC);
     static Local<Value> create(lcb_STATUS err);
+
+    // Returns a frozen { code } object which is shared by every caller
+    // asking for the same status, for errors which carry no context.
+    static Local<Value> shared(lcb_STATUS err);
+};
+
+// A key-value error.  Unlike the errors built by Error::create(), no JS
+// Error (and stack trace) is created; the object only wraps a copy of the
+// native error context and its properties are read from it on access.
+// This keeps expected failures such as a document not being found about as
+// cheap as a successful operation.
+class KvError : public Nan::ObjectWrap
+{
+public:
+    static NAN_MODULE_INIT(Init);
+
+    static Local<Value> create(lcb_STATUS err, const KvErrorContext &ctx,
+                               CasMode casMode);
+
+    static inline Nan::Persistent<Function> &constructor()
+    {
+        return addondata::Get()->_kvErrorConstructor;
+    }
+
+private:
+    KvError(lcb_STATUS err, const KvErrorContext &ctx, CasMode casMode);
+
+    static NAN_GETTER(fnGetCode);
+    static NAN_GETTER(fnGetMessage);
+    static NAN_GETTER(fnGetCtxType);
+    static NAN_GETTER(fnGetStatusCode);
+    static NAN_GETTER(fnGetOpaque);
+    static NAN_GETTER(fnGetCas);
+    static NAN_GETTER(fnGetKey);
+    static NAN_GETTER(fnGetBucket);
+    static NAN_GETTER(fnGetCollection);
+    static NAN_GETTER(fnGetScope);
+    static NAN_GETTER(fnGetContext);
+    static NAN_GETTER(fnGetRef);
+
+    lcb_STATUS _err;
+    KvErrorContext _ctx;
+    CasMode _casMode;
 };
 
 } // namespace couchnode
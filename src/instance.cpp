@@ -13,16 +13,18 @@ Instance::Instance(lcb_INSTANCE *instance, Logger *logger,
     , _tracer(tracer)
     , _meter(meter)
     , _clientStringCache(nullptr)
+    , _casMode(CAS_MODE_BUFFER)
+    , _flushScheduled(false)
+    , _shards(nullptr)
+    , _completions(nullptr)
+    , _pendingBootstraps(0)
+    , _bootstrapErr(LCB_SUCCESS)
     , _bootstrapCookie(nullptr)
     , _openCookie(nullptr)
 {
     _parent = addondata::Get();
     _parent->add_instance(this);
 
-    _flushWatch = new uv_prepare_t();
-    uv_prepare_init(Nan::GetCurrentEventLoop(), _flushWatch);
-    _flushWatch->data = this;
-
     _shutdownProc = new uv_check_t();
     uv_check_init(Nan::GetCurrentEventLoop(), _shutdownProc);
     _shutdownProc->data = this;
@@ -30,6 +32,7 @@ Instance::Instance(lcb_INSTANCE *instance, Logger *logger,
     lcb_set_cookie(instance, reinterpret_cast<void *>(this));
     lcb_set_bootstrap_callback(instance, &lcbBootstapHandler);
     lcb_set_open_callback(instance, &lcbOpenHandler);
+    lcb_set_sched_flush_callback(instance, &lcbSchedFlushHandler);
     lcb_install_callback(
         instance, LCB_CALLBACK_GET,
         reinterpret_cast<lcb_RESPCALLBACK>(&lcbGetRespHandler));
@@ -71,20 +74,23 @@ Instance::Instance(lcb_INSTANCE *instance, Logger *logger,
         reinterpret_cast<lcb_RESPCALLBACK>(&lcbHttpDataHandler));
 }
 
+void Instance::enableShards(IoShards *shards, CompletionQueue *completions)
+{
+    _shards = shards;
+    _completions = completions;
+}
+
 Instance::~Instance()
 {
+    // When the isolate itself is going away, nothing can be delivered to it
+    // anymore.
+    bool exiting = false;
     if (_parent) {
+        exiting = _parent->_exiting;
         _parent->remove_instance(this);
         _parent = nullptr;
     }
 
-    if (_flushWatch) {
-        uv_prepare_stop(_flushWatch);
-        uv_close(reinterpret_cast<uv_handle_t *>(_flushWatch),
-                 [](uv_handle_t *handle) { delete handle; });
-        _flushWatch = nullptr;
-    }
-
     if (_shutdownProc) {
         uv_check_stop(_shutdownProc);
         uv_close(reinterpret_cast<uv_handle_t *>(_shutdownProc),
@@ -92,6 +98,21 @@ Instance::~Instance()
         _shutdownProc = nullptr;
     }
 
+    // Our operations still in flight on the shards are canceled, with the
+    // cancellations reported once we return to the loop.  This must happen
+    // before the instance is destroyed, since the trace spans of those
+    // operations belong to it.
+    if (_completions) {
+        _completions->close(!exiting);
+    }
+    if (_shards) {
+        // Detaching our sink lets go of the last reference to the queue, and
+        // of what we log and meter along with it.
+        _shards->release(ShardSink{_completions, _logger, _meter});
+        _shards = nullptr;
+    }
+    _completions = nullptr;
+
     if (_instance) {
         lcb_destroy(_instance);
         _instance = nullptr;
@@ -121,6 +142,7 @@ Instance::~Instance()
         delete[] _clientStringCache;
         _clientStringCache = nullptr;
     }
+    _bucketNameCache.Reset();
     if (_bootstrapCookie) {
         delete _bootstrapCookie;
         _bootstrapCookie = nullptr;
@@ -148,6 +170,23 @@ const char *Instance::bucketName()
     return value;
 }
 
+Local<Value> Instance::bucketNameValue()
+{
+    if (_bucketNameCache.IsEmpty()) {
+        const char *value = bucketName();
+        if (!value) {
+            return Nan::Undefined();
+        }
+        _bucketNameCache.Reset(Nan::New<String>(value).ToLocalChecked());
+    }
+    return Nan::New<String>(_bucketNameCache);
+}
+
+void Instance::resetBucketNameValue()
+{
+    _bucketNameCache.Reset();
+}
+
 const char *Instance::clientString()
 {
     // Check to see if our cache is already populated
@@ -177,12 +216,6 @@ const char *Instance::clientString()
     return _clientStringCache;
 }
 
-void Instance::uvFlushHandler(uv_prepare_t *handle)
-{
-    Instance *me = reinterpret_cast<Instance *>(handle->data);
-    lcb_sched_flush(me->_instance);
-}
-
 void Instance::lcbBootstapHandler(lcb_INSTANCE *instance, lcb_STATUS err)
 {
     Instance *me = Instance::fromLcbInst(instance);
@@ -192,24 +225,49 @@ void Instance::lcbBootstapHandler(lcb_INSTANCE *instance, lcb_STATUS err)
         lcb_destroy_async(instance, NULL);
         me->_instance = nullptr;
     } else {
-        uv_prepare_start(me->_flushWatch, &uvFlushHandler);
-
         int flushMode = 0;
         lcb_cntl(instance, LCB_CNTL_SET, LCB_CNTL_SCHED_IMPLICIT_FLUSH,
                  &flushMode);
+        me->scheduleFlush();
+    }
+
+    me->bootstrapDone(err);
+}
+
+void Instance::bootstrapDone(lcb_STATUS err)
+{
+    if (_pendingBootstraps == 0) {
+        return;
+    }
+
+    // The connection is only usable once the I/O shards are too, so the
+    // first failure of any of them is what gets reported.
+    if (_bootstrapErr == LCB_SUCCESS) {
+        _bootstrapErr = err;
+    }
+    if (--_pendingBootstraps > 0) {
+        return;
     }
 
-    if (me->_bootstrapCookie) {
+    if (_bootstrapCookie) {
         Nan::HandleScope scope;
 
-        Local<Value> args[] = {Error::create(err)};
-        me->_bootstrapCookie->Call(1, args);
+        Local<Value> args[] = {Error::create(_bootstrapErr)};
+        _bootstrapCookie->Call(1, args);
 
-        delete me->_bootstrapCookie;
-        me->_bootstrapCookie = nullptr;
+        delete _bootstrapCookie;
+        _bootstrapCookie = nullptr;
     }
 }
 
+void Instance::lcbSchedFlushHandler(lcb_INSTANCE *instance)
+{
+    // Once implicit flushing is off, this is invoked for every command left
+    // unflushed, including those libcouchbase queues by itself.
+    Instance *me = Instance::fromLcbInst(instance);
+    me->scheduleFlush();
+}
+
 void Instance::lcbOpenHandler(lcb_INSTANCE *instance, lcb_STATUS err)
 {
     Instance *me = Instance::fromLcbInst(instance);
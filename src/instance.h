@@ -4,6 +4,7 @@
 
 #include "addondata.h"
 #include "cookie.h"
+#include "ioshards.h"
 #include "logger.h"
 #include "metrics.h"
 #include "tracing.h"
@@ -40,14 +41,33 @@ public:
 
     void shutdown();
 
+    // Takes over a reference to the shards, along with the queue which was
+    // attached to them as our sink.
+    void enableShards(IoShards *shards, CompletionQueue *completions);
+
+    // Invoked once our own instance and each of the I/O shards finished
+    // bootstrapping, invoking the connect callback after the last of them.
+    void bootstrapDone(lcb_STATUS err);
+
     const char *bucketName();
     const char *clientString();
 
-    static void uvFlushHandler(uv_prepare_t *handle);
+    // Requests a flush of the operations scheduled on this instance.
+    void scheduleFlush()
+    {
+        _parent->schedule_flush(this);
+    }
+
+    // The bucket name as a string which is shared by the mutation tokens
+    // of this instance, or undefined if no bucket has been opened.
+    Local<Value> bucketNameValue();
+    void resetBucketNameValue();
+
     static void uvShutdownHandler(uv_check_t *handle);
     static void lcbRegisterCallbacks(lcb_INSTANCE *instance);
     static void lcbBootstapHandler(lcb_INSTANCE *instance, lcb_STATUS err);
     static void lcbOpenHandler(lcb_INSTANCE *instance, lcb_STATUS err);
+    static void lcbSchedFlushHandler(lcb_INSTANCE *instance);
     static void lcbGetRespHandler(lcb_INSTANCE *instance, int cbtype,
                                   const lcb_RESPGET *resp);
     static void lcbExistsRespHandler(lcb_INSTANCE *instance, int cbtype,
@@ -88,10 +108,19 @@ public:
     Logger *_logger;
     RequestTracer *_tracer;
     Meter *_meter;
-    uv_prepare_t *_flushWatch;
+    bool _flushScheduled;
     uv_check_t *_shutdownProc;
     const char *_clientStringCache;
+    Nan::Persistent<String> _bucketNameCache;
+    CasMode _casMode;
+
+    // Optional I/O threads which key-value operations are dispatched to
+    // instead of this instance, and the queue their results come back on.
+    IoShards *_shards;
+    CompletionQueue *_completions;
 
+    size_t _pendingBootstraps;
+    lcb_STATUS _bootstrapErr;
     Cookie *_bootstrapCookie;
     Cookie *_openCookie;
 };
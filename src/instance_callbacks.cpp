@@ -4,6 +4,7 @@
 #include "error.h"
 #include "mutationtoken.h"
 #include "respreader.h"
+#include "sdresult.h"
 
 namespace couchnode
 {
@@ -215,29 +216,24 @@ void Instance::lcbLookupRespHandler(lcb_INSTANCE *instance, int cbtype,
 
         Local<Array> resArr = Nan::New<Array>(numResults);
         for (size_t i = 0; i < numResults; ++i) {
-            Local<Object> resObj = Nan::New<Object>();
-
             lcb_STATUS itemstatus =
                 rdr.getValue<&lcb_respsubdoc_result_status>(i);
-            Nan::Set(resObj, Nan::New("error").ToLocalChecked(),
-                     Error::create(itemstatus));
 
+            Local<Object> resObj;
             if (itemstatus == LCB_SUCCESS) {
-                Nan::Set(resObj, Nan::New("value").ToLocalChecked(),
-                         rdr.parseValue<&lcb_respsubdoc_result_value>(i));
+                resObj = SubdocResult::createLookupItem(
+                    Local<Value>(),
+                    rdr.parseValue<&lcb_respsubdoc_result_value>(i));
             } else {
-                Nan::Set(resObj, Nan::New("value").ToLocalChecked(),
-                         Nan::Null());
+                resObj = SubdocResult::createLookupItem(
+                    Error::shared(itemstatus), Nan::Null());
             }
 
             Nan::Set(resArr, i, resObj);
         }
 
-        Local<Object> resObj = Nan::New<Object>();
-        Nan::Set(resObj, Nan::New("cas").ToLocalChecked(),
-                 rdr.decodeCas<&lcb_respsubdoc_cas>());
-        Nan::Set(resObj, Nan::New("content").ToLocalChecked(), resArr);
-        resVal = resObj;
+        resVal = SubdocResult::createResult(
+            rdr.decodeCas<&lcb_respsubdoc_cas>(), resArr);
     } else {
         resVal = Nan::Null();
     }
@@ -273,26 +269,21 @@ void Instance::lcbMutateRespHandler(lcb_INSTANCE *instance, int cbtype,
 
         Local<Array> resArr = Nan::New<Array>(numResults);
         for (size_t i = 0; i < numResults; ++i) {
-            Local<Object> resObj = Nan::New<Object>();
-
             lcb_STATUS itemstatus =
                 rdr.getValue<&lcb_respsubdoc_result_status>(i);
+
+            Local<Value> value;
             if (itemstatus == LCB_SUCCESS) {
-                Nan::Set(resObj, Nan::New("value").ToLocalChecked(),
-                         rdr.parseValue<&lcb_respsubdoc_result_value>(i));
+                value = rdr.parseValue<&lcb_respsubdoc_result_value>(i);
             } else {
-                Nan::Set(resObj, Nan::New("value").ToLocalChecked(),
-                         Nan::Null());
+                value = Nan::Null();
             }
 
-            Nan::Set(resArr, i, resObj);
+            Nan::Set(resArr, i, SubdocResult::createMutateItem(value));
         }
 
-        Local<Object> resObj = Nan::New<Object>();
-        Nan::Set(resObj, Nan::New("cas").ToLocalChecked(),
-                 rdr.decodeCas<&lcb_respsubdoc_cas>());
-        Nan::Set(resObj, Nan::New("content").ToLocalChecked(), resArr);
-        resVal = resObj;
+        resVal = SubdocResult::createResult(
+            rdr.decodeCas<&lcb_respsubdoc_cas>(), resArr);
     } else {
         resVal = Nan::Null();
     }
@@ -326,6 +317,85 @@ void Instance::lcbViewDataHandler(lcb_INSTANCE *instance, int cbtype,
     }
 }
 
+/*
+ * Builds the metadata of a query result from the fields which libcouchbase
+ * has already decoded, so that it does not need to be parsed again as JSON.
+ * The signature and profile are left encoded, as their shape is not known.
+ */
+static Local<Value> createQueryMeta(const lcb_QUERY_META *meta)
+{
+    const char *value = nullptr;
+    size_t nvalue = 0;
+    Local<Object> metaObj = Nan::New<Object>();
+
+    lcb_querymeta_request_id(meta, &value, &nvalue);
+    Nan::Set(metaObj, Nan::New("requestId").ToLocalChecked(),
+             Nan::New<String>(value, nvalue).ToLocalChecked());
+    lcb_querymeta_client_context_id(meta, &value, &nvalue);
+    Nan::Set(metaObj, Nan::New("clientContextId").ToLocalChecked(),
+             Nan::New<String>(value, nvalue).ToLocalChecked());
+    lcb_querymeta_status(meta, &value, &nvalue);
+    Nan::Set(metaObj, Nan::New("status").ToLocalChecked(),
+             Nan::New<String>(value, nvalue).ToLocalChecked());
+    if (lcb_querymeta_signature(meta, &value, &nvalue) == LCB_SUCCESS) {
+        Nan::Set(metaObj, Nan::New("signature").ToLocalChecked(),
+                 Nan::New<String>(value, nvalue).ToLocalChecked());
+    }
+    if (lcb_querymeta_profile(meta, &value, &nvalue) == LCB_SUCCESS) {
+        Nan::Set(metaObj, Nan::New("profile").ToLocalChecked(),
+                 Nan::New<String>(value, nvalue).ToLocalChecked());
+    }
+
+    size_t numWarnings = lcb_querymeta_warning_count(meta);
+    Local<Array> warningsArr = Nan::New<Array>(numWarnings);
+    for (size_t i = 0; i < numWarnings; ++i) {
+        uint32_t code = 0;
+        lcb_querymeta_warning(meta, i, &code, &value, &nvalue);
+
+        Local<Object> warningObj = Nan::New<Object>();
+        Nan::Set(warningObj, Nan::New("code").ToLocalChecked(),
+                 Nan::New<Number>(code));
+        Nan::Set(warningObj, Nan::New("message").ToLocalChecked(),
+                 Nan::New<String>(value, nvalue).ToLocalChecked());
+        Nan::Set(warningsArr, i, warningObj);
+    }
+    Nan::Set(metaObj, Nan::New("warnings").ToLocalChecked(), warningsArr);
+
+    if (lcb_querymeta_has_metrics(meta)) {
+        static const struct {
+            const char *name;
+            lcb_QUERY_METRIC metric;
+        } counts[] = {
+            {"sortCount", LCB_QUERY_METRIC_SORT_COUNT},
+            {"resultCount", LCB_QUERY_METRIC_RESULT_COUNT},
+            {"resultSize", LCB_QUERY_METRIC_RESULT_SIZE},
+            {"mutationCount", LCB_QUERY_METRIC_MUTATION_COUNT},
+            {"errorCount", LCB_QUERY_METRIC_ERROR_COUNT},
+            {"warningCount", LCB_QUERY_METRIC_WARNING_COUNT},
+        };
+        uint64_t metricVal = 0;
+        Local<Object> metricsObj = Nan::New<Object>();
+
+        // Times are reported to JS in milliseconds
+        lcb_querymeta_metric(meta, LCB_QUERY_METRIC_ELAPSED_TIME_US,
+                             &metricVal);
+        Nan::Set(metricsObj, Nan::New("elapsedTime").ToLocalChecked(),
+                 Nan::New<Number>(metricVal / 1000.0));
+        lcb_querymeta_metric(meta, LCB_QUERY_METRIC_EXECUTION_TIME_US,
+                             &metricVal);
+        Nan::Set(metricsObj, Nan::New("executionTime").ToLocalChecked(),
+                 Nan::New<Number>(metricVal / 1000.0));
+        for (const auto &count : counts) {
+            lcb_querymeta_metric(meta, count.metric, &metricVal);
+            Nan::Set(metricsObj, Nan::New(count.name).ToLocalChecked(),
+                     Nan::New<Number>(static_cast<double>(metricVal)));
+        }
+        Nan::Set(metaObj, Nan::New("metrics").ToLocalChecked(), metricsObj);
+    }
+
+    return metaObj;
+}
+
 void Instance::lcbQueryDataHandler(lcb_INSTANCE *instance, int cbtype,
                                    const lcb_RESPQUERY *resp)
 {
@@ -335,14 +405,25 @@ void Instance::lcbQueryDataHandler(lcb_INSTANCE *instance, int cbtype,
     lcb_STATUS rc = rdr.getValue<&lcb_respquery_status>();
     Local<Value> errVal = rdr.decodeError<lcb_respquery_error_context>(rc);
 
-    Local<Value> dataRes = rdr.parseValue<&lcb_respquery_row>();
-
     uint32_t rflags = 0;
     if (!rdr.getValue<&lcb_respquery_is_final>()) {
         rflags |= LCBX_RESP_F_NONFINAL;
     }
     Local<Value> flagsVal = Nan::New<Number>(rflags);
 
+    // Rows are passed on as they are, but the final metadata has already
+    // been parsed by libcouchbase and is passed on in its decoded form.
+    Local<Value> dataRes;
+    const lcb_QUERY_META *meta = nullptr;
+    if (rflags & LCBX_RESP_F_NONFINAL) {
+        dataRes = rdr.parseValue<&lcb_respquery_row>();
+    } else if (rc == LCB_SUCCESS &&
+               lcb_respquery_meta(resp, &meta) == LCB_SUCCESS) {
+        dataRes = createQueryMeta(meta);
+    } else {
+        dataRes = Nan::Null();
+    }
+
     if (rflags & LCBX_RESP_F_NONFINAL) {
         rdr.invokeNonFinalCallback(errVal, flagsVal, dataRes);
     } else {
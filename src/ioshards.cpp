@@ -0,0 +1,914 @@
+#include "ioshards.h"
+
+#include "cas.h"
+#include "error.h"
+#include "logger.h"
+#include "metrics.h"
+#include "mutationtoken.h"
+#include "opbuilder.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <libcouchbase/libuv_io_opts.h>
+#include <map>
+#include <mutex>
+
+namespace couchnode
+{
+
+KvIoOp::KvIoOp(OpCookie *cookie, int cbtype)
+    : _cookie(cookie)
+    , _cbtype(cbtype)
+    , _rc(LCB_SUCCESS)
+    , _cas(0)
+    , _flags(0)
+    , _found(false)
+    , _counterValue(0)
+    , _hasToken(false)
+    , _hasTimings(false)
+    , _queueUs(0)
+    , _networkUs(0)
+    , _serverUs(0)
+    , _traced(cookie && cookie->_traceSpan)
+    , _shardSpan(nullptr)
+{
+}
+
+KvIoOp::~KvIoOp()
+{
+    if (_cookie) {
+        delete _cookie;
+        _cookie = nullptr;
+    }
+}
+
+void KvIoOp::fail(lcb_STATUS err)
+{
+    endShardTrace();
+    _rc = err;
+    _completions->push(this);
+}
+
+// The span recorded by the tracer of the shard instances.  Spans which do
+// not descend from the span of an operation are not recorded at all.
+struct ShardSpan {
+    KvIoOp *op;
+    size_t index;
+};
+
+// The operation starting its span on the current I/O thread, which is how
+// the tracer tells which operation a span without a parent belongs to.
+static thread_local KvIoOp *tracingOp = nullptr;
+
+static void *lcbShardTracerStartSpan(lcbtrace_TRACER *tracer,
+                                     const char *name, void *parent)
+{
+    ShardSpan *parentSpan = reinterpret_cast<ShardSpan *>(parent);
+
+    // libcouchbase expects a span even for what we do not record.
+    ShardSpan *span = new ShardSpan{nullptr, KvIoOp::NO_PARENT};
+    span->op = parentSpan ? parentSpan->op : tracingOp;
+    if (span->op) {
+        KvIoOp::RecordedSpan rec;
+        rec.name = name;
+        rec.parent = parentSpan ? parentSpan->index : KvIoOp::NO_PARENT;
+        rec.start = lcbtrace_now();
+        rec.end = 0;
+
+        span->index = span->op->_spans.size();
+        span->op->_spans.push_back(std::move(rec));
+    }
+    return span;
+}
+
+static void lcbShardTracerEndSpan(void *procs)
+{
+    ShardSpan *span = reinterpret_cast<ShardSpan *>(procs);
+    if (span->op) {
+        span->op->_spans[span->index].end = lcbtrace_now();
+    }
+}
+
+static void lcbShardTracerDestroySpan(void *procs)
+{
+    delete reinterpret_cast<ShardSpan *>(procs);
+}
+
+static void lcbShardTracerAddTagString(void *procs, const char *name,
+                                       const char *value, size_t nvalue)
+{
+    ShardSpan *span = reinterpret_cast<ShardSpan *>(procs);
+    if (span->op) {
+        span->op->_spans[span->index].strTags.emplace_back(
+            name, std::string(value, nvalue));
+    }
+}
+
+static void lcbShardTracerAddTagUint64(void *procs, const char *name,
+                                       uint64_t value)
+{
+    ShardSpan *span = reinterpret_cast<ShardSpan *>(procs);
+    if (span->op) {
+        span->op->_spans[span->index].uintTags.emplace_back(name, value);
+    }
+}
+
+lcbtrace_SPAN *KvIoOp::startShardTrace(lcb_INSTANCE *instance)
+{
+    if (!_traced) {
+        return nullptr;
+    }
+
+    lcbtrace_TRACER *tracer = lcb_get_tracer(instance);
+    if (!tracer) {
+        return nullptr;
+    }
+
+    tracingOp = this;
+    _shardSpan = lcbtrace_span_start(tracer, "shard", LCBTRACE_NOW, nullptr);
+    tracingOp = nullptr;
+
+    // This makes the spans of the dispatches its children.
+    lcbtrace_span_set_is_outer(_shardSpan, 1);
+    return _shardSpan;
+}
+
+void KvIoOp::endShardTrace()
+{
+    // The spans of the dispatches have already ended by the time the
+    // response is handed to us.
+    if (_shardSpan) {
+        lcbtrace_span_finish(_shardSpan, LCBTRACE_NOW);
+        _shardSpan = nullptr;
+    }
+}
+
+void KvIoOp::replaySpans(OpCookie *cookie) const
+{
+    // Canceled operations are reported after their instance is gone.
+    if (_spans.empty() || !cookie->_inst || !cookie->_traceSpan) {
+        return;
+    }
+
+    lcb_INSTANCE *instance = cookie->_inst->lcbHandle();
+    if (!instance) {
+        return;
+    }
+
+    lcbtrace_TRACER *tracer = lcb_get_tracer(instance);
+    if (!tracer) {
+        return;
+    }
+
+    std::vector<lcbtrace_SPAN *> replayed(_spans.size(), nullptr);
+    for (size_t i = 0; i < _spans.size(); ++i) {
+        const RecordedSpan &rec = _spans[i];
+
+        lcbtrace_SPAN *span;
+        if (rec.parent == NO_PARENT) {
+            span = cookie->_traceSpan.span();
+        } else {
+            lcbtrace_REF ref;
+            ref.type = LCBTRACE_REF_CHILD_OF;
+            ref.span = replayed[rec.parent];
+            span = lcbtrace_span_start(tracer, rec.name.c_str(), rec.start,
+                                       &ref);
+        }
+        replayed[i] = span;
+
+        for (const auto &tag : rec.strTags) {
+            lcbtrace_span_add_tag_str(span, tag.first.c_str(),
+                                      tag.second.c_str());
+        }
+        for (const auto &tag : rec.uintTags) {
+            lcbtrace_span_add_tag_uint64(span, tag.first.c_str(), tag.second);
+        }
+    }
+
+    // Children end before their parents, the operation's own span is ended
+    // by the caller.
+    for (size_t i = _spans.size(); i-- > 0;) {
+        if (_spans[i].parent != NO_PARENT) {
+            lcbtrace_span_finish(replayed[i], _spans[i].end);
+        }
+    }
+}
+
+// Reports the cancellation of a KvIoOp the I/O thread is still working on.
+class KvCanceledOp : public KvIoOp
+{
+public:
+    KvCanceledOp(OpCookie *cookie, int cbtype)
+        : KvIoOp(cookie, cbtype)
+    {
+        _rc = LCB_ERR_REQUEST_CANCELED;
+    }
+
+    lcb_STATUS schedule(lcb_INSTANCE *) override
+    {
+        return LCB_ERR_REQUEST_CANCELED;
+    }
+};
+
+IoOp *KvIoOp::cancel()
+{
+    OpCookie *cookie = _cookie;
+    _cookie = nullptr;
+
+    // The instance is about to go away, while the cancellation is only
+    // reported after that.
+    cookie->detachInstance();
+
+    return new KvCanceledOp(cookie, _cbtype);
+}
+
+Local<Value> KvIoOp::decodeError() const
+{
+    if (_rc == LCB_SUCCESS) {
+        return Nan::Null();
+    }
+
+    if (!_errCtx.valid || !_cookie->_inst) {
+        return Error::create(_rc);
+    }
+
+    return KvError::create(_rc, _errCtx, _cookie->_inst->_casMode);
+}
+
+Local<Value> KvIoOp::decodeCas() const
+{
+    if (_rc != LCB_SUCCESS || !_cookie->_inst) {
+        return Nan::Null();
+    }
+    return Cas::create(_cas, _cookie->_inst->_casMode);
+}
+
+Local<Value> KvIoOp::decodeMutationToken(OpCookie *cookie) const
+{
+    if (_rc != LCB_SUCCESS || !_hasToken || !cookie->_inst) {
+        return Nan::Null();
+    }
+    // The shards are connected to the same bucket as the submitting
+    // instance, so its cached name can be shared.
+    return MutationToken::create(_token, cookie->_inst->bucketNameValue());
+}
+
+void KvIoOp::complete()
+{
+    Nan::HandleScope scope;
+    bench::StageTimer benchTimer(bench::STAGE_DECODE);
+
+    Local<Value> errVal = decodeError();
+    Local<Value> casVal = decodeCas();
+
+    OpCookie *cookie = _cookie;
+    _cookie = nullptr;
+
+    replaySpans(cookie);
+    cookie->endTrace();
+    if (_hasTimings) {
+        cookie->setTimings(_queueUs, _networkUs, _serverUs);
+    }
+
+    switch (_cbtype) {
+    case LCB_CALLBACK_GET: {
+        Local<Value> valueVal = Nan::Null();
+        if (_rc == LCB_SUCCESS) {
+            Nan::TryCatch tryCatch;
+            valueVal = cookie->decodeDocValue(
+                Nan::CopyBuffer(_value.data(), _value.size())
+                    .ToLocalChecked(),
+                Nan::New<Number>(_flags));
+            if (tryCatch.HasCaught()) {
+                errVal = tryCatch.Exception();
+            }
+        }
+
+        Local<Value> argsArr[] = {errVal, casVal, valueVal};
+        cookie->invokeCallback(3, argsArr);
+        break;
+    }
+    case LCB_CALLBACK_EXISTS: {
+        Local<Value> existsVal = Nan::Null();
+        if (_rc == LCB_SUCCESS) {
+            existsVal = Nan::New<Boolean>(_found);
+        }
+
+        Local<Value> argsArr[] = {errVal, casVal, existsVal};
+        cookie->invokeCallback(3, argsArr);
+        break;
+    }
+    case LCB_CALLBACK_STORE: {
+        Local<Value> argsArr[] = {errVal, casVal, decodeMutationToken(cookie)};
+        cookie->invokeCallback(3, argsArr);
+        break;
+    }
+    case LCB_CALLBACK_REMOVE:
+    case LCB_CALLBACK_TOUCH: {
+        Local<Value> argsArr[] = {errVal, casVal};
+        cookie->invokeCallback(2, argsArr);
+        break;
+    }
+    case LCB_CALLBACK_UNLOCK: {
+        Local<Value> argsArr[] = {errVal};
+        cookie->invokeCallback(1, argsArr);
+        break;
+    }
+    case LCB_CALLBACK_COUNTER: {
+        Local<Value> valueVal = Nan::Null();
+        if (_rc == LCB_SUCCESS) {
+            valueVal = Nan::New<Number>(_counterValue);
+        }
+
+        Local<Value> argsArr[] = {errVal, casVal, decodeMutationToken(cookie),
+                                  valueVal};
+        cookie->invokeCallback(4, argsArr);
+        break;
+    }
+    }
+
+    delete cookie;
+}
+
+template <typename RespType, lcb_STATUS (*CookieFn)(const RespType *, void **),
+          lcb_STATUS (*StatusFn)(const RespType *),
+          lcb_STATUS (*CtxFn)(const RespType *,
+                              const lcb_KEY_VALUE_ERROR_CONTEXT **),
+          lcb_STATUS (*CasFn)(const RespType *, uint64_t *)>
+static KvIoOp *captureKvResp(const RespType *resp)
+{
+    void *cookie = nullptr;
+    CookieFn(resp, &cookie);
+    KvIoOp *op = reinterpret_cast<KvIoOp *>(cookie);
+    op->endShardTrace();
+
+    const lcb_KEY_VALUE_ERROR_CONTEXT *ctx = nullptr;
+    if (CtxFn(resp, &ctx) != LCB_SUCCESS) {
+        ctx = nullptr;
+    }
+    if (ctx) {
+        op->_hasTimings =
+            lcb_errctx_kv_op_timings(ctx, &op->_queueUs, &op->_networkUs,
+                                     &op->_serverUs) == LCB_SUCCESS;
+    }
+
+    op->_rc = StatusFn(resp);
+    if (op->_rc == LCB_SUCCESS) {
+        CasFn(resp, &op->_cas);
+    } else if (ctx) {
+        op->_errCtx.assign(ctx);
+    }
+
+    return op;
+}
+
+template <typename RespType>
+static void captureMutationToken(
+    KvIoOp *op, const RespType *resp,
+    lcb_STATUS (*TokenFn)(const RespType *, lcb_MUTATION_TOKEN *))
+{
+    if (op->_rc != LCB_SUCCESS) {
+        return;
+    }
+
+    if (TokenFn(resp, &op->_token) == LCB_SUCCESS) {
+        op->_hasToken = true;
+    }
+}
+
+void IoShards::lcbGetRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                 const lcb_RESPGET *resp)
+{
+    KvIoOp *op = captureKvResp<lcb_RESPGET, &lcb_respget_cookie,
+                               &lcb_respget_status, &lcb_respget_error_context,
+                               &lcb_respget_cas>(resp);
+    if (op->_rc == LCB_SUCCESS) {
+        const char *value = nullptr;
+        size_t nvalue = 0;
+        lcb_respget_value(resp, &value, &nvalue);
+        op->_value.assign(value, nvalue);
+        lcb_respget_flags(resp, &op->_flags);
+    }
+    op->_completions->push(op);
+}
+
+void IoShards::lcbExistsRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                    const lcb_RESPEXISTS *resp)
+{
+    KvIoOp *op =
+        captureKvResp<lcb_RESPEXISTS, &lcb_respexists_cookie,
+                      &lcb_respexists_status, &lcb_respexists_error_context,
+                      &lcb_respexists_cas>(resp);
+    if (op->_rc == LCB_SUCCESS) {
+        op->_found = lcb_respexists_is_found(resp) != 0;
+    }
+    op->_completions->push(op);
+}
+
+void IoShards::lcbStoreRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                   const lcb_RESPSTORE *resp)
+{
+    KvIoOp *op =
+        captureKvResp<lcb_RESPSTORE, &lcb_respstore_cookie,
+                      &lcb_respstore_status, &lcb_respstore_error_context,
+                      &lcb_respstore_cas>(resp);
+    captureMutationToken(op, resp, &lcb_respstore_mutation_token);
+    op->_completions->push(op);
+}
+
+void IoShards::lcbRemoveRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                    const lcb_RESPREMOVE *resp)
+{
+    KvIoOp *op =
+        captureKvResp<lcb_RESPREMOVE, &lcb_respremove_cookie,
+                      &lcb_respremove_status, &lcb_respremove_error_context,
+                      &lcb_respremove_cas>(resp);
+    op->_completions->push(op);
+}
+
+void IoShards::lcbTouchRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                   const lcb_RESPTOUCH *resp)
+{
+    KvIoOp *op =
+        captureKvResp<lcb_RESPTOUCH, &lcb_resptouch_cookie,
+                      &lcb_resptouch_status, &lcb_resptouch_error_context,
+                      &lcb_resptouch_cas>(resp);
+    op->_completions->push(op);
+}
+
+void IoShards::lcbUnlockRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                    const lcb_RESPUNLOCK *resp)
+{
+    KvIoOp *op =
+        captureKvResp<lcb_RESPUNLOCK, &lcb_respunlock_cookie,
+                      &lcb_respunlock_status, &lcb_respunlock_error_context,
+                      &lcb_respunlock_cas>(resp);
+    op->_completions->push(op);
+}
+
+void IoShards::lcbCounterRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                     const lcb_RESPCOUNTER *resp)
+{
+    KvIoOp *op =
+        captureKvResp<lcb_RESPCOUNTER, &lcb_respcounter_cookie,
+                      &lcb_respcounter_status, &lcb_respcounter_error_context,
+                      &lcb_respcounter_cas>(resp);
+    if (op->_rc == LCB_SUCCESS) {
+        lcb_respcounter_value(resp, &op->_counterValue);
+    }
+    captureMutationToken(op, resp, &lcb_respcounter_mutation_token);
+    op->_completions->push(op);
+}
+
+ShardBootstrapOp::ShardBootstrapOp(Instance *inst)
+    : _inst(inst)
+    , _rc(LCB_SUCCESS)
+{
+}
+
+lcb_STATUS ShardBootstrapOp::schedule(lcb_INSTANCE *instance)
+{
+    _rc = IoThread::bootstrapStatus(instance);
+    _completions->push(this);
+    return LCB_SUCCESS;
+}
+
+void ShardBootstrapOp::fail(lcb_STATUS err)
+{
+    _rc = err;
+    _completions->push(this);
+}
+
+void ShardBootstrapOp::complete()
+{
+    _inst->bootstrapDone(_rc);
+}
+
+IoOp *ShardBootstrapOp::cancel()
+{
+    // The connect callback goes away with the instance.
+    return nullptr;
+}
+
+// Something the shard instances produced which is not tied to an operation,
+// delivered to the sink of the shards.
+class ShardEventOp : public IoOp
+{
+public:
+    lcb_STATUS schedule(lcb_INSTANCE *) override
+    {
+        return LCB_SUCCESS;
+    }
+
+    void fail(lcb_STATUS) override
+    {
+    }
+
+    IoOp *cancel() override
+    {
+        return nullptr;
+    }
+};
+
+class ShardLogOp : public ShardEventOp
+{
+public:
+    // The subsystem and source file are static strings of libcouchbase.
+    ShardLogOp(Logger *logger, int severity, const char *subsys,
+               const char *srcfile, int srcline, std::string &&message)
+        : _logger(logger)
+        , _severity(severity)
+        , _subsys(subsys)
+        , _srcfile(srcfile)
+        , _srcline(srcline)
+        , _message(std::move(message))
+    {
+    }
+
+    void complete() override
+    {
+        _logger->log(_severity, _subsys, _srcfile, _srcline,
+                     _message.c_str());
+    }
+
+private:
+    Logger *_logger;
+    int _severity;
+    const char *_subsys;
+    const char *_srcfile;
+    int _srcline;
+    std::string _message;
+};
+
+class ShardValueOp : public ShardEventOp
+{
+public:
+    ShardValueOp(Meter *meter, const std::string &name,
+                 const std::vector<std::pair<std::string, std::string>> &tags,
+                 uint64_t value)
+        : _meter(meter)
+        , _name(name)
+        , _tags(tags)
+        , _value(value)
+    {
+    }
+
+    void complete() override
+    {
+        _meter->recordValue(_name, _tags, _value);
+    }
+
+private:
+    Meter *_meter;
+    std::string _name;
+    std::vector<std::pair<std::string, std::string>> _tags;
+    uint64_t _value;
+};
+
+static void lcbShardLogHandler(const lcb_LOGGER *procs, uint64_t iid,
+                               const char *subsys, lcb_LOG_SEVERITY severity,
+                               const char *srcfile, int srcline,
+                               const char *fmt, va_list ap)
+{
+    IoShards *shards;
+    lcb_logger_cookie(procs, reinterpret_cast<void **>(&shards));
+
+    // The arguments do not outlive the call, so the message is formatted
+    // here rather than on the thread it is delivered to.
+    char buffer[512];
+    va_list apCopy;
+    va_copy(apCopy, ap);
+    int len = vsnprintf(buffer, sizeof(buffer), fmt, apCopy);
+    va_end(apCopy);
+    if (len < 0) {
+        return;
+    }
+
+    std::string message;
+    if (static_cast<size_t>(len) < sizeof(buffer)) {
+        message.assign(buffer, len);
+    } else {
+        message.resize(len + 1);
+        vsnprintf(&message[0], message.size(), fmt, ap);
+        message.resize(len);
+    }
+
+    shards->postLog(severity, subsys, srcfile, srcline, std::move(message));
+}
+
+// A value recorder of the shard instances, which libcouchbase caches for
+// each name and set of tags.
+struct ShardValueRecorder {
+    IoShards *shards;
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> tags;
+};
+
+static void lcbShardValueRecorderDtor(const lcbmetrics_VALUERECORDER *procs)
+{
+    ShardValueRecorder *recorder = nullptr;
+    lcbmetrics_valuerecorder_cookie(procs,
+                                    reinterpret_cast<void **>(&recorder));
+    delete recorder;
+}
+
+static void lcbShardRecordValue(const lcbmetrics_VALUERECORDER *procs,
+                                uint64_t value)
+{
+    ShardValueRecorder *recorder = nullptr;
+    lcbmetrics_valuerecorder_cookie(procs,
+                                    reinterpret_cast<void **>(&recorder));
+    if (recorder) {
+        recorder->shards->postValue(recorder->name, recorder->tags, value);
+    }
+}
+
+static const lcbmetrics_VALUERECORDER *
+lcbShardValueRecorder(const lcbmetrics_METER *procs, const char *name,
+                      const lcbmetrics_TAG *tags, size_t ntags)
+{
+    IoShards *shards = nullptr;
+    lcbmetrics_meter_cookie(procs, reinterpret_cast<void **>(&shards));
+
+    ShardValueRecorder *recorder = new ShardValueRecorder();
+    recorder->shards = shards;
+    recorder->name = name;
+    for (size_t i = 0; i < ntags; ++i) {
+        recorder->tags.emplace_back(tags[i].key, tags[i].value);
+    }
+
+    lcbmetrics_VALUERECORDER *recorderProcs;
+    lcbmetrics_valuerecorder_create(&recorderProcs, recorder);
+    lcbmetrics_valuerecorder_dtor_callback(recorderProcs,
+                                           &lcbShardValueRecorderDtor);
+    lcbmetrics_valuerecorder_record_value_callback(recorderProcs,
+                                                   &lcbShardRecordValue);
+    return recorderProcs;
+}
+
+static std::mutex registryLock;
+static std::map<std::string, IoShards *> registry;
+
+IoShards::IoShards(const ShardSink &sink)
+    : _refs(0)
+    , _logger(nullptr)
+    , _meter(nullptr)
+    , _tracer(nullptr)
+{
+    // The sink is attached before any thread starts, so that nothing the
+    // instances log while bootstrapping is lost.
+    sink.completions->retain();
+    _sinks.push_back(sink);
+
+    if (sink.logger) {
+        lcb_logger_create(&_logger, this);
+        lcb_logger_callback(_logger, &lcbShardLogHandler);
+    }
+
+    if (sink.meter) {
+        lcbmetrics_meter_create(&_meter, this);
+        lcbmetrics_meter_value_recorder_callback(_meter,
+                                                 &lcbShardValueRecorder);
+    }
+
+    // Spans are recorded even without a tracer of the connection's own, as
+    // the threshold logging of the isolates covers the shards too.
+    _tracer = new lcbtrace_TRACER();
+    _tracer->version = 1;
+    _tracer->flags = LCBTRACE_F_EXTERNAL;
+    _tracer->cookie = this;
+    _tracer->destructor = nullptr;
+    _tracer->v.v1.start_span = &lcbShardTracerStartSpan;
+    _tracer->v.v1.end_span = &lcbShardTracerEndSpan;
+    _tracer->v.v1.destroy_span = &lcbShardTracerDestroySpan;
+    _tracer->v.v1.add_tag_string = &lcbShardTracerAddTagString;
+    _tracer->v.v1.add_tag_uint64 = &lcbShardTracerAddTagUint64;
+}
+
+IoShards::~IoShards()
+{
+    for (IoThread *thread : _threads) {
+        thread->stop();
+        delete thread;
+    }
+    _threads.clear();
+
+    // The instances using these are gone now.
+    if (_logger) {
+        lcb_logger_destroy(_logger);
+        _logger = nullptr;
+    }
+    if (_meter) {
+        lcbmetrics_meter_destroy(_meter);
+        _meter = nullptr;
+    }
+    delete _tracer;
+    _tracer = nullptr;
+
+    for (const ShardSink &sink : _sinks) {
+        sink.completions->release();
+    }
+    _sinks.clear();
+}
+
+IoShards *IoShards::create(lcb_INSTANCE_TYPE connType, const char *connStr,
+                           size_t connStrLen, const char *username,
+                           size_t usernameLen, const char *password,
+                           size_t passwordLen, size_t numShards,
+                           const ShardSink &sink, lcb_STATUS *err)
+{
+    IoShards *shards = new IoShards(sink);
+
+    for (size_t i = 0; i < numShards; ++i) {
+        IoThread *thread = new IoThread();
+        shards->_threads.push_back(thread);
+
+        lcb_io_opt_st *iops;
+        lcbuv_options_t iopsOptions;
+
+        iopsOptions.version = 0;
+        iopsOptions.v.v0.loop = thread->loop();
+        iopsOptions.v.v0.startsop_noop = 1;
+
+        *err = lcb_create_libuv_io_opts(0, &iops, &iopsOptions);
+        if (*err != LCB_SUCCESS) {
+            delete shards;
+            return nullptr;
+        }
+
+        lcb_CREATEOPTS *createOpts = nullptr;
+        lcb_createopts_create(&createOpts, connType);
+        lcb_createopts_connstr(createOpts, connStr, connStrLen);
+        if (username || password) {
+            lcb_createopts_credentials(createOpts, username, usernameLen,
+                                       password, passwordLen);
+        }
+        if (shards->_logger) {
+            lcb_createopts_logger(createOpts, shards->_logger);
+        }
+        if (shards->_meter) {
+            lcb_createopts_meter(createOpts, shards->_meter);
+        }
+        lcb_createopts_tracer(createOpts, shards->_tracer);
+        lcb_createopts_io(createOpts, iops);
+
+        lcb_INSTANCE *instance;
+        *err = lcb_create(&instance, createOpts);
+        lcb_createopts_destroy(createOpts);
+
+        if (*err != LCB_SUCCESS) {
+            lcb_destroy_io_ops(iops);
+            delete shards;
+            return nullptr;
+        }
+
+        lcb_install_callback(
+            instance, LCB_CALLBACK_GET,
+            reinterpret_cast<lcb_RESPCALLBACK>(&lcbGetRespHandler));
+        lcb_install_callback(
+            instance, LCB_CALLBACK_EXISTS,
+            reinterpret_cast<lcb_RESPCALLBACK>(&lcbExistsRespHandler));
+        lcb_install_callback(
+            instance, LCB_CALLBACK_STORE,
+            reinterpret_cast<lcb_RESPCALLBACK>(&lcbStoreRespHandler));
+        lcb_install_callback(
+            instance, LCB_CALLBACK_REMOVE,
+            reinterpret_cast<lcb_RESPCALLBACK>(&lcbRemoveRespHandler));
+        lcb_install_callback(
+            instance, LCB_CALLBACK_TOUCH,
+            reinterpret_cast<lcb_RESPCALLBACK>(&lcbTouchRespHandler));
+        lcb_install_callback(
+            instance, LCB_CALLBACK_UNLOCK,
+            reinterpret_cast<lcb_RESPCALLBACK>(&lcbUnlockRespHandler));
+        lcb_install_callback(
+            instance, LCB_CALLBACK_COUNTER,
+            reinterpret_cast<lcb_RESPCALLBACK>(&lcbCounterRespHandler));
+
+        if (!thread->start(instance, iops)) {
+            *err = LCB_ERR_SDK_INTERNAL;
+            delete shards;
+            return nullptr;
+        }
+    }
+
+    *err = LCB_SUCCESS;
+    return shards;
+}
+
+IoShards *IoShards::acquire(lcb_INSTANCE_TYPE connType, const char *connStr,
+                            size_t connStrLen, const char *username,
+                            size_t usernameLen, const char *password,
+                            size_t passwordLen, size_t numShards,
+                            const ShardSink &sink, lcb_STATUS *err)
+{
+    // Which hooks the instances relay to is fixed when they are created.
+    std::string key;
+    key.append(std::to_string(connType)).append(1, '\0');
+    key.append(std::to_string(numShards)).append(1, '\0');
+    key.append(sink.logger ? "L" : "").append(sink.meter ? "M" : "");
+    key.append(1, '\0');
+    key.append(connStr ? connStr : "", connStrLen).append(1, '\0');
+    key.append(username ? username : "", usernameLen).append(1, '\0');
+    key.append(password ? password : "", passwordLen);
+
+    std::lock_guard<std::mutex> lock(registryLock);
+
+    auto iter = registry.find(key);
+    if (iter != registry.end()) {
+        IoShards *shards = iter->second;
+        if (!shards->failed()) {
+            shards->_refs++;
+
+            std::lock_guard<std::mutex> sinksLock(shards->_sinksLock);
+            sink.completions->retain();
+            shards->_sinks.push_back(sink);
+
+            *err = LCB_SUCCESS;
+            return shards;
+        }
+
+        // Whoever still uses these keeps them until they let go, but
+        // nobody new should get shards which cannot bootstrap.
+        registry.erase(iter);
+    }
+
+    IoShards *shards =
+        create(connType, connStr, connStrLen, username, usernameLen, password,
+               passwordLen, numShards, sink, err);
+    if (!shards) {
+        return nullptr;
+    }
+
+    shards->_key = key;
+    shards->_refs = 1;
+    registry.emplace(key, shards);
+    return shards;
+}
+
+void IoShards::release(const ShardSink &sink)
+{
+    {
+        std::lock_guard<std::mutex> lock(_sinksLock);
+        for (auto iter = _sinks.begin(); iter != _sinks.end(); ++iter) {
+            if (iter->completions == sink.completions) {
+                _sinks.erase(iter);
+                break;
+            }
+        }
+    }
+    sink.completions->release();
+
+    {
+        std::lock_guard<std::mutex> lock(registryLock);
+        if (--_refs > 0) {
+            return;
+        }
+
+        auto iter = registry.find(_key);
+        if (iter != registry.end() && iter->second == this) {
+            registry.erase(iter);
+        }
+    }
+
+    delete this;
+}
+
+bool IoShards::failed() const
+{
+    for (IoThread *thread : _threads) {
+        if (thread->failed()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void IoShards::postLog(int severity, const char *subsys, const char *srcfile,
+                       int srcline, std::string &&message)
+{
+    std::lock_guard<std::mutex> lock(_sinksLock);
+    if (_sinks.empty() || !_sinks.front().logger) {
+        return;
+    }
+
+    const ShardSink &sink = _sinks.front();
+    sink.completions->post(new ShardLogOp(sink.logger, severity, subsys,
+                                          srcfile, srcline,
+                                          std::move(message)));
+}
+
+void IoShards::postValue(
+    const std::string &name,
+    const std::vector<std::pair<std::string, std::string>> &tags,
+    uint64_t value)
+{
+    std::lock_guard<std::mutex> lock(_sinksLock);
+    if (_sinks.empty() || !_sinks.front().meter) {
+        return;
+    }
+
+    const ShardSink &sink = _sinks.front();
+    sink.completions->post(new ShardValueOp(sink.meter, name, tags, value));
+}
+
+} // namespace couchnode
@@ -0,0 +1,270 @@
+#pragma once
+#ifndef IOSHARDS_H
+#define IOSHARDS_H
+
+#include "error.h"
+#include "iothread.h"
+#include "lcbx.h"
+#include <libcouchbase/couchbase.h>
+#include <nan.h>
+#include <node.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace couchnode
+{
+
+using namespace v8;
+
+class Instance;
+class Logger;
+class Meter;
+class OpCookie;
+
+// A key-value operation dispatched to an I/O shard.  The response is copied
+// into the operation on the I/O thread and turned into the same callback
+// arguments the instance callbacks would have produced once it reaches the
+// submitting thread.
+class KvIoOp : public IoOp
+{
+public:
+    KvIoOp(OpCookie *cookie, int cbtype);
+    ~KvIoOp();
+
+    void fail(lcb_STATUS err) override;
+    void complete() override;
+    IoOp *cancel() override;
+
+    // Only touched by the submitting thread, which may detach it from an
+    // operation still owned by the I/O thread.
+    OpCookie *_cookie;
+    int _cbtype;
+    lcb_STATUS _rc;
+    uint64_t _cas;
+    uint32_t _flags;
+    bool _found;
+    uint64_t _counterValue;
+    bool _hasToken;
+    lcb_MUTATION_TOKEN _token;
+    std::string _value;
+    KvErrorContext _errCtx;
+    bool _hasTimings;
+    uint64_t _queueUs;
+    uint64_t _networkUs;
+    uint64_t _serverUs;
+
+    // The spans the shard instance recorded for the operation, which are
+    // replayed as children of its own span on the submitting thread.  The
+    // first one stands in for the operation's own span and has no parent.
+    static const size_t NO_PARENT = SIZE_MAX;
+    struct RecordedSpan {
+        std::string name;
+        size_t parent;
+        uint64_t start;
+        uint64_t end;
+        std::vector<std::pair<std::string, std::string>> strTags;
+        std::vector<std::pair<std::string, uint64_t>> uintTags;
+    };
+    const bool _traced;
+    lcbtrace_SPAN *_shardSpan;
+    std::vector<RecordedSpan> _spans;
+
+    // Starts the span standing in for the operation's own span on the shard
+    // instance, which the spans recorded for the operation descend from.
+    // Returns nullptr if the operation is not traced.
+    lcbtrace_SPAN *startShardTrace(lcb_INSTANCE *instance);
+    void endShardTrace();
+
+private:
+    void replaySpans(OpCookie *cookie) const;
+    Local<Value> decodeError() const;
+    Local<Value> decodeCas() const;
+    Local<Value> decodeMutationToken(OpCookie *cookie) const;
+};
+
+inline int kvCallbackType(const lcb_CMDGET *)
+{
+    return LCB_CALLBACK_GET;
+}
+
+inline int kvCallbackType(const lcb_CMDEXISTS *)
+{
+    return LCB_CALLBACK_EXISTS;
+}
+
+inline int kvCallbackType(const lcb_CMDSTORE *)
+{
+    return LCB_CALLBACK_STORE;
+}
+
+inline int kvCallbackType(const lcb_CMDREMOVE *)
+{
+    return LCB_CALLBACK_REMOVE;
+}
+
+inline int kvCallbackType(const lcb_CMDTOUCH *)
+{
+    return LCB_CALLBACK_TOUCH;
+}
+
+inline int kvCallbackType(const lcb_CMDUNLOCK *)
+{
+    return LCB_CALLBACK_UNLOCK;
+}
+
+inline int kvCallbackType(const lcb_CMDCOUNTER *)
+{
+    return LCB_CALLBACK_COUNTER;
+}
+
+template <typename CmdType,
+          lcb_STATUS (*ExecFn)(lcb_INSTANCE *, void *, const CmdType *)>
+class KvIoCmdOp : public KvIoOp
+{
+public:
+    // Takes ownership of the command.
+    KvIoCmdOp(OpCookie *cookie, CmdType *cmd)
+        : KvIoOp(cookie, kvCallbackType(cmd))
+        , _cmd(cmd)
+    {
+    }
+
+    ~KvIoCmdOp()
+    {
+        if (_cmd) {
+            lcbx_cmd_destroy(_cmd);
+        }
+    }
+
+    lcb_STATUS schedule(lcb_INSTANCE *instance) override
+    {
+        lcbtrace_SPAN *span = startShardTrace(instance);
+        if (span) {
+            lcbx_cmd_parent_span(_cmd, span);
+        }
+        return ExecFn(instance, static_cast<KvIoOp *>(this), _cmd);
+    }
+
+private:
+    CmdType *_cmd;
+};
+
+// Reports the outcome of bootstrapping an I/O shard to the connect callback
+// of the instance attaching to it.
+class ShardBootstrapOp : public IoOp
+{
+public:
+    ShardBootstrapOp(Instance *inst);
+
+    lcb_STATUS schedule(lcb_INSTANCE *instance) override;
+    void fail(lcb_STATUS err) override;
+    void complete() override;
+    IoOp *cancel() override;
+
+private:
+    Instance *_inst;
+    lcb_STATUS _rc;
+};
+
+// Where the I/O shards deliver what their instances log and meter.  These
+// are not tied to any operation, so they go to the first attached isolate.
+struct ShardSink {
+    CompletionQueue *completions;
+    Logger *logger;
+    Meter *meter;
+};
+
+// A fixed set of I/O threads, each owning its own libcouchbase instance
+// connected to the same bucket.  Operations are partitioned by key so that
+// operations against a single document keep their relative ordering.
+//
+// Shards are process-wide: every isolate (e.g. each worker thread) which
+// connects with the same options attaches to the same shards, so their KV
+// operations share a single set of threads and data connections.  Each
+// isolate still bootstraps its own Instance, which serves everything else.
+// Results are routed back through the CompletionQueue of whichever isolate
+// submitted the operation.
+class IoShards
+{
+public:
+    // Returns the shards for the given options, starting them if no other
+    // isolate is using them yet, and attaches the sink to them.  Each call
+    // must be paired with release().
+    static IoShards *acquire(lcb_INSTANCE_TYPE connType, const char *connStr,
+                             size_t connStrLen, const char *username,
+                             size_t usernameLen, const char *password,
+                             size_t passwordLen, size_t numShards,
+                             const ShardSink &sink, lcb_STATUS *err);
+
+    // Detaches the sink of the caller, stopping the shards once nobody
+    // uses them.
+    void release(const ShardSink &sink);
+
+    size_t size() const
+    {
+        return _threads.size();
+    }
+
+    void submit(size_t keyHash, IoOp *op)
+    {
+        _threads[keyHash % _threads.size()]->submit(op);
+    }
+
+    void submitAfterBootstrap(size_t shard, IoOp *op)
+    {
+        _threads[shard]->submitAfterBootstrap(op);
+    }
+
+    // May be called from any thread.
+    void postLog(int severity, const char *subsys, const char *srcfile,
+                 int srcline, std::string &&message);
+    void postValue(const std::string &name,
+                   const std::vector<std::pair<std::string, std::string>> &tags,
+                   uint64_t value);
+
+private:
+    IoShards(const ShardSink &sink);
+    ~IoShards();
+
+    static IoShards *create(lcb_INSTANCE_TYPE connType, const char *connStr,
+                            size_t connStrLen, const char *username,
+                            size_t usernameLen, const char *password,
+                            size_t passwordLen, size_t numShards,
+                            const ShardSink &sink, lcb_STATUS *err);
+
+    bool failed() const;
+
+    static void lcbGetRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                  const lcb_RESPGET *resp);
+    static void lcbExistsRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                     const lcb_RESPEXISTS *resp);
+    static void lcbStoreRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                    const lcb_RESPSTORE *resp);
+    static void lcbRemoveRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                     const lcb_RESPREMOVE *resp);
+    static void lcbTouchRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                    const lcb_RESPTOUCH *resp);
+    static void lcbUnlockRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                     const lcb_RESPUNLOCK *resp);
+    static void lcbCounterRespHandler(lcb_INSTANCE *instance, int cbtype,
+                                      const lcb_RESPCOUNTER *resp);
+
+    std::vector<IoThread *> _threads;
+    std::string _key;
+    size_t _refs;
+
+    // Shared by the instances of all shards.
+    lcb_LOGGER *_logger;
+    lcbmetrics_METER *_meter;
+    lcbtrace_TRACER *_tracer;
+
+    std::mutex _sinksLock;
+    std::vector<ShardSink> _sinks;
+};
+
+} // namespace couchnode
+
+#endif // IOSHARDS_H
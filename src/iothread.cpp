@@ -0,0 +1,389 @@
+#include "iothread.h"
+
+namespace couchnode
+{
+
+CompletionQueue::CompletionQueue(uv_loop_t *loop)
+    : _outstanding(0)
+    , _outstandingOps(nullptr)
+    , _canceled(nullptr)
+    , _closing(false)
+    , _closed(false)
+    , _refs(1)
+{
+    _async = new uv_async_t();
+    uv_async_init(loop, _async, &uvAsyncHandler);
+    _async->data = this;
+
+    // We only keep the loop alive while operations are outstanding.
+    uv_unref(reinterpret_cast<uv_handle_t *>(_async));
+}
+
+CompletionQueue::~CompletionQueue()
+{
+}
+
+void CompletionQueue::begin(IoOp *op)
+{
+    retain();
+
+    op->_completions = this;
+    op->_tracked = true;
+    op->_prevOutstanding = nullptr;
+    op->_nextOutstanding = _outstandingOps;
+    if (_outstandingOps) {
+        _outstandingOps->_prevOutstanding = op;
+    }
+    _outstandingOps = op;
+
+    if (_outstanding++ == 0) {
+        uv_ref(reinterpret_cast<uv_handle_t *>(_async));
+    }
+}
+
+void CompletionQueue::push(IoOp *op)
+{
+    {
+        std::lock_guard<std::mutex> lock(_closeLock);
+        if (!_closed) {
+            if (_queue.push(op)) {
+                uv_async_send(_async);
+            }
+            return;
+        }
+    }
+
+    // The submitting thread is gone, and has already reported the
+    // operation as canceled.
+    delete op;
+    release();
+}
+
+void CompletionQueue::post(IoOp *op)
+{
+    retain();
+
+    op->_completions = this;
+    op->_tracked = false;
+    push(op);
+}
+
+void CompletionQueue::retain()
+{
+    _refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CompletionQueue::drain()
+{
+    IoOp *op = _queue.drain();
+    while (op) {
+        IoOp *next = op->_next;
+        bool tracked = op->_tracked;
+
+        if (tracked) {
+            if (op->_prevOutstanding) {
+                op->_prevOutstanding->_nextOutstanding =
+                    op->_nextOutstanding;
+            } else {
+                _outstandingOps = op->_nextOutstanding;
+            }
+            if (op->_nextOutstanding) {
+                op->_nextOutstanding->_prevOutstanding =
+                    op->_prevOutstanding;
+            }
+        }
+
+        op->complete();
+        delete op;
+        op = next;
+
+        // We hold a reference of our own, so this never deletes us.
+        release();
+
+        if (tracked && --_outstanding == 0) {
+            uv_unref(reinterpret_cast<uv_handle_t *>(_async));
+        }
+    }
+}
+
+void CompletionQueue::release(size_t count)
+{
+    if (_refs.fetch_sub(count, std::memory_order_acq_rel) == count) {
+        delete this;
+    }
+}
+
+void CompletionQueue::uvAsyncHandler(uv_async_t *handle)
+{
+    CompletionQueue *me = reinterpret_cast<CompletionQueue *>(handle->data);
+    if (me->_closing) {
+        me->finishClose();
+        return;
+    }
+    me->drain();
+}
+
+void CompletionQueue::close(bool report)
+{
+    // Everything not delivered yet is canceled now, as the I/O threads
+    // cannot be told to stop working on it.  This ends the trace spans of
+    // the operations while the instance they belong to is still alive.
+    IoOp **tail = &_canceled;
+    for (IoOp *op = _outstandingOps; op; op = op->_nextOutstanding) {
+        IoOp *canceled = op->cancel();
+        if (canceled) {
+            *tail = canceled;
+            tail = &canceled->_next;
+        }
+    }
+    _outstandingOps = nullptr;
+
+    // The operations which already arrived are dropped here, and those
+    // arriving later by whoever pushes them.
+    IoOp *op;
+    {
+        std::lock_guard<std::mutex> lock(_closeLock);
+        _closed = true;
+        op = _queue.drain();
+    }
+
+    size_t dropped = 0;
+    while (op) {
+        IoOp *next = op->_next;
+        delete op;
+        op = next;
+        ++dropped;
+    }
+    if (dropped > 0) {
+        release(dropped);
+    }
+
+    _closing = true;
+    if (!report) {
+        // The isolate is going away, so there is nobody left to tell.
+        while (_canceled) {
+            IoOp *next = _canceled->_next;
+            delete _canceled;
+            _canceled = next;
+        }
+    }
+
+    if (_canceled) {
+        uv_ref(reinterpret_cast<uv_handle_t *>(_async));
+        uv_async_send(_async);
+        return;
+    }
+
+    finishClose();
+}
+
+void CompletionQueue::finishClose()
+{
+    while (_canceled) {
+        IoOp *next = _canceled->_next;
+        _canceled->complete();
+        delete _canceled;
+        _canceled = next;
+    }
+
+    uv_close(reinterpret_cast<uv_handle_t *>(_async), [](uv_handle_t *handle) {
+        delete reinterpret_cast<uv_async_t *>(handle);
+    });
+    _async = nullptr;
+
+    release();
+}
+
+IoThread::IoThread()
+    : _instance(nullptr)
+    , _iops(nullptr)
+    , _started(false)
+    , _waitingForBootstrap(nullptr)
+    , _bootstrapped(false)
+    , _bootstrapErr(LCB_SUCCESS)
+    , _failed(false)
+    , _stopping(false)
+{
+    uv_loop_init(&_loop);
+    uv_async_init(&_loop, &_wakeup, &uvWakeupHandler);
+    _wakeup.data = this;
+}
+
+IoThread::~IoThread()
+{
+    stop();
+}
+
+bool IoThread::start(lcb_INSTANCE *instance, lcb_io_opt_t iops)
+{
+    _instance = instance;
+    _iops = iops;
+
+    lcb_set_cookie(instance, this);
+    lcb_set_bootstrap_callback(instance, &lcbBootstrapHandler);
+
+    if (uv_thread_create(&_thread, &threadMain, this) != 0) {
+        return false;
+    }
+
+    _started = true;
+    return true;
+}
+
+void IoThread::submit(IoOp *op)
+{
+    enqueue(_pending, op);
+}
+
+void IoThread::submitAfterBootstrap(IoOp *op)
+{
+    enqueue(_pendingAfterBootstrap, op);
+}
+
+void IoThread::enqueue(MpscQueue<IoOp> &queue, IoOp *op)
+{
+    {
+        std::lock_guard<std::mutex> lock(_stopLock);
+        if (!_stopping) {
+            if (queue.push(op)) {
+                uv_async_send(&_wakeup);
+            }
+            return;
+        }
+    }
+
+    // Nothing would ever pick the operation up anymore.
+    op->fail(LCB_ERR_REQUEST_CANCELED);
+}
+
+void IoThread::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_stopLock);
+        _stopping = true;
+    }
+
+    if (!_started) {
+        if (_instance) {
+            lcb_destroy(_instance);
+            _instance = nullptr;
+        }
+        if (_iops) {
+            lcb_destroy_io_ops(_iops);
+            _iops = nullptr;
+        }
+        if (!uv_is_closing(reinterpret_cast<uv_handle_t *>(&_wakeup))) {
+            uv_close(reinterpret_cast<uv_handle_t *>(&_wakeup), nullptr);
+            uv_run(&_loop, UV_RUN_DEFAULT);
+            uv_loop_close(&_loop);
+        }
+        return;
+    }
+
+    uv_async_send(&_wakeup);
+    uv_thread_join(&_thread);
+    _started = false;
+}
+
+void IoThread::threadMain(void *arg)
+{
+    IoThread *me = reinterpret_cast<IoThread *>(arg);
+
+    lcb_STATUS err = lcb_connect(me->_instance);
+    if (err != LCB_SUCCESS) {
+        lcbBootstrapHandler(me->_instance, err);
+    }
+    uv_run(&me->_loop, UV_RUN_DEFAULT);
+
+    if (me->_iops) {
+        lcb_destroy_io_ops(me->_iops);
+        me->_iops = nullptr;
+    }
+    uv_loop_close(&me->_loop);
+}
+
+void IoThread::scheduleAll(IoOp *op, bool cancel)
+{
+    if (!op) {
+        return;
+    }
+
+    // Everything handed over at once goes out in one flush.
+    lcb_sched_enter(_instance);
+    while (op) {
+        IoOp *next = op->_next;
+        lcb_STATUS err =
+            cancel ? LCB_ERR_REQUEST_CANCELED : op->schedule(_instance);
+        if (err != LCB_SUCCESS) {
+            op->fail(err);
+        }
+        op = next;
+    }
+    lcb_sched_leave(_instance);
+}
+
+static IoThread *threadOf(lcb_INSTANCE *instance)
+{
+    void *cookie = const_cast<void *>(lcb_get_cookie(instance));
+    return reinterpret_cast<IoThread *>(cookie);
+}
+
+lcb_STATUS IoThread::bootstrapStatus(lcb_INSTANCE *instance)
+{
+    return threadOf(instance)->_bootstrapErr;
+}
+
+void IoThread::lcbBootstrapHandler(lcb_INSTANCE *instance, lcb_STATUS err)
+{
+    IoThread *me = threadOf(instance);
+    if (me->_bootstrapped) {
+        return;
+    }
+
+    me->_bootstrapped = true;
+    me->_bootstrapErr = err;
+    if (err != LCB_SUCCESS) {
+        me->_failed = true;
+    }
+
+    IoOp *op = me->_waitingForBootstrap;
+    me->_waitingForBootstrap = nullptr;
+    me->scheduleAll(op, false);
+}
+
+void IoThread::uvWakeupHandler(uv_async_t *handle)
+{
+    IoThread *me = reinterpret_cast<IoThread *>(handle->data);
+    bool stopping;
+    {
+        std::lock_guard<std::mutex> lock(me->_stopLock);
+        stopping = me->_stopping;
+    }
+
+    me->scheduleAll(me->_pending.drain(), stopping);
+
+    IoOp *op = me->_pendingAfterBootstrap.drain();
+    if (me->_bootstrapped || stopping) {
+        me->scheduleAll(op, stopping);
+    } else if (op) {
+        IoOp **tail = &me->_waitingForBootstrap;
+        while (*tail) {
+            tail = &(*tail)->_next;
+        }
+        *tail = op;
+    }
+
+    if (stopping) {
+        me->scheduleAll(me->_waitingForBootstrap, true);
+        me->_waitingForBootstrap = nullptr;
+
+        // This cancels anything still in flight, the callbacks of which
+        // will deliver the results to their completion queues.
+        lcb_destroy(me->_instance);
+        me->_instance = nullptr;
+
+        uv_close(reinterpret_cast<uv_handle_t *>(&me->_wakeup), nullptr);
+    }
+}
+
+} // namespace couchnode
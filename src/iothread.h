@@ -0,0 +1,229 @@
+#pragma once
+#ifndef IOTHREAD_H
+#define IOTHREAD_H
+
+#include <atomic>
+#include <libcouchbase/couchbase.h>
+#include <mutex>
+#include <uv.h>
+
+namespace couchnode
+{
+
+// A multi-producer, single-consumer intrusive queue.  Any thread may push
+// without taking a lock, while the single consumer takes the whole backlog
+// at once with drain(), which hands it back in submission order.
+template <typename T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+        : _head(nullptr)
+    {
+    }
+
+    // Returns true if the queue was empty, in which case the producer is
+    // responsible for waking up the consumer.
+    bool push(T *item)
+    {
+        T *head = _head.load(std::memory_order_relaxed);
+        do {
+            item->_next = head;
+        } while (!_head.compare_exchange_weak(head, item,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+        return head == nullptr;
+    }
+
+    bool empty() const
+    {
+        return _head.load(std::memory_order_acquire) == nullptr;
+    }
+
+    T *drain()
+    {
+        T *item = _head.exchange(nullptr, std::memory_order_acquire);
+
+        T *ordered = nullptr;
+        while (item) {
+            T *next = item->_next;
+            item->_next = ordered;
+            ordered = item;
+            item = next;
+        }
+        return ordered;
+    }
+
+private:
+    std::atomic<T *> _head;
+};
+
+class CompletionQueue;
+
+// An operation which is scheduled on an I/O thread and whose result is
+// delivered back on the thread of the isolate which submitted it.
+class IoOp
+{
+public:
+    IoOp()
+        : _next(nullptr)
+        , _completions(nullptr)
+        , _tracked(false)
+        , _prevOutstanding(nullptr)
+        , _nextOutstanding(nullptr)
+    {
+    }
+
+    virtual ~IoOp()
+    {
+    }
+
+    // Invoked on the I/O thread to hand the operation to libcouchbase.
+    virtual lcb_STATUS schedule(lcb_INSTANCE *instance) = 0;
+
+    // Invoked on the I/O thread if the operation could not be scheduled.
+    virtual void fail(lcb_STATUS err) = 0;
+
+    // Invoked on the submitting thread once the result is available.
+    virtual void complete() = 0;
+
+    // Invoked on the submitting thread when it goes away before the result
+    // arrived.  The I/O thread may still be using the operation, so this
+    // only detaches what belongs to the submitting thread and returns a new
+    // operation reporting the cancellation from its complete(), or nullptr
+    // if there is nothing to report.
+    virtual IoOp *cancel() = 0;
+
+    IoOp *_next;
+    CompletionQueue *_completions;
+
+    // The operations a CompletionQueue is still waiting for, only touched
+    // by the submitting thread.  Operations posted to the queue rather than
+    // submitted through it are not tracked.
+    bool _tracked;
+    IoOp *_prevOutstanding;
+    IoOp *_nextOutstanding;
+};
+
+// Collects completed operations from any number of I/O threads and runs
+// them in batches on the loop it was created on.
+class CompletionQueue
+{
+public:
+    CompletionQueue(uv_loop_t *loop);
+
+    // Must be called from the owning thread for each submitted operation.
+    void begin(IoOp *op);
+
+    // May be called from any thread.
+    void push(IoOp *op);
+
+    // Delivers an operation which was not submitted through this queue,
+    // such as a message logged by a shared I/O thread.  May be called from
+    // any thread holding a reference to the queue.
+    void post(IoOp *op);
+
+    // Keeps the queue around for threads which post to it, even after it
+    // was closed.
+    void retain();
+    void release(size_t count = 1);
+
+    // Cancels every outstanding operation and drops the reference of the
+    // owner, who must not use the queue after this.  Unless the loop is going away with the
+    // isolate, the cancellations are reported on its next iteration.  The
+    // I/O threads may be shared with other isolates and keep running, so
+    // whatever they still hand back later is dropped by whoever pushes it.
+    void close(bool report);
+
+private:
+    ~CompletionQueue();
+
+    static void uvAsyncHandler(uv_async_t *handle);
+    void drain();
+    void finishClose();
+
+    MpscQueue<IoOp> _queue;
+    uv_async_t *_async;
+    size_t _outstanding;
+    IoOp *_outstandingOps;
+
+    // The cancellations waiting to be reported once the queue is closed.
+    IoOp *_canceled;
+    bool _closing;
+
+    // Once closed, the pushing threads drop their operations instead of
+    // waking up the loop.  Each operation in flight holds a reference, and
+    // the queue is deleted once the last one is gone.
+    std::mutex _closeLock;
+    bool _closed;
+    std::atomic<size_t> _refs;
+};
+
+// A native thread running its own libuv loop and libcouchbase instance.
+class IoThread
+{
+public:
+    IoThread();
+    ~IoThread();
+
+    uv_loop_t *loop()
+    {
+        return &_loop;
+    }
+
+    // Takes ownership of the instance, which must have been created with
+    // an IO plugin bound to loop(), and begins bootstrapping it.  The
+    // cookie of the instance is taken over too.
+    bool start(lcb_INSTANCE *instance, lcb_io_opt_t iops);
+
+    // Schedules the operation on the instance.  Once the thread is
+    // stopping, the operation is failed right away instead.
+    void submit(IoOp *op);
+
+    // Like submit(), but holds the operation back until the instance has
+    // finished bootstrapping, successfully or not.
+    void submitAfterBootstrap(IoOp *op);
+
+    // Whether the instance failed to bootstrap.
+    bool failed() const
+    {
+        return _failed;
+    }
+
+    // The outcome of bootstrapping an instance started by an IoThread, for
+    // the operations submitted with submitAfterBootstrap().
+    static lcb_STATUS bootstrapStatus(lcb_INSTANCE *instance);
+
+    // Cancels outstanding operations and waits for the thread to exit.
+    void stop();
+
+private:
+    static void threadMain(void *arg);
+    static void uvWakeupHandler(uv_async_t *handle);
+    static void lcbBootstrapHandler(lcb_INSTANCE *instance, lcb_STATUS err);
+
+    void enqueue(MpscQueue<IoOp> &queue, IoOp *op);
+    void scheduleAll(IoOp *op, bool cancel);
+
+    uv_loop_t _loop;
+    uv_async_t _wakeup;
+    uv_thread_t _thread;
+    lcb_INSTANCE *_instance;
+    lcb_io_opt_t _iops;
+    MpscQueue<IoOp> _pending;
+    MpscQueue<IoOp> _pendingAfterBootstrap;
+    bool _started;
+
+    // Only touched by the I/O thread.
+    IoOp *_waitingForBootstrap;
+    bool _bootstrapped;
+    lcb_STATUS _bootstrapErr;
+
+    std::atomic<bool> _failed;
+    std::mutex _stopLock;
+    std::atomic<bool> _stopping;
+};
+
+} // namespace couchnode
+
+#endif // IOTHREAD_H
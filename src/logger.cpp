@@ -37,7 +37,6 @@ void Logger::handler(unsigned int iid, const char *subsys, int severity,
         return;
     }
 
-    Nan::HandleScope scope;
     va_list apCopy;
 
     if (!_logBuffer) {
@@ -61,6 +60,18 @@ void Logger::handler(unsigned int iid, const char *subsys, int severity,
 
     va_end(apCopy);
 
+    log(severity, subsys, srcfile, srcline, _logBuffer);
+}
+
+void Logger::log(int severity, const char *subsys, const char *srcfile,
+                 int srcline, const char *message)
+{
+    if (!_enabled) {
+        return;
+    }
+
+    Nan::HandleScope scope;
+
     Local<Object> infoObj = Nan::New<Object>();
     Nan::Set(infoObj, Nan::New<String>("severity").ToLocalChecked(),
              Nan::New(severity));
@@ -71,7 +82,7 @@ void Logger::handler(unsigned int iid, const char *subsys, int severity,
     Nan::Set(infoObj, Nan::New<String>("subsys").ToLocalChecked(),
              Nan::New(subsys).ToLocalChecked());
     Nan::Set(infoObj, Nan::New<String>("message").ToLocalChecked(),
-             Nan::New(_logBuffer).ToLocalChecked());
+             Nan::New(message).ToLocalChecked());
 
     Local<Value> args[] = {infoObj};
     Nan::Call(_callback, 1, args);
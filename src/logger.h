@@ -19,6 +19,11 @@ public:
 
     const lcb_LOGGER *lcbProcs() const;
 
+    // Delivers an already formatted message, such as those logged by the
+    // I/O shards.
+    void log(int severity, const char *subsys, const char *srcfile,
+             int srcline, const char *message);
+
     void disconnect();
 
 private:
@@ -74,6 +74,11 @@ Meter::Meter(Local<Object> impl)
 
 Meter::~Meter()
 {
+    for (auto &item : _recorders) {
+        lcbmetrics_valuerecorder_destroy(item.second);
+    }
+    _recorders.clear();
+
     _impl.Reset();
     _valueRecorderImpl.Reset();
     lcbmetrics_meter_destroy(_lcbMeter);
@@ -130,6 +135,42 @@ const lcbmetrics_VALUERECORDER *Meter::valueRecorder(const char *name,
     return (new ValueRecorder(res.As<Object>()))->lcbProcs();
 }
 
+void Meter::recordValue(
+    const std::string &name,
+    const std::vector<std::pair<std::string, std::string>> &tags,
+    uint64_t value)
+{
+    if (!_enabled) {
+        return;
+    }
+
+    std::string key = name;
+    for (const auto &tag : tags) {
+        key.append(1, '\0').append(tag.first).append(1, '\0').append(
+            tag.second);
+    }
+
+    auto iter = _recorders.find(key);
+    if (iter == _recorders.end()) {
+        std::vector<lcbmetrics_TAG> lcbTags;
+        for (const auto &tag : tags) {
+            lcbTags.push_back({tag.first.c_str(), tag.second.c_str()});
+        }
+
+        const lcbmetrics_VALUERECORDER *procs =
+            valueRecorder(name.c_str(), lcbTags.data(), lcbTags.size());
+        if (!procs) {
+            return;
+        }
+        iter = _recorders.emplace(key, procs).first;
+    }
+
+    const ValueRecorder *recorder = unwrapValueRecorder(iter->second);
+    if (recorder) {
+        recorder->recordValue(value);
+    }
+}
+
 ValueRecorder::ValueRecorder(Local<Object> impl)
 {
     lcbmetrics_valuerecorder_create(&_lcbValueRecorder, this);
@@ -149,7 +190,7 @@ ValueRecorder::~ValueRecorder()
 {
     _impl.Reset();
     _recordValueImpl.Reset();
-    lcbmetrics_valuerecorder_destroy(_lcbValueRecorder);
+    // We are only ever destroyed along with our procs, which free themselves.
     _lcbValueRecorder = nullptr;
 }
 
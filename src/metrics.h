@@ -6,6 +6,11 @@
 #include <nan.h>
 #include <node.h>
 
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace couchnode
 {
 
@@ -24,6 +29,13 @@ public:
                                                   const lcbmetrics_TAG *tags,
                                                   size_t ntags) const;
 
+    // Records a value which did not come through our own instance, such as
+    // those of the I/O shards.  The value recorders are cached here, since
+    // libcouchbase is not doing it for us.
+    void recordValue(const std::string &name,
+                     const std::vector<std::pair<std::string, std::string>> &tags,
+                     uint64_t value);
+
     void disconnect();
 
 protected:
@@ -31,6 +43,7 @@ protected:
     lcbmetrics_METER *_lcbMeter;
     Nan::Persistent<Object> _impl;
     Nan::Persistent<Function> _valueRecorderImpl;
+    std::map<std::string, const lcbmetrics_VALUERECORDER *> _recorders;
 };
 
 class ValueRecorder
@@ -1,22 +1,33 @@
 #include "mutationtoken.h"
+#include "cas.h"
 
 namespace couchnode
 {
 
-struct TokenData {
-    lcb_MUTATION_TOKEN token;
-    char bucketName[256];
+// The token is held in the internal fields of the CbMutationToken object,
+// with the 64-bit parts split into 32-bit halves.  Its string form is only
+// built if it is asked for.
+enum TokenField {
+    TOKEN_FIELD_VBID = 0,
+    TOKEN_FIELD_UUID_LOW,
+    TOKEN_FIELD_UUID_HIGH,
+    TOKEN_FIELD_SEQNO_LOW,
+    TOKEN_FIELD_SEQNO_HIGH,
+    TOKEN_FIELD_BUCKET,
+    TOKEN_FIELD_COUNT
 };
 
 NAN_MODULE_INIT(MutationToken::Init)
 {
     Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>();
     tpl->SetClassName(Nan::New<String>("CbMutationToken").ToLocalChecked());
+    tpl->InstanceTemplate()->SetInternalFieldCount(TOKEN_FIELD_COUNT);
 
     Nan::SetPrototypeMethod(tpl, "toString", fnToString);
     Nan::SetPrototypeMethod(tpl, "toJSON", fnToString);
     Nan::SetPrototypeMethod(tpl, "inspect", fnInspect);
 
+    functionTemplate().Reset(tpl);
     constructor().Reset(Nan::GetFunction(tpl).ToLocalChecked());
 }
 
@@ -48,58 +59,104 @@ NAN_METHOD(MutationToken::fnInspect)
         Nan::New<String>(tokenStr).ToLocalChecked());
 }
 
+static inline void _SetU64Fields(Local<Object> obj, int lowField, uint64_t val)
+{
+    obj->SetInternalField(lowField,
+                          Nan::New<Uint32>(static_cast<uint32_t>(val)));
+    obj->SetInternalField(lowField + 1,
+                          Nan::New<Uint32>(static_cast<uint32_t>(val >> 32)));
+}
+
+static inline uint32_t _GetU32Field(Local<Object> obj, int field)
+{
+    return Nan::To<uint32_t>(obj->GetInternalField(field).As<Value>())
+        .FromMaybe(0);
+}
+
+static inline uint64_t _GetU64Fields(Local<Object> obj, int lowField)
+{
+    return (static_cast<uint64_t>(_GetU32Field(obj, lowField + 1)) << 32) |
+           _GetU32Field(obj, lowField);
+}
+
 v8::Local<v8::Value> MutationToken::create(lcb_MUTATION_TOKEN token,
-                                           const char *bucketName)
+                                           Local<Value> bucketName)
 {
-    if (!lcb_mutation_token_is_valid(&token) || !bucketName) {
+    if (!lcb_mutation_token_is_valid(&token) || !bucketName->IsString()) {
         return Nan::Undefined();
     }
 
     Local<Object> ret =
         Nan::NewInstance(Nan::New<Function>(constructor())).ToLocalChecked();
 
-    TokenData tokenData;
-    tokenData.token = token;
-    strcpy(tokenData.bucketName, bucketName);
-
-    Local<Value> tokenBuf =
-        Nan::CopyBuffer(reinterpret_cast<const char *>(&tokenData),
-                        sizeof(TokenData))
-            .ToLocalChecked();
-    Nan::Set(ret, 0, tokenBuf);
+    ret->SetInternalField(TOKEN_FIELD_VBID, Nan::New<Uint32>(token.vbid_));
+    _SetU64Fields(ret, TOKEN_FIELD_UUID_LOW, token.uuid_);
+    _SetU64Fields(ret, TOKEN_FIELD_SEQNO_LOW, token.seqno_);
+    ret->SetInternalField(TOKEN_FIELD_BUCKET, bucketName);
 
     return ret;
 }
 
+static bool _ParseTokenPart(const char **cur, const char *end, uint64_t *out)
+{
+    const char *sep = static_cast<const char *>(memchr(*cur, ':', end - *cur));
+    if (!sep || !Cas::parseDecimal(*cur, sep - *cur, out)) {
+        return false;
+    }
+    *cur = sep + 1;
+    return true;
+}
+
 bool _StrToToken(Local<Value> obj, lcb_MUTATION_TOKEN *token, char *bucketName)
 {
-    if (sscanf(*Nan::Utf8String(
-                   obj->ToString(Nan::GetCurrentContext()).ToLocalChecked()),
-               "%hu:%llu:%llu:%s", &token->vbid_, &token->uuid_, &token->seqno_,
-               bucketName) != 1) {
+    Nan::Utf8String tokenStr(obj);
+    const char *cur = *tokenStr;
+    const char *end = cur + tokenStr.length();
+
+    uint64_t vbid, uuid, seqno;
+    if (!_ParseTokenPart(&cur, end, &vbid) || vbid > UINT16_MAX ||
+        !_ParseTokenPart(&cur, end, &uuid) ||
+        !_ParseTokenPart(&cur, end, &seqno)) {
         return false;
     }
+
+    size_t bucketLen = end - cur;
+    if (bucketLen == 0 || bucketLen > 255) {
+        return false;
+    }
+
+    token->vbid_ = static_cast<uint16_t>(vbid);
+    token->uuid_ = uuid;
+    token->seqno_ = seqno;
+    memcpy(bucketName, cur, bucketLen);
+    bucketName[bucketLen] = '\0';
     return true;
 }
 
 bool _ObjToToken(Local<Value> obj, lcb_MUTATION_TOKEN *token, char *bucketName)
 {
     Local<Object> realObj = obj.As<Object>();
-    Local<Value> tokenBuf = Nan::Get(realObj, 0).ToLocalChecked();
 
-    if (!node::Buffer::HasInstance(tokenBuf)) {
+    if (!Nan::New<FunctionTemplate>(MutationToken::functionTemplate())
+             ->HasInstance(realObj)) {
         return false;
     }
 
-    if (node::Buffer::Length(tokenBuf) != sizeof(TokenData)) {
+    Local<Value> bucketVal =
+        realObj->GetInternalField(TOKEN_FIELD_BUCKET).As<Value>();
+    if (!bucketVal->IsString()) {
         return false;
     }
 
-    const TokenData *tokenData =
-        reinterpret_cast<const TokenData *>(node::Buffer::Data(tokenBuf));
+    token->vbid_ =
+        static_cast<uint16_t>(_GetU32Field(realObj, TOKEN_FIELD_VBID));
+    token->uuid_ = _GetU64Fields(realObj, TOKEN_FIELD_UUID_LOW);
+    token->seqno_ = _GetU64Fields(realObj, TOKEN_FIELD_SEQNO_LOW);
 
-    memcpy(token, &tokenData->token, sizeof(lcb_MUTATION_TOKEN));
-    strcpy(bucketName, tokenData->bucketName);
+    int written = bucketVal.As<String>()->WriteUtf8(
+        Isolate::GetCurrent(), bucketName, 255, nullptr,
+        String::NO_NULL_TERMINATION);
+    bucketName[written] = '\0';
 
     return true;
 }
@@ -110,6 +167,7 @@ bool MutationToken::parse(Local<Value> obj, lcb_MUTATION_TOKEN *token,
     Nan::HandleScope scope;
 
     memset(token, 0, sizeof(lcb_MUTATION_TOKEN));
+    bucketName[0] = '\0';
     if (obj->IsObject()) {
         return _ObjToToken(obj, token, bucketName);
     } else if (obj->IsString()) {
@@ -17,8 +17,10 @@ class MutationToken
 public:
     static NAN_MODULE_INIT(Init);
 
+    // The bucket name is expected to be a string which is shared between
+    // the tokens of a connection, see Instance::bucketNameValue().
     static v8::Local<v8::Value> create(lcb_MUTATION_TOKEN token,
-                                       const char *bucketName);
+                                       Local<Value> bucketName);
 
     static bool parse(Local<Value> obj, lcb_MUTATION_TOKEN *token,
                       char *bucketName);
@@ -28,6 +30,11 @@ public:
         return addondata::Get()->_mutationtokenConstructor;
     }
 
+    static inline Nan::Persistent<FunctionTemplate> &functionTemplate()
+    {
+        return addondata::Get()->_mutationtokenTemplate;
+    }
+
 private:
     static NAN_METHOD(fnToString);
     static NAN_METHOD(fnInspect);
@@ -2,13 +2,16 @@
 #ifndef OPBUILDER_H
 #define OPBUILDER_H
 
+#include "benchstats.h"
 #include "connection.h"
 #include "instance.h"
+#include "ioshards.h"
 #include "lcbx.h"
 #include "tracespan.h"
 #include "tracing.h"
 #include "valueparser.h"
 #include <libcouchbase/couchbase.h>
+#include <vector>
 
 namespace couchnode
 {
@@ -25,6 +28,7 @@ public:
         , _inst(inst)
         , _parentSpan(parentSpan)
         , _traceSpan(span)
+        , _hasTimings(false)
     {
         _callback.Reset(callback.GetFunction());
         _transcoder.Reset(transcoder);
@@ -52,6 +56,19 @@ public:
     void endTrace()
     {
         _traceSpan.end();
+        _traceSpan = TraceSpan();
+    }
+
+    // Lets go of everything tied to the instance, for an operation which is
+    // only reported once the instance is gone.
+    void detachInstance()
+    {
+        endTrace();
+        if (_parentSpan) {
+            delete _parentSpan;
+            _parentSpan = nullptr;
+        }
+        _inst = nullptr;
     }
 
     Nan::AsyncResource *asyncContext()
@@ -59,16 +76,88 @@ public:
         return static_cast<Nan::AsyncResource *>(this);
     }
 
+    // Records where the time of a KV operation went, which is only available
+    // when kv_op_timings is enabled on the connection.
+    void setTimings(const lcb_KEY_VALUE_ERROR_CONTEXT *ctx)
+    {
+        _hasTimings = lcb_errctx_kv_op_timings(ctx, &_queueUs, &_networkUs,
+                                               &_serverUs) == LCB_SUCCESS;
+    }
+
+    void setTimings(uint64_t queueUs, uint64_t networkUs, uint64_t serverUs)
+    {
+        _hasTimings = true;
+        _queueUs = queueUs;
+        _networkUs = networkUs;
+        _serverUs = serverUs;
+    }
+
     Local<Value> invokeCallback(int argc, Local<Value> argv[])
     {
+        bench::StageTimer benchTimer(bench::STAGE_CALLBACK);
+        if (_hasTimings) {
+            // The timings follow the usual arguments of the callback
+            std::vector<Local<Value>> args(argv, argv + argc);
+            args.push_back(decodeTimings());
+            return _callback
+                .Call(static_cast<int>(args.size()), args.data(),
+                      asyncContext())
+                .ToLocalChecked();
+        }
         return _callback.Call(argc, argv, asyncContext()).ToLocalChecked();
     }
 
+    Local<Value> decodeTimings() const
+    {
+        Local<Object> timingsObj = Nan::New<Object>();
+        Nan::Set(timingsObj, Nan::New("queue").ToLocalChecked(),
+                 Nan::New<Number>(static_cast<double>(_queueUs)));
+        Nan::Set(timingsObj, Nan::New("network").ToLocalChecked(),
+                 Nan::New<Number>(static_cast<double>(_networkUs)));
+        Nan::Set(timingsObj, Nan::New("server").ToLocalChecked(),
+                 Nan::New<Number>(static_cast<double>(_serverUs)));
+        return timingsObj;
+    }
+
+    Local<Value> decodeDocValue(Local<Value> valueVal, Local<Value> flagsVal)
+    {
+        ScopedTraceSpan decodeTrace = startDecodeTrace();
+
+        Local<Object> transcoderObj = Nan::New(_transcoder);
+
+        Nan::MaybeLocal<Value> decodeFnValM =
+            Nan::Get(transcoderObj, Nan::New("decode").ToLocalChecked());
+        if (decodeFnValM.IsEmpty()) {
+            return Nan::Undefined();
+        }
+
+        Nan::MaybeLocal<Function> decodeFnM =
+            Nan::To<Function>(decodeFnValM.ToLocalChecked());
+        if (decodeFnM.IsEmpty()) {
+            return Nan::Undefined();
+        }
+
+        Local<Function> decodeFn = decodeFnM.ToLocalChecked();
+
+        Local<Value> argsArr[] = {valueVal, flagsVal};
+        Nan::MaybeLocal<Value> resValM =
+            Nan::CallAsFunction(decodeFn, transcoderObj, 2, argsArr);
+        if (resValM.IsEmpty()) {
+            return Nan::Undefined();
+        }
+
+        return resValM.ToLocalChecked();
+    }
+
     Instance *_inst;
     Nan::Callback _callback;
     Nan::Persistent<Object> _transcoder;
     WrappedRequestSpan *_parentSpan;
     TraceSpan _traceSpan;
+    bool _hasTimings;
+    uint64_t _queueUs;
+    uint64_t _networkUs;
+    uint64_t _serverUs;
 };
 
 template <typename CmdType>
@@ -269,11 +358,50 @@ public:
                      parsedValue) == LCB_SUCCESS;
     }
 
+    // Variants of the above for paths which have already been decoded, as
+    // held by a SubdocTemplate.
+    template <lcb_STATUS (*SetFn)(lcb_SUBDOCSPECS *, size_t, uint32_t,
+                                  const char *, size_t, const char *, size_t)>
+    bool parseOption(size_t index, uint32_t flags, const std::string &path,
+                     Local<Value> value)
+    {
+        const char *parsedValue;
+        size_t parsedNValue;
+        if (!_valueParser.parseString(&parsedValue, &parsedNValue, value)) {
+            return false;
+        }
+
+        return SetFn(_cmd, index, flags, path.data(), path.size(),
+                     parsedValue, parsedNValue) == LCB_SUCCESS;
+    }
+
+    template <lcb_STATUS (*SetFn)(lcb_SUBDOCSPECS *, size_t, uint32_t,
+                                  const char *, size_t, int64_t)>
+    bool parseOption(size_t index, uint32_t flags, const std::string &path,
+                     Local<Value> value)
+    {
+        int64_t parsedValue = 0;
+        if (!_valueParser.parseInt(&parsedValue, value)) {
+            return false;
+        }
+
+        return SetFn(_cmd, index, flags, path.data(), path.size(),
+                     parsedValue) == LCB_SUCCESS;
+    }
+
     CmdType *cmd()
     {
         return _cmd;
     }
 
+    // Hands ownership of the command over to the caller.
+    CmdType *releaseCmd()
+    {
+        CmdType *cmd = _cmd;
+        _cmd = nullptr;
+        return cmd;
+    }
+
 protected:
     template <typename T, lcb_STATUS (*SetFn)(CmdType *, T)>
     bool _parseIntOption(Local<Value> value)
@@ -314,8 +442,10 @@ public:
     template <typename... Ts>
     OpBuilder(Instance *inst, Ts... args)
         : CmdBuilder<CmdType>(_valueParser, args...)
+        , _benchTimer(bench::STAGE_ENCODE)
         , _inst(inst)
         , _parentSpan(nullptr)
+        , _keyHash(0)
     {
     }
 
@@ -377,6 +507,31 @@ public:
         return true;
     }
 
+    // Same as parseOption for the document key, but also remembers a hash
+    // of the key which is used to pick the I/O shard for the operation.
+    template <lcb_STATUS (*SetFn)(CmdType *, const char *, size_t)>
+    bool parseKey(Local<Value> value)
+    {
+        const char *bytes;
+        size_t nbytes;
+        if (!_valueParser.parseString(&bytes, &nbytes, value)) {
+            return false;
+        }
+
+        // FNV-1a
+        size_t hash = 2166136261u;
+        for (size_t i = 0; i < nbytes; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(bytes[i])) * 16777619u;
+        }
+        _keyHash = hash;
+
+        if (bytes == nullptr || nbytes == 0) {
+            return true;
+        }
+
+        return SetFn(this->_cmd, bytes, nbytes) == LCB_SUCCESS;
+    }
+
     template <lcb_STATUS (*BytesFn)(CmdType *, const char *, size_t),
               lcb_STATUS (*FlagsFn)(CmdType *, uint32_t)>
     bool parseDocValue(Local<Value> value)
@@ -476,6 +631,7 @@ public:
         // ownership of the parent span wrapper transfers to the opcookie
         _parentSpan = nullptr;
 
+        _benchTimer.switchTo(bench::STAGE_SCHEDULE);
         lcb_STATUS err = ExecFn(this->_inst->lcbHandle(), cookie, this->cmd());
         if (err != LCB_SUCCESS) {
             // If the result was unsuccessful, we need to destroy the cookie
@@ -486,7 +642,34 @@ public:
         return err;
     }
 
+    // Executes a key-value operation on one of the instance's I/O shards if
+    // it has any, falling back to the instance itself otherwise.
+    template <lcb_STATUS (*ExecFn)(lcb_INSTANCE *, void *, const CmdType *)>
+    lcb_STATUS executeKv()
+    {
+        IoShards *shards = this->_inst->_shards;
+        if (!shards) {
+            return execute<ExecFn>();
+        }
+
+        OpCookie *cookie =
+            new OpCookie(this->_inst, this->_callback, this->_transcoder,
+                         this->_traceSpan, this->_parentSpan);
+
+        // ownership of the parent span wrapper transfers to the opcookie
+        _parentSpan = nullptr;
+
+        _benchTimer.switchTo(bench::STAGE_SCHEDULE);
+        KvIoOp *op =
+            new KvIoCmdOp<CmdType, ExecFn>(cookie, this->releaseCmd());
+        this->_inst->_completions->begin(op);
+        shards->submit(_keyHash, op);
+
+        return LCB_SUCCESS;
+    }
+
 protected:
+    bench::StageTimer _benchTimer;
     Instance *_inst;
     ValueParser _valueParser;
     std::vector<Nan::Utf8String *> _strings;
@@ -494,6 +677,7 @@ protected:
     Nan::Persistent<Object> _transcoder;
     WrappedRequestSpan *_parentSpan;
     TraceSpan _traceSpan;
+    size_t _keyHash;
 };
 
 } // namespace couchnode
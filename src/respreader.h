@@ -36,9 +36,9 @@ public:
     }
 
     template <lcb_STATUS (*GetFn)(const CtxType *, uint64_t *)>
-    Local<Value> decodeCas()
+    Local<Value> decodeCas(CasMode mode)
     {
-        return _parseValueCas<GetFn>();
+        return _parseValueCas<GetFn>(mode);
     }
 
     template <lcb_STATUS (*GetFn)(const CtxType *, const char **, size_t *)>
@@ -63,7 +63,7 @@ private:
     }
 
     template <lcb_STATUS (*GetFn)(const CtxType *, uint64_t *)>
-    Local<Value> _parseValueCas()
+    Local<Value> _parseValueCas(CasMode mode)
     {
         uint64_t value;
 
@@ -72,7 +72,7 @@ private:
             return Nan::Null();
         }
 
-        return Cas::create(value);
+        return Cas::create(value, mode);
     }
 
     template <lcb_STATUS (*GetFn)(const CtxType *, const char **, size_t *)>
@@ -95,7 +95,8 @@ class RespReader
 {
 public:
     RespReader(lcb_INSTANCE *instance, const RespType *resp)
-        : _instance(instance)
+        : _benchTimer(bench::STAGE_DECODE)
+        , _instance(instance)
         , _resp(resp)
     {
         lcb_STATUS rc = CookieFn(_resp, reinterpret_cast<void **>(&_cookie));
@@ -181,36 +182,24 @@ public:
                                   const lcb_KEY_VALUE_ERROR_CONTEXT **)>
     Local<Value> decodeError(lcb_STATUS rc) const
     {
+        const lcb_KEY_VALUE_ERROR_CONTEXT *ctx = nullptr;
+        if (CtxFn(_resp, &ctx) != LCB_SUCCESS) {
+            ctx = nullptr;
+        }
+        if (ctx && _cookie) {
+            _cookie->setTimings(ctx);
+        }
+
         if (rc == LCB_SUCCESS) {
             return Nan::Null();
         }
+        if (!ctx) {
+            return Error::create(rc);
+        }
 
-        Local<Value> errVal = Error::create(rc);
-        Local<Object> errValObj = errVal.As<Object>();
-
-        CtxReader<RespType, lcb_KEY_VALUE_ERROR_CONTEXT, CtxFn> ctxRdr(_resp);
-        Nan::Set(errValObj, Nan::New<String>("ctxtype").ToLocalChecked(),
-                 Nan::New<String>("kv").ToLocalChecked());
-        Nan::Set(errValObj, Nan::New<String>("status_code").ToLocalChecked(),
-                 ctxRdr.template parseValue<&lcb_errctx_kv_status_code>());
-        Nan::Set(errValObj, Nan::New<String>("opaque").ToLocalChecked(),
-                 ctxRdr.template parseValue<&lcb_errctx_kv_opaque>());
-        Nan::Set(errValObj, Nan::New<String>("cas").ToLocalChecked(),
-                 ctxRdr.template decodeCas<&lcb_errctx_kv_cas>());
-        Nan::Set(errValObj, Nan::New<String>("key").ToLocalChecked(),
-                 ctxRdr.template parseValue<&lcb_errctx_kv_key>());
-        Nan::Set(errValObj, Nan::New<String>("bucket").ToLocalChecked(),
-                 ctxRdr.template parseValue<&lcb_errctx_kv_bucket>());
-        Nan::Set(errValObj, Nan::New<String>("collection").ToLocalChecked(),
-                 ctxRdr.template parseValue<&lcb_errctx_kv_collection>());
-        Nan::Set(errValObj, Nan::New<String>("scope").ToLocalChecked(),
-                 ctxRdr.template parseValue<&lcb_errctx_kv_scope>());
-        Nan::Set(errValObj, Nan::New<String>("context").ToLocalChecked(),
-                 ctxRdr.template parseValue<&lcb_errctx_kv_context>());
-        Nan::Set(errValObj, Nan::New<String>("ref").ToLocalChecked(),
-                 ctxRdr.template parseValue<&lcb_errctx_kv_ref>());
-
-        return errVal;
+        KvErrorContext errCtx;
+        errCtx.assign(ctx);
+        return KvError::create(rc, errCtx, instance()->_casMode);
     }
 
     template <lcb_STATUS (*CtxFn)(const RespType *,
@@ -373,7 +362,7 @@ public:
             return Nan::Null();
         }
 
-        return Cas::create(value);
+        return Cas::create(value, instance()->_casMode);
     }
 
     template <lcb_STATUS (*GetFn)(const RespType *, lcb_MUTATION_TOKEN *)>
@@ -386,7 +375,7 @@ public:
             return Nan::Null();
         }
 
-        return MutationToken::create(value, instance()->bucketName());
+        return MutationToken::create(value, instance()->bucketNameValue());
     }
 
     template <lcb_STATUS (*ValFn)(const RespType *, const char **, size_t *)>
@@ -418,35 +407,9 @@ public:
               lcb_STATUS (*FlagsFn)(const RespType *, uint32_t *)>
     Local<Value> parseDocValue() const
     {
-        ScopedTraceSpan decodeTrace = this->_cookie->startDecodeTrace();
-
-        Local<Object> transcoderObj = Nan::New(this->_cookie->_transcoder);
-
-        Nan::MaybeLocal<Value> decodeFnValM =
-            Nan::Get(transcoderObj, Nan::New("decode").ToLocalChecked());
-        if (decodeFnValM.IsEmpty()) {
-            return Nan::Undefined();
-        }
-
-        Nan::MaybeLocal<Function> decodeFnM =
-            Nan::To<Function>(decodeFnValM.ToLocalChecked());
-        if (decodeFnM.IsEmpty()) {
-            return Nan::Undefined();
-        }
-
-        Local<Function> decodeFn = decodeFnM.ToLocalChecked();
-
         Local<Value> valueVal = parseValue<BytesFn>();
         Local<Value> flagsVal = parseValue<FlagsFn>();
-
-        Local<Value> argsArr[] = {valueVal, flagsVal};
-        Nan::MaybeLocal<Value> resValM =
-            Nan::CallAsFunction(decodeFn, transcoderObj, 2, argsArr);
-        if (resValM.IsEmpty()) {
-            return Nan::Undefined();
-        }
-
-        return resValM.ToLocalChecked();
+        return this->_cookie->decodeDocValue(valueVal, flagsVal);
     }
 
     template <typename... Ts>
@@ -472,6 +435,7 @@ public:
     }
 
 private:
+    bench::StageTimer _benchTimer;
     lcb_INSTANCE *_instance;
     const RespType *_resp;
     OpCookie *_cookie;
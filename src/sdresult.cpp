@@ -0,0 +1,71 @@
+#include "sdresult.h"
+
+namespace couchnode
+{
+
+static Local<String> key(const Nan::Persistent<String> &persistent)
+{
+    return Nan::New<String>(persistent);
+}
+
+NAN_MODULE_INIT(SubdocResult::Init)
+{
+    AddonData *data = addondata::Get();
+
+    data->_errorKey.Reset(Nan::New("error").ToLocalChecked());
+    data->_valueKey.Reset(Nan::New("value").ToLocalChecked());
+    data->_casKey.Reset(Nan::New("cas").ToLocalChecked());
+    data->_contentKey.Reset(Nan::New("content").ToLocalChecked());
+
+    Local<ObjectTemplate> lookupItem = Nan::New<ObjectTemplate>();
+    lookupItem->Set(key(data->_errorKey), Nan::Null());
+    lookupItem->Set(key(data->_valueKey), Nan::Null());
+    data->_sdLookupItemTemplate.Reset(lookupItem);
+
+    Local<ObjectTemplate> mutateItem = Nan::New<ObjectTemplate>();
+    mutateItem->Set(key(data->_valueKey), Nan::Null());
+    data->_sdMutateItemTemplate.Reset(mutateItem);
+
+    Local<ObjectTemplate> result = Nan::New<ObjectTemplate>();
+    result->Set(key(data->_casKey), Nan::Null());
+    result->Set(key(data->_contentKey), Nan::Null());
+    data->_sdResultTemplate.Reset(result);
+}
+
+Local<Object> SubdocResult::createLookupItem(Local<Value> error,
+                                             Local<Value> value)
+{
+    AddonData *data = addondata::Get();
+    Local<Object> obj =
+        Nan::NewInstance(Nan::New<ObjectTemplate>(data->_sdLookupItemTemplate))
+            .ToLocalChecked();
+    if (!error.IsEmpty()) {
+        Nan::Set(obj, key(data->_errorKey), error);
+    }
+    Nan::Set(obj, key(data->_valueKey), value);
+    return obj;
+}
+
+Local<Object> SubdocResult::createMutateItem(Local<Value> value)
+{
+    AddonData *data = addondata::Get();
+    Local<Object> obj =
+        Nan::NewInstance(Nan::New<ObjectTemplate>(data->_sdMutateItemTemplate))
+            .ToLocalChecked();
+    Nan::Set(obj, key(data->_valueKey), value);
+    return obj;
+}
+
+Local<Object> SubdocResult::createResult(Local<Value> cas,
+                                         Local<Value> content)
+{
+    AddonData *data = addondata::Get();
+    Local<Object> obj =
+        Nan::NewInstance(Nan::New<ObjectTemplate>(data->_sdResultTemplate))
+            .ToLocalChecked();
+    Nan::Set(obj, key(data->_casKey), cas);
+    Nan::Set(obj, key(data->_contentKey), content);
+    return obj;
+}
+
+} // namespace couchnode
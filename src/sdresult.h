@@ -0,0 +1,36 @@
+#pragma once
+#ifndef SDRESULT_H
+#define SDRESULT_H
+
+#include "addondata.h"
+#include <nan.h>
+#include <node.h>
+
+namespace couchnode
+{
+
+using namespace v8;
+
+// Builds the result objects handed to lookupIn/mutateIn callbacks from
+// object templates created once per isolate, so that every result shares
+// the same hidden class with its properties stored in-object.
+class SubdocResult
+{
+public:
+    static NAN_MODULE_INIT(Init);
+
+    // An { error, value } entry of a lookupIn result.  Successful specs pass
+    // an empty error handle and keep the template's null.
+    static Local<Object> createLookupItem(Local<Value> error,
+                                          Local<Value> value);
+
+    // A { value } entry of a mutateIn result.
+    static Local<Object> createMutateItem(Local<Value> value);
+
+    // The { cas, content } object wrapping the entries.
+    static Local<Object> createResult(Local<Value> cas, Local<Value> content);
+};
+
+} // namespace couchnode
+
+#endif // SDRESULT_H
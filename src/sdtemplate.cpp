@@ -0,0 +1,188 @@
+#include "sdtemplate.h"
+
+#include "error.h"
+
+namespace couchnode
+{
+
+NAN_MODULE_INIT(SubdocTemplate::Init)
+{
+    Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(fnNew);
+    tpl->SetClassName(Nan::New<String>("CbSubdocTemplate").ToLocalChecked());
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+    functionTemplate().Reset(tpl);
+
+    Nan::Set(target, Nan::New("SubdocTemplate").ToLocalChecked(),
+             Nan::GetFunction(tpl).ToLocalChecked());
+}
+
+SubdocTemplate::SubdocTemplate(bool isMutation)
+    : _isMutation(isMutation)
+    , _lookupSpecs(nullptr)
+{
+}
+
+SubdocTemplate::~SubdocTemplate()
+{
+    if (_lookupSpecs) {
+        lcbx_cmd_destroy(_lookupSpecs);
+        _lookupSpecs = nullptr;
+    }
+}
+
+static bool isLookupCmd(lcbx_SDCMD sdcmd)
+{
+    return sdcmd == LCBX_SDCMD_GET || sdcmd == LCBX_SDCMD_GET_COUNT ||
+           sdcmd == LCBX_SDCMD_EXISTS;
+}
+
+NAN_METHOD(SubdocTemplate::fnNew)
+{
+    Nan::HandleScope scope;
+
+    if (info.Length() != 2) {
+        return Nan::ThrowError(Error::create("expected 2 parameters"));
+    }
+    if (!info[1]->IsArray()) {
+        return Nan::ThrowError(Error::create("must pass array for specs"));
+    }
+
+    bool isMutation = Nan::To<bool>(info[0]).FromMaybe(false);
+    Local<Array> cmds = info[1].As<Array>();
+
+    size_t numCmds = cmds->Length() / 3;
+    if (numCmds == 0) {
+        return Nan::ThrowError(Error::create("must pass at least one spec"));
+    }
+
+    SubdocTemplate *obj = new SubdocTemplate(isMutation);
+    obj->_specs.resize(numCmds);
+
+    for (size_t i = 0, idx = 0; i < numCmds; ++i, idx += 3) {
+        Spec &spec = obj->_specs[i];
+        spec.op = static_cast<lcbx_SDCMD>(
+            ValueParser::asUint(Nan::Get(cmds, idx + 0).ToLocalChecked()));
+        spec.flags =
+            ValueParser::asUint(Nan::Get(cmds, idx + 1).ToLocalChecked());
+
+        Local<Value> pathVal = Nan::Get(cmds, idx + 2).ToLocalChecked();
+        if (!pathVal->IsUndefined() && !pathVal->IsNull()) {
+            Nan::Utf8String path(pathVal);
+            spec.path.assign(*path, path.length());
+        }
+
+        if (spec.op == LCBX_SDCMD_UNKNOWN || spec.op > LCBX_SDCMD_GET_COUNT ||
+            isLookupCmd(spec.op) == isMutation) {
+            delete obj;
+            return Nan::ThrowError(Error::create("unexpected optype"));
+        }
+    }
+
+    // Lookups carry no per-call values, so their specs are built just once.
+    // Attaching them to a command shares them rather than copying them.
+    if (!isMutation) {
+        lcbx_cmd_create(&obj->_lookupSpecs, numCmds);
+        for (size_t i = 0; i < numCmds; ++i) {
+            const Spec &spec = obj->_specs[i];
+            switch (spec.op) {
+            case LCBX_SDCMD_GET:
+                lcb_subdocspecs_get(obj->_lookupSpecs, i, spec.flags,
+                                    spec.path.data(), spec.path.size());
+                break;
+            case LCBX_SDCMD_GET_COUNT:
+                lcb_subdocspecs_get_count(obj->_lookupSpecs, i, spec.flags,
+                                          spec.path.data(), spec.path.size());
+                break;
+            case LCBX_SDCMD_EXISTS:
+                lcb_subdocspecs_exists(obj->_lookupSpecs, i, spec.flags,
+                                       spec.path.data(), spec.path.size());
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    obj->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+}
+
+SubdocTemplate *SubdocTemplate::fromCmds(Local<Array> cmds)
+{
+    if (cmds->Length() == 0) {
+        return nullptr;
+    }
+
+    Local<Value> head = Nan::Get(cmds, 0).ToLocalChecked();
+    if (!head->IsObject() ||
+        !Nan::New<FunctionTemplate>(functionTemplate())->HasInstance(head)) {
+        return nullptr;
+    }
+
+    return ObjectWrap::Unwrap<SubdocTemplate>(head.As<Object>());
+}
+
+bool SubdocTemplate::encodeMutation(CmdBuilder<lcb_SUBDOCSPECS> &cmdsEnc,
+                                    Local<Array> cmds) const
+{
+    if (cmds->Length() != _specs.size() + 1) {
+        return false;
+    }
+
+    for (size_t i = 0; i < _specs.size(); ++i) {
+        const Spec &spec = _specs[i];
+        Local<Value> value = Nan::Get(cmds, i + 1).ToLocalChecked();
+
+        bool ok = false;
+        switch (spec.op) {
+        case LCBX_SDCMD_REMOVE:
+            ok = lcb_subdocspecs_remove(cmdsEnc.cmd(), i, spec.flags,
+                                        spec.path.data(),
+                                        spec.path.size()) == LCB_SUCCESS;
+            break;
+        case LCBX_SDCMD_REPLACE:
+            ok = cmdsEnc.parseOption<&lcb_subdocspecs_replace>(i, spec.flags,
+                                                               spec.path, value);
+            break;
+        case LCBX_SDCMD_DICT_ADD:
+            ok = cmdsEnc.parseOption<&lcb_subdocspecs_dict_add>(
+                i, spec.flags, spec.path, value);
+            break;
+        case LCBX_SDCMD_DICT_UPSERT:
+            ok = cmdsEnc.parseOption<&lcb_subdocspecs_dict_upsert>(
+                i, spec.flags, spec.path, value);
+            break;
+        case LCBX_SDCMD_ARRAY_ADD_UNIQUE:
+            ok = cmdsEnc.parseOption<&lcb_subdocspecs_array_add_unique>(
+                i, spec.flags, spec.path, value);
+            break;
+        case LCBX_SDCMD_COUNTER:
+            ok = cmdsEnc.parseOption<&lcb_subdocspecs_counter>(
+                i, spec.flags, spec.path, value);
+            break;
+        case LCBX_SDCMD_ARRAY_INSERT:
+            ok = cmdsEnc.parseOption<&lcb_subdocspecs_array_insert>(
+                i, spec.flags, spec.path, value);
+            break;
+        case LCBX_SDCMD_ARRAY_ADD_FIRST:
+            ok = cmdsEnc.parseOption<&lcb_subdocspecs_array_add_first>(
+                i, spec.flags, spec.path, value);
+            break;
+        case LCBX_SDCMD_ARRAY_ADD_LAST:
+            ok = cmdsEnc.parseOption<&lcb_subdocspecs_array_add_last>(
+                i, spec.flags, spec.path, value);
+            break;
+        default:
+            break;
+        }
+
+        if (!ok) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace couchnode
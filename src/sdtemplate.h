@@ -0,0 +1,81 @@
+#pragma once
+#ifndef SDTEMPLATE_H
+#define SDTEMPLATE_H
+
+#include "addondata.h"
+#include "lcbx.h"
+#include "opbuilder.h"
+#include <libcouchbase/couchbase.h>
+#include <nan.h>
+#include <node.h>
+#include <string>
+#include <vector>
+
+namespace couchnode
+{
+
+using namespace v8;
+
+// A set of sub-document specs whose opcodes, flags and paths are decoded
+// once, so that lookupIn/mutateIn calls which reuse it only have to supply
+// the values.  It is passed in place of the usual flat spec array as the
+// first element of the array, followed by one value per mutation spec.
+class SubdocTemplate : public Nan::ObjectWrap
+{
+public:
+    static NAN_MODULE_INIT(Init);
+
+    static inline Nan::Persistent<FunctionTemplate> &functionTemplate()
+    {
+        return addondata::Get()->_subdocTemplateClass;
+    }
+
+    // Returns the template at the head of a spec array, or nullptr if the
+    // array holds regular specs.
+    static SubdocTemplate *fromCmds(Local<Array> cmds);
+
+    bool isMutation() const
+    {
+        return _isMutation;
+    }
+
+    // The specs of a lookup template, ready to be passed to libcouchbase.
+    const lcb_SUBDOCSPECS *lookupSpecs() const
+    {
+        return _lookupSpecs;
+    }
+
+    // Fills in the specs of a mutation from the values which follow the
+    // template in the spec array.  Every spec is still built anew on each
+    // call, path included: libcouchbase only lets a spec's value be set
+    // together with its path, and a list of specs shared with a command
+    // copies every spec as soon as one of them changes.  The template only
+    // saves decoding the opcodes, flags and paths from JavaScript.
+    bool encodeMutation(CmdBuilder<lcb_SUBDOCSPECS> &cmdsEnc,
+                        Local<Array> cmds) const;
+
+    size_t size() const
+    {
+        return _specs.size();
+    }
+
+private:
+    struct Spec {
+        lcbx_SDCMD op;
+        uint32_t flags;
+        std::string path;
+    };
+
+    SubdocTemplate(bool isMutation);
+    ~SubdocTemplate();
+
+    static NAN_METHOD(fnNew);
+
+    bool _isMutation;
+    std::vector<Spec> _specs;
+    lcb_SUBDOCSPECS *_lookupSpecs;
+};
+
+} // namespace couchnode
+
+#endif // SDTEMPLATE_H
@@ -77,6 +77,198 @@ describe('#Cluster', function () {
     cluster.close()
   })
 
+  it('should perform kv operations on io threads', async function () {
+    var cluster = await H.lib.Cluster.connect(H.connStr, {
+      ...H.connOpts,
+      kvIoThreads: 2,
+    })
+    var bucket = cluster.bucket(H.bucketName)
+    var coll = bucket.defaultCollection()
+
+    var testKeys = [H.genTestKey(), H.genTestKey(), H.genTestKey()]
+    await Promise.all(testKeys.map((key, idx) => coll.insert(key, { idx })))
+
+    for (var idx = 0; idx < testKeys.length; ++idx) {
+      var res = await coll.get(testKeys[idx])
+      assert.deepStrictEqual(res.value, { idx })
+    }
+
+    await H.throwsHelper(async () => {
+      await coll.insert(testKeys[0], 'bar')
+    }, H.lib.DocumentExistsError)
+
+    cluster.close()
+  })
+
+  it('should return mutation tokens from io threads', async function () {
+    // Only check for tokens on the io threads when the server hands them out
+    var testKey = H.genTestKey()
+    var directRes = await H.dco.upsert(testKey, 'foo')
+
+    var cluster = await H.lib.Cluster.connect(H.connStr, {
+      ...H.connOpts,
+      kvIoThreads: 2,
+    })
+    var coll = cluster.bucket(H.bucketName).defaultCollection()
+
+    var upsertRes = await coll.upsert(testKey, 'bar')
+    var counterKey = H.genTestKey()
+    var counterRes = await coll.binary().increment(counterKey, 1, {
+      initial: 5,
+    })
+    assert.strictEqual(counterRes.value, 5)
+
+    if (directRes.token) {
+      for (const res of [upsertRes, counterRes]) {
+        assert.ok(res.token)
+        assert.strictEqual(res.token.toString().split(':')[3], H.bucketName)
+      }
+    }
+
+    cluster.close()
+  })
+
+  it('should cancel io thread operations in flight on close', async function () {
+    var cluster = await H.lib.Cluster.connect(H.connStr, {
+      ...H.connOpts,
+      kvIoThreads: 2,
+    })
+    var coll = cluster.bucket(H.bucketName).defaultCollection()
+
+    // Make sure the bucket is open so the operations are actually dispatched
+    await coll.upsert(H.genTestKey(), 'foo')
+
+    var ops = []
+    for (var i = 0; i < 50; ++i) {
+      ops.push(coll.upsert(H.genTestKey(), 'bar'))
+    }
+    cluster.close()
+
+    var results = await Promise.allSettled(ops)
+    for (const res of results) {
+      if (res.status === 'rejected') {
+        assert.ok(res.reason instanceof H.lib.RequestCanceledError)
+      }
+    }
+  })
+
+  it('should error io thread operations after failed connect', async function () {
+    var cluster = await H.lib.Cluster.connect(H.connStr, {
+      ...H.connOpts,
+      kvIoThreads: 2,
+    })
+    var coll = cluster.bucket('invalid-bucket').defaultCollection()
+
+    await H.throwsHelper(async () => {
+      await coll.insert(H.genTestKey(), 'bar')
+    }, Error)
+
+    cluster.close()
+  })
+
+  it('should close io thread connections while they still log', async function () {
+    var logs = []
+    var cluster = await H.lib.Cluster.connect(H.connStr, {
+      ...H.connOpts,
+      kvIoThreads: 2,
+      logFunc: (entry) => logs.push(entry),
+    })
+    var coll = cluster.bucket(H.bucketName).defaultCollection()
+
+    var ops = []
+    for (var i = 0; i < 10; ++i) {
+      ops.push(coll.upsert(H.genTestKey(), 'bar'))
+    }
+    cluster.close()
+
+    await Promise.allSettled(ops)
+    assert.ok(logs.length > 0)
+  })
+
+  it('should report kv operation timings when enabled', async function () {
+    var cluster = await H.lib.Cluster.connect(H.connStr, {
+      ...H.connOpts,
+      kvOpTimings: true,
+    })
+    var bucket = cluster.bucket(H.bucketName)
+    var coll = bucket.defaultCollection()
+
+    var testKey = H.genTestKey()
+    var results = [await coll.upsert(testKey, 'bar'), await coll.get(testKey)]
+    for (const res of results) {
+      assert.ok(res.timings)
+      for (const part of ['queue', 'network', 'server']) {
+        assert.strictEqual(typeof res.timings[part], 'number')
+        assert.ok(res.timings[part] >= 0)
+      }
+    }
+
+    var numOps = 0
+    var nodeTimings = bucket.kvOpTimings()
+    assert.ok(Array.isArray(nodeTimings))
+    for (const node of nodeTimings) {
+      assert.strictEqual(typeof node.endpoint, 'string')
+      for (const hg of [node.queue, node.network, node.server]) {
+        for (const bucket of hg) {
+          assert.ok(bucket.min <= bucket.max)
+          assert.ok(bucket.count > 0)
+        }
+      }
+      numOps += node.queue.reduce((sum, bucket) => sum + bucket.count, 0)
+    }
+    assert.ok(numOps >= results.length)
+
+    cluster.close()
+
+    assert.throws(() => bucket.kvOpTimings(), /closed connection/)
+  })
+
+  it('should not report kv operation timings by default', async function () {
+    var cluster = await H.lib.Cluster.connect(H.connStr, H.connOpts)
+    var coll = cluster.bucket(H.bucketName).defaultCollection()
+
+    var res = await coll.upsert(H.genTestKey(), 'bar')
+    assert.strictEqual(res.timings, undefined)
+
+    cluster.close()
+  })
+
+  it('should support alternate cas representations', async function () {
+    for (const casMode of ['compact', 'bigint']) {
+      var cluster = await H.lib.Cluster.connect(H.connStr, {
+        ...H.connOpts,
+        casMode,
+      })
+      var bucket = cluster.bucket(H.bucketName)
+      var coll = bucket.defaultCollection()
+
+      var testKey = H.genTestKey()
+      var insRes = await coll.insert(testKey, 'bar')
+      var getRes = await coll.get(testKey)
+      assert.strictEqual(insRes.cas.toString(), getRes.cas.toString())
+      if (casMode === 'bigint') {
+        assert.strictEqual(typeof getRes.cas, 'bigint')
+      }
+
+      await coll.replace(testKey, 'baz', { cas: getRes.cas })
+      await H.throwsHelper(async () => {
+        await coll.replace(testKey, 'qux', { cas: getRes.cas.toString() })
+      }, H.lib.CasMismatchError)
+
+      // Each of these characters has the low byte of the digit it replaces
+      var curRes = await coll.get(testKey)
+      var wideCas = curRes.cas
+        .toString()
+        .replace(/\d/g, (c) => String.fromCharCode(0x100 | c.charCodeAt(0)))
+      await H.throwsHelper(async () => {
+        await coll.replace(testKey, 'qux', { cas: wideCas })
+      }, Error)
+      assert.deepStrictEqual((await coll.get(testKey)).value, 'baz')
+
+      cluster.close()
+    }
+  })
+
   it('lcbVersion property should work', function () {
     assert(typeof H.lib.lcbVersion === 'string')
   })
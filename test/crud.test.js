@@ -583,6 +583,31 @@ function genericTests(collFn) {
       assert.deepStrictEqual(gres.value.arr, [1, 2, 3, 4, 5, 6])
     })
 
+    it('should lookupIn and mutateIn with spec templates', async function () {
+      var lookupTmpl = new H.lib.LookupInSpecTemplate([
+        H.lib.LookupInSpec.get('baz'),
+        H.lib.LookupInSpec.exists('not-exists'),
+      ])
+      var mutateTmpl = new H.lib.MutateInSpecTemplate([
+        H.lib.MutateInSpec.increment('bar', 1),
+        H.lib.MutateInSpec.upsert('baz', 'first'),
+      ])
+
+      await collFn().mutateIn(testKeySd, mutateTmpl)
+      var res = await collFn().lookupIn(testKeySd, lookupTmpl)
+      assert.deepStrictEqual(res.content[0].value, 'first')
+      assert.deepStrictEqual(res.content[1].value, false)
+
+      var mres = await collFn().mutateIn(
+        testKeySd,
+        mutateTmpl.bind([10, 'second'])
+      )
+      assert.strictEqual(mres.content[0].value, 16)
+
+      res = await collFn().lookupIn(testKeySd, lookupTmpl)
+      assert.deepStrictEqual(res.content[0].value, 'second')
+    })
+
     it('should cas mismatch when mutatein with wrong cas', async function () {
       var getRes = await collFn().get(testKeySd)
 
@@ -1,6 +1,8 @@
 'use strict'
 
 const assert = require('chai').assert
+const binding = require('../lib/binding').default
+const { translateCppError } = require('../lib/bindingutilities')
 const H = require('./harness')
 
 function genericTests(collFn) {
@@ -14,8 +16,99 @@ function genericTests(collFn) {
     }
     assert(false, 'should never reach here')
   })
+
+  it('should fill the context of repeated misses', async function () {
+    for (let i = 0; i < 3; ++i) {
+      const testKey = 'some-missing-key-' + i
+      try {
+        await collFn().get(testKey)
+      } catch (err) {
+        assert.instanceOf(err, H.lib.DocumentNotFoundError)
+        assert.strictEqual(err.context.key, testKey)
+        assert.strictEqual(err.context.bucket, H.bucketName)
+        assert.isNumber(err.context.status_code)
+        continue
+      }
+      assert(false, 'should never reach here')
+    }
+  })
 }
 
+describe('#error-translation', function () {
+  function fakeKvError(reads) {
+    const cppErr = { code: binding.LCB_ERR_DOCUMENT_NOT_FOUND, ctxtype: 'kv' }
+    for (const field of [
+      'status_code',
+      'opaque',
+      'cas',
+      'key',
+      'bucket',
+      'collection',
+      'scope',
+      'context',
+      'ref',
+    ]) {
+      Object.defineProperty(cppErr, field, {
+        get() {
+          reads.push(field)
+          // Like the binding, hand out a new object on every read of the cas
+          return field === 'cas' ? { cas: field } : field
+        },
+      })
+    }
+    return cppErr
+  }
+
+  it('should only read the context fields which are accessed', function () {
+    const reads = []
+    const err = translateCppError(fakeKvError(reads))
+    assert.instanceOf(err, H.lib.DocumentNotFoundError)
+    assert.instanceOf(err.context, H.lib.KeyValueErrorContext)
+    assert.deepEqual(reads, [])
+
+    assert.strictEqual(err.context.key, 'key')
+    assert.deepEqual(reads, ['key'])
+  })
+
+  it('should read each context field only once', function () {
+    const reads = []
+    const err = translateCppError(fakeKvError(reads))
+
+    assert.strictEqual(err.context.cas, err.context.cas)
+    assert.strictEqual(err.context.opaque, 'opaque')
+    assert.strictEqual(err.context.opaque, 'opaque')
+    assert.deepEqual(reads, ['cas', 'opaque'])
+
+    const json = JSON.parse(JSON.stringify(err.context))
+    assert.deepEqual(json.cas, { cas: 'cas' })
+    assert.strictEqual(json.ref, 'ref')
+    assert.strictEqual(reads.filter((field) => field === 'cas').length, 1)
+  })
+
+  it('should allow assigning context fields', function () {
+    const reads = []
+    const err = translateCppError(fakeKvError(reads))
+
+    err.context.key = 'other-key'
+    err.context.cas = 'other-cas'
+    assert.strictEqual(err.context.key, 'other-key')
+    assert.strictEqual(err.context.cas, 'other-cas')
+    assert.deepEqual(reads, [])
+
+    err.context.key = 'last-key'
+    assert.strictEqual(err.context.key, 'last-key')
+    assert.include(Object.keys(err.context), 'key')
+  })
+
+  it('should not share causes between errors', function () {
+    const err1 = translateCppError(fakeKvError([]))
+    const err2 = translateCppError(fakeKvError([]))
+    assert.instanceOf(err1.cause, Error)
+    assert.notStrictEqual(err1.cause, err2.cause)
+    assert.strictEqual(err1.cause.code, err2.cause.code)
+  })
+})
+
 describe('#errors', function () {
   /* eslint-disable-next-line mocha/no-setup-in-describe */
   genericTests(() => H.dco)
@@ -0,0 +1,381 @@
+'use strict'
+
+// Key-value benchmark for the binding.
+//
+// Runs a mix of get, upsert and subdoc lookup operations through the public
+// API against the mock server (or a real cluster, with --connstr) and
+// reports throughput and latency.  When the instrumented addon is built
+// (node-gyp rebuild --couchbase_bench=1), it also reports the CPU time the
+// binding spends in each stage of an operation and the number of native
+// allocations per operation.  With --kv-op-timings, it also reports where
+// the latency of operations went (queued in the SDK, network or server).
+//
+//   npm run bench -- --ops=200000 --concurrency=128 --mix=get:80,upsert:20
+
+const bindings = require('bindings')
+
+const BENCH_DEFAULTS = {
+  connstr: undefined,
+  username: 'default',
+  password: '',
+  bucket: 'default',
+  ops: 100000,
+  warmup: 10000,
+  concurrency: 64,
+  keys: 1000,
+  size: 256,
+  mix: 'get:70,upsert:20,subdoc:10',
+  ioThreads: 0,
+  kvOpTimings: false,
+  native: 'bench',
+  json: false,
+}
+
+function parseArgs(argv) {
+  const opts = Object.assign({}, BENCH_DEFAULTS)
+  argv.forEach((arg) => {
+    const match = /^--([a-zA-Z-]+)(?:=(.*))?$/.exec(arg)
+    if (!match) {
+      throw new Error('unexpected argument: ' + arg)
+    }
+
+    const name = match[1].replace(/-([a-z])/g, (m, c) => c.toUpperCase())
+    if (!(name in BENCH_DEFAULTS)) {
+      throw new Error('unknown option: --' + match[1])
+    }
+
+    const value = match[2] === undefined ? 'true' : match[2]
+    if (typeof BENCH_DEFAULTS[name] === 'number') {
+      opts[name] = parseInt(value, 10)
+    } else if (typeof BENCH_DEFAULTS[name] === 'boolean') {
+      opts[name] = value === 'true'
+    } else {
+      opts[name] = value
+    }
+  })
+  return opts
+}
+
+function parseMix(mixStr) {
+  const mix = []
+  let total = 0
+  mixStr.split(',').forEach((part) => {
+    const [op, weightStr] = part.split(':')
+    if (['get', 'upsert', 'subdoc'].indexOf(op) === -1) {
+      throw new Error('unknown operation in mix: ' + op)
+    }
+    const weight = parseInt(weightStr, 10)
+    if (!(weight > 0)) {
+      throw new Error('bad weight in mix: ' + part)
+    }
+    total += weight
+    mix.push({ op: op, until: total })
+  })
+  return { ops: mix, total: total }
+}
+
+function pickOp(mix) {
+  const pick = Math.random() * mix.total
+  for (let i = 0; i < mix.ops.length; ++i) {
+    if (pick < mix.ops[i].until) {
+      return mix.ops[i].op
+    }
+  }
+  return mix.ops[mix.ops.length - 1].op
+}
+
+const opts = parseArgs(process.argv.slice(2))
+
+// The SDK always loads couchbase_impl, so the instrumented addon is swapped
+// in underneath it when it has been built.
+let benchBinding = null
+if (opts.native === 'bench') {
+  require.cache[require.resolve('bindings')].exports = function (name) {
+    if (name === 'couchbase_impl') {
+      try {
+        benchBinding = bindings('couchbase_bench')
+        return benchBinding
+      } catch (e) {
+        console.error(
+          'couchbase_bench is not built, stage timings are unavailable ' +
+            '(node-gyp rebuild --couchbase_bench=1)'
+        )
+      }
+    }
+    return bindings(name)
+  }
+}
+
+const couchbase = require('../lib/couchbase')
+const jcbmock = require('./jcbmock')
+
+function startMock() {
+  return new Promise((resolve, reject) => {
+    jcbmock.create({ replicas: 0 }, (err, mock) => {
+      if (err) {
+        reject(err)
+        return
+      }
+
+      mock.command('get_mcports', (err, ports) => {
+        if (err) {
+          reject(err)
+          return
+        }
+
+        const hosts = ports.map((port) => 'localhost:' + port)
+        resolve({ mock: mock, connstr: 'couchbase://' + hosts.join(',') })
+      })
+    })
+  })
+}
+
+function benchKey(idx) {
+  return 'kvbench_' + idx
+}
+
+async function runOps(coll, opts, mix, numOps, latencies, timings) {
+  const value = {
+    name: 'kvbench',
+    pad: 'x'.repeat(Math.max(0, opts.size - 32)),
+  }
+  const lookupSpecs = [couchbase.LookupInSpec.get('name')]
+  const counts = { get: 0, upsert: 0, subdoc: 0, errors: 0 }
+
+  let issued = 0
+  const worker = async () => {
+    while (issued < numOps) {
+      issued++
+
+      const op = pickOp(mix)
+      const key = benchKey(Math.floor(Math.random() * opts.keys))
+      const start = process.hrtime.bigint()
+      try {
+        let res
+        if (op === 'get') {
+          res = await coll.get(key)
+        } else if (op === 'upsert') {
+          res = await coll.upsert(key, value)
+        } else {
+          res = await coll.lookupIn(key, lookupSpecs)
+        }
+        counts[op]++
+        if (timings && res.timings) {
+          timings.count++
+          timings.queue += res.timings.queue
+          timings.network += res.timings.network
+          timings.server += res.timings.server
+        }
+      } catch (e) {
+        counts.errors++
+      }
+      if (latencies) {
+        latencies.push(Number(process.hrtime.bigint() - start) / 1000)
+      }
+    }
+  }
+
+  const workers = []
+  for (let i = 0; i < opts.concurrency; ++i) {
+    workers.push(worker())
+  }
+  await Promise.all(workers)
+  return counts
+}
+
+function percentile(sorted, pct) {
+  if (sorted.length === 0) {
+    return 0
+  }
+  const idx = Math.min(sorted.length - 1, Math.floor(sorted.length * pct))
+  return sorted[idx]
+}
+
+function buildReport(
+  opts,
+  counts,
+  wallNs,
+  cpuUsage,
+  latencies,
+  timings,
+  stats
+) {
+  const numOps = latencies.length
+  latencies.sort((a, b) => a - b)
+
+  const report = {
+    ops: numOps,
+    counts: counts,
+    opsPerSec: numOps / (Number(wallNs) / 1e9),
+    latencyUs: {
+      p50: percentile(latencies, 0.5),
+      p90: percentile(latencies, 0.9),
+      p99: percentile(latencies, 0.99),
+      p999: percentile(latencies, 0.999),
+      max: latencies[numOps - 1],
+    },
+    // Whole process, including any I/O threads
+    cpuUsPerOp: (cpuUsage.user + cpuUsage.system) / numOps,
+    opTimingsUs: undefined,
+    stages: undefined,
+    allocationsPerOp: undefined,
+  }
+
+  if (timings && timings.count > 0) {
+    report.opTimingsUs = {
+      queue: timings.queue / timings.count,
+      network: timings.network / timings.count,
+      server: timings.server / timings.count,
+    }
+  }
+
+  if (stats) {
+    report.stages = {}
+    let stagesUs = 0
+    Object.keys(stats.stages).forEach((name) => {
+      const stage = stats.stages[name]
+      const usPerOp = stage.cpuNs / 1000 / numOps
+      report.stages[name] = { cpuUsPerOp: usPerOp, count: stage.count }
+      stagesUs += usPerOp
+    })
+    // The JS layers of the SDK, libcouchbase I/O and garbage collection
+    report.stages.other = {
+      cpuUsPerOp: Math.max(0, report.cpuUsPerOp - stagesUs),
+    }
+    report.clock = stats.clock
+    if (stats.allocations !== undefined) {
+      report.allocationsPerOp = stats.allocations / numOps
+    }
+  }
+
+  return report
+}
+
+function printReport(opts, report) {
+  const fmt = (n) => n.toFixed(2)
+
+  console.log(
+    'mix=%s concurrency=%d keys=%d size=%d ioThreads=%d',
+    opts.mix,
+    opts.concurrency,
+    opts.keys,
+    opts.size,
+    opts.ioThreads
+  )
+  console.log(
+    'ops: %d (get=%d upsert=%d subdoc=%d errors=%d)',
+    report.ops,
+    report.counts.get,
+    report.counts.upsert,
+    report.counts.subdoc,
+    report.counts.errors
+  )
+  console.log('throughput: %s ops/sec', report.opsPerSec.toFixed(0))
+  console.log(
+    'latency (us): p50=%s p90=%s p99=%s p99.9=%s max=%s',
+    fmt(report.latencyUs.p50),
+    fmt(report.latencyUs.p90),
+    fmt(report.latencyUs.p99),
+    fmt(report.latencyUs.p999),
+    fmt(report.latencyUs.max)
+  )
+  if (report.opTimingsUs) {
+    console.log(
+      'mean op breakdown (us): queue=%s network=%s server=%s',
+      fmt(report.opTimingsUs.queue),
+      fmt(report.opTimingsUs.network),
+      fmt(report.opTimingsUs.server)
+    )
+  }
+  console.log('process cpu: %s us/op', fmt(report.cpuUsPerOp))
+
+  if (report.stages) {
+    console.log('binding cpu per op (%s clock):', report.clock)
+    Object.keys(report.stages).forEach((name) => {
+      const usPerOp = report.stages[name].cpuUsPerOp
+      console.log('  %s %s us', name.padEnd(10), fmt(usPerOp))
+    })
+  }
+  if (report.allocationsPerOp !== undefined) {
+    console.log('native allocations: %s per op', fmt(report.allocationsPerOp))
+  }
+}
+
+async function main() {
+  const mix = parseMix(opts.mix)
+
+  let mockInfo = null
+  let connstr = opts.connstr
+  if (!connstr) {
+    mockInfo = await startMock()
+    connstr = mockInfo.connstr
+  }
+
+  const cluster = await couchbase.Cluster.connect(connstr, {
+    username: opts.username,
+    password: opts.password,
+    kvIoThreads: opts.ioThreads,
+    kvOpTimings: opts.kvOpTimings,
+  })
+  const coll = cluster.bucket(opts.bucket).defaultCollection()
+
+  try {
+    // Every key exists before it is read
+    const value = { name: 'kvbench', pad: 'x'.repeat(opts.size) }
+    for (let i = 0; i < opts.keys; ++i) {
+      await coll.upsert(benchKey(i), value)
+    }
+
+    await runOps(coll, opts, mix, opts.warmup, null)
+
+    if (global.gc) {
+      global.gc()
+    }
+    if (benchBinding) {
+      benchBinding.benchReset()
+    }
+
+    const latencies = []
+    const timings = opts.kvOpTimings
+      ? { count: 0, queue: 0, network: 0, server: 0 }
+      : null
+    const cpuStart = process.cpuUsage()
+    const wallStart = process.hrtime.bigint()
+    const counts = await runOps(
+      coll,
+      opts,
+      mix,
+      opts.ops,
+      latencies,
+      timings
+    )
+    const wallNs = process.hrtime.bigint() - wallStart
+    const cpuUsage = process.cpuUsage(cpuStart)
+    const stats = benchBinding ? benchBinding.benchStats() : null
+
+    const report = buildReport(
+      opts,
+      counts,
+      wallNs,
+      cpuUsage,
+      latencies,
+      timings,
+      stats
+    )
+    if (opts.json) {
+      console.log(JSON.stringify(report))
+    } else {
+      printReport(opts, report)
+    }
+  } finally {
+    await cluster.close()
+    if (mockInfo) {
+      mockInfo.mock.close()
+    }
+  }
+}
+
+main().catch((err) => {
+  console.error(err)
+  process.exit(1)
+})
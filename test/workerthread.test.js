@@ -39,4 +39,27 @@ describe('#worker-threads', function () {
       throw res.error
     }
   }).timeout(30000)
+
+  it('should share kv io threads between workers', async function () {
+    if (semver.lt(process.version, '12.11.0')) {
+      return this.skip()
+    }
+
+    const connOpts = { ...H.connOpts, kvIoThreads: 2 }
+    const results = await Promise.all(
+      [0, 1, 2, 3].map(() =>
+        startWorker({
+          connStr: H.connStr,
+          connOpts: connOpts,
+          bucketName: H.bucketName,
+          testKey: H.genTestKey(),
+        })
+      )
+    )
+    results.forEach((res) => {
+      if (!res.success) {
+        throw res.error
+      }
+    })
+  }).timeout(30000)
 })